@@ -0,0 +1,17 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/eigen-download"
+  "CMakeFiles/eigen-download-complete"
+  "eigen-download-prefix/src/eigen-download-stamp/eigen-download-build"
+  "eigen-download-prefix/src/eigen-download-stamp/eigen-download-configure"
+  "eigen-download-prefix/src/eigen-download-stamp/eigen-download-download"
+  "eigen-download-prefix/src/eigen-download-stamp/eigen-download-install"
+  "eigen-download-prefix/src/eigen-download-stamp/eigen-download-mkdir"
+  "eigen-download-prefix/src/eigen-download-stamp/eigen-download-patch"
+  "eigen-download-prefix/src/eigen-download-stamp/eigen-download-test"
+  "eigen-download-prefix/src/eigen-download-stamp/eigen-download-update"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/eigen-download.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,22 @@
+# Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+# file Copyright.txt or https://cmake.org/licensing for details.
+
+cmake_minimum_required(VERSION 3.5)
+
+file(MAKE_DIRECTORY
+  "/root/repo/cmake/../external/eigen"
+  "/tmp/gb/eigen-build"
+  "/root/repo/external/.cache/eigen/eigen-download-prefix"
+  "/root/repo/external/.cache/eigen/eigen-download-prefix/tmp"
+  "/root/repo/external/.cache/eigen/eigen-download-prefix/src/eigen-download-stamp"
+  "/root/repo/external/.cache/eigen/eigen-download-prefix/src"
+  "/root/repo/external/.cache/eigen/eigen-download-prefix/src/eigen-download-stamp"
+)
+
+set(configSubDirs )
+foreach(subDir IN LISTS configSubDirs)
+    file(MAKE_DIRECTORY "/root/repo/external/.cache/eigen/eigen-download-prefix/src/eigen-download-stamp/${subDir}")
+endforeach()
+if(cfgdir)
+  file(MAKE_DIRECTORY "/root/repo/external/.cache/eigen/eigen-download-prefix/src/eigen-download-stamp${cfgdir}") # cfgdir has leading slash
+endif()
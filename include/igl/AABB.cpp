@@ -17,12 +17,523 @@
 #include "ray_box_intersect.h"
 #include "parallel_for.h"
 #include "ray_mesh_intersect.h"
+#include "ray_triangle_intersect.h"
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <iomanip>
 #include <limits>
 #include <list>
 #include <queue>
 #include <stack>
+#include <thread>
+
+namespace igl
+{
+  namespace AABB_detail
+  {
+    // Spread the lower 10 bits of x out to every third bit
+    inline uint32_t spread_bits(uint32_t x)
+    {
+      x &= 0x3ff;
+      x = (x | (x << 16)) & 0x030000ff;
+      x = (x | (x << 8)) & 0x0300f00f;
+      x = (x | (x << 4)) & 0x030c30c3;
+      x = (x | (x << 2)) & 0x09249249;
+      return x;
+    }
+    // Interleave the bits of three 10-bit coordinates
+    inline uint32_t morton_code(
+      const uint32_t x,
+      const uint32_t y,
+      const uint32_t z)
+    {
+      return spread_bits(x) | (spread_bits(y) << 1) | (spread_bits(z) << 2);
+    }
+    // Order rays by coarse direction, then by origin along a Morton curve
+    //
+    // Inputs:
+    //   O  #R by 3 list of ray origins
+    //   D  #R by 3 list of ray directions
+    // Outputs:
+    //   order  #R list of indices into O
+    template <typename DerivedO, typename DerivedD>
+    inline void coherent_order(
+      const Eigen::MatrixBase<DerivedO> & O,
+      const Eigen::MatrixBase<DerivedD> & D,
+      std::vector<int> & order)
+    {
+      typedef typename DerivedO::Scalar Scalar;
+      const int n = O.rows();
+      const Eigen::Matrix<Scalar,1,3> min = O.colwise().minCoeff();
+      const Eigen::Matrix<Scalar,1,3> ext =
+        (O.colwise().maxCoeff()-min).cwiseMax(Scalar(0));
+      std::vector<uint64_t> key(n);
+      for(int r = 0;r<n;r++)
+      {
+        uint32_t q[3], b[3];
+        const Scalar norm = D.row(r).norm();
+        for(int c = 0;c<3;c++)
+        {
+          q[c] = ext(c) > 0 ?
+            std::min<uint32_t>(1023,uint32_t(1023*((O(r,c)-min(c))/ext(c)))) : 0;
+          // 8 bins per component of the unit direction
+          const Scalar u = norm > 0 ? D(r,c)/norm : Scalar(0);
+          b[c] = std::min<uint32_t>(7,uint32_t(4*(u+1)));
+        }
+        key[r] =
+          (uint64_t(morton_code(b[0],b[1],b[2])) << 30) |
+          morton_code(q[0],q[1],q[2]);
+      }
+      order.resize(n);
+      for(int r = 0;r<n;r++)
+      {
+        order[r] = r;
+      }
+      std::sort(
+        order.begin(),
+        order.end(),
+        [&key](const int a, const int b){ return key[a] < key[b]; });
+    }
+
+    // Order points along a Morton curve through their bounding box
+    //
+    // Inputs:
+    //   P  #P by dim list of points (only the first 3 coordinates are used)
+    // Outputs:
+    //   order  #P list of indices into P
+    template <typename DerivedP>
+    inline void morton_order(
+      const Eigen::MatrixBase<DerivedP> & P,
+      std::vector<int> & order)
+    {
+      typedef typename DerivedP::Scalar Scalar;
+      const int n = P.rows();
+      const int dim = std::min<int>(P.cols(),3);
+      order.resize(n);
+      if(n == 0)
+      {
+        return;
+      }
+      const Eigen::Matrix<Scalar,1,Eigen::Dynamic> min = P.colwise().minCoeff();
+      const Eigen::Matrix<Scalar,1,Eigen::Dynamic> ext =
+        (P.colwise().maxCoeff()-min).cwiseMax(Scalar(0));
+      // Code in the upper, index in the lower half so that sorting does not
+      // chase indices
+      std::vector<uint64_t> key(n);
+      for(int r = 0;r<n;r++)
+      {
+        uint32_t q[3] = {0,0,0};
+        for(int c = 0;c<dim;c++)
+        {
+          q[c] = ext(c) > 0 ?
+            std::min<uint32_t>(1023,uint32_t(1023*((P(r,c)-min(c))/ext(c)))) : 0;
+        }
+        key[r] = (uint64_t(morton_code(q[0],q[1],q[2])) << 32) | uint32_t(r);
+      }
+      std::sort(key.begin(),key.end());
+      for(int r = 0;r<n;r++)
+      {
+        order[r] = int(key[r] & 0xffffffff);
+      }
+    }
+
+    // Trace a packet of up to K rays through the tree
+    //
+    // Inputs:
+    //   tree  root of the tree
+    //   V  #V by 3 list of vertex positions
+    //   Ele  #Ele by 3 list of triangle indices
+    //   O  #R by 3 list of ray origins
+    //   D  #R by 3 list of ray directions
+    //   rays  n list of indices into O of the rays of the packet
+    //   n  number of rays in the packet, at most K
+    //   min_t  only report hits closer than min_t
+    //   any_hit  whether to stop a ray at its first hit found
+    // Outputs:
+    //   hits  #R list of hits, only the entries of rays are written
+    template <
+      int K,
+      typename AABBType,
+      typename DerivedV,
+      typename DerivedEle,
+      typename DerivedO,
+      typename DerivedD>
+    inline void intersect_packet(
+      const AABBType & tree,
+      const Eigen::MatrixBase<DerivedV> & V,
+      const Eigen::MatrixBase<DerivedEle> & Ele,
+      const Eigen::MatrixBase<DerivedO> & O,
+      const Eigen::MatrixBase<DerivedD> & D,
+      const int * rays,
+      const int n,
+      const typename AABBType::Scalar min_t,
+      const bool any_hit,
+      std::vector<igl::Hit> & hits)
+    {
+      typedef typename AABBType::Scalar Scalar;
+      typedef Eigen::Array<Scalar,K,1> ArrayK;
+      // Rays as columns of structure of arrays, padding rays never hit
+      ArrayK o[3], inv_d[3];
+      ArrayK t_max = ArrayK::Constant(-std::numeric_limits<Scalar>::infinity());
+      double od[K][3], dd[K][3];
+      Scalar dir_sum[3] = {0,0,0};
+      for(int c = 0;c<3;c++)
+      {
+        o[c].setZero();
+        inv_d[c].setOnes();
+      }
+      for(int k = 0;k<n;k++)
+      {
+        const int r = rays[k];
+        t_max(k) = min_t;
+        for(int c = 0;c<3;c++)
+        {
+          const Scalar d = Scalar(D(r,c));
+          o[c](k) = Scalar(O(r,c));
+          // Nudge zero components so that the slab test stays NaN-free
+          inv_d[c](k) = Scalar(1)/(d != 0 ? d :
+            std::copysign(std::numeric_limits<Scalar>::min(),d));
+          od[k][c] = double(O(r,c));
+          dd[k][c] = double(d);
+          dir_sum[c] += d;
+        }
+      }
+      int active = n;
+      const AABBType * stack[128];
+      int top = 0;
+      stack[top++] = &tree;
+      while(top > 0 && active > 0)
+      {
+        const AABBType * node = stack[--top];
+        ArrayK t_near = ArrayK::Zero();
+        ArrayK t_far = t_max;
+        for(int c = 0;c<3;c++)
+        {
+          const ArrayK t0 = (node->m_box.min()(c)-o[c])*inv_d[c];
+          const ArrayK t1 = (node->m_box.max()(c)-o[c])*inv_d[c];
+          t_near = t_near.max(t0.min(t1));
+          t_far = t_far.min(t0.max(t1));
+        }
+        const Eigen::Array<bool,K,1> enter = t_near <= t_far;
+        if(!enter.any())
+        {
+          continue;
+        }
+        if(node->is_leaf())
+        {
+          const int e = node->m_primitive;
+          double v[3][3];
+          for(int i = 0;i<3;i++)
+          {
+            for(int c = 0;c<3;c++)
+            {
+              v[i][c] = double(V(Ele(e,i),c));
+            }
+          }
+          for(int k = 0;k<n;k++)
+          {
+            double t,u,w;
+            if(enter(k) &&
+              ray_triangle_intersect(od[k],dd[k],v[0],v[1],v[2],t,u,w) &&
+              Scalar(t) < t_max(k))
+            {
+              hits[rays[k]] = {e,-1,float(u),float(w),float(t)};
+              if(any_hit)
+              {
+                t_max(k) = -std::numeric_limits<Scalar>::infinity();
+                active--;
+              }else
+              {
+                t_max(k) = Scalar(t);
+              }
+            }
+          }
+          continue;
+        }
+        assert(top+2 <= 128 && "Tree too deep");
+        // Visit the child on the side the packet comes from first
+        int axis = 0;
+        const Eigen::Matrix<Scalar,3,1> diff =
+          node->m_right->m_box.center()-node->m_left->m_box.center();
+        diff.cwiseAbs().maxCoeff(&axis);
+        const bool left_first = diff(axis)*dir_sum[axis] >= 0;
+        stack[top++] = left_first ? node->m_right : node->m_left;
+        stack[top++] = left_first ? node->m_left : node->m_right;
+      }
+    }
+
+    // Closest points on the triangle (a,b,c) to a SIMD packet of points. Same
+    // region tests as point_simplex_squared_distance (Ericson, Real-time
+    // collision detection, Chapter 5), but every region is evaluated and
+    // picked by masks instead of branches.
+    //
+    // Inputs:
+    //   a,b,c  dim-long triangle corners
+    //   p  dim list of packets of point coordinates
+    // Outputs:
+    //   q  dim list of packets of closest point coordinates
+    //   sqr_d  packet of squared distances
+    template <typename Packet, int DIM, typename Scalar>
+    inline void point_triangle_squared_distance_packet(
+      const Scalar * a,
+      const Scalar * b,
+      const Scalar * c,
+      const Packet (&p)[DIM],
+      Packet (&q)[DIM],
+      Packet & sqr_d)
+    {
+      using namespace Eigen::internal;
+      const Packet zero = pset1<Packet>(Scalar(0));
+      Packet ab[DIM], ac[DIM], bc[DIM];
+      bool a_is_b = true;
+      Packet d1 = zero, d2 = zero, d3 = zero, d4 = zero, d5 = zero, d6 = zero;
+      for(int j = 0;j<DIM;j++)
+      {
+        ab[j] = pset1<Packet>(b[j]-a[j]);
+        ac[j] = pset1<Packet>(c[j]-a[j]);
+        bc[j] = pset1<Packet>(c[j]-b[j]);
+        a_is_b = a_is_b && a[j] == b[j];
+        const Packet ap = psub(p[j],pset1<Packet>(a[j]));
+        const Packet bp = psub(p[j],pset1<Packet>(b[j]));
+        const Packet cp = psub(p[j],pset1<Packet>(c[j]));
+        d1 = padd(d1,pmul(ab[j],ap));
+        d2 = padd(d2,pmul(ac[j],ap));
+        d3 = padd(d3,pmul(ab[j],bp));
+        d4 = padd(d4,pmul(ac[j],bp));
+        d5 = padd(d5,pmul(ab[j],cp));
+        d6 = padd(d6,pmul(ac[j],cp));
+      }
+      const Packet vc = psub(pmul(d1,d4),pmul(d3,d2));
+      const Packet vb = psub(pmul(d5,d2),pmul(d1,d6));
+      const Packet va = psub(pmul(d3,d6),pmul(d5,d4));
+      const Packet d43 = psub(d4,d3);
+      const Packet d56 = psub(d5,d6);
+      // Regions in the order point_simplex_squared_distance tests them
+      const Packet in_a = pand(pcmp_le(d1,zero),pcmp_le(d2,zero));
+      const Packet in_b = pand(pcmp_le(zero,d3),pcmp_le(d4,d3));
+      const Packet in_ab = a_is_b ? zero : pand(
+        pcmp_le(vc,zero),pand(pcmp_le(zero,d1),pcmp_le(d3,zero)));
+      const Packet in_c = pand(pcmp_le(zero,d6),pcmp_le(d5,d6));
+      const Packet in_ac = pand(
+        pcmp_le(vb,zero),pand(pcmp_le(zero,d2),pcmp_le(d6,zero)));
+      const Packet in_bc = pand(
+        pcmp_le(va,zero),pand(pcmp_le(zero,d43),pcmp_le(zero,d56)));
+      // Each point in the first region it passes
+      const Packet on_a = in_a;
+      const Packet on_b = pandnot(in_b,on_a);
+      const Packet on_ab = pandnot(in_ab,por(on_a,in_b));
+      const Packet before_c = por(por(in_a,in_b),in_ab);
+      const Packet on_c = pandnot(in_c,before_c);
+      const Packet before_ac = por(before_c,in_c);
+      const Packet on_ac = pandnot(in_ac,before_ac);
+      const Packet on_bc = pandnot(in_bc,por(before_ac,in_ac));
+      // q = base + s*e1 + t*ac with e1 = ab, or bc on the edge bc
+      const Packet at_vertex = por(por(on_a,on_b),on_c);
+      const Packet denom = pdiv(pset1<Packet>(Scalar(1)),padd(padd(va,vb),vc));
+      Packet s = pmul(vb,denom);
+      s = pselect(on_bc,pdiv(d43,padd(d43,d56)),s);
+      s = pselect(on_ab,pdiv(d1,psub(d1,d3)),s);
+      s = pselect(por(at_vertex,on_ac),zero,s);
+      Packet t = pmul(vc,denom);
+      t = pselect(on_ac,pdiv(d2,psub(d2,d6)),t);
+      t = pselect(por(at_vertex,por(on_ab,on_bc)),zero,t);
+      const Packet from_b = por(on_b,on_bc);
+      sqr_d = zero;
+      for(int j = 0;j<DIM;j++)
+      {
+        const Packet base = pselect(from_b,pset1<Packet>(b[j]),
+          pselect(on_c,pset1<Packet>(c[j]),pset1<Packet>(a[j])));
+        const Packet e1 = pselect(on_bc,bc[j],ab[j]);
+        q[j] = padd(padd(base,pmul(s,e1)),pmul(t,ac[j]));
+        const Packet diff = psub(p[j],q[j]);
+        sqr_d = padd(sqr_d,pmul(diff,diff));
+      }
+    }
+
+    // Find the closest points on the triangles of the tree to a packet of up
+    // to K points, descending into a subtree if any point in the packet might
+    // still find something closer there
+    //
+    // Inputs:
+    //   tree  root of the tree
+    //   V  #V by dim list of vertex positions
+    //   Ele  #Ele by 3 list of triangle indices
+    //   P  #P by dim list of query points
+    //   points  n list of indices into P of the points of the packet
+    //   n  number of points in the packet, at most K
+    // Outputs:
+    //   sqrD  #P list of squared distances, only the entries of points are
+    //     written
+    //   I  #P list of indices into Ele of closest triangles
+    //   C  #P by dim list of closest points
+    template <
+      int K,
+      typename AABBType,
+      typename DerivedV,
+      typename DerivedEle,
+      typename DerivedP,
+      typename DerivedsqrD,
+      typename DerivedI,
+      typename DerivedC>
+    inline void squared_distance_packet(
+      const AABBType & tree,
+      const Eigen::MatrixBase<DerivedV> & V,
+      const Eigen::MatrixBase<DerivedEle> & Ele,
+      const Eigen::MatrixBase<DerivedP> & P,
+      const int * points,
+      const int n,
+      Eigen::PlainObjectBase<DerivedsqrD> & sqrD,
+      Eigen::PlainObjectBase<DerivedI> & I,
+      Eigen::PlainObjectBase<DerivedC> & C)
+    {
+      using namespace Eigen::internal;
+      typedef typename AABBType::Scalar Scalar;
+      typedef typename AABBType::RowVectorDIMS RowVectorDIMS;
+      const int DIM = RowVectorDIMS::SizeAtCompileTime;
+      // Widest SIMD packet that divides K (a single Scalar without
+      // vectorization)
+      typedef typename find_best_packet<Scalar,K>::type Packet;
+      const int W = unpacket_traits<Packet>::size;
+      const int NP = K/W;
+      // Points as structure of arrays, padding points are never closer than
+      // -infinity
+      EIGEN_ALIGN_MAX Scalar lanes[DIM][K];
+      EIGEN_ALIGN_MAX Scalar best_lanes[K];
+      for(int k = 0;k<K;k++)
+      {
+        best_lanes[k] = k < n ?
+          std::numeric_limits<Scalar>::infinity() :
+          -std::numeric_limits<Scalar>::infinity();
+        for(int j = 0;j<DIM;j++)
+        {
+          lanes[j][k] = k < n ? Scalar(P(points[k],j)) : Scalar(0);
+        }
+      }
+      int best_i[K];
+      std::fill(best_i,best_i+K,-1);
+      Packet p[NP][DIM], q[NP][DIM], best[NP];
+      for(int w = 0;w<NP;w++)
+      {
+        for(int j = 0;j<DIM;j++)
+        {
+          p[w][j] = pload<Packet>(lanes[j]+w*W);
+          q[w][j] = pset1<Packet>(Scalar(0));
+        }
+        best[w] = pload<Packet>(best_lanes+w*W);
+      }
+      const Packet zero = pset1<Packet>(Scalar(0));
+      const auto box_squared_distance =
+        [&p,&zero](const AABBType * node, Packet (&d)[NP])
+      {
+        for(int w = 0;w<NP;w++)
+        {
+          d[w] = zero;
+          for(int j = 0;j<DIM;j++)
+          {
+            const Packet e = pmax(pmax(
+              psub(pset1<Packet>(node->m_box.min()(j)),p[w][j]),
+              psub(p[w][j],pset1<Packet>(node->m_box.max()(j)))),zero);
+            d[w] = padd(d[w],pmul(e,e));
+          }
+        }
+      };
+      // Subtrees still to visit along with the squared distances of the
+      // points to their boxes
+      const AABBType * stack[128];
+      Packet stack_d[128][NP];
+      int top = 0;
+      stack[top] = &tree;
+      box_squared_distance(&tree,stack_d[top++]);
+      Packet d_left[NP], d_right[NP], active[NP];
+      while(top > 0)
+      {
+        const AABBType * node = stack[--top];
+        bool any_active = false;
+        for(int w = 0;w<NP;w++)
+        {
+          active[w] = pcmp_lt(stack_d[top][w],best[w]);
+          any_active = any_active || predux_any(active[w]);
+        }
+        if(!any_active)
+        {
+          continue;
+        }
+        if(node->is_leaf())
+        {
+          const int e = node->m_primitive;
+          const RowVectorDIMS a = V.row(Ele(e,0));
+          const RowVectorDIMS b = V.row(Ele(e,1));
+          const RowVectorDIMS c = V.row(Ele(e,2));
+          for(int w = 0;w<NP;w++)
+          {
+            if(!predux_any(active[w]))
+            {
+              continue;
+            }
+            Packet cand, cand_q[DIM];
+            point_triangle_squared_distance_packet<Packet,DIM,Scalar>(
+              a.data(),b.data(),c.data(),p[w],cand_q,cand);
+            const Packet closer = pcmp_lt(cand,best[w]);
+            if(!predux_any(closer))
+            {
+              continue;
+            }
+            best[w] = pselect(closer,cand,best[w]);
+            for(int j = 0;j<DIM;j++)
+            {
+              q[w][j] = pselect(closer,cand_q[j],q[w][j]);
+            }
+            EIGEN_ALIGN_MAX Scalar closer_lanes[W];
+            pstore(closer_lanes,closer);
+            for(int l = 0;l<W;l++)
+            {
+              best_i[w*W+l] = closer_lanes[l] != Scalar(0) ? e : best_i[w*W+l];
+            }
+          }
+          continue;
+        }
+        // Nearer child on top, as seen by the points still searching
+        box_squared_distance(node->m_left,d_left);
+        box_squared_distance(node->m_right,d_right);
+        Packet sum_left = zero, sum_right = zero;
+        for(int w = 0;w<NP;w++)
+        {
+          sum_left = padd(sum_left,pselect(active[w],d_left[w],zero));
+          sum_right = padd(sum_right,pselect(active[w],d_right[w],zero));
+        }
+        const bool left_first = predux(sum_left) <= predux(sum_right);
+        stack[top] = left_first ? node->m_right : node->m_left;
+        std::copy(
+          left_first ? d_right : d_left,(left_first ? d_right : d_left)+NP,
+          stack_d[top++]);
+        stack[top] = left_first ? node->m_left : node->m_right;
+        std::copy(
+          left_first ? d_left : d_right,(left_first ? d_left : d_right)+NP,
+          stack_d[top++]);
+      }
+      EIGEN_ALIGN_MAX Scalar q_lanes[DIM][K];
+      for(int w = 0;w<NP;w++)
+      {
+        pstore(best_lanes+w*W,best[w]);
+        for(int j = 0;j<DIM;j++)
+        {
+          pstore(q_lanes[j]+w*W,q[w][j]);
+        }
+      }
+      for(int k = 0;k<n;k++)
+      {
+        const int r = points[k];
+        sqrD(r) = best_lanes[k];
+        I(r) = best_i[k];
+        for(int j = 0;j<DIM;j++)
+        {
+          C(r,j) = q_lanes[j][k];
+        }
+      }
+    }
+  }
+}
 
 template <typename DerivedV, int DIM>
 template <typename DerivedEle, typename Derivedbb_mins, typename Derivedbb_maxs, typename Derivedelements>
@@ -195,6 +706,42 @@ IGL_INLINE void igl::AABB<DerivedV,DIM>::init(
   }
 }
 
+template <typename DerivedV, int DIM>
+template <typename DerivedEle>
+IGL_INLINE void igl::AABB<DerivedV,DIM>::refit(
+    const Eigen::MatrixBase<DerivedV> & V,
+    const Eigen::MatrixBase<DerivedEle> & Ele,
+    const int depth)
+{
+  if(is_leaf())
+  {
+    m_box = Eigen::AlignedBox<Scalar,DIM>();
+    for(int c = 0;c<Ele.cols();c++)
+    {
+      m_box.extend(V.row(Ele(m_primitive,c)).transpose());
+    }
+    return;
+  }
+  if(m_left == NULL || m_right == NULL)
+  {
+    // Empty tree
+    return;
+  }
+  // Enough subtrees to keep every core busy
+  static const unsigned int num_threads = std::thread::hardware_concurrency();
+  if((1u<<depth) < num_threads)
+  {
+    std::thread worker([&](){ m_right->refit(V,Ele,depth+1); });
+    m_left->refit(V,Ele,depth+1);
+    worker.join();
+  }else
+  {
+    m_left->refit(V,Ele,depth+1);
+    m_right->refit(V,Ele,depth+1);
+  }
+  m_box = m_left->m_box.merged(m_right->m_box);
+}
+
 template <typename DerivedV, int DIM>
 IGL_INLINE bool igl::AABB<DerivedV,DIM>::is_leaf() const
 {
@@ -481,11 +1028,37 @@ IGL_INLINE void igl::AABB<DerivedV,DIM>::squared_distance(
   sqrD.resize(P.rows(),1);
   I.resize(P.rows(),1);
   C.resizeLike(P);
+  if(P.rows() == 0)
+  {
+    return;
+  }
+  // Consecutive queries land in the same part of the tree
+  std::vector<int> order;
+  AABB_detail::morton_order(P,order);
+  // Triangles: packets of nearby points walk the tree together and each leaf
+  // is tested against the whole packet at once with SIMD instructions
+  if(Ele.cols() == 3 &&
+    Eigen::internal::packet_traits<Scalar>::Vectorizable &&
+    (is_leaf() || m_left != NULL))
+  {
+    const int packet_size = 4;
+    const int num_packets = (P.rows()+packet_size-1)/packet_size;
+    igl::parallel_for(num_packets,[&](const int k)
+      {
+        const int first = k*packet_size;
+        AABB_detail::squared_distance_packet<packet_size>(
+          *this,V,Ele,P,&order[first],
+          std::min<int>(packet_size,P.rows()-first),sqrD,I,C);
+      },
+      2500);
+    return;
+  }
   // O( #P * log #Ele ), where log #Ele is really the depth of this AABB
   // hierarchy
   //for(int p = 0;p<P.rows();p++)
-  igl::parallel_for(P.rows(),[&](int p)
+  igl::parallel_for(P.rows(),[&](int k)
     {
+      const int p = order[k];
       RowVectorDIMS Pp = P.row(p), c;
       int Ip;
       sqrD(p) = squared_distance(V,Ele,Pp,Ip,c);
@@ -1002,6 +1575,60 @@ igl::AABB<DerivedV,DIM>::intersect_ray(
   return left_ret || right_ret;
 }
 
+template <typename DerivedV, int DIM>
+template <typename DerivedEle, typename DerivedO, typename DerivedD>
+IGL_INLINE int igl::AABB<DerivedV,DIM>::intersect_rays(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedEle> & Ele,
+  const Eigen::MatrixBase<DerivedO> & O,
+  const Eigen::MatrixBase<DerivedD> & D,
+  const Scalar min_t,
+  const bool any_hit,
+  std::vector<igl::Hit> & hits,
+  const int packet_size) const
+{
+  assert((Ele.size() == 0 || Ele.cols() == 3) && "Elements should be triangles");
+  assert(O.cols() == 3 && D.cols() == 3 && O.rows() == D.rows());
+  assert((packet_size == 4 || packet_size == 8 || packet_size == 16) &&
+    "packet_size should be 4, 8 or 16");
+  const int n = O.rows();
+  hits.assign(n,{-1,-1,0,0,0});
+  // Empty tree
+  if(n == 0 || (!is_leaf() && m_left == NULL))
+  {
+    return 0;
+  }
+  std::vector<int> order;
+  AABB_detail::coherent_order(O,D,order);
+  const int num_packets = (n+packet_size-1)/packet_size;
+  parallel_for(num_packets,[&](const int p)
+  {
+    const int first = p*packet_size;
+    const int count = std::min(packet_size,n-first);
+    switch(packet_size)
+    {
+      case 4:
+        AABB_detail::intersect_packet<4>(
+          *this,V,Ele,O,D,&order[first],count,min_t,any_hit,hits);
+        break;
+      case 16:
+        AABB_detail::intersect_packet<16>(
+          *this,V,Ele,O,D,&order[first],count,min_t,any_hit,hits);
+        break;
+      default:
+        AABB_detail::intersect_packet<8>(
+          *this,V,Ele,O,D,&order[first],count,min_t,any_hit,hits);
+        break;
+    }
+  },64);
+  int num_hits = 0;
+  for(const auto & hit : hits)
+  {
+    num_hits += hit.id >= 0;
+  }
+  return num_hits;
+}
+
 // This is a bullshit template because AABB annoyingly needs templates for bad
 // combinations of 3D V with DIM=2 AABB
 //
@@ -1054,6 +1681,10 @@ template void igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::squared_di
 template void igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::squared_distance<Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, 1, 0, -1, 1>, Eigen::Matrix<long, -1, 1, 0, -1, 1>, Eigen::Matrix<double, -1, 3, 0, -1, 3> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<long, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 3, 0, -1, 3> >&) const;
 // generated by autoexplicit.sh
 template void igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::squared_distance<Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, 1, 0, -1, 1>, Eigen::Matrix<int, -1, 1, 0, -1, 1>, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&) const;
+template void igl::AABB<Eigen::Matrix<double, -1, 3, 1, -1, 3>, 3>::squared_distance<Eigen::Matrix<int, -1, 3, 1, -1, 3>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, 1, 0, -1, 1>, Eigen::Matrix<int, -1, 1, 0, -1, 1>, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, 3, 1, -1, 3> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, 3, 1, -1, 3> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&) const;
+template void igl::AABB<Eigen::Matrix<float, -1, 3, 0, -1, 3>, 3>::squared_distance<Eigen::Matrix<int, -1, 3, 0, -1, 3>, Eigen::Matrix<float, -1, 3, 0, -1, 3>, Eigen::Matrix<float, -1, 1, 0, -1, 1>, Eigen::Matrix<int, -1, 1, 0, -1, 1>, Eigen::Matrix<float, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<float, -1, 3, 0, -1, 3> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, 3, 0, -1, 3> > const&, Eigen::MatrixBase<Eigen::Matrix<float, -1, 3, 0, -1, 3> > const&, Eigen::PlainObjectBase<Eigen::Matrix<float, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<float, -1, -1, 0, -1, -1> >&) const;
+template void igl::AABB<Eigen::Matrix<float, -1, 3, 1, -1, 3>, 3>::squared_distance<Eigen::Matrix<int, -1, 3, 1, -1, 3>, Eigen::Matrix<float, -1, 3, 1, -1, 3>, Eigen::Matrix<float, -1, 1, 0, -1, 1>, Eigen::Matrix<int, -1, 1, 0, -1, 1>, Eigen::Matrix<float, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<float, -1, 3, 1, -1, 3> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, 3, 1, -1, 3> > const&, Eigen::MatrixBase<Eigen::Matrix<float, -1, 3, 1, -1, 3> > const&, Eigen::PlainObjectBase<Eigen::Matrix<float, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<float, -1, -1, 0, -1, -1> >&) const;
+template void igl::AABB<Eigen::Matrix<float, -1, 3, 1, -1, 3>, 3>::squared_distance<Eigen::Matrix<int, -1, 3, 1, -1, 3>, Eigen::Matrix<float, -1, -1, 0, -1, -1>, Eigen::Matrix<float, -1, 1, 0, -1, 1>, Eigen::Matrix<int, -1, 1, 0, -1, 1>, Eigen::Matrix<float, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<float, -1, 3, 1, -1, 3> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, 3, 1, -1, 3> > const&, Eigen::MatrixBase<Eigen::Matrix<float, -1, -1, 0, -1, -1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<float, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<float, -1, -1, 0, -1, -1> >&) const;
 // generated by autoexplicit.sh
 template double igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::squared_distance<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::Matrix<double, 1, 3, 1, 1, 3> const&, int&, Eigen::PlainObjectBase<Eigen::Matrix<double, 1, 3, 1, 1, 3> >&) const;
 // generated by autoexplicit.sh
@@ -1068,10 +1699,14 @@ template double igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 2>::squared_
 template void igl::AABB<Eigen::Matrix<float, -1, 3, 1, -1, 3>, 3>::init<Eigen::Matrix<int, -1, 3, 1, -1, 3> >(Eigen::MatrixBase<Eigen::Matrix<float, -1, 3, 1, -1, 3> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, 3, 1, -1, 3> > const&);
 // generated by autoexplicit.sh
 template void igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::init<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&);
+template void igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::refit<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, int);
+template void igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 2>::refit<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, int);
 // generated by autoexplicit.sh
 template void igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 2>::init<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&);
 template double igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::squared_distance<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::Matrix<double, 1, 3, 1, 1, 3> const&, double, int&, Eigen::PlainObjectBase<Eigen::Matrix<double, 1, 3, 1, 1, 3> >&) const;
 template bool igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::intersect_ray<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::Matrix<double, 1, 3, 1, 1, 3> const&, Eigen::Matrix<double, 1, 3, 1, 1, 3> const&, igl::Hit&) const;
+template int igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::intersect_rays<Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, double, bool, std::vector<igl::Hit, std::allocator<igl::Hit> >&, int) const;
+template int igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::intersect_rays<Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, 3, 0, -1, 3>, Eigen::Matrix<double, -1, 3, 0, -1, 3> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, 3, 0, -1, 3> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, 3, 0, -1, 3> > const&, double, bool, std::vector<igl::Hit, std::allocator<igl::Hit> >&, int) const;
 template void igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::squared_distance<Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, 2, 3, 0, 2, 3>, Eigen::Matrix<double, 2, 1, 0, 2, 1>, Eigen::Matrix<int, 2, 1, 0, 2, 1>, Eigen::Matrix<double, 2, 3, 0, 2, 3> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, 2, 3, 0, 2, 3> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, 2, 1, 0, 2, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, 2, 1, 0, 2, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, 2, 3, 0, 2, 3> >&) const;
 template void igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::squared_distance<Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, 1, 0, -1, 1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&) const;
 template void igl::AABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 2>::squared_distance<Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, 1, 0, -1, 1>, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&) const;
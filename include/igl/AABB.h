@@ -140,6 +140,21 @@ public:
           const Eigen::MatrixBase<DerivedEle> & Ele, 
           const Eigen::MatrixBase<DerivedSI> & SI,
           const Eigen::MatrixBase<DerivedI>& I);
+      // Update the boxes for new positions of the same mesh, keeping the
+      // tree. Much cheaper than init, but queries slow down if the elements
+      // moved far relative to each other (see also FlatAABB::refit).
+      //
+      // Inputs:
+      //   V  #V by dim list of new mesh vertex positions.
+      //   Ele  #Ele by dim+1 list of mesh indices into #V, as used to build
+      //     the tree.
+      //   depth  recursive call depth {0}, the subtrees of the upper levels
+      //     are refit on separate threads
+      template <typename DerivedEle>
+      IGL_INLINE void refit(
+          const Eigen::MatrixBase<DerivedV> & V,
+          const Eigen::MatrixBase<DerivedEle> & Ele,
+          const int depth = 0);
       // Return whether at leaf node
       IGL_INLINE bool is_leaf() const;
       // Find the indices of elements containing given point: this makes sense
@@ -255,6 +270,34 @@ public:
         const RowVectorDIMS & origin,
         const RowVectorDIMS & dir,
         igl::Hit & hit) const;
+      // Intersect many rays at once (3D only). The rays are reordered so
+      // that neighbours start close by and point the same way, then traced
+      // in packets: each box test runs on all the rays of a packet together
+      // (vectorized by Eigen with SSE/AVX when enabled), and the packets are
+      // split across threads.
+      //
+      // Inputs:
+      //   V  #V by 3 list of vertex positions
+      //   Ele  #Ele by 3 list of triangle indices
+      //   O  #R by 3 list of ray origins
+      //   D  #R by 3 list of ray directions
+      //   min_t  only report hits closer than min_t
+      //   any_hit  whether any hit closer than min_t is enough (e.g. for
+      //     occlusion) instead of the first one
+      //   packet_size  number of rays traced together: 4, 8 or 16
+      // Outputs:
+      //   hits  #R list of hits, with id = -1 for rays that hit nothing
+      // Returns number of rays that hit
+      template <typename DerivedEle, typename DerivedO, typename DerivedD>
+      IGL_INLINE int intersect_rays(
+        const Eigen::MatrixBase<DerivedV> & V,
+        const Eigen::MatrixBase<DerivedEle> & Ele, 
+        const Eigen::MatrixBase<DerivedO> & O,
+        const Eigen::MatrixBase<DerivedD> & D,
+        const Scalar min_t,
+        const bool any_hit,
+        std::vector<igl::Hit> & hits,
+        const int packet_size = 8) const;
 //private:
       template <typename DerivedEle>
       IGL_INLINE bool intersect_ray(
@@ -271,6 +314,10 @@ public:
       // _closest_ points on the primitives stored in the AABB hierarchy for
       // the mesh (V,Ele).
       //
+      // The points are visited in Morton order. For triangles, packets of
+      // nearby points descend the tree together and each leaf is tested
+      // against a whole packet with SIMD instructions.
+      //
       // Inputs:
       //   V  #V by dim list of vertex positions
       //   Ele  #Ele by dim list of simplex indices
@@ -0,0 +1,19 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_FILEENCODING_H
+#define IGL_FILEENCODING_H
+
+namespace igl
+{
+  // Encoding of mesh files that can be written as text or binary
+  enum class FileEncoding
+  {
+    Binary,
+    Ascii
+  };
+}
+
+#endif
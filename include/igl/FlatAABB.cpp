@@ -0,0 +1,1000 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "FlatAABB.h"
+#include "EPS.h"
+#include "doublearea.h"
+#include "parallel_for.h"
+#include "point_simplex_squared_distance.h"
+#include "ray_triangle_intersect.h"
+#include "volume.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <thread>
+
+namespace igl
+{
+  namespace FlatAABB_detail
+  {
+    // Round to the float just below/above x so that float boxes contain the
+    // Scalar ones
+    template <typename Scalar>
+    inline float round_down(const Scalar x)
+    {
+      float f = float(x);
+      if(Scalar(f) > x)
+      {
+        f = std::nextafter(f,-std::numeric_limits<float>::infinity());
+      }
+      return f;
+    }
+    template <typename Scalar>
+    inline float round_up(const Scalar x)
+    {
+      float f = float(x);
+      if(Scalar(f) < x)
+      {
+        f = std::nextafter(f,std::numeric_limits<float>::infinity());
+      }
+      return f;
+    }
+
+    // Half the surface area of a box (perimeter in 2D)
+    template <typename Scalar, int DIM>
+    inline Scalar half_area(
+      const Eigen::Matrix<Scalar,1,DIM> & lo,
+      const Eigen::Matrix<Scalar,1,DIM> & hi)
+    {
+      const Eigen::Matrix<Scalar,1,DIM> d = (hi-lo).cwiseMax(Scalar(0));
+      if(DIM != 3)
+      {
+        return d.sum();
+      }
+      return d(0)*d(1) + d(1)*d(2) + d(2)*d(0);
+    }
+
+    // Set the box of a node, rounding outwards
+    template <typename Node, typename Scalar, int DIM>
+    inline void set_box(
+      const Eigen::Matrix<Scalar,1,DIM> & lo,
+      const Eigen::Matrix<Scalar,1,DIM> & hi,
+      Node & node)
+    {
+      for(int d = 0;d<3;d++)
+      {
+        node.min[d] = d<DIM ? round_down(lo(d)) : 0.f;
+        node.max[d] = d<DIM ? round_up(hi(d)) : 0.f;
+      }
+    }
+
+    // Surface area of the intersection of the boxes of the children of an
+    // inner node relative to the surface area of its box
+    template <typename Node, int DIM>
+    inline float overlap(const Node & node, const Node & left, const Node & right)
+    {
+      typedef Eigen::Matrix<float,1,DIM> RowVectorDIMf;
+      typedef Eigen::Map<const RowVectorDIMf> MapDIMf;
+      const RowVectorDIMf lo = MapDIMf(left.min).cwiseMax(MapDIMf(right.min));
+      const RowVectorDIMf hi = MapDIMf(left.max).cwiseMin(MapDIMf(right.max));
+      if((hi.array() < lo.array()).any())
+      {
+        return 0;
+      }
+      const float area = half_area<float,DIM>(MapDIMf(node.min),MapDIMf(node.max));
+      return area > 0 ? std::min(1.f,half_area<float,DIM>(lo,hi)/area) : 0.f;
+    }
+
+    // Depth above which subtrees get their own thread, enough to keep every
+    // core busy
+    inline int parallel_depth()
+    {
+      int depth = 0;
+      while((1u<<depth) < std::thread::hardware_concurrency())
+      {
+        depth++;
+      }
+      return depth;
+    }
+
+    // Builds the nodes of a FlatAABB from the boxes of its elements
+    template <typename Node, typename Scalar, int DIM>
+    struct Builder
+    {
+      typedef Eigen::Matrix<Scalar,1,DIM> RowVectorDIMS;
+      typedef Eigen::Matrix<Scalar,Eigen::Dynamic,DIM,Eigen::RowMajor> MatrixXDIMS;
+      enum { NUM_BINS = 16 };
+      // #Ele by dim boxes and their centers
+      MatrixXDIMS mins, maxs, centers;
+      int * prims;
+      int max_leaf_size;
+      int max_depth;
+      // Subtrees above this depth are built on their own thread
+      int parallel_depth;
+      // ... if they have at least this many elements
+      int parallel_min;
+
+      Builder(
+        const int m,
+        int * _prims,
+        const int _max_leaf_size,
+        const int _max_depth):
+        mins(m,DIM),
+        maxs(m,DIM),
+        centers(m,DIM),
+        prims(_prims),
+        max_leaf_size(_max_leaf_size),
+        max_depth(_max_depth),
+        parallel_depth(FlatAABB_detail::parallel_depth()),
+        parallel_min(10000)
+      {}
+
+      // Compute the boxes of the elements prims[begin..end)
+      template <typename DerivedV, typename DerivedEle>
+      void set_boxes(
+        const Eigen::MatrixBase<DerivedV> & V,
+        const Eigen::MatrixBase<DerivedEle> & Ele,
+        const int begin,
+        const int end)
+      {
+        igl::parallel_for(end-begin,[&](const int k)
+          {
+            const int e = prims[begin+k];
+            RowVectorDIMS lo = V.row(Ele(e,0)).template head<DIM>();
+            RowVectorDIMS hi = lo;
+            for(int c = 1;c<Ele.cols();c++)
+            {
+              lo = lo.cwiseMin(V.row(Ele(e,c)).template head<DIM>());
+              hi = hi.cwiseMax(V.row(Ele(e,c)).template head<DIM>());
+            }
+            mins.row(e) = lo;
+            maxs.row(e) = hi;
+            centers.row(e) = (lo+hi)/Scalar(2);
+          },
+          10000);
+      }
+
+      // Append the subtree of prims[begin..end) to nodes, depth first
+      void build(
+        const int begin,
+        const int end,
+        const int depth,
+        std::vector<Node> & nodes) const
+      {
+        const Scalar inf = std::numeric_limits<Scalar>::infinity();
+        RowVectorDIMS lo = RowVectorDIMS::Constant(inf);
+        RowVectorDIMS hi = RowVectorDIMS::Constant(-inf);
+        RowVectorDIMS clo = lo;
+        RowVectorDIMS chi = hi;
+        for(int k = begin;k<end;k++)
+        {
+          const int e = prims[k];
+          lo = lo.cwiseMin(mins.row(e));
+          hi = hi.cwiseMax(maxs.row(e));
+          clo = clo.cwiseMin(centers.row(e));
+          chi = chi.cwiseMax(centers.row(e));
+        }
+        const int id = int(nodes.size());
+        {
+          Node node;
+          set_box(lo,hi,node);
+          node.offset = begin;
+          node.count = end-begin;
+          nodes.push_back(node);
+        }
+        const int n = end-begin;
+        if(n <= max_leaf_size)
+        {
+          return;
+        }
+        int axis;
+        const Scalar extent = (chi-clo).maxCoeff(&axis);
+        int mid = -1;
+        // Past half the maximum depth, split at the median to bound it
+        if(extent > 0 && 2*depth < max_depth)
+        {
+          mid = sah_split(begin,end,axis,clo(axis),extent);
+        }
+        if(mid <= begin || mid >= end)
+        {
+          mid = begin + n/2;
+          const MatrixXDIMS & C = centers;
+          std::nth_element(prims+begin,prims+mid,prims+end,
+            [&C,axis](const int a, const int b)->bool
+            {
+              return C(a,axis) < C(b,axis);
+            });
+        }
+        nodes[id].count = 0;
+        if(depth < parallel_depth && n >= parallel_min)
+        {
+          std::vector<Node> right;
+          std::thread worker(
+            &Builder::build,this,mid,end,depth+1,std::ref(right));
+          build(begin,mid,depth+1,nodes);
+          worker.join();
+          const int base = int(nodes.size());
+          nodes[id].offset = base;
+          for(auto & node : right)
+          {
+            if(!node.is_leaf())
+            {
+              node.offset += base;
+            }
+          }
+          nodes.insert(nodes.end(),right.begin(),right.end());
+        }else
+        {
+          build(begin,mid,depth+1,nodes);
+          nodes[id].offset = int(nodes.size());
+          build(mid,end,depth+1,nodes);
+        }
+      }
+
+      // Partition prims[begin..end) along axis at the bin boundary of least
+      // surface area cost. Returns the start of the right part.
+      int sah_split(
+        const int begin,
+        const int end,
+        const int axis,
+        const Scalar clo,
+        const Scalar extent) const
+      {
+        const Scalar inf = std::numeric_limits<Scalar>::infinity();
+        const Scalar scale = Scalar(NUM_BINS)/extent;
+        const auto bin = [&](const int e)->int
+        {
+          return std::min(NUM_BINS-1,int((centers(e,axis)-clo)*scale));
+        };
+        int count[NUM_BINS];
+        RowVectorDIMS lo[NUM_BINS], hi[NUM_BINS];
+        for(int b = 0;b<NUM_BINS;b++)
+        {
+          count[b] = 0;
+          lo[b].setConstant(inf);
+          hi[b].setConstant(-inf);
+        }
+        for(int k = begin;k<end;k++)
+        {
+          const int e = prims[k];
+          const int b = bin(e);
+          count[b]++;
+          lo[b] = lo[b].cwiseMin(mins.row(e));
+          hi[b] = hi[b].cwiseMax(maxs.row(e));
+        }
+        // Cost of the right part starting at each bin
+        Scalar right_cost[NUM_BINS];
+        {
+          RowVectorDIMS rlo = RowVectorDIMS::Constant(inf);
+          RowVectorDIMS rhi = RowVectorDIMS::Constant(-inf);
+          int rn = 0;
+          for(int b = NUM_BINS-1;b>0;b--)
+          {
+            rlo = rlo.cwiseMin(lo[b]);
+            rhi = rhi.cwiseMax(hi[b]);
+            rn += count[b];
+            right_cost[b] = rn*half_area<Scalar,DIM>(rlo,rhi);
+          }
+        }
+        RowVectorDIMS llo = RowVectorDIMS::Constant(inf);
+        RowVectorDIMS lhi = RowVectorDIMS::Constant(-inf);
+        int ln = 0;
+        int best = -1;
+        Scalar best_cost = inf;
+        for(int b = 0;b+1<NUM_BINS;b++)
+        {
+          llo = llo.cwiseMin(lo[b]);
+          lhi = lhi.cwiseMax(hi[b]);
+          ln += count[b];
+          if(ln == 0 || ln == end-begin)
+          {
+            continue;
+          }
+          const Scalar cost = ln*half_area<Scalar,DIM>(llo,lhi) + right_cost[b+1];
+          if(cost < best_cost)
+          {
+            best_cost = cost;
+            best = b;
+          }
+        }
+        if(best < 0)
+        {
+          return -1;
+        }
+        return int(std::partition(prims+begin,prims+end,
+          [&](const int e)->bool{ return bin(e) <= best; }) - prims);
+      }
+    };
+  }
+}
+
+template <typename DerivedV, int DIM>
+template <typename DerivedEle>
+IGL_INLINE void igl::FlatAABB<DerivedV,DIM>::init(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedEle> & Ele,
+  const int max_leaf_size)
+{
+  using namespace std;
+  deinit();
+  const int m = int(Ele.rows());
+  if(m == 0)
+  {
+    return;
+  }
+  m_max_leaf_size = std::max(1,max_leaf_size);
+  m_primitives.resize(m);
+  for(int e = 0;e<m;e++)
+  {
+    m_primitives[e] = e;
+  }
+  FlatAABB_detail::Builder<Node,Scalar,DIM> builder(
+    m,m_primitives.data(),m_max_leaf_size,MAX_DEPTH);
+  builder.set_boxes(V,Ele,0,m);
+  m_nodes.reserve(4*m/m_max_leaf_size+1);
+  builder.build(0,m,0,m_nodes);
+  m_build_overlap.resize(m_nodes.size());
+  for(int id = 0;id<int(m_nodes.size());id++)
+  {
+    m_build_overlap[id] = m_nodes[id].is_leaf() ? 0.f : overlap(id);
+  }
+}
+
+template <typename DerivedV, int DIM>
+IGL_INLINE void igl::FlatAABB<DerivedV,DIM>::deinit()
+{
+  m_nodes.clear();
+  m_primitives.clear();
+  m_build_overlap.clear();
+}
+
+template <typename DerivedV, int DIM>
+IGL_INLINE float igl::FlatAABB<DerivedV,DIM>::overlap(const int id) const
+{
+  assert(!m_nodes[id].is_leaf() && "Leaves have no children");
+  return FlatAABB_detail::overlap<Node,DIM>(
+    m_nodes[id],m_nodes[id+1],m_nodes[m_nodes[id].offset]);
+}
+
+template <typename DerivedV, int DIM>
+template <typename DerivedEle>
+IGL_INLINE int igl::FlatAABB<DerivedV,DIM>::refit(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedEle> & Ele,
+  const float max_overlap_growth)
+{
+  if(empty())
+  {
+    return 0;
+  }
+  refit_subtree(V,Ele,0,0,
+    m_primitives.size() >= 10000 ? FlatAABB_detail::parallel_depth() : 0);
+  // Top-most subtrees whose quality degraded, in depth first order
+  std::vector<int> roots, depths;
+  int stack[2*MAX_DEPTH];
+  int stack_depth[2*MAX_DEPTH];
+  int top = 0;
+  stack[top] = 0;
+  stack_depth[top++] = 0;
+  while(top > 0)
+  {
+    top--;
+    const int id = stack[top];
+    const int depth = stack_depth[top];
+    if(m_nodes[id].is_leaf())
+    {
+      continue;
+    }
+    if(overlap(id) > m_build_overlap[id] + max_overlap_growth)
+    {
+      roots.push_back(id);
+      depths.push_back(depth);
+      continue;
+    }
+    stack[top] = m_nodes[id].offset;
+    stack_depth[top++] = depth+1;
+    stack[top] = id+1;
+    stack_depth[top++] = depth+1;
+  }
+  if(!roots.empty())
+  {
+    rebuild(V,Ele,roots,depths);
+  }
+  return int(roots.size());
+}
+
+template <typename DerivedV, int DIM>
+template <typename DerivedEle>
+IGL_INLINE void igl::FlatAABB<DerivedV,DIM>::refit_subtree(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedEle> & Ele,
+  const int id,
+  const int depth,
+  const int parallel_depth)
+{
+  Node & node = m_nodes[id];
+  if(node.is_leaf())
+  {
+    const Scalar inf = std::numeric_limits<Scalar>::infinity();
+    RowVectorDIMS lo = RowVectorDIMS::Constant(inf);
+    RowVectorDIMS hi = RowVectorDIMS::Constant(-inf);
+    for(int k = node.offset;k<node.offset+node.count;k++)
+    {
+      for(int c = 0;c<Ele.cols();c++)
+      {
+        lo = lo.cwiseMin(V.row(Ele(m_primitives[k],c)).template head<DIM>());
+        hi = hi.cwiseMax(V.row(Ele(m_primitives[k],c)).template head<DIM>());
+      }
+    }
+    FlatAABB_detail::set_box(lo,hi,node);
+    return;
+  }
+  const int left = id+1;
+  const int right = node.offset;
+  if(depth < parallel_depth)
+  {
+    std::thread worker([&]()
+      {
+        refit_subtree(V,Ele,right,depth+1,parallel_depth);
+      });
+    refit_subtree(V,Ele,left,depth+1,parallel_depth);
+    worker.join();
+  }else
+  {
+    refit_subtree(V,Ele,left,depth+1,parallel_depth);
+    refit_subtree(V,Ele,right,depth+1,parallel_depth);
+  }
+  for(int d = 0;d<3;d++)
+  {
+    node.min[d] = std::min(m_nodes[left].min[d],m_nodes[right].min[d]);
+    node.max[d] = std::max(m_nodes[left].max[d],m_nodes[right].max[d]);
+  }
+}
+
+template <typename DerivedV, int DIM>
+template <typename DerivedEle>
+IGL_INLINE void igl::FlatAABB<DerivedV,DIM>::rebuild(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedEle> & Ele,
+  const std::vector<int> & roots,
+  const std::vector<int> & depths)
+{
+  const int r = int(roots.size());
+  // Node and element ranges of each subtree
+  std::vector<int> ends(r), begins(r), prim_begins(r), prim_ends(r);
+  for(int j = 0;j<r;j++)
+  {
+    int first = roots[j];
+    while(!m_nodes[first].is_leaf())
+    {
+      first++;
+    }
+    int last = roots[j];
+    while(!m_nodes[last].is_leaf())
+    {
+      last = m_nodes[last].offset;
+    }
+    begins[j] = roots[j];
+    ends[j] = last+1;
+    prim_begins[j] = m_nodes[first].offset;
+    prim_ends[j] = m_nodes[last].offset + m_nodes[last].count;
+  }
+  FlatAABB_detail::Builder<Node,Scalar,DIM> builder(
+    int(Ele.rows()),m_primitives.data(),m_max_leaf_size,MAX_DEPTH);
+  for(int j = 0;j<r;j++)
+  {
+    builder.set_boxes(V,Ele,prim_begins[j],prim_ends[j]);
+  }
+  std::vector<std::vector<Node> > subtrees(r);
+  igl::parallel_for(r,[&](const int j)
+    {
+      builder.build(prim_begins[j],prim_ends[j],depths[j],subtrees[j]);
+    },
+    2);
+  // Splice: nodes outside the subtrees move by the change in size of the
+  // subtrees before them
+  std::vector<int> shifts(r);
+  {
+    int shift = 0;
+    for(int j = 0;j<r;j++)
+    {
+      shift += int(subtrees[j].size()) - (ends[j]-begins[j]);
+      shifts[j] = shift;
+    }
+  }
+  const auto new_index = [&](const int old)->int
+  {
+    const int j = int(std::upper_bound(ends.begin(),ends.end(),old)-ends.begin());
+    return old + (j>0 ? shifts[j-1] : 0);
+  };
+  std::vector<Node> nodes;
+  nodes.reserve(m_nodes.size() + shifts.back());
+  std::vector<float> build_overlap;
+  build_overlap.reserve(nodes.capacity());
+  const auto keep = [&](const int begin, const int end)
+  {
+    for(int id = begin;id<end;id++)
+    {
+      Node node = m_nodes[id];
+      if(!node.is_leaf())
+      {
+        node.offset = new_index(node.offset);
+      }
+      nodes.push_back(node);
+      build_overlap.push_back(m_build_overlap[id]);
+    }
+  };
+  int prev = 0;
+  for(int j = 0;j<r;j++)
+  {
+    keep(prev,begins[j]);
+    const int base = int(nodes.size());
+    for(auto node : subtrees[j])
+    {
+      if(!node.is_leaf())
+      {
+        node.offset += base;
+      }
+      nodes.push_back(node);
+      build_overlap.push_back(0);
+    }
+    for(int id = base;id<int(nodes.size());id++)
+    {
+      if(!nodes[id].is_leaf())
+      {
+        build_overlap[id] = FlatAABB_detail::overlap<Node,DIM>(
+          nodes[id],nodes[id+1],nodes[nodes[id].offset]);
+      }
+    }
+    prev = ends[j];
+  }
+  keep(prev,int(m_nodes.size()));
+  m_nodes.swap(nodes);
+  m_build_overlap.swap(build_overlap);
+}
+
+template <typename DerivedV, int DIM>
+template <typename DerivedEle, typename Derivedq>
+IGL_INLINE std::vector<int> igl::FlatAABB<DerivedV,DIM>::find(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedEle> & Ele,
+  const Eigen::MatrixBase<Derivedq> & q,
+  const bool first) const
+{
+  assert(q.size() == DIM &&
+    "Query dimension should match aabb dimension");
+  assert(Ele.cols() == V.cols()+1 &&
+    "FlatAABB::find only makes sense for (d+1)-simplices");
+  const Scalar epsilon = igl::EPS<Scalar>();
+  // Dynamic size to compile both cases below for any q
+  const Eigen::Matrix<Scalar,1,Eigen::Dynamic> qX = q.template cast<Scalar>();
+  std::vector<int> found;
+  if(empty())
+  {
+    return found;
+  }
+  int stack[2*MAX_DEPTH];
+  int top = 0;
+  stack[top++] = 0;
+  while(top > 0)
+  {
+    const Node & node = m_nodes[stack[--top]];
+    bool inside = true;
+    for(int d = 0;d<DIM;d++)
+    {
+      inside = inside && qX(d) >= node.min[d] && qX(d) <= node.max[d];
+    }
+    if(!inside)
+    {
+      continue;
+    }
+    if(!node.is_leaf())
+    {
+      stack[top++] = node.offset;
+      stack[top++] = int(&node - m_nodes.data()) + 1;
+      continue;
+    }
+    for(int k = node.offset;k<node.offset+node.count;k++)
+    {
+      const int e = m_primitives[k];
+      // Initialize to some value > -epsilon
+      Scalar a1=0,a2=0,a3=0,a4=0;
+      switch(DIM)
+      {
+        case 3:
+          {
+            // Barycentric coordinates
+            typedef Eigen::Matrix<Scalar,1,3> RowVector3S;
+            const RowVector3S V1 = V.row(Ele(e,0));
+            const RowVector3S V2 = V.row(Ele(e,1));
+            const RowVector3S V3 = V.row(Ele(e,2));
+            const RowVector3S V4 = V.row(Ele(e,3));
+            a1 = volume_single(V2,V4,V3,(RowVector3S)qX);
+            a2 = volume_single(V1,V3,V4,(RowVector3S)qX);
+            a3 = volume_single(V1,V4,V2,(RowVector3S)qX);
+            a4 = volume_single(V1,V2,V3,(RowVector3S)qX);
+            break;
+          }
+        case 2:
+          {
+            // Barycentric coordinates
+            typedef Eigen::Matrix<Scalar,2,1> Vector2S;
+            const Vector2S V1 = V.row(Ele(e,0));
+            const Vector2S V2 = V.row(Ele(e,1));
+            const Vector2S V3 = V.row(Ele(e,2));
+            const Vector2S q2 = qX.head(2);
+            a1 = doublearea_single(V1,V2,q2);
+            a2 = doublearea_single(V2,V3,q2);
+            a3 = doublearea_single(V3,V1,q2);
+            break;
+          }
+        default:assert(false);
+      }
+      // Normalization is important for correcting sign
+      const Scalar sum = a1+a2+a3+a4;
+      if(
+        a1/sum>=-epsilon &&
+        a2/sum>=-epsilon &&
+        a3/sum>=-epsilon &&
+        a4/sum>=-epsilon)
+      {
+        found.push_back(e);
+        if(first)
+        {
+          return found;
+        }
+      }
+    }
+  }
+  return found;
+}
+
+template <typename DerivedV, int DIM>
+IGL_INLINE typename igl::FlatAABB<DerivedV,DIM>::Scalar
+igl::FlatAABB<DerivedV,DIM>::box_squared_distance(
+  const Node & node,
+  const RowVectorDIMS & p) const
+{
+  Scalar sqr_d = 0;
+  for(int d = 0;d<DIM;d++)
+  {
+    const Scalar below = Scalar(node.min[d]) - p(d);
+    const Scalar above = p(d) - Scalar(node.max[d]);
+    const Scalar out = std::max(Scalar(0),std::max(below,above));
+    sqr_d += out*out;
+  }
+  return sqr_d;
+}
+
+template <typename DerivedV, int DIM>
+template <typename DerivedEle>
+IGL_INLINE typename igl::FlatAABB<DerivedV,DIM>::Scalar
+igl::FlatAABB<DerivedV,DIM>::squared_distance(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedEle> & Ele,
+  const RowVectorDIMS & p,
+  int & i,
+  Eigen::PlainObjectBase<RowVectorDIMS> & c) const
+{
+  return squared_distance(V,Ele,p,std::numeric_limits<Scalar>::infinity(),i,c);
+}
+
+template <typename DerivedV, int DIM>
+template <typename DerivedEle>
+IGL_INLINE typename igl::FlatAABB<DerivedV,DIM>::Scalar
+igl::FlatAABB<DerivedV,DIM>::squared_distance(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedEle> & Ele,
+  const RowVectorDIMS & p,
+  const Scalar up_sqr_d,
+  int & i,
+  Eigen::PlainObjectBase<RowVectorDIMS> & c) const
+{
+  assert((Ele.cols() == 3 || Ele.cols() == 2 || Ele.cols() == 1)
+    && "Code has only been tested for simplex sizes 3,2,1");
+  Scalar sqr_d = up_sqr_d;
+  if(empty())
+  {
+    return sqr_d;
+  }
+  // Nodes to visit and the squared distance to their boxes
+  int stack[2*MAX_DEPTH];
+  Scalar stack_sqr_d[2*MAX_DEPTH];
+  int top = 0;
+  stack[top] = 0;
+  stack_sqr_d[top++] = box_squared_distance(m_nodes[0],p);
+  while(top > 0)
+  {
+    top--;
+    if(stack_sqr_d[top] >= sqr_d)
+    {
+      continue;
+    }
+    const int id = stack[top];
+    const Node & node = m_nodes[id];
+    if(node.is_leaf())
+    {
+      for(int k = node.offset;k<node.offset+node.count;k++)
+      {
+        const int e = m_primitives[k];
+        Scalar sqr_d_e;
+        RowVectorDIMS c_e;
+        igl::point_simplex_squared_distance<DIM>(p,V,Ele,e,sqr_d_e,c_e);
+        if(sqr_d_e < sqr_d)
+        {
+          sqr_d = sqr_d_e;
+          i = e;
+          c = c_e;
+        }
+      }
+      continue;
+    }
+    // Push the farther child first to look at the closer one next
+    const int left = id+1;
+    const int right = node.offset;
+    const Scalar left_sqr_d = box_squared_distance(m_nodes[left],p);
+    const Scalar right_sqr_d = box_squared_distance(m_nodes[right],p);
+    const bool left_first = left_sqr_d <= right_sqr_d;
+    const int near_child = left_first ? left : right;
+    const int far_child = left_first ? right : left;
+    const Scalar near_sqr_d = left_first ? left_sqr_d : right_sqr_d;
+    const Scalar far_sqr_d = left_first ? right_sqr_d : left_sqr_d;
+    if(far_sqr_d < sqr_d)
+    {
+      stack[top] = far_child;
+      stack_sqr_d[top++] = far_sqr_d;
+    }
+    if(near_sqr_d < sqr_d)
+    {
+      stack[top] = near_child;
+      stack_sqr_d[top++] = near_sqr_d;
+    }
+  }
+  return sqr_d;
+}
+
+template <typename DerivedV, int DIM>
+template <
+  typename DerivedEle,
+  typename DerivedP,
+  typename DerivedsqrD,
+  typename DerivedI,
+  typename DerivedC>
+IGL_INLINE void igl::FlatAABB<DerivedV,DIM>::squared_distance(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedEle> & Ele,
+  const Eigen::MatrixBase<DerivedP> & P,
+  Eigen::PlainObjectBase<DerivedsqrD> & sqrD,
+  Eigen::PlainObjectBase<DerivedI> & I,
+  Eigen::PlainObjectBase<DerivedC> & C) const
+{
+  assert(P.cols() == V.cols() && "cols in P should match dim of cols in V");
+  sqrD.resize(P.rows(),1);
+  I.resize(P.rows(),1);
+  C.resizeLike(P);
+  igl::parallel_for(P.rows(),[&](int p)
+    {
+      RowVectorDIMS Pp = P.row(p).template head<DIM>(), c;
+      int Ip = -1;
+      sqrD(p) = squared_distance(V,Ele,Pp,Ip,c);
+      I(p) = Ip;
+      C.row(p).head(DIM) = c;
+    },
+    10000);
+}
+
+template <typename DerivedV, int DIM>
+IGL_INLINE bool igl::FlatAABB<DerivedV,DIM>::ray_box_intersect(
+  const Node & node,
+  const RowVectorDIMS & origin,
+  const RowVectorDIMS & inv_dir,
+  const Scalar t1,
+  Scalar & tmin) const
+{
+  tmin = 0;
+  Scalar tmax = t1;
+  for(int d = 0;d<DIM;d++)
+  {
+    const Scalar ta = (Scalar(node.min[d]) - origin(d))*inv_dir(d);
+    const Scalar tb = (Scalar(node.max[d]) - origin(d))*inv_dir(d);
+    // A NaN (origin on a slab parallel to the ray) keeps the bound, erring on
+    // the side of visiting the box
+    tmin = std::max(tmin,std::min(ta,tb));
+    tmax = std::min(tmax,std::max(ta,tb));
+  }
+  return tmin <= tmax;
+}
+
+template <typename DerivedV, int DIM>
+template <typename DerivedEle>
+IGL_INLINE bool igl::FlatAABB<DerivedV,DIM>::intersect_ray(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedEle> & Ele,
+  const RowVectorDIMS & origin,
+  const RowVectorDIMS & dir,
+  std::vector<igl::Hit> & hits) const
+{
+  assert((Ele.size() == 0 || Ele.cols() == 3) && "Elements should be triangles");
+  hits.clear();
+  if(empty())
+  {
+    return false;
+  }
+  const RowVectorDIMS inv_dir = dir.cwiseInverse();
+  double o[3], d[3];
+  for(int c = 0;c<3;c++)
+  {
+    o[c] = double(origin(c));
+    d[c] = double(dir(c));
+  }
+  int stack[2*MAX_DEPTH];
+  int top = 0;
+  stack[top++] = 0;
+  while(top > 0)
+  {
+    const int id = stack[--top];
+    const Node & node = m_nodes[id];
+    Scalar tmin;
+    if(!ray_box_intersect(
+      node,origin,inv_dir,std::numeric_limits<Scalar>::infinity(),tmin))
+    {
+      continue;
+    }
+    if(!node.is_leaf())
+    {
+      stack[top++] = node.offset;
+      stack[top++] = id+1;
+      continue;
+    }
+    for(int k = node.offset;k<node.offset+node.count;k++)
+    {
+      const int e = m_primitives[k];
+      double v0[3], v1[3], v2[3];
+      for(int c = 0;c<3;c++)
+      {
+        v0[c] = double(V(Ele(e,0),c));
+        v1[c] = double(V(Ele(e,1),c));
+        v2[c] = double(V(Ele(e,2),c));
+      }
+      double t,u,v;
+      if(ray_triangle_intersect(o,d,v0,v1,v2,t,u,v))
+      {
+        hits.push_back({e,-1,(float)u,(float)v,(float)t});
+      }
+    }
+  }
+  std::sort(
+    hits.begin(),
+    hits.end(),
+    [](const igl::Hit & a, const igl::Hit & b)->bool{ return a.t < b.t;});
+  return !hits.empty();
+}
+
+template <typename DerivedV, int DIM>
+template <typename DerivedEle>
+IGL_INLINE bool igl::FlatAABB<DerivedV,DIM>::intersect_ray(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedEle> & Ele,
+  const RowVectorDIMS & origin,
+  const RowVectorDIMS & dir,
+  igl::Hit & hit) const
+{
+  return intersect_ray(
+    V,Ele,origin,dir,std::numeric_limits<Scalar>::infinity(),hit);
+}
+
+template <typename DerivedV, int DIM>
+template <typename DerivedEle>
+IGL_INLINE bool igl::FlatAABB<DerivedV,DIM>::intersect_ray(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedEle> & Ele,
+  const RowVectorDIMS & origin,
+  const RowVectorDIMS & dir,
+  const Scalar min_t,
+  igl::Hit & hit) const
+{
+  assert((Ele.size() == 0 || Ele.cols() == 3) && "Elements should be triangles");
+  if(empty())
+  {
+    return false;
+  }
+  const RowVectorDIMS inv_dir = dir.cwiseInverse();
+  double o[3], d[3];
+  for(int c = 0;c<3;c++)
+  {
+    o[c] = double(origin(c));
+    d[c] = double(dir(c));
+  }
+  Scalar t_hit = min_t;
+  bool found = false;
+  // Nodes to visit and where the ray enters their boxes
+  int stack[2*MAX_DEPTH];
+  Scalar stack_t[2*MAX_DEPTH];
+  int top = 0;
+  if(!ray_box_intersect(m_nodes[0],origin,inv_dir,t_hit,stack_t[top]))
+  {
+    return false;
+  }
+  stack[top++] = 0;
+  while(top > 0)
+  {
+    top--;
+    if(stack_t[top] > t_hit)
+    {
+      continue;
+    }
+    const int id = stack[top];
+    const Node & node = m_nodes[id];
+    if(node.is_leaf())
+    {
+      for(int k = node.offset;k<node.offset+node.count;k++)
+      {
+        const int e = m_primitives[k];
+        double v0[3], v1[3], v2[3];
+        for(int c = 0;c<3;c++)
+        {
+          v0[c] = double(V(Ele(e,0),c));
+          v1[c] = double(V(Ele(e,1),c));
+          v2[c] = double(V(Ele(e,2),c));
+        }
+        double t,u,v;
+        if(ray_triangle_intersect(o,d,v0,v1,v2,t,u,v) && t<t_hit)
+        {
+          t_hit = Scalar(t);
+          hit = {e,-1,(float)u,(float)v,(float)t};
+          found = true;
+        }
+      }
+      continue;
+    }
+    // Push the farther child first to look at the closer one next
+    const int left = id+1;
+    const int right = node.offset;
+    Scalar left_t, right_t;
+    const bool left_hit =
+      ray_box_intersect(m_nodes[left],origin,inv_dir,t_hit,left_t);
+    const bool right_hit =
+      ray_box_intersect(m_nodes[right],origin,inv_dir,t_hit,right_t);
+    if(left_hit && right_hit)
+    {
+      const bool left_first = left_t <= right_t;
+      stack[top] = left_first ? right : left;
+      stack_t[top++] = left_first ? right_t : left_t;
+      stack[top] = left_first ? left : right;
+      stack_t[top++] = left_first ? left_t : right_t;
+    }else if(left_hit)
+    {
+      stack[top] = left;
+      stack_t[top++] = left_t;
+    }else if(right_hit)
+    {
+      stack[top] = right;
+      stack_t[top++] = right_t;
+    }
+  }
+  return found;
+}
+
+#ifdef IGL_STATIC_LIBRARY
+// Explicit template instantiation
+template void igl::FlatAABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::init<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, int);
+template void igl::FlatAABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 2>::init<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, int);
+template void igl::FlatAABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::deinit();
+template void igl::FlatAABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 2>::deinit();
+template int igl::FlatAABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::refit<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, float);
+template int igl::FlatAABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 2>::refit<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, float);
+template float igl::FlatAABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::overlap(int) const;
+template float igl::FlatAABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 2>::overlap(int) const;
+template std::vector<int, std::allocator<int> > igl::FlatAABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::find<Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, 1, -1, 1, 1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, 1, -1, 1, 1, -1> > const&, bool) const;
+template std::vector<int, std::allocator<int> > igl::FlatAABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 2>::find<Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, 1, -1, 1, 1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, 1, -1, 1, 1, -1> > const&, bool) const;
+template double igl::FlatAABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::squared_distance<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::Matrix<double, 1, 3, 1, 1, 3> const&, int&, Eigen::PlainObjectBase<Eigen::Matrix<double, 1, 3, 1, 1, 3> >&) const;
+template double igl::FlatAABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::squared_distance<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::Matrix<double, 1, 3, 1, 1, 3> const&, double, int&, Eigen::PlainObjectBase<Eigen::Matrix<double, 1, 3, 1, 1, 3> >&) const;
+template void igl::FlatAABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::squared_distance<Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, 1, 0, -1, 1>, Eigen::Matrix<int, -1, 1, 0, -1, 1>, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&) const;
+template void igl::FlatAABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 2>::squared_distance<Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, 1, 0, -1, 1>, Eigen::Matrix<int, -1, 1, 0, -1, 1>, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, 1, 0, -1, 1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&) const;
+template bool igl::FlatAABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::intersect_ray<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::Matrix<double, 1, 3, 1, 1, 3> const&, Eigen::Matrix<double, 1, 3, 1, 1, 3> const&, igl::Hit&) const;
+template bool igl::FlatAABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3>::intersect_ray<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::Matrix<double, 1, 3, 1, 1, 3> const&, Eigen::Matrix<double, 1, 3, 1, 1, 3> const&, std::vector<igl::Hit, std::allocator<igl::Hit> >&) const;
+#endif
@@ -0,0 +1,252 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_FLATAABB_H
+#define IGL_FLATAABB_H
+
+#include "Hit.h"
+#include "igl_inline.h"
+#include <Eigen/Core>
+#include <vector>
+namespace igl
+{
+  // Axis-aligned bounding box hierarchy stored in a single array, as an
+  // alternative to igl::AABB for large meshes.
+  //
+  // Nodes are 32 bytes and laid out depth first: the left child of an inner
+  // node directly follows it, so a traversal mostly walks forward through
+  // memory instead of chasing heap pointers. Leaves hold up to max_leaf_size
+  // primitives. The tree is built by binned surface area heuristic, with the
+  // subtrees of the upper levels built on separate threads.
+  //
+  // Like igl::AABB, the mesh (V,Ele) is stored and managed by the caller and
+  // each routine here simply takes it as references (it better not change
+  // between calls).
+  //
+  // Example:
+  //   igl::FlatAABB<Eigen::MatrixXd,3> tree;
+  //   tree.init(V,F);
+  //   tree.squared_distance(V,F,P,sqrD,I,C);
+  //
+  // See also: AABB
+  template <typename DerivedV, int DIM>
+  class FlatAABB
+  {
+  public:
+    typedef typename DerivedV::Scalar Scalar;
+    typedef Eigen::Matrix<Scalar,1,DIM> RowVectorDIMS;
+    // Boxes are rounded outwards to float so that a node fits in 32 bytes.
+    struct Node
+    {
+      float min[3];
+      float max[3];
+      // Index of the right child for inner nodes (the left child is the next
+      // node), index of the first primitive in m_primitives for leaves
+      int offset;
+      // Number of primitives, 0 for inner nodes
+      int count;
+      bool is_leaf() const { return count > 0; }
+    };
+    // Depth first list of nodes, root first (empty if there are no elements)
+    std::vector<Node> m_nodes;
+    // Indices into Ele, leaves referring to contiguous ranges
+    std::vector<int> m_primitives;
+    // Maximum depth of the tree, deeper subtrees are split at the median
+    enum { MAX_DEPTH = 64 };
+    FlatAABB():m_max_leaf_size(4){}
+
+    // Build the tree for a given mesh.
+    //
+    // Inputs:
+    //   V  #V by dim list of mesh vertex positions.
+    //   Ele  #Ele by dim+1 list of mesh indices into #V.
+    //   max_leaf_size  maximum number of elements per leaf
+    template <typename DerivedEle>
+    IGL_INLINE void init(
+      const Eigen::MatrixBase<DerivedV> & V,
+      const Eigen::MatrixBase<DerivedEle> & Ele,
+      const int max_leaf_size = 4);
+    IGL_INLINE void deinit();
+    bool empty() const { return m_nodes.empty(); }
+    // Update the boxes for new positions of the same mesh (e.g. every frame
+    // of an animation), bottom up and with the subtrees of the upper levels
+    // on separate threads. Subtrees whose children overlap grew by more than
+    // max_overlap_growth since they were built are rebuilt, so that queries
+    // stay fast when elements move far relative to each other.
+    //
+    // Inputs:
+    //   V  #V by dim list of new mesh vertex positions.
+    //   Ele  #Ele by dim+1 list of mesh indices into #V, as used to build the
+    //     tree.
+    //   max_overlap_growth  threshold on the growth of overlap(), use
+    //     infinity to only update the boxes
+    // Returns number of subtrees rebuilt
+    template <typename DerivedEle>
+    IGL_INLINE int refit(
+      const Eigen::MatrixBase<DerivedV> & V,
+      const Eigen::MatrixBase<DerivedEle> & Ele,
+      const float max_overlap_growth = 0.25f);
+    // Quality of an inner node: surface area of the intersection of the
+    // boxes of its children relative to the surface area of its box, from 0
+    // (disjoint children) to 1.
+    //
+    // Inputs:
+    //   id  index into m_nodes of an inner node
+    IGL_INLINE float overlap(const int id) const;
+    // Find the indices of elements containing given point: this makes sense
+    // when Ele is a co-dimension 0 simplex (tets in 3D, triangles in 2D).
+    //
+    // Inputs:
+    //   V  #V by dim list of mesh vertex positions. **Should be same as used to
+    //     construct mesh.**
+    //   Ele  #Ele by dim+1 list of mesh indices into #V. **Should be same as used to
+    //     construct mesh.**
+    //   q  dim row-vector query position
+    //   first  whether to only return first element containing q
+    // Returns:
+    //   list of indices of elements containing q
+    template <typename DerivedEle, typename Derivedq>
+    IGL_INLINE std::vector<int> find(
+      const Eigen::MatrixBase<DerivedV> & V,
+      const Eigen::MatrixBase<DerivedEle> & Ele,
+      const Eigen::MatrixBase<Derivedq> & q,
+      const bool first=false) const;
+    // Compute squared distance to a query point
+    //
+    // Inputs:
+    //   V  #V by dim list of vertex positions
+    //   Ele  #Ele by dim list of simplex indices
+    //   p  dim-long query point
+    // Outputs:
+    //   i  facet index corresponding to smallest distances
+    //   c  closest point
+    // Returns squared distance
+    //
+    // Known bugs: currently assumes Elements are triangles regardless of
+    // dimension.
+    template <typename DerivedEle>
+    IGL_INLINE Scalar squared_distance(
+      const Eigen::MatrixBase<DerivedV> & V,
+      const Eigen::MatrixBase<DerivedEle> & Ele,
+      const RowVectorDIMS & p,
+      int & i,
+      Eigen::PlainObjectBase<RowVectorDIMS> & c) const;
+    // Default low_sqr_d
+    //
+    // Inputs:
+    //   up_sqr_d  current upper bound on squared distance, i and c are only
+    //     set if an element is closer
+    template <typename DerivedEle>
+    IGL_INLINE Scalar squared_distance(
+      const Eigen::MatrixBase<DerivedV> & V,
+      const Eigen::MatrixBase<DerivedEle> & Ele,
+      const RowVectorDIMS & p,
+      const Scalar up_sqr_d,
+      int & i,
+      Eigen::PlainObjectBase<RowVectorDIMS> & c) const;
+    // Compute the squared distance from all query points in P to the
+    // _closest_ points on the primitives stored in the tree.
+    //
+    // Inputs:
+    //   V  #V by dim list of vertex positions
+    //   Ele  #Ele by dim list of simplex indices
+    //   P  #P by dim list of query points
+    // Outputs:
+    //   sqrD  #P list of squared distances
+    //   I  #P list of indices into Ele of closest primitives
+    //   C  #P by dim list of closest points
+    template <
+      typename DerivedEle,
+      typename DerivedP,
+      typename DerivedsqrD,
+      typename DerivedI,
+      typename DerivedC>
+    IGL_INLINE void squared_distance(
+      const Eigen::MatrixBase<DerivedV> & V,
+      const Eigen::MatrixBase<DerivedEle> & Ele,
+      const Eigen::MatrixBase<DerivedP> & P,
+      Eigen::PlainObjectBase<DerivedsqrD> & sqrD,
+      Eigen::PlainObjectBase<DerivedI> & I,
+      Eigen::PlainObjectBase<DerivedC> & C) const;
+    // Intersect a ray with the triangles (3D only)
+    //
+    // Inputs:
+    //   V  #V by 3 list of vertex positions
+    //   Ele  #Ele by 3 list of triangle indices
+    //   origin  3-long ray origin
+    //   dir  3-long ray direction
+    // Outputs:
+    //   hits  list of hits sorted by distance along the ray
+    // Returns true if there is any hit
+    template <typename DerivedEle>
+    IGL_INLINE bool intersect_ray(
+      const Eigen::MatrixBase<DerivedV> & V,
+      const Eigen::MatrixBase<DerivedEle> & Ele,
+      const RowVectorDIMS & origin,
+      const RowVectorDIMS & dir,
+      std::vector<igl::Hit> & hits) const;
+    // Outputs:
+    //   hit  first hit
+    template <typename DerivedEle>
+    IGL_INLINE bool intersect_ray(
+      const Eigen::MatrixBase<DerivedV> & V,
+      const Eigen::MatrixBase<DerivedEle> & Ele,
+      const RowVectorDIMS & origin,
+      const RowVectorDIMS & dir,
+      igl::Hit & hit) const;
+    // Inputs:
+    //   min_t  only report a hit closer than min_t
+    template <typename DerivedEle>
+    IGL_INLINE bool intersect_ray(
+      const Eigen::MatrixBase<DerivedV> & V,
+      const Eigen::MatrixBase<DerivedEle> & Ele,
+      const RowVectorDIMS & origin,
+      const RowVectorDIMS & dir,
+      const Scalar min_t,
+      igl::Hit & hit) const;
+  private:
+    // Recompute the box of m_nodes[id] and its descendants
+    template <typename DerivedEle>
+    IGL_INLINE void refit_subtree(
+      const Eigen::MatrixBase<DerivedV> & V,
+      const Eigen::MatrixBase<DerivedEle> & Ele,
+      const int id,
+      const int depth,
+      const int parallel_depth);
+    // Build the subtrees rooted at the given nodes again and splice them
+    // into m_nodes
+    //
+    // Inputs:
+    //   roots  sorted list of indices into m_nodes of subtree roots
+    //   depths  depth of each root
+    template <typename DerivedEle>
+    IGL_INLINE void rebuild(
+      const Eigen::MatrixBase<DerivedV> & V,
+      const Eigen::MatrixBase<DerivedEle> & Ele,
+      const std::vector<int> & roots,
+      const std::vector<int> & depths);
+    // Squared distance from p to the box of a node
+    IGL_INLINE Scalar box_squared_distance(
+      const Node & node,
+      const RowVectorDIMS & p) const;
+    // Whether the ray origin+t*dir with dir = 1/inv_dir hits the box of a
+    // node for some t in [0,t1]
+    IGL_INLINE bool ray_box_intersect(
+      const Node & node,
+      const RowVectorDIMS & origin,
+      const RowVectorDIMS & inv_dir,
+      const Scalar t1,
+      Scalar & tmin) const;
+    int m_max_leaf_size;
+    // overlap() of each node when it was built (0 for leaves)
+    std::vector<float> m_build_overlap;
+  };
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "FlatAABB.cpp"
+#endif
+
+#endif
@@ -0,0 +1,225 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "MappedDMAT.h"
+#include "parse_number.h"
+#include "readDMAT.h"
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Binary .dmat files are "0 0\n" (an empty ascii matrix), then
+// "<#columns> <#rows>\n" and the column major doubles. readDMAT skips
+// whitespace before the numbers, so DMATWriter pads the second line with
+// spaces to align the data to a page.
+namespace igl
+{
+  namespace MappedDMAT_detail
+  {
+    const std::size_t HEADER_SIZE = 4096;
+
+    inline bool is_space(const char c)
+    {
+      return c==' ' || c=='\t' || c=='\n' || c=='\r' || c=='\v' || c=='\f';
+    }
+
+    // Parse "<#columns> <#rows>" and the single line ending character like
+    // readDMAT. Returns pointer past it or NULL.
+    inline const char * parse_header(
+      const char * p,
+      const char * end,
+      int & rows,
+      int & cols)
+    {
+      long c, r;
+      while(p < end && is_space(*p)) p++;
+      p = igl::parse_number(p, end, c);
+      if(p == NULL)
+      {
+        return NULL;
+      }
+      while(p < end && is_space(*p)) p++;
+      p = igl::parse_number(p, end, r);
+      if(p == NULL || p == end || !(*p == '\n' || *p == '\r') ||
+        c < 0 || r < 0 || c > INT_MAX || r > INT_MAX)
+      {
+        return NULL;
+      }
+      rows = int(r);
+      cols = int(c);
+      return p + 1;
+    }
+
+    // Seek to offsets beyond 2GB
+    inline bool seek(FILE * fp, const std::uint64_t offset)
+    {
+#ifdef _WIN32
+      return _fseeki64(fp, (__int64)offset, SEEK_SET) == 0;
+#else
+      return fseeko(fp, (off_t)offset, SEEK_SET) == 0;
+#endif
+    }
+  }
+}
+
+IGL_INLINE igl::DMATWriter::DMATWriter():
+  m_fp(NULL),
+  m_ok(false),
+  m_rows(0),
+  m_cols(0)
+{
+}
+
+IGL_INLINE igl::DMATWriter::~DMATWriter()
+{
+  close();
+}
+
+IGL_INLINE bool igl::DMATWriter::open(
+  const std::string & file_name,
+  const int rows,
+  const bool append)
+{
+  using namespace MappedDMAT_detail;
+  close();
+  m_rows = rows;
+  m_cols = 0;
+  FILE * existing = append ? fopen(file_name.c_str(),"rb") : NULL;
+  if(existing != NULL)
+  {
+    fclose(existing);
+    // Continue after the columns in the header, if written by DMATWriter
+    MappedFile file;
+    int r = 0, c = 0;
+    const char * p = file.open(file_name) ?
+      parse_header(file.data(), file.data() + file.size(), r, c) : NULL;
+    if(p != NULL && r == 0 && c == 0)
+    {
+      p = parse_header(p, file.data() + file.size(), r, c);
+    }
+    if(p == NULL || std::size_t(p - file.data()) != HEADER_SIZE || r != rows ||
+      std::size_t(c)*r > (file.size() - HEADER_SIZE)/sizeof(double))
+    {
+      fprintf(stderr,"IOError: DMATWriter can not append to %s...\n",file_name.c_str());
+      return false;
+    }
+    m_cols = c;
+    m_fp = fopen(file_name.c_str(),"r+b");
+  }else
+  {
+    m_fp = fopen(file_name.c_str(),"wb");
+  }
+  if(m_fp == NULL || rows < 0)
+  {
+    fprintf(stderr,"IOError: DMATWriter could not open %s...\n",file_name.c_str());
+    close();
+    return false;
+  }
+  m_ok = true;
+  return write_header();
+}
+
+IGL_INLINE bool igl::DMATWriter::write_header()
+{
+  using namespace MappedDMAT_detail;
+  const std::string size = std::to_string(m_cols) + " " + std::to_string(m_rows) + "\n";
+  std::string header = "0 0\n";
+  header.append(HEADER_SIZE - header.size() - size.size(), ' ');
+  header += size;
+  m_ok = m_ok &&
+    seek(m_fp, 0) &&
+    fwrite(header.data(), 1, header.size(), m_fp) == header.size() &&
+    seek(m_fp, HEADER_SIZE + std::uint64_t(m_cols)*m_rows*sizeof(double)) &&
+    fflush(m_fp) == 0;
+  return m_ok;
+}
+
+IGL_INLINE bool igl::DMATWriter::append(const double * data, const int n)
+{
+  if(m_fp == NULL || n < 0 || n > INT_MAX - m_cols)
+  {
+    return false;
+  }
+  const std::size_t count = std::size_t(n)*m_rows;
+  m_ok = m_ok && fwrite(data, sizeof(double), count, m_fp) == count;
+  m_cols += n;
+  return write_header();
+}
+
+IGL_INLINE bool igl::DMATWriter::close()
+{
+  if(m_fp == NULL)
+  {
+    return false;
+  }
+  m_ok = fclose(m_fp) == 0 && m_ok;
+  m_fp = NULL;
+  return m_ok;
+}
+
+IGL_INLINE igl::MappedDMAT::MappedDMAT():
+  m_data(NULL),
+  m_rows(0),
+  m_cols(0)
+{
+}
+
+IGL_INLINE bool igl::MappedDMAT::open(const std::string & file_name)
+{
+  using namespace MappedDMAT_detail;
+  close();
+  if(!m_file.open(file_name))
+  {
+    fprintf(stderr,"IOError: MappedDMAT could not open %s...\n",file_name.c_str());
+    return false;
+  }
+  const char * begin = m_file.data();
+  const char * end = begin + m_file.size();
+  int rows = 0, cols = 0;
+  const char * p = parse_header(begin, end, rows, cols);
+  if(p != NULL && rows == 0 && cols == 0)
+  {
+    // Binary
+    p = parse_header(p, end, rows, cols);
+    if(p != NULL && std::size_t(cols)*rows <= std::size_t(end - p)/sizeof(double))
+    {
+      m_rows = rows;
+      m_cols = cols;
+      if(std::size_t(p - begin) % sizeof(double) == 0)
+      {
+        m_data = reinterpret_cast<const double *>(p);
+      }else
+      {
+        // Not aligned for doubles
+        m_copy.resize(rows, cols);
+        std::memcpy(m_copy.data(), p, m_copy.size()*sizeof(double));
+        m_data = m_copy.data();
+        m_file.close();
+      }
+      return true;
+    }
+  }
+  // Ascii (or corrupt)
+  m_file.close();
+  if(!readDMAT(file_name, m_copy))
+  {
+    close();
+    return false;
+  }
+  m_rows = int(m_copy.rows());
+  m_cols = int(m_copy.cols());
+  m_data = m_copy.data();
+  return true;
+}
+
+IGL_INLINE void igl::MappedDMAT::close()
+{
+  m_file.close();
+  m_copy.resize(0, 0);
+  m_data = NULL;
+  m_rows = 0;
+  m_cols = 0;
+}
@@ -0,0 +1,141 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_MAPPEDDMAT_H
+#define IGL_MAPPEDDMAT_H
+#include "igl_inline.h"
+#include "MappedFile.h"
+#include <Eigen/Core>
+#include <cstdio>
+#include <string>
+
+namespace igl
+{
+  // Writes a binary .dmat file (readable by readDMAT) of a fixed number of
+  // rows column block by column block, e.g. one #V by 3 frame of a
+  // simulation at a time, without holding the whole matrix in memory. The
+  // header is padded so that the data starts at a page boundary (4096
+  // bytes) and can be mapped directly by MappedDMAT. It is updated after
+  // every block, so a file still being written can be read.
+  //
+  // Example:
+  //   igl::DMATWriter writer;
+  //   writer.open("frames.dmat",V.size());
+  //   for(int f = 0;f<1000;f++)
+  //   {
+  //     ...step simulation...
+  //     writer.append(Eigen::Map<const Eigen::VectorXd>(U.data(),U.size()));
+  //   }
+  //   writer.close();
+  //
+  // See also: MappedDMAT, writeDMAT
+  class DMATWriter
+  {
+  public:
+    IGL_INLINE DMATWriter();
+    // Closes the file if still open
+    IGL_INLINE ~DMATWriter();
+    // Create a file, or continue one written by DMATWriter.
+    //
+    // Inputs:
+    //   file_name  path to .dmat file
+    //   rows  number of rows of the matrix
+    //   append  whether to append to the columns of an existing file (which
+    //     must have rows rows) rather than truncate it
+    // Returns false if the file could not be created or appended to
+    IGL_INLINE bool open(
+      const std::string & file_name,
+      const int rows,
+      const bool append = false);
+    // Append columns, converted to double.
+    //
+    // Inputs:
+    //   W  rows by #W matrix
+    // Returns false if W has the wrong number of rows or writing failed
+    template <typename DerivedW>
+    inline bool append(const Eigen::MatrixBase<DerivedW> & W);
+    // Append #n columns stored contiguously (column major).
+    IGL_INLINE bool append(const double * data, const int n);
+    // Number of rows and of columns written so far
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+    // Close the file. Returns false if any write failed.
+    IGL_INLINE bool close();
+  private:
+    DMATWriter(const DMATWriter &);
+    DMATWriter & operator=(const DMATWriter &);
+    IGL_INLINE bool write_header();
+    FILE * m_fp;
+    bool m_ok;
+    int m_rows;
+    int m_cols;
+  };
+
+  // Read-only, memory mapped view of a .dmat file as an Eigen::Map. Files
+  // written by DMATWriter are mapped without copying, so opening is
+  // immediate and only the columns accessed are paged in from disk. Other
+  // binary or ascii .dmat files are read into memory.
+  //
+  // Example:
+  //   // Scrub through frames written by DMATWriter
+  //   igl::MappedDMAT frames;
+  //   frames.open("frames.dmat");
+  //   const auto U = frames.columns(f,1);
+  //   viewer.data().set_vertices(
+  //     Eigen::Map<const Eigen::MatrixXd>(U.data(),U.size()/3,3));
+  //
+  // See also: DMATWriter, readDMAT
+  class MappedDMAT
+  {
+  public:
+    typedef Eigen::Map<const Eigen::MatrixXd> ConstMap;
+    IGL_INLINE MappedDMAT();
+    // Map a .dmat file, closing any previous one. Open again to see
+    // columns appended since.
+    //
+    // Inputs:
+    //   file_name  path to .dmat file
+    // Returns false if the file could not be read
+    IGL_INLINE bool open(const std::string & file_name);
+    IGL_INLINE void close();
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+    // Whether the matrix is mapped from the file rather than copied
+    bool is_mapped() const { return m_data != m_copy.data(); }
+    // The whole rows by cols matrix
+    ConstMap matrix() const { return ConstMap(m_data, m_rows, m_cols); }
+    // Columns first..first+n-1
+    ConstMap columns(const int first, const int n) const
+    {
+      return ConstMap(m_data + std::size_t(first)*m_rows, m_rows, n);
+    }
+  private:
+    MappedDMAT(const MappedDMAT &);
+    MappedDMAT & operator=(const MappedDMAT &);
+    MappedFile m_file;
+    // Matrix if it could not be mapped
+    Eigen::MatrixXd m_copy;
+    const double * m_data;
+    int m_rows;
+    int m_cols;
+  };
+}
+
+template <typename DerivedW>
+inline bool igl::DMATWriter::append(const Eigen::MatrixBase<DerivedW> & W)
+{
+  if(W.rows() != m_rows)
+  {
+    return false;
+  }
+  const Eigen::MatrixXd Wd = W.template cast<double>();
+  return append(Wd.data(), int(Wd.cols()));
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "MappedDMAT.cpp"
+#endif
+
+#endif
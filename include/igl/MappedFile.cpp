@@ -0,0 +1,140 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "MappedFile.h"
+#include <cstdio>
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+IGL_INLINE igl::MappedFile::MappedFile():
+  m_data(NULL),
+  m_size(0),
+  m_file(NULL),
+  m_mapping(NULL)
+{
+}
+
+IGL_INLINE igl::MappedFile::~MappedFile()
+{
+  close();
+}
+
+IGL_INLINE bool igl::MappedFile::open(const std::string & path)
+{
+  close();
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+    OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if(file == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+  LARGE_INTEGER size;
+  if(!GetFileSizeEx(file, &size))
+  {
+    CloseHandle(file);
+    return false;
+  }
+  m_file = file;
+  m_size = std::size_t(size.QuadPart);
+  if(m_size == 0)
+  {
+    // Empty files can not be mapped
+    return true;
+  }
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  void * view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+  if(view)
+  {
+    m_mapping = mapping;
+    m_data = static_cast<const char *>(view);
+    return true;
+  }
+  if(mapping)
+  {
+    CloseHandle(mapping);
+  }
+#else
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if(fd < 0)
+  {
+    return false;
+  }
+  struct stat st;
+  if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+  {
+    ::close(fd);
+    return false;
+  }
+  m_size = std::size_t(st.st_size);
+  if(m_size == 0)
+  {
+    ::close(fd);
+    return true;
+  }
+  void * view = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after closing the descriptor
+  ::close(fd);
+  if(view != MAP_FAILED)
+  {
+    madvise(view, m_size, MADV_SEQUENTIAL);
+    m_mapping = view;
+    m_data = static_cast<const char *>(view);
+    return true;
+  }
+#endif
+  // Fall back to reading the whole file
+  FILE * fp = fopen(path.c_str(), "rb");
+  if(fp == NULL)
+  {
+    close();
+    return false;
+  }
+  m_buffer.resize(m_size);
+  const bool ok = fread(m_buffer.data(), 1, m_size, fp) == m_size;
+  fclose(fp);
+  if(!ok)
+  {
+    close();
+    return false;
+  }
+  m_data = m_buffer.data();
+  return true;
+}
+
+IGL_INLINE void igl::MappedFile::close()
+{
+#ifdef _WIN32
+  if(m_mapping)
+  {
+    UnmapViewOfFile(m_data);
+    CloseHandle(static_cast<HANDLE>(m_mapping));
+  }
+  if(m_file)
+  {
+    CloseHandle(static_cast<HANDLE>(m_file));
+  }
+#else
+  if(m_mapping)
+  {
+    munmap(m_mapping, m_size);
+  }
+#endif
+  m_data = NULL;
+  m_size = 0;
+  m_file = NULL;
+  m_mapping = NULL;
+  m_buffer.clear();
+  m_buffer.shrink_to_fit();
+}
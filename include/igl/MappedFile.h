@@ -0,0 +1,51 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_MAPPEDFILE_H
+#define IGL_MAPPEDFILE_H
+#include "igl_inline.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+namespace igl
+{
+  // Read-only view of the contents of a file, memory mapped where the
+  // platform supports it (otherwise read into memory). The mapping is
+  // released on close() or destruction.
+  //
+  // Example:
+  //   igl::MappedFile file;
+  //   if(!file.open("mesh.obj")) return false;
+  //   parse(file.data(), file.data() + file.size());
+  class MappedFile
+  {
+  public:
+    IGL_INLINE MappedFile();
+    IGL_INLINE ~MappedFile();
+    // Map the file at path, closing any previous one. Returns false if it
+    // could not be opened.
+    IGL_INLINE bool open(const std::string & path);
+    IGL_INLINE void close();
+    // Pointer to the first of size() bytes of the file (NULL if empty)
+    const char * data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+  private:
+    MappedFile(const MappedFile &);
+    MappedFile & operator=(const MappedFile &);
+    const char * m_data;
+    std::size_t m_size;
+    // Platform handles of the mapping
+    void * m_file;
+    void * m_mapping;
+    // Contents if mapping is not available
+    std::vector<char> m_buffer;
+  };
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "MappedFile.cpp"
+#endif
+
+#endif
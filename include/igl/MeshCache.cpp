@@ -0,0 +1,408 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "MeshCache.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+
+namespace igl
+{
+  namespace MeshCache_detail
+  {
+    const char MAGIC[8] = {'I','G','L','M','E','S','H','\0'};
+    const std::uint32_t VERSION = 1;
+    const std::size_t HEADER_SIZE = 64;
+    const std::size_t ENTRY_SIZE = 32;
+    const std::size_t ALIGNMENT = 64;
+    const std::uint32_t MAX_BLOCKS = 64;
+    enum Type
+    {
+      TYPE_FLOAT64 = 1,
+      TYPE_INT32 = 2
+    };
+
+    inline std::size_t type_size(const std::uint32_t type)
+    {
+      return type == TYPE_FLOAT64 ? 8 : (type == TYPE_INT32 ? 4 : 0);
+    }
+
+    inline bool little_endian()
+    {
+      const std::uint32_t one = 1;
+      unsigned char c;
+      std::memcpy(&c, &one, 1);
+      return c == 1;
+    }
+
+    // Header fields are (de)serialized bytewise, so they read the same on
+    // any host
+    template <typename T>
+    inline void store(char * p, const T x)
+    {
+      for(std::size_t i = 0;i<sizeof(T);i++)
+      {
+        p[i] = char((std::uint64_t(x) >> (8*i)) & 0xff);
+      }
+    }
+    template <typename T>
+    inline T load(const char * p)
+    {
+      std::uint64_t x = 0;
+      for(std::size_t i = 0;i<sizeof(T);i++)
+      {
+        x |= std::uint64_t((unsigned char)p[i]) << (8*i);
+      }
+      return T(x);
+    }
+
+    inline std::size_t align(const std::size_t n)
+    {
+      return (n + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    // 64-bit hash of n bytes (n a multiple of 32) in four independent lanes
+    // (xxHash style rounds), fast enough to check every load
+    inline std::uint64_t hash(const char * p, const std::size_t n)
+    {
+      const std::uint64_t P1 = 0x9E3779B185EBCA87ULL;
+      const std::uint64_t P2 = 0xC2B2AE3D27D4EB4FULL;
+      const auto rotl = [](const std::uint64_t x, const int r)
+      {
+        return (x << r) | (x >> (64 - r));
+      };
+      std::uint64_t h[4] = {P1 + P2, P2, 0, 0 - P1};
+      for(std::size_t i = 0;i + 32 <= n;i += 32)
+      {
+        for(int k = 0;k<4;k++)
+        {
+          std::uint64_t w;
+          std::memcpy(&w, p + i + 8*k, 8);
+          h[k] = rotl(h[k] + w * P2, 31) * P1;
+        }
+      }
+      std::uint64_t r = rotl(h[0],1) + rotl(h[1],7) + rotl(h[2],12) +
+        rotl(h[3],18) + std::uint64_t(n);
+      r ^= r >> 33;
+      r *= P2;
+      r ^= r >> 29;
+      r *= P1;
+      r ^= r >> 32;
+      return r;
+    }
+
+    // Size and modification time (in nanoseconds, where available) of a file
+    inline bool stamp(
+      const std::string & path,
+      std::uint64_t & size,
+      std::int64_t & time)
+    {
+#ifdef _WIN32
+      struct _stat64 st;
+      if(_stat64(path.c_str(), &st) != 0)
+      {
+        return false;
+      }
+      time = std::int64_t(st.st_mtime) * 1000000000;
+#else
+      struct stat st;
+      if(stat(path.c_str(), &st) != 0)
+      {
+        return false;
+      }
+#  if defined(__APPLE__)
+      time = std::int64_t(st.st_mtimespec.tv_sec) * 1000000000 +
+        st.st_mtimespec.tv_nsec;
+#  elif defined(__linux__)
+      time = std::int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#  else
+      time = std::int64_t(st.st_mtime) * 1000000000;
+#  endif
+#endif
+      size = std::uint64_t(st.st_size);
+      return true;
+    }
+  }
+}
+
+IGL_INLINE igl::MeshCache::MeshCache():
+  m_source_size(0),
+  m_source_time(0)
+{
+  close();
+}
+
+IGL_INLINE bool igl::MeshCache::open(const std::string & path, const bool verify)
+{
+  using namespace MeshCache_detail;
+  close();
+  // Blocks are raw little-endian memory
+  if(!little_endian() || !m_file.open(path))
+  {
+    return false;
+  }
+  const char * data = m_file.data();
+  const std::size_t size = m_file.size();
+  if(size < HEADER_SIZE ||
+    std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 ||
+    load<std::uint32_t>(data+8) != VERSION ||
+    load<std::uint64_t>(data+40) != size ||
+    size % ALIGNMENT != 0)
+  {
+    close();
+    return false;
+  }
+  const std::uint32_t count = load<std::uint32_t>(data+12);
+  if(count > MAX_BLOCKS || HEADER_SIZE + count*ENTRY_SIZE > size)
+  {
+    close();
+    return false;
+  }
+  for(std::uint32_t i = 0;i<count;i++)
+  {
+    const char * e = data + HEADER_SIZE + i*ENTRY_SIZE;
+    const std::uint32_t tag = load<std::uint32_t>(e);
+    Entry entry;
+    entry.type = load<std::uint32_t>(e+4);
+    entry.rows = load<std::uint64_t>(e+8);
+    entry.cols = load<std::uint64_t>(e+16);
+    entry.offset = load<std::uint64_t>(e+24);
+    const std::size_t bytes = type_size(entry.type);
+    if(bytes == 0 ||
+      entry.offset % ALIGNMENT != 0 ||
+      entry.offset > size ||
+      (entry.cols != 0 && entry.rows > (size - entry.offset) / bytes / entry.cols))
+    {
+      close();
+      return false;
+    }
+    // Ignore blocks unknown to this version
+    if(tag < NUM_BLOCKS)
+    {
+      m_blocks[tag] = entry;
+    }
+  }
+  if(verify && hash(data + HEADER_SIZE, size - HEADER_SIZE) !=
+    load<std::uint64_t>(data+32))
+  {
+    close();
+    return false;
+  }
+  m_source_size = load<std::uint64_t>(data+16);
+  m_source_time = load<std::int64_t>(data+24);
+  return true;
+}
+
+IGL_INLINE void igl::MeshCache::close()
+{
+  m_file.close();
+  for(int b = 0;b<NUM_BLOCKS;b++)
+  {
+    m_blocks[b].type = 0;
+    m_blocks[b].rows = 0;
+    m_blocks[b].cols = 0;
+    m_blocks[b].offset = 0;
+  }
+  m_source_size = 0;
+  m_source_time = 0;
+}
+
+IGL_INLINE bool igl::MeshCache::is_current(const std::string & source) const
+{
+  std::uint64_t size;
+  std::int64_t time;
+  return m_file.data() != NULL &&
+    MeshCache_detail::stamp(source, size, time) &&
+    size == m_source_size &&
+    time == m_source_time;
+}
+
+IGL_INLINE const void * igl::MeshCache::block(
+  const Block b,
+  const std::uint32_t type) const
+{
+  const Entry & e = m_blocks[b];
+  if(e.type != type || e.rows == 0 || e.cols == 0)
+  {
+    return NULL;
+  }
+  return m_file.data() + e.offset;
+}
+
+IGL_INLINE igl::MeshCache::MapXd igl::MeshCache::V() const
+{
+  const void * p = block(BLOCK_V, MeshCache_detail::TYPE_FLOAT64);
+  return MapXd(static_cast<const double *>(p),
+    p ? m_blocks[BLOCK_V].rows : 0, p ? m_blocks[BLOCK_V].cols : 0);
+}
+
+IGL_INLINE igl::MeshCache::MapXi igl::MeshCache::F() const
+{
+  const void * p = block(BLOCK_F, MeshCache_detail::TYPE_INT32);
+  return MapXi(static_cast<const int *>(p),
+    p ? m_blocks[BLOCK_F].rows : 0, p ? m_blocks[BLOCK_F].cols : 0);
+}
+
+IGL_INLINE igl::MeshCache::MapXd igl::MeshCache::N() const
+{
+  const void * p = block(BLOCK_N, MeshCache_detail::TYPE_FLOAT64);
+  return MapXd(static_cast<const double *>(p),
+    p ? m_blocks[BLOCK_N].rows : 0, p ? m_blocks[BLOCK_N].cols : 0);
+}
+
+IGL_INLINE igl::MeshCache::MapXd igl::MeshCache::UV() const
+{
+  const void * p = block(BLOCK_UV, MeshCache_detail::TYPE_FLOAT64);
+  return MapXd(static_cast<const double *>(p),
+    p ? m_blocks[BLOCK_UV].rows : 0, p ? m_blocks[BLOCK_UV].cols : 0);
+}
+
+IGL_INLINE igl::MeshCache::MapXd igl::MeshCache::C() const
+{
+  const void * p = block(BLOCK_C, MeshCache_detail::TYPE_FLOAT64);
+  return MapXd(static_cast<const double *>(p),
+    p ? m_blocks[BLOCK_C].rows : 0, p ? m_blocks[BLOCK_C].cols : 0);
+}
+
+IGL_INLINE igl::MeshCache::MapXd igl::MeshCache::S() const
+{
+  const void * p = block(BLOCK_S, MeshCache_detail::TYPE_FLOAT64);
+  return MapXd(static_cast<const double *>(p),
+    p ? m_blocks[BLOCK_S].rows : 0, p ? m_blocks[BLOCK_S].cols : 0);
+}
+
+IGL_INLINE bool igl::MeshCache::write(
+  const std::string & path,
+  const Eigen::MatrixXd & V,
+  const Eigen::MatrixXi & F,
+  const Eigen::MatrixXd & N,
+  const Eigen::MatrixXd & UV,
+  const Eigen::MatrixXd & C,
+  const Eigen::MatrixXd & S,
+  const std::string & source)
+{
+  using namespace MeshCache_detail;
+  if(!little_endian())
+  {
+    return false;
+  }
+  const Eigen::MatrixXd * dblocks[NUM_BLOCKS] = {&V, NULL, &N, &UV, &C, &S};
+  // Lay out the blocks, skipping empty optional ones
+  std::uint32_t count = 0;
+  std::size_t offsets[NUM_BLOCKS];
+  std::size_t end = 0;
+  for(int pass = 0;pass<2;pass++)
+  {
+    end = align(HEADER_SIZE + count*ENTRY_SIZE);
+    for(int b = 0;b<NUM_BLOCKS;b++)
+    {
+      const std::size_t n = b == BLOCK_F ? F.size()*4 : dblocks[b]->size()*8;
+      if(b > BLOCK_F && n == 0)
+      {
+        continue;
+      }
+      if(pass == 0)
+      {
+        count++;
+      }else
+      {
+        offsets[b] = end;
+        end = align(end + n);
+      }
+    }
+  }
+  std::vector<char> buffer(end, 0);
+  char * data = buffer.data();
+  std::memcpy(data, MAGIC, sizeof(MAGIC));
+  store<std::uint32_t>(data+8, VERSION);
+  store<std::uint32_t>(data+12, count);
+  std::uint64_t source_size = 0;
+  std::int64_t source_time = 0;
+  if(!source.empty() && !stamp(source, source_size, source_time))
+  {
+    return false;
+  }
+  store<std::uint64_t>(data+16, source_size);
+  store<std::int64_t>(data+24, source_time);
+  store<std::uint64_t>(data+40, end);
+  char * entry = data + HEADER_SIZE;
+  for(int b = 0;b<NUM_BLOCKS;b++)
+  {
+    const bool is_F = b == BLOCK_F;
+    const Eigen::Index rows = is_F ? F.rows() : dblocks[b]->rows();
+    const Eigen::Index cols = is_F ? F.cols() : dblocks[b]->cols();
+    if(b > BLOCK_F && rows*cols == 0)
+    {
+      continue;
+    }
+    store<std::uint32_t>(entry, b);
+    store<std::uint32_t>(entry+4, is_F ? TYPE_INT32 : TYPE_FLOAT64);
+    store<std::uint64_t>(entry+8, rows);
+    store<std::uint64_t>(entry+16, cols);
+    store<std::uint64_t>(entry+24, offsets[b]);
+    entry += ENTRY_SIZE;
+    if(is_F)
+    {
+      Eigen::Map<RowMatrixXi>(
+        reinterpret_cast<int *>(data + offsets[b]), rows, cols) = F;
+    }else
+    {
+      Eigen::Map<RowMatrixXd>(
+        reinterpret_cast<double *>(data + offsets[b]), rows, cols) = *dblocks[b];
+    }
+  }
+  store<std::uint64_t>(data+32, hash(data + HEADER_SIZE, end - HEADER_SIZE));
+
+  // Write under a unique temporary name and move into place
+  const std::string tmp = path + ".tmp" + std::to_string(
+    std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+    std::size_t(std::chrono::steady_clock::now().time_since_epoch().count()));
+  FILE * fp = fopen(tmp.c_str(), "wb");
+  if(fp == NULL)
+  {
+    return false;
+  }
+  const bool ok = fwrite(data, 1, end, fp) == end;
+  if(fclose(fp) != 0 || !ok)
+  {
+    std::remove(tmp.c_str());
+    return false;
+  }
+#ifdef _WIN32
+  // rename does not replace existing files on Windows
+  std::remove(path.c_str());
+#endif
+  if(std::rename(tmp.c_str(), path.c_str()) != 0)
+  {
+    std::remove(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+IGL_INLINE bool igl::MeshCache::write(
+  const std::string & path,
+  const Eigen::MatrixXd & V,
+  const Eigen::MatrixXi & F,
+  const std::string & source)
+{
+  const Eigen::MatrixXd empty;
+  return write(path, V, F, empty, empty, empty, empty, source);
+}
+
+IGL_INLINE std::string igl::MeshCache::cache_path(const std::string & source)
+{
+  return source + ".iglmesh";
+}
+
+IGL_INLINE bool & igl::MeshCache::enabled()
+{
+  static bool enabled = true;
+  return enabled;
+}
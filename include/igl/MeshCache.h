@@ -0,0 +1,130 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_MESHCACHE_H
+#define IGL_MESHCACHE_H
+#include "igl_inline.h"
+#include "MappedFile.h"
+#include <Eigen/Core>
+#include <cstdint>
+#include <string>
+namespace igl
+{
+  // Binary container for a mesh (V, F and optionally per-vertex normals N,
+  // texture coordinates UV, colors C and scalars S) that opens without
+  // parsing or copying: the file is memory mapped and the blocks are exposed
+  // as Eigen::Map views into the mapping.
+  //
+  // Layout (all little-endian):
+  //   64-byte header: magic "IGLMESH", version, block count, size and
+  //     modification time of the source file the cache was made from, and a
+  //     64-bit hash of everything after the header
+  //   table of 32-byte block entries: tag, element type, rows, cols, offset
+  //   row-major blocks, each starting at a multiple of 64 bytes
+  // V, N, UV, C and S are stored as double, F as 32-bit int.
+  //
+  // read_triangle_mesh writes a cache next to each file it parses into double
+  // positions (see cache_path) and loads it instead of the file while the
+  // source is unchanged. Set MeshCache::enabled() = false to turn that off.
+  //
+  // Example:
+  //   igl::MeshCache cache;
+  //   if(cache.open("bunny.obj.iglmesh") && cache.is_current("bunny.obj"))
+  //   {
+  //     draw(cache.V(), cache.F());
+  //   }
+  class MeshCache
+  {
+  public:
+    typedef Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor>
+      RowMatrixXd;
+    typedef Eigen::Matrix<int,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor>
+      RowMatrixXi;
+    typedef Eigen::Map<const RowMatrixXd,Eigen::Aligned16> MapXd;
+    typedef Eigen::Map<const RowMatrixXi,Eigen::Aligned16> MapXi;
+    enum Block
+    {
+      BLOCK_V = 0,
+      BLOCK_F = 1,
+      BLOCK_N = 2,
+      BLOCK_UV = 3,
+      BLOCK_C = 4,
+      BLOCK_S = 5,
+      NUM_BLOCKS = 6
+    };
+
+    IGL_INLINE MeshCache();
+    // Map a cache file, closing any previous one.
+    //
+    // Inputs:
+    //   path  path to cache file
+    //   verify  whether to check the content hash (reads the whole file)
+    // Returns false if the file can not be opened, is not a cache of this
+    // version, is truncated or fails the hash check
+    IGL_INLINE bool open(const std::string & path, const bool verify = true);
+    IGL_INLINE void close();
+    // Returns whether the source file still has the size and modification
+    // time recorded when the cache was written
+    IGL_INLINE bool is_current(const std::string & source) const;
+    // Views into the mapping, valid until close(). Missing blocks are 0 by 0.
+    IGL_INLINE MapXd V() const;
+    IGL_INLINE MapXi F() const;
+    IGL_INLINE MapXd N() const;
+    IGL_INLINE MapXd UV() const;
+    IGL_INLINE MapXd C() const;
+    IGL_INLINE MapXd S() const;
+
+    // Write a cache file. The file is written under a temporary name and
+    // renamed, so readers never see a partially written cache.
+    //
+    // Inputs:
+    //   path  path to cache file
+    //   V  #V by dim list of vertex positions
+    //   F  #F by ss list of face indices
+    //   N  #V by 3 list of normals, UV  #V by 2 list of texture
+    //     coordinates, C  #V by 3|4 list of colors, S  #V by k list of
+    //     scalars (any of them may be empty)
+    //   source  path to the file the mesh was read from, whose size and
+    //     modification time are recorded for is_current ("" for none)
+    // Returns true on success
+    IGL_INLINE static bool write(
+      const std::string & path,
+      const Eigen::MatrixXd & V,
+      const Eigen::MatrixXi & F,
+      const Eigen::MatrixXd & N,
+      const Eigen::MatrixXd & UV,
+      const Eigen::MatrixXd & C,
+      const Eigen::MatrixXd & S,
+      const std::string & source = "");
+    IGL_INLINE static bool write(
+      const std::string & path,
+      const Eigen::MatrixXd & V,
+      const Eigen::MatrixXi & F,
+      const std::string & source = "");
+    // Returns the path of the cache of a source file (source + ".iglmesh")
+    IGL_INLINE static std::string cache_path(const std::string & source);
+    // Whether read_triangle_mesh reads and writes caches (default true)
+    IGL_INLINE static bool & enabled();
+  private:
+    struct Entry
+    {
+      std::uint32_t type;
+      std::uint64_t rows;
+      std::uint64_t cols;
+      std::uint64_t offset;
+    };
+    IGL_INLINE const void * block(const Block b, const std::uint32_t type) const;
+    MappedFile m_file;
+    Entry m_blocks[NUM_BLOCKS];
+    std::uint64_t m_source_size;
+    std::int64_t m_source_time;
+  };
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "MeshCache.cpp"
+#endif
+
+#endif
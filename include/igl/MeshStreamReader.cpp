@@ -0,0 +1,669 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "MeshStreamReader.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace igl
+{
+  namespace MeshStreamReader_detail
+  {
+    inline bool little_endian()
+    {
+      const std::uint32_t one = 1;
+      unsigned char c;
+      std::memcpy(&c, &one, 1);
+      return c == 1;
+    }
+
+    inline bool seek(FILE * fp, const std::int64_t offset, const int whence)
+    {
+#ifdef _WIN32
+      return _fseeki64(fp, offset, whence) == 0;
+#else
+      return fseeko(fp, off_t(offset), whence) == 0;
+#endif
+    }
+
+    // Size of a PLY scalar type (0 if unknown)
+    inline int ply_type(const std::string & name, bool & is_float, bool & is_signed)
+    {
+      is_float = name == "float" || name == "float32" ||
+        name == "double" || name == "float64";
+      is_signed = is_float ||
+        name == "char" || name == "int8" ||
+        name == "short" || name == "int16" ||
+        name == "int" || name == "int32";
+      if(name == "char" || name == "int8" || name == "uchar" || name == "uint8")
+      {
+        return 1;
+      }
+      if(name == "short" || name == "int16" || name == "ushort" || name == "uint16")
+      {
+        return 2;
+      }
+      if(name == "int" || name == "int32" || name == "uint" || name == "uint32" ||
+        name == "float" || name == "float32")
+      {
+        return 4;
+      }
+      if(name == "double" || name == "float64")
+      {
+        return 8;
+      }
+      return 0;
+    }
+
+    // Value of a binary scalar of the given type stored at p
+    inline double decode(
+      const char * p,
+      const int type,
+      const bool is_float,
+      const bool is_signed,
+      const bool swap)
+    {
+      char b[8];
+      std::memcpy(b, p, type);
+      if(swap)
+      {
+        std::reverse(b, b + type);
+      }
+      switch(type)
+      {
+        case 1:
+        {
+          std::int8_t x;
+          std::memcpy(&x, b, 1);
+          return is_signed ? double(x) : double(std::uint8_t(x));
+        }
+        case 2:
+        {
+          std::int16_t x;
+          std::memcpy(&x, b, 2);
+          return is_signed ? double(x) : double(std::uint16_t(x));
+        }
+        case 4:
+        {
+          if(is_float)
+          {
+            float x;
+            std::memcpy(&x, b, 4);
+            return x;
+          }
+          std::int32_t x;
+          std::memcpy(&x, b, 4);
+          return is_signed ? double(x) : double(std::uint32_t(x));
+        }
+        default:
+        {
+          double x;
+          std::memcpy(&x, b, 8);
+          return x;
+        }
+      }
+    }
+  }
+}
+
+IGL_INLINE bool igl::MeshStreamReader::Cursor::read(void * dst, const std::size_t n)
+{
+  char * out = static_cast<char *>(dst);
+  std::size_t left = n;
+  while(left > 0)
+  {
+    if(pos == end)
+    {
+      pos = 0;
+      end = fread(buffer.data(), 1, buffer.size(), fp);
+      if(end == 0)
+      {
+        return false;
+      }
+    }
+    const std::size_t k = std::min(left, end - pos);
+    std::memcpy(out, buffer.data() + pos, k);
+    pos += k;
+    out += k;
+    left -= k;
+  }
+  return true;
+}
+
+IGL_INLINE bool igl::MeshStreamReader::Cursor::skip(std::uint64_t n)
+{
+  const std::size_t k = std::size_t(std::min<std::uint64_t>(n, end - pos));
+  pos += k;
+  n -= k;
+  if(n == 0)
+  {
+    return true;
+  }
+  pos = end = 0;
+  return MeshStreamReader_detail::seek(fp, std::int64_t(n), SEEK_CUR);
+}
+
+IGL_INLINE bool igl::MeshStreamReader::Cursor::seek(const std::int64_t offset)
+{
+  pos = end = 0;
+  done = 0;
+  return MeshStreamReader_detail::seek(fp, offset, SEEK_SET);
+}
+
+IGL_INLINE igl::MeshStreamReader::MeshStreamReader(const Eigen::Index block_size):
+  block_size(block_size),
+  m_format(FORMAT_NONE),
+  m_swap(false),
+  m_header_size(0),
+  m_vertex_element(-1),
+  m_face_element(-1),
+  m_num_vertices(0),
+  m_num_faces(0)
+{
+  m_vertices.fp = m_faces.fp = NULL;
+}
+
+IGL_INLINE igl::MeshStreamReader::~MeshStreamReader()
+{
+  close();
+}
+
+IGL_INLINE bool igl::MeshStreamReader::open(const std::string & path)
+{
+  using namespace std;
+  using namespace MeshStreamReader_detail;
+  close();
+  FILE * fp = fopen(path.c_str(), "rb");
+  if(fp == NULL)
+  {
+    cerr<<"IOError: "<<path<<" could not be opened."<<endl;
+    return false;
+  }
+  char magic[4] = {0};
+  const bool is_ply = fread(magic, 1, 4, fp) == 4 &&
+    std::memcmp(magic, "ply", 3) == 0 && (magic[3] == '\n' || magic[3] == '\r');
+  bool ok = false;
+  if(is_ply)
+  {
+    fseek(fp, 0, SEEK_SET);
+    ok = parse_ply_header(fp);
+    m_format = FORMAT_PLY;
+  }else
+  {
+    // Binary STL: 80 byte header, face count and 50 byte records
+    unsigned char count[4];
+    seek(fp, 0, SEEK_END);
+#ifdef _WIN32
+    const std::int64_t size = _ftelli64(fp);
+#else
+    const std::int64_t size = ftello(fp);
+#endif
+    ok = seek(fp, 80, SEEK_SET) && fread(count, 1, 4, fp) == 4;
+    if(ok)
+    {
+      m_num_faces = std::int64_t(count[0]) | std::int64_t(count[1]) << 8 |
+        std::int64_t(count[2]) << 16 | std::int64_t(count[3]) << 24;
+      ok = size == 84 + 50*m_num_faces;
+    }
+    if(ok)
+    {
+      m_format = FORMAT_STL;
+      m_num_vertices = 3*m_num_faces;
+      m_header_size = 84;
+      m_swap = !little_endian();
+    }else
+    {
+      cerr<<"Error: "<<path<<" is neither a binary PLY nor a binary STL file."<<endl;
+    }
+  }
+  fclose(fp);
+  if(!ok)
+  {
+    close();
+    return false;
+  }
+  m_path = path;
+  Cursor * cursors[2] = {&m_vertices, &m_faces};
+  for(Cursor * cursor : cursors)
+  {
+    cursor->fp = fopen(path.c_str(), "rb");
+    cursor->buffer.resize(1<<16);
+    if(cursor->fp == NULL)
+    {
+      close();
+      return false;
+    }
+  }
+  if(!rewind())
+  {
+    cerr<<"IOError: "<<path<<" is truncated."<<endl;
+    close();
+    return false;
+  }
+  return true;
+}
+
+IGL_INLINE bool igl::MeshStreamReader::parse_ply_header(FILE * fp)
+{
+  using namespace std;
+  using namespace MeshStreamReader_detail;
+  char line[4096];
+  bool format = false;
+  while(fgets(line, sizeof(line), fp) != NULL)
+  {
+    istringstream s(line);
+    string keyword;
+    s >> keyword;
+    if(keyword == "format")
+    {
+      string encoding;
+      s >> encoding;
+      if(encoding == "binary_little_endian" || encoding == "binary_big_endian")
+      {
+        m_swap = (encoding == "binary_little_endian") != little_endian();
+        format = true;
+      }else
+      {
+        cerr<<"Error: only binary PLY files can be streamed, use readPLY."<<endl;
+        return false;
+      }
+    }else if(keyword == "element")
+    {
+      Element e;
+      s >> e.name >> e.count;
+      if(!s || e.count < 0)
+      {
+        cerr<<"Error: bad PLY element: "<<line<<endl;
+        return false;
+      }
+      e.stride = 0;
+      m_elements.push_back(e);
+    }else if(keyword == "property")
+    {
+      if(m_elements.empty())
+      {
+        cerr<<"Error: PLY property before first element."<<endl;
+        return false;
+      }
+      Property p;
+      string type;
+      s >> type;
+      p.count_type = 0;
+      p.count_is_signed = false;
+      if(type == "list")
+      {
+        string count_type;
+        bool count_is_float;
+        s >> count_type >> type;
+        p.count_type = ply_type(count_type, count_is_float, p.count_is_signed);
+        if(p.count_type == 0 || count_is_float)
+        {
+          cerr<<"Error: bad PLY list count type: "<<count_type<<endl;
+          return false;
+        }
+      }
+      s >> p.name;
+      p.type = ply_type(type, p.is_float, p.is_signed);
+      if(!s || p.type == 0)
+      {
+        cerr<<"Error: bad PLY property: "<<line<<endl;
+        return false;
+      }
+      m_elements.back().properties.push_back(p);
+    }else if(keyword == "end_header")
+    {
+      break;
+    }
+  }
+  if(!format || feof(fp))
+  {
+    cerr<<"Error: missing PLY format or end_header."<<endl;
+    return false;
+  }
+#ifdef _WIN32
+  m_header_size = _ftelli64(fp);
+#else
+  m_header_size = ftello(fp);
+#endif
+
+  for(int i = 0;i<int(m_elements.size());i++)
+  {
+    Element & e = m_elements[i];
+    std::size_t stride = 0;
+    for(const Property & p : e.properties)
+    {
+      if(p.count_type)
+      {
+        stride = 0;
+        break;
+      }
+      stride += p.type;
+    }
+    e.stride = stride;
+    if(e.name == "vertex")
+    {
+      m_vertex_element = i;
+    }else if(e.name == "face")
+    {
+      m_face_element = i;
+    }
+  }
+  if(m_vertex_element < 0)
+  {
+    cerr<<"Error: PLY file has no vertex element."<<endl;
+    return false;
+  }
+  const Element & vertex = m_elements[m_vertex_element];
+  m_num_vertices = vertex.count;
+  const char * xyz[3] = {"x","y","z"};
+  for(int c = 0;c<3;c++)
+  {
+    m_xyz[c] = -1;
+    std::size_t offset = 0;
+    for(int p = 0;p<int(vertex.properties.size());p++)
+    {
+      if(vertex.properties[p].name == xyz[c])
+      {
+        m_xyz[c] = p;
+        m_xyz_offset[c] = offset;
+      }
+      offset += vertex.properties[p].type;
+    }
+    if(m_xyz[c] < 0 || vertex.properties[m_xyz[c]].count_type || vertex.stride == 0)
+    {
+      cerr<<"Error: PLY vertices need scalar x, y and z properties."<<endl;
+      return false;
+    }
+  }
+  if(m_face_element >= 0)
+  {
+    bool found = false;
+    for(const Property & p : m_elements[m_face_element].properties)
+    {
+      found |= p.count_type &&
+        (p.name == "vertex_indices" || p.name == "vertex_index") && !p.is_float;
+    }
+    if(!found)
+    {
+      cerr<<"Error: PLY faces need a vertex_indices list."<<endl;
+      return false;
+    }
+    m_num_faces = m_elements[m_face_element].count;
+  }
+  return true;
+}
+
+IGL_INLINE void igl::MeshStreamReader::close()
+{
+  Cursor * cursors[2] = {&m_vertices, &m_faces};
+  for(Cursor * cursor : cursors)
+  {
+    if(cursor->fp)
+    {
+      fclose(cursor->fp);
+    }
+    cursor->fp = NULL;
+    cursor->buffer.clear();
+    cursor->pos = cursor->end = 0;
+    cursor->done = 0;
+  }
+  m_path.clear();
+  m_format = FORMAT_NONE;
+  m_swap = false;
+  m_header_size = 0;
+  m_elements.clear();
+  m_vertex_element = m_face_element = -1;
+  m_num_vertices = m_num_faces = 0;
+}
+
+IGL_INLINE bool igl::MeshStreamReader::rewind()
+{
+  switch(m_format)
+  {
+    case FORMAT_PLY:
+      return position(m_vertices, m_vertex_element) &&
+        (m_face_element < 0 || position(m_faces, m_face_element));
+    case FORMAT_STL:
+      m_faces.done = 0;
+      return m_vertices.seek(m_header_size);
+    default:
+      return false;
+  }
+}
+
+IGL_INLINE bool igl::MeshStreamReader::read_value(
+  Cursor & cursor,
+  const int type,
+  const bool is_float,
+  const bool is_signed,
+  double & x)
+{
+  char b[8];
+  if(!cursor.read(b, type))
+  {
+    return false;
+  }
+  x = MeshStreamReader_detail::decode(b, type, is_float, is_signed, m_swap);
+  return true;
+}
+
+IGL_INLINE bool igl::MeshStreamReader::position(Cursor & cursor, const int element)
+{
+  if(!cursor.seek(m_header_size))
+  {
+    return false;
+  }
+  // Skip preceding elements, record by record if their size varies
+  for(int i = 0;i<element;i++)
+  {
+    const Element & e = m_elements[i];
+    if(e.stride)
+    {
+      if(!cursor.skip(std::uint64_t(e.count)*e.stride))
+      {
+        return false;
+      }
+      continue;
+    }
+    for(std::int64_t r = 0;r<e.count;r++)
+    {
+      for(const Property & p : e.properties)
+      {
+        double count = 1;
+        if(p.count_type &&
+          !read_value(cursor, p.count_type, false, p.count_is_signed, count))
+        {
+          return false;
+        }
+        if(!cursor.skip(std::uint64_t(count)*p.type))
+        {
+          return false;
+        }
+      }
+    }
+  }
+  cursor.done = 0;
+  return true;
+}
+
+IGL_INLINE Eigen::Index igl::MeshStreamReader::next_vertices(std::vector<double> & V)
+{
+  using namespace MeshStreamReader_detail;
+  if(m_format == FORMAT_PLY)
+  {
+    const Element & e = m_elements[m_vertex_element];
+    const Eigen::Index rows = Eigen::Index(std::min<std::int64_t>(
+      block_size, m_num_vertices - m_vertices.done));
+    V.resize(3*rows);
+    m_record.resize(e.stride);
+    for(Eigen::Index i = 0;i<rows;i++)
+    {
+      if(!m_vertices.read(m_record.data(), e.stride))
+      {
+        return -1;
+      }
+      for(int c = 0;c<3;c++)
+      {
+        const Property & p = e.properties[m_xyz[c]];
+        V[3*i+c] = decode(m_record.data() + m_xyz_offset[c],
+          p.type, p.is_float, p.is_signed, m_swap);
+      }
+    }
+    m_vertices.done += rows;
+    return rows;
+  }
+  if(m_format == FORMAT_STL)
+  {
+    const Eigen::Index faces = Eigen::Index(std::min<std::int64_t>(
+      std::max<Eigen::Index>(block_size/3, 1),
+      (m_num_vertices - m_vertices.done)/3));
+    V.resize(9*faces);
+    char record[50];
+    for(Eigen::Index f = 0;f<faces;f++)
+    {
+      if(!m_vertices.read(record, 50))
+      {
+        return -1;
+      }
+      // Skip the normal
+      for(int k = 0;k<9;k++)
+      {
+        V[9*f+k] = decode(record + 12 + 4*k, 4, true, true, m_swap);
+      }
+    }
+    m_vertices.done += 3*faces;
+    return 3*faces;
+  }
+  return -1;
+}
+
+IGL_INLINE Eigen::Index igl::MeshStreamReader::next_faces(std::vector<std::int64_t> & F)
+{
+  F.clear();
+  if(m_format == FORMAT_PLY)
+  {
+    if(m_face_element < 0)
+    {
+      return 0;
+    }
+    const Element & e = m_elements[m_face_element];
+    const std::int64_t faces = std::min<std::int64_t>(
+      block_size, m_num_faces - m_faces.done);
+    F.reserve(3*faces);
+    std::vector<std::int64_t> polygon;
+    for(std::int64_t f = 0;f<faces;f++)
+    {
+      for(const Property & p : e.properties)
+      {
+        double count = 1;
+        if(p.count_type &&
+          !read_value(m_faces, p.count_type, false, p.count_is_signed, count))
+        {
+          return -1;
+        }
+        if(!p.count_type ||
+          (p.name != "vertex_indices" && p.name != "vertex_index"))
+        {
+          if(!m_faces.skip(std::uint64_t(count)*p.type))
+          {
+            return -1;
+          }
+          continue;
+        }
+        polygon.resize(std::size_t(count));
+        for(std::int64_t & v : polygon)
+        {
+          double x;
+          if(!read_value(m_faces, p.type, p.is_float, p.is_signed, x))
+          {
+            return -1;
+          }
+          v = std::int64_t(x);
+        }
+        for(std::size_t c = 2;c<polygon.size();c++)
+        {
+          F.push_back(polygon[0]);
+          F.push_back(polygon[c-1]);
+          F.push_back(polygon[c]);
+        }
+      }
+    }
+    m_faces.done += faces;
+    return Eigen::Index(F.size()/3);
+  }
+  if(m_format == FORMAT_STL)
+  {
+    const std::int64_t faces = std::min<std::int64_t>(
+      block_size, m_num_faces - m_faces.done);
+    F.resize(3*faces);
+    for(std::int64_t f = 0;f<faces;f++)
+    {
+      for(int c = 0;c<3;c++)
+      {
+        F[3*f+c] = 3*(m_faces.done+f)+c;
+      }
+    }
+    m_faces.done += faces;
+    return Eigen::Index(faces);
+  }
+  return -1;
+}
+
+template <typename DerivedV>
+IGL_INLINE bool igl::MeshStreamReader::read_vertices(
+  Eigen::PlainObjectBase<DerivedV> & V)
+{
+  const Eigen::Index rows = next_vertices(m_V);
+  if(rows <= 0)
+  {
+    V.resize(0,3);
+    return false;
+  }
+  V.resize(rows,3);
+  for(Eigen::Index i = 0;i<rows;i++)
+  {
+    for(int c = 0;c<3;c++)
+    {
+      V(i,c) = typename DerivedV::Scalar(m_V[3*i+c]);
+    }
+  }
+  return true;
+}
+
+template <typename DerivedF>
+IGL_INLINE bool igl::MeshStreamReader::read_faces(
+  Eigen::PlainObjectBase<DerivedF> & F)
+{
+  // Empty blocks of a PLY file can only come from faces with fewer than 3
+  // vertices, keep going
+  Eigen::Index rows = 0;
+  while(rows == 0 && m_faces.done < m_num_faces)
+  {
+    rows = next_faces(m_F);
+  }
+  if(rows <= 0)
+  {
+    F.resize(0,3);
+    return false;
+  }
+  F.resize(rows,3);
+  for(Eigen::Index i = 0;i<rows;i++)
+  {
+    for(int c = 0;c<3;c++)
+    {
+      F(i,c) = typename DerivedF::Scalar(m_F[3*i+c]);
+    }
+  }
+  return true;
+}
+
+#ifdef IGL_STATIC_LIBRARY
+// Explicit template instantiation
+template bool igl::MeshStreamReader::read_vertices<Eigen::Matrix<double, -1, -1, 0, -1, -1> >(Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&);
+template bool igl::MeshStreamReader::read_vertices<Eigen::Matrix<float, -1, -1, 0, -1, -1> >(Eigen::PlainObjectBase<Eigen::Matrix<float, -1, -1, 0, -1, -1> >&);
+template bool igl::MeshStreamReader::read_faces<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> >&);
+#endif
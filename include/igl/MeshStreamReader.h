@@ -0,0 +1,156 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_MESHSTREAMREADER_H
+#define IGL_MESHSTREAMREADER_H
+#include "igl_inline.h"
+#include <Eigen/Core>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+namespace igl
+{
+  // Pull-based reader that returns the vertices and faces of a mesh file in
+  // blocks of bounded size. Memory use does not depend on the size of the
+  // mesh, so algorithms that work blockwise (bounding boxes, spatial hashing,
+  // per face quantities of triangle soups, ...) can process meshes larger
+  // than memory. Vertices and faces are read by independent cursors and can
+  // be interleaved in any order.
+  //
+  // Supported formats:
+  //   binary PLY (little or big endian) with x, y, z vertex properties and a
+  //     vertex_indices (or vertex_index) face list. Other elements and
+  //     properties are skipped; polygons are fan triangulated.
+  //   binary STL, returned unwelded like readSTL: face f has the vertices
+  //     3*f, 3*f+1 and 3*f+2.
+  //
+  // Example:
+  //   igl::MeshStreamReader reader;
+  //   Eigen::MatrixXd V;
+  //   Eigen::RowVector3d min_corner = Eigen::RowVector3d::Constant(INFINITY);
+  //   if(!reader.open("scan.ply")) return false;
+  //   while(reader.read_vertices(V))
+  //   {
+  //     min_corner = min_corner.cwiseMin(V.colwise().minCoeff());
+  //   }
+  //
+  // See also: MeshStreamWriter, readPLY, readSTL
+  class MeshStreamReader
+  {
+  public:
+    // Inputs:
+    //   block_size  number of vertices or faces returned per call
+    IGL_INLINE MeshStreamReader(const Eigen::Index block_size = 65536);
+    IGL_INLINE ~MeshStreamReader();
+    // Open a file, closing any previous one. The format is detected from
+    // the contents.
+    //
+    // Returns false (and prints why) if the file can not be opened or its
+    // format is not supported
+    IGL_INLINE bool open(const std::string & path);
+    IGL_INLINE void close();
+    // Number of vertices and faces in the file (faces as stored, i.e.
+    // before triangulating polygons)
+    std::int64_t num_vertices() const { return m_num_vertices; }
+    std::int64_t num_faces() const { return m_num_faces; }
+    // Read the next block of vertices.
+    //
+    // Outputs:
+    //   V  up to block_size by 3 list of vertex positions
+    // Returns false once all vertices have been read or on errors (then V
+    // is empty)
+    template <typename DerivedV>
+    IGL_INLINE bool read_vertices(Eigen::PlainObjectBase<DerivedV> & V);
+    // Read the next block of faces.
+    //
+    // Outputs:
+    //   F  about block_size by 3 list of triangles indexing all vertices of
+    //     the file (more rows if polygons are triangulated)
+    // Returns false once all faces have been read or on errors (then F is
+    // empty)
+    template <typename DerivedF>
+    IGL_INLINE bool read_faces(Eigen::PlainObjectBase<DerivedF> & F);
+    // Restart reading vertices and faces from the beginning
+    IGL_INLINE bool rewind();
+    Eigen::Index block_size;
+  private:
+    MeshStreamReader(const MeshStreamReader &);
+    MeshStreamReader & operator=(const MeshStreamReader &);
+    enum Format
+    {
+      FORMAT_NONE = 0,
+      FORMAT_PLY = 1,
+      FORMAT_STL = 2
+    };
+    struct Property
+    {
+      std::string name;
+      // Size in bytes of (list) values, 0 for unknown types
+      int type;
+      bool is_float;
+      bool is_signed;
+      // Type of the count of list properties (0 if not a list)
+      int count_type;
+      bool count_is_signed;
+    };
+    struct Element
+    {
+      std::string name;
+      std::int64_t count;
+      std::vector<Property> properties;
+      // Bytes per record, 0 if it contains lists
+      std::size_t stride;
+    };
+    // Buffered sequential reader over its own file handle
+    struct Cursor
+    {
+      FILE * fp;
+      std::vector<char> buffer;
+      std::size_t pos;
+      std::size_t end;
+      // Records consumed
+      std::int64_t done;
+      IGL_INLINE bool read(void * dst, const std::size_t n);
+      IGL_INLINE bool skip(std::uint64_t n);
+      IGL_INLINE bool seek(const std::int64_t offset);
+    };
+    IGL_INLINE bool parse_ply_header(FILE * fp);
+    IGL_INLINE bool position(Cursor & cursor, const int element);
+    IGL_INLINE bool read_value(
+      Cursor & cursor,
+      const int type,
+      const bool is_float,
+      const bool is_signed,
+      double & x);
+    // Non-template parts of read_vertices and read_faces: fill row-major
+    // blocks and return the number of rows (-1 on errors)
+    IGL_INLINE Eigen::Index next_vertices(std::vector<double> & V);
+    IGL_INLINE Eigen::Index next_faces(std::vector<std::int64_t> & F);
+    std::string m_path;
+    Format m_format;
+    bool m_swap;
+    std::int64_t m_header_size;
+    std::vector<Element> m_elements;
+    int m_vertex_element;
+    int m_face_element;
+    // Positions of x, y, z within a vertex record
+    std::size_t m_xyz_offset[3];
+    int m_xyz[3];
+    std::int64_t m_num_vertices;
+    std::int64_t m_num_faces;
+    Cursor m_vertices;
+    Cursor m_faces;
+    std::vector<double> m_V;
+    std::vector<std::int64_t> m_F;
+    std::vector<char> m_record;
+  };
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "MeshStreamReader.cpp"
+#endif
+
+#endif
@@ -0,0 +1,244 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "MeshStreamWriter.h"
+#include "pathinfo.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace igl
+{
+  namespace MeshStreamWriter_detail
+  {
+    // Width of the element counts in PLY headers, filled in on close
+    const int COUNT_WIDTH = 20;
+
+    // Append x as little-endian bytes
+    template <typename T>
+    inline void put(std::vector<char> & out, const T x)
+    {
+      char b[sizeof(T)];
+      std::memcpy(b, &x, sizeof(T));
+      const std::uint32_t one = 1;
+      char little;
+      std::memcpy(&little, &one, 1);
+      if(!little)
+      {
+        std::reverse(b, b + sizeof(T));
+      }
+      out.insert(out.end(), b, b + sizeof(T));
+    }
+
+    inline std::int64_t tell(FILE * fp)
+    {
+#ifdef _WIN32
+      return _ftelli64(fp);
+#else
+      return ftello(fp);
+#endif
+    }
+  }
+}
+
+IGL_INLINE igl::MeshStreamWriter::MeshStreamWriter():
+  m_fp(NULL),
+  m_format(FORMAT_NONE),
+  m_ok(false),
+  m_vertex_count_offset(0),
+  m_face_count_offset(0),
+  m_num_vertices(0),
+  m_num_faces(0)
+{
+}
+
+IGL_INLINE igl::MeshStreamWriter::~MeshStreamWriter()
+{
+  close();
+}
+
+IGL_INLINE bool igl::MeshStreamWriter::open(const std::string & path)
+{
+  using namespace std;
+  using namespace MeshStreamWriter_detail;
+  close();
+  string d,b,ext,f;
+  pathinfo(path,d,b,ext,f);
+  transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+  if(ext == "ply")
+  {
+    m_format = FORMAT_PLY;
+  }else if(ext == "stl")
+  {
+    m_format = FORMAT_STL;
+  }else
+  {
+    cerr<<"Error: "<<path<<" is not a .ply or .stl file."<<endl;
+    return false;
+  }
+  m_fp = fopen(path.c_str(), "wb");
+  if(m_fp == NULL)
+  {
+    cerr<<"IOError: "<<path<<" could not be opened for writing."<<endl;
+    m_format = FORMAT_NONE;
+    return false;
+  }
+  m_ok = true;
+  m_num_vertices = m_num_faces = 0;
+  if(m_format == FORMAT_PLY)
+  {
+    m_ok &= fprintf(m_fp,
+      "ply\nformat binary_little_endian 1.0\ncomment libigl\nelement vertex ") > 0;
+    m_vertex_count_offset = tell(m_fp);
+    m_ok &= fprintf(m_fp,
+      "%*d\nproperty double x\nproperty double y\nproperty double z\n"
+      "element face ", COUNT_WIDTH, 0) > 0;
+    m_face_count_offset = tell(m_fp);
+    m_ok &= fprintf(m_fp,
+      "%*d\nproperty list uchar int vertex_indices\nend_header\n",
+      COUNT_WIDTH, 0) > 0;
+  }else
+  {
+    // Must not start with "solid", which marks ascii files
+    char header[84] = "binary STL written by libigl";
+    m_face_count_offset = 80;
+    m_ok &= write(header, 84);
+  }
+  return m_ok;
+}
+
+IGL_INLINE bool igl::MeshStreamWriter::write(const void * data, const std::size_t n)
+{
+  m_ok = m_ok && fwrite(data, 1, n, m_fp) == n;
+  return m_ok;
+}
+
+template <typename DerivedV>
+IGL_INLINE bool igl::MeshStreamWriter::write_vertices(
+  const Eigen::MatrixBase<DerivedV> & V)
+{
+  using namespace MeshStreamWriter_detail;
+  assert(V.cols() == 3 && "V should be #V by 3");
+  // Vertices must precede faces
+  if(m_format != FORMAT_PLY || m_num_faces > 0)
+  {
+    return false;
+  }
+  m_buffer.clear();
+  m_buffer.reserve(V.rows()*3*sizeof(double));
+  for(Eigen::Index i = 0;i<V.rows();i++)
+  {
+    for(int c = 0;c<3;c++)
+    {
+      put(m_buffer, double(V(i,c)));
+    }
+  }
+  m_num_vertices += V.rows();
+  return write(m_buffer.data(), m_buffer.size());
+}
+
+template <typename DerivedF>
+IGL_INLINE bool igl::MeshStreamWriter::write_faces(
+  const Eigen::MatrixBase<DerivedF> & F)
+{
+  using namespace MeshStreamWriter_detail;
+  assert(F.cols() == 3 && "F should contain triangles");
+  if(m_format != FORMAT_PLY)
+  {
+    return false;
+  }
+  m_buffer.clear();
+  m_buffer.reserve(F.rows()*(1+3*sizeof(std::int32_t)));
+  for(Eigen::Index f = 0;f<F.rows();f++)
+  {
+    put(m_buffer, std::uint8_t(3));
+    for(int c = 0;c<3;c++)
+    {
+      put(m_buffer, std::int32_t(F(f,c)));
+    }
+  }
+  m_num_faces += F.rows();
+  return write(m_buffer.data(), m_buffer.size());
+}
+
+template <typename DerivedV, typename DerivedF>
+IGL_INLINE bool igl::MeshStreamWriter::write_triangles(
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedF> & F)
+{
+  using namespace MeshStreamWriter_detail;
+  assert(V.cols() == 3 && "V should be #V by 3");
+  assert(F.cols() == 3 && "F should contain triangles");
+  if(m_format != FORMAT_STL)
+  {
+    return false;
+  }
+  m_buffer.clear();
+  m_buffer.reserve(F.rows()*50);
+  for(Eigen::Index f = 0;f<F.rows();f++)
+  {
+    const Eigen::RowVector3d a = V.row(F(f,0)).template cast<double>();
+    const Eigen::RowVector3d b = V.row(F(f,1)).template cast<double>();
+    const Eigen::RowVector3d c = V.row(F(f,2)).template cast<double>();
+    Eigen::RowVector3d n = (b-a).cross(c-a);
+    const double norm = n.norm();
+    n = norm > 0 ? Eigen::RowVector3d(n/norm) : Eigen::RowVector3d::Zero();
+    const Eigen::RowVector3d * rows[4] = {&n, &a, &b, &c};
+    for(const Eigen::RowVector3d * r : rows)
+    {
+      for(int d = 0;d<3;d++)
+      {
+        put(m_buffer, float((*r)(d)));
+      }
+    }
+    put(m_buffer, std::uint16_t(0));
+  }
+  m_num_faces += F.rows();
+  m_num_vertices += 3*F.rows();
+  return write(m_buffer.data(), m_buffer.size());
+}
+
+IGL_INLINE bool igl::MeshStreamWriter::close()
+{
+  using namespace std;
+  using namespace MeshStreamWriter_detail;
+  if(m_fp == NULL)
+  {
+    return false;
+  }
+  if(m_format == FORMAT_PLY)
+  {
+    m_ok = m_ok &&
+      fseek(m_fp, long(m_vertex_count_offset), SEEK_SET) == 0 &&
+      fprintf(m_fp, "%*lld", COUNT_WIDTH, (long long)m_num_vertices) == COUNT_WIDTH &&
+      fseek(m_fp, long(m_face_count_offset), SEEK_SET) == 0 &&
+      fprintf(m_fp, "%*lld", COUNT_WIDTH, (long long)m_num_faces) == COUNT_WIDTH;
+  }else if(m_format == FORMAT_STL)
+  {
+    if(m_num_faces > 0xffffffffLL)
+    {
+      cerr<<"Error: binary STL files hold at most 2^32-1 faces."<<endl;
+      m_ok = false;
+    }
+    m_buffer.clear();
+    put(m_buffer, std::uint32_t(m_num_faces));
+    m_ok = m_ok &&
+      fseek(m_fp, long(m_face_count_offset), SEEK_SET) == 0 &&
+      fwrite(m_buffer.data(), 1, 4, m_fp) == 4;
+  }
+  m_ok = fclose(m_fp) == 0 && m_ok;
+  m_fp = NULL;
+  m_format = FORMAT_NONE;
+  return m_ok;
+}
+
+#ifdef IGL_STATIC_LIBRARY
+// Explicit template instantiation
+template bool igl::MeshStreamWriter::write_vertices<Eigen::Matrix<double, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&);
+template bool igl::MeshStreamWriter::write_faces<Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&);
+template bool igl::MeshStreamWriter::write_triangles<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&);
+#endif
@@ -0,0 +1,96 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_MESHSTREAMWRITER_H
+#define IGL_MESHSTREAMWRITER_H
+#include "igl_inline.h"
+#include <Eigen/Core>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+namespace igl
+{
+  // Writer counterpart of MeshStreamReader: writes a binary PLY or binary
+  // STL file block by block, so the mesh never has to be in memory at once.
+  // Element counts are filled in by close().
+  //
+  // PLY files (double positions, int triangle indices) are written with
+  // write_vertices for all vertex blocks followed by write_faces for all
+  // face blocks, faces indexing all vertices of the file.
+  //
+  // STL files store triangle soups and are written with write_triangles,
+  // whose face blocks index the vertex block they are passed with.
+  //
+  // Example:
+  //   igl::MeshStreamReader reader;
+  //   igl::MeshStreamWriter writer;
+  //   reader.open("scan.ply");
+  //   writer.open("scaled.ply");
+  //   while(reader.read_vertices(V)) writer.write_vertices(2*V);
+  //   while(reader.read_faces(F)) writer.write_faces(F);
+  //   writer.close();
+  //
+  // See also: MeshStreamReader, writePLY, writeSTL
+  class MeshStreamWriter
+  {
+  public:
+    IGL_INLINE MeshStreamWriter();
+    // Closes the file if still open
+    IGL_INLINE ~MeshStreamWriter();
+    // Create a file, the format is chosen by the extension (.ply or .stl).
+    // Returns false if the file can not be created.
+    IGL_INLINE bool open(const std::string & path);
+    // Inputs:
+    //   V  #V by 3 block of vertex positions
+    // Returns false if the file is not a PLY file, faces were already
+    // written or writing failed
+    template <typename DerivedV>
+    IGL_INLINE bool write_vertices(const Eigen::MatrixBase<DerivedV> & V);
+    // Inputs:
+    //   F  #F by 3 block of triangle indices into all written vertices
+    // Returns false if the file is not a PLY file or writing failed
+    template <typename DerivedF>
+    IGL_INLINE bool write_faces(const Eigen::MatrixBase<DerivedF> & F);
+    // Inputs:
+    //   V  #V by 3 list of vertex positions
+    //   F  #F by 3 block of triangle indices into V
+    // Returns false if the file is not an STL file or writing failed
+    template <typename DerivedV, typename DerivedF>
+    IGL_INLINE bool write_triangles(
+      const Eigen::MatrixBase<DerivedV> & V,
+      const Eigen::MatrixBase<DerivedF> & F);
+    // Fill in the element counts and close the file. Returns false if any
+    // write failed.
+    IGL_INLINE bool close();
+    std::int64_t num_vertices() const { return m_num_vertices; }
+    std::int64_t num_faces() const { return m_num_faces; }
+  private:
+    MeshStreamWriter(const MeshStreamWriter &);
+    MeshStreamWriter & operator=(const MeshStreamWriter &);
+    enum Format
+    {
+      FORMAT_NONE = 0,
+      FORMAT_PLY = 1,
+      FORMAT_STL = 2
+    };
+    IGL_INLINE bool write(const void * data, const std::size_t n);
+    FILE * m_fp;
+    Format m_format;
+    bool m_ok;
+    // Offsets of the counts to fill in on close
+    std::int64_t m_vertex_count_offset;
+    std::int64_t m_face_count_offset;
+    std::int64_t m_num_vertices;
+    std::int64_t m_num_faces;
+    std::vector<char> m_buffer;
+  };
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "MeshStreamWriter.cpp"
+#endif
+
+#endif
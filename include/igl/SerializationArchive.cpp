@@ -0,0 +1,365 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "SerializationArchive.h"
+#include "lz4_block.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// File layout (integers little endian):
+//   header  "IGLARCH\0", u32 version, u32 block size, u64 offset and u64
+//     size of the table of contents
+//   members  blocks of at most block size bytes, each a u32 stored size
+//     (high bit set if stored uncompressed) followed by the stored bytes
+//   table of contents  u64 count, then per member: u32 length and name, u32
+//     length and type, u64 size and u64 offset of its first block
+namespace igl
+{
+  namespace SerializationArchive_detail
+  {
+    const char MAGIC[8] = {'I','G','L','A','R','C','H','\0'};
+    const std::uint32_t VERSION = 1;
+    const std::size_t HEADER_SIZE = 32;
+    const std::uint32_t BLOCK_SIZE = 1 << 20;
+    const std::uint32_t RAW_BIT = 0x80000000u;
+
+    template <typename T>
+    inline void put(std::vector<char> & out, const T x)
+    {
+      for(std::size_t b = 0;b<sizeof(T);b++)
+      {
+        out.push_back(char((std::uint64_t(x) >> (8*b)) & 0xff));
+      }
+    }
+    inline void put(std::vector<char> & out, const std::string & s)
+    {
+      put(out, std::uint32_t(s.size()));
+      out.insert(out.end(), s.begin(), s.end());
+    }
+
+    // Bounds checked reading from a range of bytes
+    struct Cursor
+    {
+      const char * p;
+      const char * end;
+      template <typename T>
+      bool get(T & x)
+      {
+        if(std::size_t(end - p) < sizeof(T))
+        {
+          return false;
+        }
+        std::uint64_t v = 0;
+        for(std::size_t b = 0;b<sizeof(T);b++)
+        {
+          v |= std::uint64_t((unsigned char)p[b]) << (8*b);
+        }
+        x = T(v);
+        p += sizeof(T);
+        return true;
+      }
+      bool get(std::string & s)
+      {
+        std::uint32_t n;
+        if(!get(n) || std::size_t(end - p) < n)
+        {
+          return false;
+        }
+        s.assign(p, n);
+        p += n;
+        return true;
+      }
+    };
+  }
+}
+
+IGL_INLINE igl::ArchiveWriter::ArchiveWriter():
+  m_fp(NULL),
+  m_ok(false),
+  m_compress(true),
+  m_offset(0)
+{
+}
+
+IGL_INLINE igl::ArchiveWriter::~ArchiveWriter()
+{
+  close();
+}
+
+IGL_INLINE bool igl::ArchiveWriter::open(
+  const std::string & filename,
+  const bool compress)
+{
+  using namespace SerializationArchive_detail;
+  close();
+  m_fp = fopen(filename.c_str(),"wb");
+  if(m_fp == NULL)
+  {
+    std::cerr << "serialization: file " << filename << " could not be created!" << std::endl;
+    return false;
+  }
+  m_ok = true;
+  m_compress = compress;
+  m_entries.clear();
+  // Table of contents filled in by close()
+  std::vector<char> header(MAGIC, MAGIC + sizeof(MAGIC));
+  put(header, VERSION);
+  put(header, BLOCK_SIZE);
+  put(header, std::uint64_t(0));
+  put(header, std::uint64_t(0));
+  m_offset = 0;
+  return write_bytes(header.data(), header.size());
+}
+
+IGL_INLINE bool igl::ArchiveWriter::write_bytes(const void * data, const std::size_t n)
+{
+  m_ok = m_ok && fwrite(data, 1, n, m_fp) == n;
+  m_offset += n;
+  return m_ok;
+}
+
+IGL_INLINE bool igl::ArchiveWriter::write_member(
+  const std::string & name,
+  const std::string & type,
+  const std::vector<char> & data)
+{
+  using namespace SerializationArchive_detail;
+  if(m_fp == NULL)
+  {
+    return false;
+  }
+  Entry entry;
+  entry.name = name;
+  entry.type = type;
+  entry.size = data.size();
+  entry.offset = m_offset;
+  const std::size_t num_blocks = (data.size() + BLOCK_SIZE - 1)/BLOCK_SIZE;
+  // Compress a few blocks per thread at a time to bound memory
+  const std::size_t batch = 2*std::max(std::thread::hardware_concurrency(), 1u);
+  std::vector<std::vector<char> > compressed(std::min(batch, num_blocks));
+  const auto block_size = [&](const std::size_t b)
+  {
+    return std::min<std::size_t>(BLOCK_SIZE, data.size() - b*BLOCK_SIZE);
+  };
+  for(std::size_t first = 0;first<num_blocks && m_ok;first += batch)
+  {
+    const std::size_t count = std::min(batch, num_blocks - first);
+    if(m_compress)
+    {
+      parallel_for(count,[&](const std::size_t c)
+      {
+        const std::size_t b = first + c;
+        lz4_compress_block(data.data() + b*BLOCK_SIZE, block_size(b), compressed[c]);
+      },1);
+    }
+    for(std::size_t c = 0;c<count;c++)
+    {
+      const std::size_t b = first + c;
+      const std::size_t n = block_size(b);
+      std::vector<char> head;
+      if(m_compress && compressed[c].size() < n)
+      {
+        put(head, std::uint32_t(compressed[c].size()));
+        write_bytes(head.data(), head.size());
+        write_bytes(compressed[c].data(), compressed[c].size());
+      }else
+      {
+        // Incompressible
+        put(head, std::uint32_t(n) | RAW_BIT);
+        write_bytes(head.data(), head.size());
+        write_bytes(data.data() + b*BLOCK_SIZE, n);
+      }
+    }
+  }
+  m_entries.push_back(entry);
+  return m_ok;
+}
+
+IGL_INLINE bool igl::ArchiveWriter::close()
+{
+  using namespace SerializationArchive_detail;
+  if(m_fp == NULL)
+  {
+    return false;
+  }
+  std::vector<char> toc;
+  put(toc, std::uint64_t(m_entries.size()));
+  for(const Entry & entry : m_entries)
+  {
+    put(toc, entry.name);
+    put(toc, entry.type);
+    put(toc, entry.size);
+    put(toc, entry.offset);
+  }
+  const std::uint64_t toc_offset = m_offset;
+  write_bytes(toc.data(), toc.size());
+  std::vector<char> location;
+  put(location, toc_offset);
+  put(location, std::uint64_t(toc.size()));
+  m_ok = m_ok &&
+    fseek(m_fp, long(sizeof(MAGIC) + 8), SEEK_SET) == 0 &&
+    fwrite(location.data(), 1, location.size(), m_fp) == location.size();
+  m_ok = fclose(m_fp) == 0 && m_ok;
+  m_fp = NULL;
+  m_entries.clear();
+  return m_ok;
+}
+
+IGL_INLINE igl::ArchiveReader::ArchiveReader()
+{
+}
+
+IGL_INLINE bool igl::ArchiveReader::open(const std::string & filename)
+{
+  using namespace SerializationArchive_detail;
+  close();
+  if(!m_file.open(filename))
+  {
+    std::cerr << "serialization: file " << filename << " not found!" << std::endl;
+    return false;
+  }
+  Cursor header = {m_file.data(), m_file.data() + m_file.size()};
+  if(m_file.size() < HEADER_SIZE ||
+    std::memcmp(m_file.data(), MAGIC, sizeof(MAGIC)) != 0)
+  {
+    // Not an archive (e.g. written by igl::serialize)
+    close();
+    return false;
+  }
+  header.p += sizeof(MAGIC);
+  std::uint32_t version = 0, block_size = 0;
+  std::uint64_t toc_offset = 0, toc_size = 0;
+  header.get(version);
+  header.get(block_size);
+  header.get(toc_offset);
+  header.get(toc_size);
+  if(version > VERSION)
+  {
+    std::cerr << "serialization: " << filename << " was written by a newer version (" <<
+      version << ")!" << std::endl;
+    close();
+    return false;
+  }
+  bool ok =
+    block_size == BLOCK_SIZE &&
+    toc_offset >= HEADER_SIZE &&
+    toc_offset <= m_file.size() &&
+    toc_size <= m_file.size() - toc_offset;
+  std::uint64_t count = 0;
+  Cursor toc = {m_file.data(), m_file.data()};
+  if(ok)
+  {
+    toc.p = m_file.data() + toc_offset;
+    toc.end = toc.p + toc_size;
+  }
+  ok = ok && toc.get(count);
+  for(std::uint64_t i = 0;ok && i<count;i++)
+  {
+    std::string name;
+    Entry entry;
+    ok = toc.get(name) && toc.get(entry.type) &&
+      toc.get(entry.size) && toc.get(entry.offset) &&
+      entry.offset >= HEADER_SIZE && entry.offset <= toc_offset;
+    if(ok)
+    {
+      // Later members replace earlier ones
+      m_entries[name] = entry;
+    }
+  }
+  if(!ok)
+  {
+    std::cerr << "serialization: " << filename << " is corrupt!" << std::endl;
+    close();
+  }
+  return ok;
+}
+
+IGL_INLINE void igl::ArchiveReader::close()
+{
+  m_entries.clear();
+  m_file.close();
+}
+
+IGL_INLINE std::vector<std::string> igl::ArchiveReader::names() const
+{
+  std::vector<std::string> names;
+  for(const auto & entry : m_entries)
+  {
+    names.push_back(entry.first);
+  }
+  return names;
+}
+
+IGL_INLINE bool igl::ArchiveReader::contains(const std::string & name) const
+{
+  return m_entries.count(name) > 0;
+}
+
+IGL_INLINE bool igl::ArchiveReader::read_member(
+  const std::string & name,
+  const std::string & type,
+  std::vector<char> & data) const
+{
+  using namespace SerializationArchive_detail;
+  const auto it = m_entries.find(name);
+  if(it == m_entries.end() || it->second.type != type)
+  {
+    return false;
+  }
+  const Entry & entry = it->second;
+  // Locate the blocks, then decompress them in parallel
+  const std::size_t num_blocks = (entry.size + BLOCK_SIZE - 1)/BLOCK_SIZE;
+  if(num_blocks > (m_file.size() - entry.offset)/sizeof(std::uint32_t))
+  {
+    return false;
+  }
+  std::vector<Cursor> blocks(num_blocks);
+  std::vector<bool> raw(num_blocks);
+  Cursor cursor = {m_file.data() + entry.offset, m_file.data() + m_file.size()};
+  for(std::size_t b = 0;b<num_blocks;b++)
+  {
+    std::uint32_t stored;
+    if(!cursor.get(stored))
+    {
+      return false;
+    }
+    raw[b] = (stored & RAW_BIT) != 0;
+    stored &= ~RAW_BIT;
+    if(std::size_t(cursor.end - cursor.p) < stored)
+    {
+      return false;
+    }
+    blocks[b].p = cursor.p;
+    blocks[b].end = cursor.p + stored;
+    cursor.p += stored;
+  }
+  std::vector<char> buffer(entry.size);
+  std::vector<char> ok(num_blocks, 0);
+  parallel_for(num_blocks,[&](const std::size_t b)
+  {
+    const std::size_t n = std::min<std::size_t>(BLOCK_SIZE, entry.size - b*BLOCK_SIZE);
+    const std::size_t stored = blocks[b].end - blocks[b].p;
+    if(raw[b])
+    {
+      if(stored == n)
+      {
+        std::memcpy(buffer.data() + b*BLOCK_SIZE, blocks[b].p, n);
+        ok[b] = 1;
+      }
+    }else
+    {
+      ok[b] = lz4_decompress_block(blocks[b].p, stored, buffer.data() + b*BLOCK_SIZE, n);
+    }
+  },1);
+  if(std::find(ok.begin(), ok.end(), 0) != ok.end())
+  {
+    return false;
+  }
+  data.swap(buffer);
+  return true;
+}
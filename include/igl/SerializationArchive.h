@@ -0,0 +1,211 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_SERIALIZATIONARCHIVE_H
+#define IGL_SERIALIZATIONARCHIVE_H
+#include "igl_inline.h"
+#include "MappedFile.h"
+#include "serialize.h"
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+namespace igl
+{
+  // Writes named objects, serialized like igl::serialize, to a versioned
+  // archive file. Each object (member) is serialized on its own, cut into
+  // blocks that are compressed in parallel (LZ4 block format) and appended
+  // to the file; a table of contents with the offset of every member is
+  // written by close(). Only the member being written is held in memory,
+  // rather than the whole file as with igl::serialize.
+  //
+  // Example:
+  //   igl::ArchiveWriter archive;
+  //   archive.open("session.igl");
+  //   archive.write("Core",viewer.core());
+  //   archive.write("Data",viewer.data());
+  //   archive.close();
+  //
+  // See also: ArchiveReader, serialize
+  class ArchiveWriter
+  {
+  public:
+    IGL_INLINE ArchiveWriter();
+    // Closes the file if still open
+    IGL_INLINE ~ArchiveWriter();
+    // Create an archive file.
+    //
+    // Inputs:
+    //   filename  path of the archive
+    //   compress  whether to compress the blocks of members
+    // Returns false if the file could not be created
+    IGL_INLINE bool open(const std::string & filename, const bool compress = true);
+    // Append an object to the archive. A member replaces earlier members of
+    // the same name.
+    //
+    // Inputs:
+    //   name  name of the member
+    //   obj  object of any type supported by igl::serialize
+    // Returns false if writing failed
+    template <typename T>
+    inline bool write(const std::string & name, const T & obj);
+    // Append an already serialized member.
+    //
+    // Inputs:
+    //   name  name of the member
+    //   type  type identifier checked when reading
+    //   data  serialized bytes
+    // Returns false if writing failed
+    IGL_INLINE bool write_member(
+      const std::string & name,
+      const std::string & type,
+      const std::vector<char> & data);
+    // Write the table of contents and close the file. Returns false if any
+    // write failed.
+    IGL_INLINE bool close();
+  private:
+    ArchiveWriter(const ArchiveWriter &);
+    ArchiveWriter & operator=(const ArchiveWriter &);
+    struct Entry
+    {
+      std::string name;
+      std::string type;
+      std::uint64_t size;
+      std::uint64_t offset;
+    };
+    IGL_INLINE bool write_bytes(const void * data, const std::size_t n);
+    FILE * m_fp;
+    bool m_ok;
+    bool m_compress;
+    std::uint64_t m_offset;
+    std::vector<Entry> m_entries;
+  };
+
+  // Reads members of an archive written by ArchiveWriter. Opening maps the
+  // file and reads only its table of contents; each member is decompressed
+  // (in parallel, block by block) when it is read.
+  //
+  // Example:
+  //   igl::ArchiveReader archive;
+  //   if(archive.open("session.igl") && archive.contains("Data"))
+  //   {
+  //     archive.read("Data",viewer.data());
+  //   }
+  //
+  // See also: ArchiveWriter, deserialize
+  class ArchiveReader
+  {
+  public:
+    IGL_INLINE ArchiveReader();
+    // Open an archive file. Returns false (quietly if the file exists but is
+    // not an archive) if it can not be read or was written by a newer
+    // version.
+    IGL_INLINE bool open(const std::string & filename);
+    IGL_INLINE void close();
+    // Names of all members
+    IGL_INLINE std::vector<std::string> names() const;
+    IGL_INLINE bool contains(const std::string & name) const;
+    // Load a single member.
+    //
+    // Inputs:
+    //   name  name of the member
+    // Outputs:
+    //   obj  deserialized object, untouched on failure
+    // Returns false if there is no member of this name and type or it is
+    // corrupt
+    template <typename T>
+    inline bool read(const std::string & name, T & obj);
+    // Load the serialized bytes of a member.
+    //
+    // Inputs:
+    //   name  name of the member
+    //   type  type identifier given when writing
+    // Outputs:
+    //   data  serialized bytes
+    // Returns false if there is no member of this name and type or it is
+    // corrupt
+    IGL_INLINE bool read_member(
+      const std::string & name,
+      const std::string & type,
+      std::vector<char> & data) const;
+  private:
+    ArchiveReader(const ArchiveReader &);
+    ArchiveReader & operator=(const ArchiveReader &);
+    struct Entry
+    {
+      std::string type;
+      std::uint64_t size;
+      std::uint64_t offset;
+    };
+    MappedFile m_file;
+    std::map<std::string,Entry> m_entries;
+  };
+}
+
+// Implementation of the templates, which use the overloads of serialize.h
+
+namespace igl
+{
+  namespace SerializationArchive_detail
+  {
+    // Types with serialize(obj,buffer) overloads (SERIALIZE_TYPE, ...)
+    template <typename T>
+    inline typename std::enable_if<!serialization::is_serializable<T>::value>::type
+      to_bytes(const T & obj, std::vector<char> & data)
+    {
+      serialization::serialize<>(obj,data);
+    }
+    template <typename T>
+    inline typename std::enable_if<serialization::is_serializable<T>::value>::type
+      to_bytes(const T & obj, std::vector<char> & data)
+    {
+      data.resize(serialization::getByteSize(obj));
+      std::vector<char>::iterator iter = data.begin();
+      serialization::serialize(obj,data,iter);
+    }
+    template <typename T>
+    inline typename std::enable_if<!serialization::is_serializable<T>::value>::type
+      from_bytes(const std::vector<char> & data, T & obj)
+    {
+      serialization::deserialize<>(obj,data);
+    }
+    template <typename T>
+    inline typename std::enable_if<serialization::is_serializable<T>::value>::type
+      from_bytes(const std::vector<char> & data, T & obj)
+    {
+      std::vector<char>::const_iterator iter = data.cbegin();
+      serialization::deserialize(obj,iter);
+    }
+  }
+}
+
+template <typename T>
+inline bool igl::ArchiveWriter::write(const std::string & name, const T & obj)
+{
+  std::vector<char> data;
+  SerializationArchive_detail::to_bytes(obj,data);
+  return write_member(name,typeid(obj).name(),data);
+}
+
+template <typename T>
+inline bool igl::ArchiveReader::read(const std::string & name, T & obj)
+{
+  std::vector<char> data;
+  if(!read_member(name,typeid(obj).name(),data))
+  {
+    return false;
+  }
+  SerializationArchive_detail::from_bytes(data,obj);
+  return true;
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "SerializationArchive.cpp"
+#endif
+
+#endif
@@ -76,21 +76,51 @@ IGL_INLINE void igl::ambient_occlusion(
   const int num_samples,
   Eigen::PlainObjectBase<DerivedS> & S)
 {
-  const auto & shoot_ray = [&aabb,&V,&F](
-    const Eigen::Vector3f& _s,
-    const Eigen::Vector3f& dir)->bool
+  using namespace Eigen;
+  typedef typename DerivedV::Scalar Scalar;
+  typedef Matrix<Scalar,Dynamic,3> MatrixX3S;
+  const int n = P.rows();
+  S.resize(n,1);
+  const MatrixXf D = random_dir_stratified(num_samples).cast<float>();
+  // Trace the rays of a batch of points together (any hit is enough), so
+  // that they can be sorted into coherent packets
+  const int batch = std::max(1,(1<<16)/std::max(num_samples,1));
+  MatrixX3S O, dirs;
+  std::vector<igl::Hit> hits;
+  for(int p0 = 0;p0<n;p0+=batch)
   {
-    Eigen::Vector3f s = _s+1e-4*dir;
-    igl::Hit hit;
-    return aabb.intersect_ray(
-      V,
-      F,
-      s  .cast<typename DerivedV::Scalar>().eval(),
-      dir.cast<typename DerivedV::Scalar>().eval(),
-      hit);
-  };
-  return ambient_occlusion(shoot_ray,P,N,num_samples,S);
-
+    const int m = std::min(batch,n-p0);
+    O.resize(m*num_samples,3);
+    dirs.resize(m*num_samples,3);
+    for(int p = 0;p<m;p++)
+    {
+      const Vector3f origin = P.row(p0+p).template cast<float>();
+      const Vector3f normal = N.row(p0+p).template cast<float>();
+      for(int s = 0;s<num_samples;s++)
+      {
+        Vector3f d = D.row(s);
+        if(d.dot(normal) < 0)
+        {
+          // reverse ray
+          d *= -1;
+        }
+        const Vector3f o = origin+1e-4*d;
+        O.row(p*num_samples+s) = o.transpose().template cast<Scalar>();
+        dirs.row(p*num_samples+s) = d.transpose().template cast<Scalar>();
+      }
+    }
+    aabb.intersect_rays(
+      V,F,O,dirs,std::numeric_limits<Scalar>::infinity(),true,hits);
+    for(int p = 0;p<m;p++)
+    {
+      int num_hits = 0;
+      for(int s = 0;s<num_samples;s++)
+      {
+        num_hits += hits[p*num_samples+s].id >= 0;
+      }
+      S(p0+p) = (double)num_hits/(double)num_samples;
+    }
+  }
 }
 
 template <
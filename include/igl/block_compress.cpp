@@ -0,0 +1,428 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "block_compress.h"
+#include "parallel_for.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace igl
+{
+  namespace block_compress_detail
+  {
+    // Endpoints of the segment through the mean of the first C channels of
+    // the 16 pixels along their principal axis, covering all projections
+    template <int C>
+    inline void fit_endpoints(
+      const unsigned char (&px)[16][4],
+      float (&e0)[4],
+      float (&e1)[4])
+    {
+      float mean[C];
+      for (int c = 0; c < C; c++)
+      {
+        mean[c] = 0;
+        for (int i = 0; i < 16; i++) mean[c] += px[i][c];
+        mean[c] /= 16.0f;
+      }
+      float cov[C][C];
+      for (int a = 0; a < C; a++)
+      {
+        for (int b = 0; b < C; b++)
+        {
+          cov[a][b] = 0;
+          for (int i = 0; i < 16; i++)
+          {
+            cov[a][b] += (px[i][a]-mean[a])*(px[i][b]-mean[b]);
+          }
+        }
+      }
+      // Power iterations from the diagonal of the bounding box
+      float axis[C];
+      for (int c = 0; c < C; c++)
+      {
+        unsigned char lo = 255, hi = 0;
+        for (int i = 0; i < 16; i++)
+        {
+          lo = std::min(lo,px[i][c]);
+          hi = std::max(hi,px[i][c]);
+        }
+        axis[c] = float(hi-lo) + 1e-3f;
+      }
+      for (int it = 0; it < 8; it++)
+      {
+        float next[C];
+        float norm = 0;
+        for (int a = 0; a < C; a++)
+        {
+          next[a] = 0;
+          for (int b = 0; b < C; b++) next[a] += cov[a][b]*axis[b];
+          norm = std::max(norm,std::abs(next[a]));
+        }
+        if (norm == 0)
+        {
+          break;
+        }
+        for (int a = 0; a < C; a++) axis[a] = next[a]/norm;
+      }
+      float len2 = 0;
+      for (int c = 0; c < C; c++) len2 += axis[c]*axis[c];
+      float tmin = 0, tmax = 0;
+      for (int i = 0; i < 16; i++)
+      {
+        float t = 0;
+        for (int c = 0; c < C; c++) t += (px[i][c]-mean[c])*axis[c];
+        t /= len2;
+        tmin = std::min(tmin,t);
+        tmax = std::max(tmax,t);
+      }
+      for (int c = 0; c < 4; c++)
+      {
+        e0[c] = c < C ? std::min(std::max(mean[c]+tmin*axis[c],0.0f),255.0f) : 255.0f;
+        e1[c] = c < C ? std::min(std::max(mean[c]+tmax*axis[c],0.0f),255.0f) : 255.0f;
+      }
+    }
+
+    // Index of the palette color nearest to each pixel in the first C
+    // channels. Returns the sum of squared errors.
+    template <int C, int N>
+    inline int nearest(
+      const unsigned char (&px)[16][4],
+      const int (&palette)[N][4],
+      int (&index)[16])
+    {
+      int total = 0;
+      for (int i = 0; i < 16; i++)
+      {
+        int best = INT_MAX;
+        for (int k = 0; k < N; k++)
+        {
+          int d = 0;
+          for (int c = 0; c < C; c++)
+          {
+            const int e = int(px[i][c]) - palette[k][c];
+            d += e*e;
+          }
+          if (d < best)
+          {
+            best = d;
+            index[i] = k;
+          }
+        }
+        total += best;
+      }
+      return total;
+    }
+
+    // Least squares endpoints for given indices, where pixel i is
+    // interpolated at weights[index[i]] in [0,1] between them. Returns false
+    // if they are underdetermined (all pixels at one weight).
+    template <int C>
+    inline bool refit_endpoints(
+      const unsigned char (&px)[16][4],
+      const int (&index)[16],
+      const float * weights,
+      float (&e0)[4],
+      float (&e1)[4])
+    {
+      float aa = 0, ab = 0, bb = 0;
+      float ax[C], bx[C];
+      for (int c = 0; c < C; c++) ax[c] = bx[c] = 0;
+      for (int i = 0; i < 16; i++)
+      {
+        const float b = weights[index[i]];
+        const float a = 1.0f - b;
+        aa += a*a;
+        ab += a*b;
+        bb += b*b;
+        for (int c = 0; c < C; c++)
+        {
+          ax[c] += a*px[i][c];
+          bx[c] += b*px[i][c];
+        }
+      }
+      const float det = aa*bb - ab*ab;
+      if (std::abs(det) < 1e-6f)
+      {
+        return false;
+      }
+      for (int c = 0; c < C; c++)
+      {
+        e0[c] = std::min(std::max((bb*ax[c] - ab*bx[c])/det,0.0f),255.0f);
+        e1[c] = std::min(std::max((aa*bx[c] - ab*ax[c])/det,0.0f),255.0f);
+      }
+      return true;
+    }
+
+    inline std::uint16_t rgb565(const float (&e)[4])
+    {
+      const int r = int(e[0]*31.0f/255.0f + 0.5f);
+      const int g = int(e[1]*63.0f/255.0f + 0.5f);
+      const int b = int(e[2]*31.0f/255.0f + 0.5f);
+      return std::uint16_t((r<<11) | (g<<5) | b);
+    }
+
+    // BC1 block with endpoints e0 and e1 in the four color mode. Returns
+    // the sum of squared errors.
+    inline int bc1_encode(
+      const unsigned char (&px)[16][4],
+      const float (&e0)[4],
+      const float (&e1)[4],
+      unsigned char * out,
+      int (&index)[16])
+    {
+      std::uint16_t c0 = rgb565(e0);
+      std::uint16_t c1 = rgb565(e1);
+      // c0 > c1 selects the four color (opaque) mode
+      const bool swapped = c0 < c1;
+      if (swapped)
+      {
+        std::swap(c0,c1);
+      }
+      int palette[4][4];
+      const std::uint16_t c[2] = {c0,c1};
+      for (int k = 0; k < 2; k++)
+      {
+        const int r = c[k]>>11, g = (c[k]>>5)&63, b = c[k]&31;
+        palette[k][0] = (r<<3) | (r>>2);
+        palette[k][1] = (g<<2) | (g>>4);
+        palette[k][2] = (b<<3) | (b>>2);
+      }
+      for (int j = 0; j < 3; j++)
+      {
+        palette[2][j] = (2*palette[0][j] + palette[1][j])/3;
+        palette[3][j] = (palette[0][j] + 2*palette[1][j])/3;
+      }
+      // With c0 == c1 the decoder uses the three color mode, only index 0
+      // is the same in both
+      int err;
+      if (c0 == c1)
+      {
+        const int solid[1][4] = {{palette[0][0], palette[0][1], palette[0][2], 0}};
+        err = nearest<3>(px,solid,index);
+      }else
+      {
+        err = nearest<3>(px,palette,index);
+      }
+      std::uint32_t bits = 0;
+      for (int i = 0; i < 16; i++)
+      {
+        bits |= std::uint32_t(index[i]) << (2*i);
+      }
+      const unsigned char block[8] = {
+        (unsigned char)(c0 & 255), (unsigned char)(c0 >> 8),
+        (unsigned char)(c1 & 255), (unsigned char)(c1 >> 8),
+        (unsigned char)(bits & 255), (unsigned char)((bits >> 8) & 255),
+        (unsigned char)((bits >> 16) & 255), (unsigned char)(bits >> 24)};
+      std::memcpy(out,block,8);
+      // Refits expect the indices relative to e0 and e1
+      if (swapped)
+      {
+        for (int i = 0; i < 16; i++) index[i] = index[i] < 2 ? 1-index[i] : 5-index[i];
+      }
+      return err;
+    }
+
+    inline void bc1(const unsigned char (&px)[16][4], unsigned char * out)
+    {
+      static const float weights[4] = {0.0f, 1.0f, 1.0f/3.0f, 2.0f/3.0f};
+      float e0[4], e1[4];
+      fit_endpoints<3>(px,e0,e1);
+      int index[16];
+      int best = bc1_encode(px,e0,e1,out,index);
+      // Refine the endpoints to the chosen indices
+      for (int it = 0; it < 2 && best > 0; it++)
+      {
+        if (!refit_endpoints<3>(px,index,weights,e0,e1))
+        {
+          break;
+        }
+        unsigned char candidate[8];
+        int candidate_index[16];
+        const int err = bc1_encode(px,e0,e1,candidate,candidate_index);
+        if (err >= best)
+        {
+          break;
+        }
+        best = err;
+        std::memcpy(out,candidate,8);
+        std::copy(candidate_index,candidate_index+16,index);
+      }
+    }
+
+    // Append n bits of value to a 128 bit little endian block
+    inline void put_bits(unsigned char * out, int & pos, const unsigned value, const int n)
+    {
+      for (int i = 0; i < n; i++, pos++)
+      {
+        if ((value >> i) & 1)
+        {
+          out[pos/8] |= (unsigned char)(1 << (pos%8));
+        }
+      }
+    }
+
+    const int bc7_weights[16] =
+      {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    // BC7 mode 6 block with endpoints e0 and e1: 7 bit RGBA endpoints with
+    // one shared low bit (p-bit) each and 4 bit indices. Returns the sum of
+    // squared errors.
+    inline int bc7_encode(
+      const unsigned char (&px)[16][4],
+      const float (&e0)[4],
+      const float (&e1)[4],
+      unsigned char * out,
+      int (&index)[16])
+    {
+      const float * e[2] = {e0, e1};
+      int q[2][4], p[2];
+      for (int k = 0; k < 2; k++)
+      {
+        // Choose the p-bit closer over all channels
+        float best = 0;
+        for (int pk = 0; pk < 2; pk++)
+        {
+          int qk[4];
+          float err = 0;
+          for (int c = 0; c < 4; c++)
+          {
+            qk[c] = std::min(std::max(int(std::floor((e[k][c]-pk)/2.0f + 0.5f)),0),127);
+            const float d = float(2*qk[c]+pk) - e[k][c];
+            err += d*d;
+          }
+          if (pk == 0 || err < best)
+          {
+            best = err;
+            p[k] = pk;
+            std::copy(qk,qk+4,q[k]);
+          }
+        }
+      }
+      int palette[16][4];
+      for (int i = 0; i < 16; i++)
+      {
+        for (int c = 0; c < 4; c++)
+        {
+          const int a = 2*q[0][c]+p[0];
+          const int b = 2*q[1][c]+p[1];
+          palette[i][c] = ((64-bc7_weights[i])*a + bc7_weights[i]*b + 32) >> 6;
+        }
+      }
+      const int err = nearest<4>(px,palette,index);
+      // The most significant bit of the first index is implicitly 0
+      int stored[16];
+      std::copy(index,index+16,stored);
+      if (stored[0] & 8)
+      {
+        std::swap(q[0],q[1]);
+        std::swap(p[0],p[1]);
+        for (int i = 0; i < 16; i++) stored[i] = 15 - stored[i];
+      }
+      std::memset(out,0,16);
+      int pos = 0;
+      put_bits(out,pos,1u<<6,7);
+      for (int c = 0; c < 4; c++)
+      {
+        put_bits(out,pos,q[0][c],7);
+        put_bits(out,pos,q[1][c],7);
+      }
+      put_bits(out,pos,p[0],1);
+      put_bits(out,pos,p[1],1);
+      for (int i = 0; i < 16; i++)
+      {
+        put_bits(out,pos,stored[i],i == 0 ? 3 : 4);
+      }
+      return err;
+    }
+
+    inline void bc7(const unsigned char (&px)[16][4], unsigned char * out)
+    {
+      float weights[16];
+      for (int i = 0; i < 16; i++) weights[i] = bc7_weights[i]/64.0f;
+      float e0[4], e1[4];
+      fit_endpoints<4>(px,e0,e1);
+      int index[16];
+      int best = bc7_encode(px,e0,e1,out,index);
+      // Refine the endpoints to the chosen indices
+      for (int it = 0; it < 2 && best > 0; it++)
+      {
+        if (!refit_endpoints<4>(px,index,weights,e0,e1))
+        {
+          break;
+        }
+        unsigned char candidate[16];
+        int candidate_index[16];
+        const int err = bc7_encode(px,e0,e1,candidate,candidate_index);
+        if (err >= best)
+        {
+          break;
+        }
+        best = err;
+        std::memcpy(out,candidate,16);
+        std::copy(candidate_index,candidate_index+16,index);
+      }
+    }
+  }
+}
+
+IGL_INLINE void igl::block_compress(
+  const int width,
+  const int height,
+  const unsigned char * rgba,
+  const BlockCompressionType type,
+  std::vector<unsigned char> & blocks)
+{
+  using namespace block_compress_detail;
+  blocks.resize(block_compress_size(width,height,type));
+  if (type == BLOCK_COMPRESSION_TYPE_NONE)
+  {
+    std::copy(rgba,rgba+blocks.size(),blocks.begin());
+    return;
+  }
+  const int bw = (width+3)/4;
+  const int bh = (height+3)/4;
+  const std::size_t block_size = type == BLOCK_COMPRESSION_TYPE_BC1 ? 8 : 16;
+  igl::parallel_for(bh,[&](const int by)
+  {
+    unsigned char px[16][4];
+    for (int bx = 0; bx < bw; bx++)
+    {
+      for (int i = 0; i < 16; i++)
+      {
+        const int x = std::min(4*bx + i%4, width-1);
+        const int y = std::min(4*by + i/4, height-1);
+        std::memcpy(px[i], rgba + (std::size_t(y)*width + x)*4, 4);
+      }
+      unsigned char * out = blocks.data() + (std::size_t(by)*bw + bx)*block_size;
+      if (type == BLOCK_COMPRESSION_TYPE_BC1)
+      {
+        bc1(px,out);
+      }else
+      {
+        bc7(px,out);
+      }
+    }
+  },16);
+}
+
+IGL_INLINE std::size_t igl::block_compress_size(
+  const int width,
+  const int height,
+  const BlockCompressionType type)
+{
+  switch (type)
+  {
+    case BLOCK_COMPRESSION_TYPE_BC1:
+      return std::size_t((width+3)/4)*((height+3)/4)*8;
+    case BLOCK_COMPRESSION_TYPE_BC7:
+      return std::size_t((width+3)/4)*((height+3)/4)*16;
+    default:
+      return std::size_t(width)*height*4;
+  }
+}
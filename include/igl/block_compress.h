@@ -0,0 +1,59 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_BLOCK_COMPRESS_H
+#define IGL_BLOCK_COMPRESS_H
+#include "igl_inline.h"
+#include <cstddef>
+#include <vector>
+
+namespace igl
+{
+  // BLOCK_COMPRESSION_TYPE_NONE  uncompressed RGBA8 (4 bytes per pixel)
+  // BLOCK_COMPRESSION_TYPE_BC1  BC1/DXT1, opaque RGB in 8 bytes per 4 by 4
+  //   block (GL_COMPRESSED_RGB_S3TC_DXT1_EXT)
+  // BLOCK_COMPRESSION_TYPE_BC7  BC7 RGBA in 16 bytes per 4 by 4 block
+  //   (GL_COMPRESSED_RGBA_BPTC_UNORM)
+  enum BlockCompressionType
+  {
+    BLOCK_COMPRESSION_TYPE_NONE = 0,
+    BLOCK_COMPRESSION_TYPE_BC1 = 1,
+    BLOCK_COMPRESSION_TYPE_BC7 = 2,
+    NUM_BLOCK_COMPRESSION_TYPE = 3
+  };
+
+  // Compress an RGBA8 image into blocks of 4 by 4 pixels for a GPU texture
+  // format. Each block is fit with two endpoint colors along the principal
+  // axis of its pixels and one index per pixel into the colors interpolated
+  // between them (BC1 ignores alpha, BC7 uses its mode 6). Blocks
+  // overlapping the right/bottom border repeat the last column/row.
+  //
+  // Inputs:
+  //   width  number of pixels per row
+  //   height  number of rows
+  //   rgba  width*height*4 bytes, row after row
+  //   type  block format
+  // Outputs:
+  //   blocks  ceil(width/4)*ceil(height/4) blocks, row after row (or a copy
+  //     of rgba for BLOCK_COMPRESSION_TYPE_NONE)
+  //
+  IGL_INLINE void block_compress(
+    const int width,
+    const int height,
+    const unsigned char * rgba,
+    const BlockCompressionType type,
+    std::vector<unsigned char> & blocks);
+  // Number of bytes of a compressed image (see block_compress)
+  IGL_INLINE std::size_t block_compress_size(
+    const int width,
+    const int height,
+    const BlockCompressionType type);
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "block_compress.cpp"
+#endif
+
+#endif
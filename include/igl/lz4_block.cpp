@@ -0,0 +1,202 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "lz4_block.h"
+#include <cstdint>
+#include <cstring>
+
+namespace igl
+{
+  namespace lz4_block_detail
+  {
+    const std::size_t MIN_MATCH = 4;
+    // The last match must start at least MF_LIMIT bytes before the end and
+    // the last LAST_LITERALS bytes are always literals
+    const std::size_t MF_LIMIT = 12;
+    const std::size_t LAST_LITERALS = 5;
+    const std::size_t MAX_OFFSET = 65535;
+    const int HASH_LOG = 16;
+
+    inline std::uint32_t read32(const char * p)
+    {
+      std::uint32_t x;
+      std::memcpy(&x, p, sizeof(x));
+      return x;
+    }
+
+    // Write a length continued from a 4 bit field of the token
+    inline unsigned char * write_length(unsigned char * op, std::size_t length)
+    {
+      while(length >= 255)
+      {
+        *op++ = 255;
+        length -= 255;
+      }
+      *op++ = (unsigned char)length;
+      return op;
+    }
+
+    inline unsigned char * write_literals(
+      unsigned char * op,
+      unsigned char * token,
+      const char * literals,
+      const std::size_t count)
+    {
+      if(count >= 15)
+      {
+        *token = 15 << 4;
+        op = write_length(op, count - 15);
+      }else
+      {
+        *token = (unsigned char)(count << 4);
+      }
+      if(count > 0)
+      {
+        std::memcpy(op, literals, count);
+      }
+      return op + count;
+    }
+  }
+}
+
+IGL_INLINE void igl::lz4_compress_block(
+  const char * src,
+  const std::size_t n,
+  std::vector<char> & dst)
+{
+  using namespace lz4_block_detail;
+  dst.resize(lz4_compress_bound(n));
+  unsigned char * op = reinterpret_cast<unsigned char *>(dst.data());
+  std::size_t anchor = 0;
+  if(n > MF_LIMIT)
+  {
+    // Last position seen for each hash of 4 bytes
+    std::vector<std::uint32_t> table(std::size_t(1) << HASH_LOG, 0);
+    const std::size_t match_limit = n - MF_LIMIT;
+    const std::size_t end_limit = n - LAST_LITERALS;
+    std::size_t i = 1;
+    while(i < match_limit)
+    {
+      const std::uint32_t sequence = read32(src + i);
+      const std::uint32_t h = (sequence * 2654435761u) >> (32 - HASH_LOG);
+      const std::size_t ref = table[h];
+      table[h] = std::uint32_t(i);
+      if(i - ref > MAX_OFFSET || read32(src + ref) != sequence)
+      {
+        // Skip faster over incompressible data
+        i += 1 + ((i - anchor) >> 6);
+        continue;
+      }
+      std::size_t length = MIN_MATCH;
+      while(i + length < end_limit && src[ref + length] == src[i + length])
+      {
+        length++;
+      }
+      unsigned char * token = op++;
+      op = write_literals(op, token, src + anchor, i - anchor);
+      const std::size_t offset = i - ref;
+      *op++ = (unsigned char)(offset & 0xff);
+      *op++ = (unsigned char)(offset >> 8);
+      const std::size_t match_length = length - MIN_MATCH;
+      if(match_length >= 15)
+      {
+        *token |= 15;
+        op = write_length(op, match_length - 15);
+      }else
+      {
+        *token |= (unsigned char)match_length;
+      }
+      i += length;
+      anchor = i;
+    }
+  }
+  unsigned char * token = op++;
+  op = write_literals(op, token, src + anchor, n - anchor);
+  dst.resize(op - reinterpret_cast<unsigned char *>(dst.data()));
+}
+
+IGL_INLINE bool igl::lz4_decompress_block(
+  const char * src,
+  const std::size_t n,
+  char * dst,
+  const std::size_t dst_size)
+{
+  using namespace lz4_block_detail;
+  const unsigned char * ip = reinterpret_cast<const unsigned char *>(src);
+  const unsigned char * const iend = ip + n;
+  char * op = dst;
+  char * const oend = dst + dst_size;
+  // Read a length continued from a 4 bit field of the token
+  const auto read_length = [&ip,iend](std::size_t & length)
+  {
+    if(length != 15)
+    {
+      return true;
+    }
+    unsigned char b;
+    do
+    {
+      if(ip >= iend)
+      {
+        return false;
+      }
+      b = *ip++;
+      length += b;
+    }while(b == 255);
+    return true;
+  };
+  while(ip < iend)
+  {
+    const unsigned char token = *ip++;
+    std::size_t literals = token >> 4;
+    if(!read_length(literals) ||
+      literals > std::size_t(iend - ip) ||
+      literals > std::size_t(oend - op))
+    {
+      return false;
+    }
+    if(literals > 0)
+    {
+      std::memcpy(op, ip, literals);
+    }
+    op += literals;
+    ip += literals;
+    if(ip == iend)
+    {
+      // The last sequence has no match
+      return op == oend;
+    }
+    if(iend - ip < 2)
+    {
+      return false;
+    }
+    const std::size_t offset = std::size_t(ip[0]) | (std::size_t(ip[1]) << 8);
+    ip += 2;
+    std::size_t length = token & 15;
+    if(offset == 0 || offset > std::size_t(op - dst) || !read_length(length))
+    {
+      return false;
+    }
+    length += MIN_MATCH;
+    if(length > std::size_t(oend - op))
+    {
+      return false;
+    }
+    const char * match = op - offset;
+    if(offset >= length)
+    {
+      std::memcpy(op, match, length);
+      op += length;
+    }else
+    {
+      // Overlapping copy repeats the last offset bytes
+      for(std::size_t k = 0;k<length;k++)
+      {
+        *op++ = *match++;
+      }
+    }
+  }
+  return false;
+}
@@ -0,0 +1,50 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_LZ4_BLOCK_H
+#define IGL_LZ4_BLOCK_H
+#include "igl_inline.h"
+#include <cstddef>
+#include <vector>
+namespace igl
+{
+  // Compress a block of bytes in the LZ4 block format (greedy matching with a
+  // 64KB window), so it can also be decompressed by the lz4 library.
+  //
+  // Inputs:
+  //   src  pointer to n bytes to compress
+  //   n  number of bytes (less than 2GB)
+  // Outputs:
+  //   dst  compressed bytes, at most lz4_compress_bound(n)
+  IGL_INLINE void lz4_compress_block(
+    const char * src,
+    const std::size_t n,
+    std::vector<char> & dst);
+  // Decompress a block written in the LZ4 block format.
+  //
+  // Inputs:
+  //   src  pointer to n compressed bytes
+  //   n  number of compressed bytes
+  //   dst_size  exact size of the decompressed block
+  // Outputs:
+  //   dst  pointer to dst_size bytes receiving the decompressed block
+  // Returns false if src is not a valid block of dst_size bytes
+  IGL_INLINE bool lz4_decompress_block(
+    const char * src,
+    const std::size_t n,
+    char * dst,
+    const std::size_t dst_size);
+  // Maximum size of a compressed block of n bytes
+  inline std::size_t lz4_compress_bound(const std::size_t n)
+  {
+    return n + n/255 + 16;
+  }
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "lz4_block.cpp"
+#endif
+
+#endif
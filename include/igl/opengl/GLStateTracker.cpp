@@ -0,0 +1,123 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "GLStateTracker.h"
+
+IGL_INLINE igl::opengl::GLStateTracker::GLStateTracker():
+  issued(0),
+  avoided(0),
+  last_frame_issued(0),
+  last_frame_avoided(0),
+  m_program(0),
+  m_vao(0),
+  m_texture(0),
+  m_program_valid(false),
+  m_vao_valid(false),
+  m_texture_valid(false)
+{
+}
+
+IGL_INLINE void igl::opengl::GLStateTracker::use_program(GLuint program)
+{
+  if (m_program_valid && m_program == program)
+  {
+    avoided++;
+    return;
+  }
+  glUseProgram(program);
+  m_program = program;
+  m_program_valid = true;
+  issued++;
+}
+
+IGL_INLINE void igl::opengl::GLStateTracker::bind_vertex_array(GLuint vao)
+{
+  if (m_vao_valid && m_vao == vao)
+  {
+    avoided++;
+    return;
+  }
+  glBindVertexArray(vao);
+  m_vao = vao;
+  m_vao_valid = true;
+  issued++;
+}
+
+IGL_INLINE void igl::opengl::GLStateTracker::bind_texture_2d(GLuint texture)
+{
+  if (m_texture_valid && m_texture == texture)
+  {
+    avoided++;
+    return;
+  }
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  m_texture = texture;
+  m_texture_valid = true;
+  issued++;
+}
+
+IGL_INLINE void igl::opengl::GLStateTracker::tex_parameter_2d(
+  GLenum pname,
+  GLint value)
+{
+  // Texture parameters are object state, they survive invalidate() as long
+  // as the texture is only modified through the tracker
+  const uint64_t key = (uint64_t(m_texture) << 32) | uint64_t(pname);
+  const auto it = m_tex_parameters.find(key);
+  if (m_texture_valid && it != m_tex_parameters.end() && it->second == value)
+  {
+    avoided++;
+    return;
+  }
+  glTexParameteri(GL_TEXTURE_2D, pname, value);
+  if (m_texture_valid)
+  {
+    m_tex_parameters[key] = value;
+  }
+  issued++;
+}
+
+IGL_INLINE void igl::opengl::GLStateTracker::forget_texture(GLuint texture)
+{
+  for (auto it = m_tex_parameters.begin(); it != m_tex_parameters.end();)
+  {
+    if ((it->first >> 32) == texture)
+      it = m_tex_parameters.erase(it);
+    else
+      ++it;
+  }
+  if (m_texture_valid && m_texture == texture)
+  {
+    m_texture_valid = false;
+  }
+}
+
+IGL_INLINE void igl::opengl::GLStateTracker::add_avoided(int count)
+{
+  avoided += count;
+}
+
+IGL_INLINE void igl::opengl::GLStateTracker::invalidate()
+{
+  m_program_valid = false;
+  m_vao_valid = false;
+  m_texture_valid = false;
+}
+
+IGL_INLINE void igl::opengl::GLStateTracker::new_frame()
+{
+  last_frame_issued = issued;
+  last_frame_avoided = avoided;
+  issued = 0;
+  avoided = 0;
+  invalidate();
+}
+
+IGL_INLINE igl::opengl::GLStateTracker & igl::opengl::gl_state()
+{
+  static GLStateTracker state;
+  return state;
+}
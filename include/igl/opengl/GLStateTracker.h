@@ -0,0 +1,83 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_OPENGL_GLSTATETRACKER_H
+#define IGL_OPENGL_GLSTATETRACKER_H
+#include "../igl_inline.h"
+#include "gl.h"
+#include <cstdint>
+#include <unordered_map>
+
+namespace igl
+{
+namespace opengl
+{
+  // Shadow copy of the few pieces of OpenGL state the viewer changes for every
+  // mesh (bound program, vertex array, 2D texture and its parameters).
+  // Requests matching the shadowed state are dropped instead of being sent to
+  // the driver, and both the issued and the avoided calls are counted.
+  //
+  // The shadow copy is only valid as long as all changes of the tracked state
+  // go through the tracker. Call invalidate() after running foreign OpenGL
+  // code (e.g., ImGui or user callbacks); Viewer::draw does so once per frame
+  // through new_frame().
+  class GLStateTracker
+  {
+  public:
+    IGL_INLINE GLStateTracker();
+
+    // glUseProgram(program) unless program is already in use
+    IGL_INLINE void use_program(GLuint program);
+    // glBindVertexArray(vao) unless vao is already bound
+    IGL_INLINE void bind_vertex_array(GLuint vao);
+    // glBindTexture(GL_TEXTURE_2D, texture) on texture unit 0 unless already
+    // bound
+    IGL_INLINE void bind_texture_2d(GLuint texture);
+    // glTexParameteri(GL_TEXTURE_2D, pname, value) for the texture bound
+    // through bind_texture_2d, unless the texture already has this value
+    IGL_INLINE void tex_parameter_2d(GLenum pname, GLint value);
+    // Drop the cached parameters of a texture about to be deleted (its name
+    // may be reused by glGenTextures)
+    IGL_INLINE void forget_texture(GLuint texture);
+
+    // Record that count calls were skipped by the caller because the state
+    // they would set is known to be current (e.g. attributes stored in a
+    // vertex array object)
+    IGL_INLINE void add_avoided(int count);
+
+    // Forget the shadowed state, the next request of each kind is issued
+    IGL_INLINE void invalidate();
+    // Start counting a new frame (also invalidates)
+    IGL_INLINE void new_frame();
+
+    // Calls issued/avoided since the start of the current frame
+    int issued;
+    int avoided;
+    // Calls issued/avoided during the previous frame
+    int last_frame_issued;
+    int last_frame_avoided;
+
+  private:
+    GLuint m_program;
+    GLuint m_vao;
+    GLuint m_texture;
+    bool m_program_valid;
+    bool m_vao_valid;
+    bool m_texture_valid;
+    // (texture << 32 | pname) -> value
+    std::unordered_map<uint64_t,GLint> m_tex_parameters;
+  };
+
+  // Tracker of the current OpenGL context (the viewer draws all cores and
+  // meshes in a single context)
+  IGL_INLINE GLStateTracker & gl_state();
+}
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "GLStateTracker.cpp"
+#endif
+
+#endif
@@ -10,19 +10,29 @@
 #include "bind_vertex_attrib_array.h"
 #include "create_shader_program.h"
 #include "destroy_shader_program.h"
+#include "GLStateTracker.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <vector>
 
 IGL_INLINE igl::opengl::MeshGL::MeshGL():
+  index_type(GL_UNSIGNED_INT),
   tex_filter(GL_LINEAR),
   tex_wrap(GL_REPEAT)
 {
+  for (int k = 0; k < 3; ++k)
+  {
+    material_constant[k] = false;
+    material_locations[k] = -1;
+  }
 }
 
 IGL_INLINE void igl::opengl::MeshGL::init_buffers()
 {
   // Mesh: Vertex Array Object & Buffer objects
   glGenVertexArrays(1, &vao_mesh);
-  glBindVertexArray(vao_mesh);
+  gl_state().bind_vertex_array(vao_mesh);
   glGenBuffers(1, &vbo_V);
   glGenBuffers(1, &vbo_V_normals);
   glGenBuffers(1, &vbo_V_ambient);
@@ -31,21 +41,31 @@ IGL_INLINE void igl::opengl::MeshGL::init_buffers()
   glGenBuffers(1, &vbo_V_uv);
   glGenBuffers(1, &vbo_F);
   glGenTextures(1, &vbo_tex);
+  tex_stream.init();
+  stream_V.init();
+  stream_V_normals.init();
 
   // Line overlay
   glGenVertexArrays(1, &vao_overlay_lines);
-  glBindVertexArray(vao_overlay_lines);
+  gl_state().bind_vertex_array(vao_overlay_lines);
   glGenBuffers(1, &vbo_lines_F);
   glGenBuffers(1, &vbo_lines_V);
   glGenBuffers(1, &vbo_lines_V_colors);
 
   // Point overlay
   glGenVertexArrays(1, &vao_overlay_points);
-  glBindVertexArray(vao_overlay_points);
+  gl_state().bind_vertex_array(vao_overlay_points);
   glGenBuffers(1, &vbo_points_F);
   glGenBuffers(1, &vbo_points_V);
   glGenBuffers(1, &vbo_points_V_colors);
 
+  // Occlusion query
+  glGenVertexArrays(1, &vao_bounds);
+  glGenBuffers(1, &vbo_bounds_V);
+  glGenBuffers(1, &vbo_bounds_F);
+  glGenQueries(1, &query_bounds);
+  bounds_uploaded.setEmpty();
+
   dirty = MeshGL::DIRTY_ALL;
 }
 
@@ -53,9 +73,12 @@ IGL_INLINE void igl::opengl::MeshGL::free_buffers()
 {
   if (is_initialized)
   {
+    // Deleted names may be handed out again
+    gl_state().invalidate();
     glDeleteVertexArrays(1, &vao_mesh);
     glDeleteVertexArrays(1, &vao_overlay_lines);
     glDeleteVertexArrays(1, &vao_overlay_points);
+    glDeleteVertexArrays(1, &vao_bounds);
 
     glDeleteBuffers(1, &vbo_V);
     glDeleteBuffers(1, &vbo_V_normals);
@@ -70,53 +93,245 @@ IGL_INLINE void igl::opengl::MeshGL::free_buffers()
     glDeleteBuffers(1, &vbo_points_F);
     glDeleteBuffers(1, &vbo_points_V);
     glDeleteBuffers(1, &vbo_points_V_colors);
-
+    glDeleteBuffers(1, &vbo_bounds_V);
+    glDeleteBuffers(1, &vbo_bounds_F);
+    glDeleteQueries(1, &query_bounds);
+    stream_V.free();
+    stream_V_normals.free();
+
+    tex_stream.free();
+    gl_state().forget_texture(vbo_tex);
     glDeleteTextures(1, &vbo_tex);
   }
 }
 
 IGL_INLINE void igl::opengl::MeshGL::bind_mesh()
 {
-  glBindVertexArray(vao_mesh);
-  glUseProgram(shader_mesh);
-  bind_vertex_attrib_array(shader_mesh,"position", vbo_V, V_vbo, dirty & MeshGL::DIRTY_POSITION);
-  bind_vertex_attrib_array(shader_mesh,"normal", vbo_V_normals, V_normals_vbo, dirty & MeshGL::DIRTY_NORMAL);
-  bind_vertex_attrib_array(shader_mesh,"Ka", vbo_V_ambient, V_ambient_vbo, dirty & MeshGL::DIRTY_AMBIENT);
-  bind_vertex_attrib_array(shader_mesh,"Kd", vbo_V_diffuse, V_diffuse_vbo, dirty & MeshGL::DIRTY_DIFFUSE);
-  bind_vertex_attrib_array(shader_mesh,"Ks", vbo_V_specular, V_specular_vbo, dirty & MeshGL::DIRTY_SPECULAR);
-  bind_vertex_attrib_array(shader_mesh,"texcoord", vbo_V_uv, V_uv_vbo, dirty & MeshGL::DIRTY_UV);
-
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_F);
+  GLStateTracker & state = gl_state();
+  state.bind_vertex_array(vao_mesh);
+  state.use_program(shader_mesh);
+
+  // Attribute bindings are stored in the vertex array object, they only need
+  // to be refreshed along with their buffer's content
+  const auto bind = [&](const char * name, GLuint vbo, const RowMatrixXf & M, uint32_t flag)
+  {
+    if (dirty & flag)
+    {
+      bind_vertex_attrib_array(shader_mesh, name, vbo, M, true);
+      return;
+    }
+    state.add_avoided(4);
+
+    // Upload the changed rows, merged into contiguous ranges
+    auto it = dirty_rows.find(flag);
+    if (it == dirty_rows.end() || M.size() == 0)
+      return;
+    std::vector<int> & rows = it->second;
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    const size_t row_size = sizeof(float)*M.cols();
+    for (size_t begin = 0; begin < rows.size();)
+    {
+      size_t end = begin + 1;
+      while (end < rows.size() && rows[end] == rows[end-1] + 1)
+        end++;
+      glBufferSubData(GL_ARRAY_BUFFER, row_size*rows[begin],
+        row_size*(end-begin), M.row(rows[begin]).data());
+      begin = end;
+    }
+  };
+  // Upload packed (normalized integer) data of an attribute
+  const auto bind_packed = [&](const char * name, GLuint vbo, const void * data, size_t bytes, GLint size, GLenum type)
+  {
+    // MeshGL::GLint is unsigned, a missing attribute is -1
+    const int id = glGetAttribLocation(shader_mesh, name);
+    if (id < 0)
+      return;
+    if (bytes == 0)
+    {
+      glDisableVertexAttribArray(id);
+      return;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, bytes, data, GL_DYNAMIC_DRAW);
+    glVertexAttribPointer(id, size, type, GL_TRUE, 0, 0);
+    glEnableVertexAttribArray(id);
+  };
+  // Constant materials become generic attribute values, which are context
+  // (not vertex array) state and therefore set on every bind. The others are
+  // uploaded as RGBA8.
+  const auto bind_material = [&](const char * name, GLuint vbo, const RowMatrixXf & M, uint32_t flag, int k)
+  {
+    if (dirty & flag)
+    {
+      material_constant[k] = M.rows() > 0 &&
+        (M.rowwise() - M.row(0)).cwiseAbs().maxCoeff() == 0;
+      if (material_constant[k])
+      {
+        material_values.row(k) = M.row(0);
+        if (material_locations[k] >= 0)
+          glDisableVertexAttribArray(material_locations[k]);
+      }
+      else
+      {
+        std::vector<unsigned char> C(M.size());
+        for (Eigen::Index i = 0; i < M.size(); ++i)
+          C[i] = (unsigned char)std::round(std::max(0.f, std::min(1.f, M.data()[i]))*255.f);
+        bind_packed(name, vbo, C.data(), C.size(), 4, GL_UNSIGNED_BYTE);
+      }
+    }
+    else
+    {
+      state.add_avoided(4);
+    }
+    if (material_constant[k] && material_locations[k] >= 0)
+      glVertexAttrib4fv(material_locations[k], material_values.row(k).data());
+  };
+
+  if (streaming)
+  {
+    finish_streams();
+    const auto bind_stream = [&](const char * name, const StreamingBuffer & stream, uint32_t flag)
+    {
+      if (!(dirty & flag))
+      {
+        state.add_avoided(4);
+        return;
+      }
+      // MeshGL::GLint is unsigned, a missing attribute is -1
+      const int id = glGetAttribLocation(shader_mesh, name);
+      if (id < 0)
+        return;
+      if (stream.rows == 0)
+      {
+        glDisableVertexAttribArray(id);
+        return;
+      }
+      glBindBuffer(GL_ARRAY_BUFFER, stream.buffer());
+      glVertexAttribPointer(id, stream.cols, GL_FLOAT, GL_FALSE, 0, 0);
+      glEnableVertexAttribArray(id);
+    };
+    bind_stream("position", stream_V, MeshGL::DIRTY_POSITION);
+    bind_stream("normal", stream_V_normals, MeshGL::DIRTY_NORMAL);
+  }
+  else
+  {
+    bind("position", vbo_V, V_vbo, MeshGL::DIRTY_POSITION);
+    if (compact)
+    {
+      if (dirty & MeshGL::DIRTY_NORMAL)
+      {
+        // x, y and z as 10 bit signed normalized integers
+        const auto pack = [](float x)->uint32_t
+        {
+          x = std::max(-1.f, std::min(1.f, x));
+          return uint32_t(int32_t(std::round(x*511.f))) & 0x3FF;
+        };
+        std::vector<uint32_t> N(V_normals_vbo.rows());
+        for (Eigen::Index i = 0; i < V_normals_vbo.rows(); ++i)
+          N[i] =
+            pack(V_normals_vbo(i,0)) |
+            pack(V_normals_vbo(i,1)) << 10 |
+            pack(V_normals_vbo(i,2)) << 20;
+        bind_packed("normal", vbo_V_normals, N.data(), sizeof(uint32_t)*N.size(), 4, GL_INT_2_10_10_10_REV);
+      }
+      else
+        state.add_avoided(4);
+    }
+    else
+      bind("normal", vbo_V_normals, V_normals_vbo, MeshGL::DIRTY_NORMAL);
+  }
+  if (compact)
+  {
+    bind_material("Ka", vbo_V_ambient, V_ambient_vbo, MeshGL::DIRTY_AMBIENT, 0);
+    bind_material("Kd", vbo_V_diffuse, V_diffuse_vbo, MeshGL::DIRTY_DIFFUSE, 1);
+    bind_material("Ks", vbo_V_specular, V_specular_vbo, MeshGL::DIRTY_SPECULAR, 2);
+  }
+  else
+  {
+    bind("Ka", vbo_V_ambient, V_ambient_vbo, MeshGL::DIRTY_AMBIENT);
+    bind("Kd", vbo_V_diffuse, V_diffuse_vbo, MeshGL::DIRTY_DIFFUSE);
+    bind("Ks", vbo_V_specular, V_specular_vbo, MeshGL::DIRTY_SPECULAR);
+  }
+  bind("texcoord", vbo_V_uv, V_uv_vbo, MeshGL::DIRTY_UV);
+
+  // The element array binding is also vertex array state
   if (dirty & MeshGL::DIRTY_FACE)
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned)*F_vbo.size(), F_vbo.data(), GL_DYNAMIC_DRAW);
+  {
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_F);
+    if (compact && F_vbo.size() > 0 && F_vbo.maxCoeff() < 0xFFFF)
+    {
+      const std::vector<unsigned short> F16(F_vbo.data(), F_vbo.data() + F_vbo.size());
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned short)*F16.size(), F16.data(), GL_DYNAMIC_DRAW);
+      index_type = GL_UNSIGNED_SHORT;
+    }
+    else
+    {
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned)*F_vbo.size(), F_vbo.data(), GL_DYNAMIC_DRAW);
+      index_type = GL_UNSIGNED_INT;
+    }
+  }
 
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, vbo_tex);
   if (dirty & MeshGL::DIRTY_TEXTURE)
   {
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, tex_wrap);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, tex_wrap);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, tex_filter);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, tex_filter);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex_u, tex_v, 0, GL_RGBA, GL_UNSIGNED_BYTE, tex.data());
+    const bool stream = tex_stream_texels > 0 && tex_u * tex_v >= tex_stream_texels;
+    if (tex_u * tex_v > 0 &&
+      (stream || tex_mipmaps || tex_compression != BLOCK_COMPRESSION_TYPE_NONE))
+    {
+      // Large textures are prepared on a worker thread and replace vbo_tex
+      // once their first level arrived
+      tex_stream.start(tex_u, tex_v, reinterpret_cast<const unsigned char *>(tex.data()),
+        tex_filter, tex_wrap, tex_mipmaps, tex_compression, stream);
+      if (!stream)
+        tex_stream.finish(vbo_tex);
+    }
+    else
+    {
+      tex_stream.cancel();
+      state.bind_texture_2d(vbo_tex);
+      state.tex_parameter_2d(GL_TEXTURE_WRAP_S, tex_wrap);
+      state.tex_parameter_2d(GL_TEXTURE_WRAP_T, tex_wrap);
+      state.tex_parameter_2d(GL_TEXTURE_MIN_FILTER, tex_filter);
+      state.tex_parameter_2d(GL_TEXTURE_MAG_FILTER, tex_filter);
+      // vbo_tex may hold the levels of a streamed texture
+      state.tex_parameter_2d(GL_TEXTURE_BASE_LEVEL, 0);
+      state.tex_parameter_2d(GL_TEXTURE_MAX_LEVEL, 0);
+      glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex_u, tex_v, 0, GL_RGBA, GL_UNSIGNED_BYTE, tex.data());
+    }
   }
-  glUniform1i(glGetUniformLocation(shader_mesh,"tex"), 0);
+  if (tex_stream.is_streaming())
+    tex_stream.update(vbo_tex, tex_stream_budget);
+  state.bind_texture_2d(vbo_tex);
   dirty &= ~MeshGL::DIRTY_MESH;
+  dirty_rows.clear();
+}
+
+IGL_INLINE void igl::opengl::MeshGL::finish_streams()
+{
+  stream_V.unmap();
+  stream_V_normals.unmap();
 }
 
 IGL_INLINE void igl::opengl::MeshGL::bind_overlay_lines()
 {
   bool is_dirty = dirty & MeshGL::DIRTY_OVERLAY_LINES;
 
-  glBindVertexArray(vao_overlay_lines);
-  glUseProgram(shader_overlay_lines);
- bind_vertex_attrib_array(shader_overlay_lines,"position", vbo_lines_V, lines_V_vbo, is_dirty);
- bind_vertex_attrib_array(shader_overlay_lines,"color", vbo_lines_V_colors, lines_V_colors_vbo, is_dirty);
-
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_lines_F);
+  GLStateTracker & state = gl_state();
+  state.bind_vertex_array(vao_overlay_lines);
+  state.use_program(shader_overlay_lines);
   if (is_dirty)
+  {
+    bind_vertex_attrib_array(shader_overlay_lines,"position", vbo_lines_V, lines_V_vbo, is_dirty);
+    bind_vertex_attrib_array(shader_overlay_lines,"color", vbo_lines_V_colors, lines_V_colors_vbo, is_dirty);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_lines_F);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned)*lines_F_vbo.size(), lines_F_vbo.data(), GL_DYNAMIC_DRAW);
+  }
+  else
+  {
+    state.add_avoided(9);
+  }
 
   dirty &= ~MeshGL::DIRTY_OVERLAY_LINES;
 }
@@ -125,19 +340,63 @@ IGL_INLINE void igl::opengl::MeshGL::bind_overlay_points()
 {
   bool is_dirty = dirty & MeshGL::DIRTY_OVERLAY_POINTS;
 
-  glBindVertexArray(vao_overlay_points);
-  glUseProgram(shader_overlay_points);
- bind_vertex_attrib_array(shader_overlay_points,"position", vbo_points_V, points_V_vbo, is_dirty);
- bind_vertex_attrib_array(shader_overlay_points,"color", vbo_points_V_colors, points_V_colors_vbo, is_dirty);
-
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_points_F);
+  GLStateTracker & state = gl_state();
+  state.bind_vertex_array(vao_overlay_points);
+  state.use_program(shader_overlay_points);
   if (is_dirty)
+  {
+    bind_vertex_attrib_array(shader_overlay_points,"position", vbo_points_V, points_V_vbo, is_dirty);
+    bind_vertex_attrib_array(shader_overlay_points,"color", vbo_points_V_colors, points_V_colors_vbo, is_dirty);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_points_F);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned)*points_F_vbo.size(), points_F_vbo.data(), GL_DYNAMIC_DRAW);
+  }
+  else
+  {
+    state.add_avoided(9);
+  }
 
   dirty &= ~MeshGL::DIRTY_OVERLAY_POINTS;
 }
 
-IGL_INLINE void igl::opengl::MeshGL::draw_mesh(bool solid)
+IGL_INLINE void igl::opengl::MeshGL::bind_bounds(const Eigen::AlignedBox3d & box)
+{
+  GLStateTracker & state = gl_state();
+  state.bind_vertex_array(vao_bounds);
+  state.use_program(shader_overlay_lines);
+  if (box.min() == bounds_uploaded.min() && box.max() == bounds_uploaded.max())
+  {
+    state.add_avoided(6);
+    return;
+  }
+
+  Eigen::Matrix<float,8,3,Eigen::RowMajor> corners;
+  for (int c = 0; c < 8; ++c)
+    corners.row(c) = box.corner(Eigen::AlignedBox3d::CornerType(c)).cast<float>().transpose();
+  // Corner c has bit 0/1/2 set for max x/y/z, two triangles per face
+  const unsigned short faces[36] = {
+    0,2,6, 0,6,4, 1,5,7, 1,7,3,
+    0,4,5, 0,5,1, 2,3,7, 2,7,6,
+    0,1,3, 0,3,2, 4,6,7, 4,7,5};
+
+  GLint id = glGetAttribLocation(shader_overlay_lines, "position");
+  glBindBuffer(GL_ARRAY_BUFFER, vbo_bounds_V);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(float)*corners.size(), corners.data(), GL_DYNAMIC_DRAW);
+  glVertexAttribPointer(id, 3, GL_FLOAT, GL_FALSE, 0, 0);
+  glEnableVertexAttribArray(id);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_bounds_F);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(faces), faces, GL_STATIC_DRAW);
+  bounds_uploaded = box;
+}
+
+IGL_INLINE void igl::opengl::MeshGL::draw_bounds(int instances)
+{
+  if (instances > 1)
+    glDrawElementsInstanced(GL_TRIANGLES, 36, GL_UNSIGNED_SHORT, 0, instances);
+  else
+    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_SHORT, 0);
+}
+
+IGL_INLINE void igl::opengl::MeshGL::draw_mesh(bool solid, int instances)
 {
   glPolygonMode(GL_FRONT_AND_BACK, solid ? GL_FILL : GL_LINE);
 
@@ -147,20 +406,36 @@ IGL_INLINE void igl::opengl::MeshGL::draw_mesh(bool solid)
     glEnable(GL_POLYGON_OFFSET_FILL);
     glPolygonOffset(1.0, 1.0);
   }
-  glDrawElements(GL_TRIANGLES, 3*F_vbo.rows(), GL_UNSIGNED_INT, 0);
+  if (instances > 1)
+    glDrawElementsInstanced(GL_TRIANGLES, 3*F_vbo.rows(), index_type, 0, instances);
+  else
+    glDrawElements(GL_TRIANGLES, 3*F_vbo.rows(), index_type, 0);
+
+  // Keep the streamed buffers from being overwritten while still in use
+  if (streaming)
+  {
+    stream_V.fence();
+    stream_V_normals.fence();
+  }
 
   glDisable(GL_POLYGON_OFFSET_FILL);
   glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 }
 
-IGL_INLINE void igl::opengl::MeshGL::draw_overlay_lines()
+IGL_INLINE void igl::opengl::MeshGL::draw_overlay_lines(int instances)
 {
-  glDrawElements(GL_LINES, lines_F_vbo.rows(), GL_UNSIGNED_INT, 0);
+  if (instances > 1)
+    glDrawElementsInstanced(GL_LINES, lines_F_vbo.rows(), GL_UNSIGNED_INT, 0, instances);
+  else
+    glDrawElements(GL_LINES, lines_F_vbo.rows(), GL_UNSIGNED_INT, 0);
 }
 
-IGL_INLINE void igl::opengl::MeshGL::draw_overlay_points()
+IGL_INLINE void igl::opengl::MeshGL::draw_overlay_points(int instances)
 {
-  glDrawElements(GL_POINTS, points_F_vbo.rows(), GL_UNSIGNED_INT, 0);
+  if (instances > 1)
+    glDrawElementsInstanced(GL_POINTS, points_F_vbo.rows(), GL_UNSIGNED_INT, 0, instances);
+  else
+    glDrawElements(GL_POINTS, points_F_vbo.rows(), GL_UNSIGNED_INT, 0);
 }
 
 IGL_INLINE void igl::opengl::MeshGL::init()
@@ -175,6 +450,10 @@ R"(#version 150
   uniform mat4 view;
   uniform mat4 proj;
   uniform mat4 normal_matrix;
+  uniform int stereo;
+  uniform mat4 stereo_view[2];
+  uniform mat4 stereo_proj[2];
+  uniform mat4 stereo_normal_matrix[2];
   in vec3 position;
   in vec3 normal;
   out vec3 position_eye;
@@ -190,10 +469,29 @@ R"(#version 150
 
   void main()
   {
-    position_eye = vec3 (view * vec4 (position, 1.0));
-    normal_eye = vec3 (normal_matrix * vec4 (normal, 0.0));
+    mat4 view_i = view;
+    mat4 proj_i = proj;
+    mat4 normal_matrix_i = normal_matrix;
+    if (stereo == 1)
+    {
+      // Instance 0 is the left eye, instance 1 the right eye
+      view_i = stereo_view[gl_InstanceID];
+      proj_i = stereo_proj[gl_InstanceID];
+      normal_matrix_i = stereo_normal_matrix[gl_InstanceID];
+    }
+    position_eye = vec3 (view_i * vec4 (position, 1.0));
+    normal_eye = vec3 (normal_matrix_i * vec4 (normal, 0.0));
     normal_eye = normalize(normal_eye);
-    gl_Position = proj * vec4 (position_eye, 1.0); //proj * view * vec4(position, 1.0);"
+    gl_Position = proj_i * vec4 (position_eye, 1.0); //proj * view * vec4(position, 1.0);"
+    gl_ClipDistance[0] = 1.0;
+    if (stereo == 1)
+    {
+      // Squeeze each eye into its half of the side-by-side target and clip
+      // it against the seam
+      float side = 2.0 * float(gl_InstanceID) - 1.0;
+      gl_Position.x = 0.5 * gl_Position.x + 0.5 * side * gl_Position.w;
+      gl_ClipDistance[0] = side * gl_Position.x;
+    }
     Kai = Ka;
     Kdi = Kd;
     Ksi = Ks;
@@ -256,13 +554,27 @@ R"(#version 150
 R"(#version 150
   uniform mat4 view;
   uniform mat4 proj;
+  uniform int stereo;
+  uniform mat4 stereo_view[2];
+  uniform mat4 stereo_proj[2];
   in vec3 position;
   in vec3 color;
   out vec3 color_frag;
 
   void main()
   {
-    gl_Position = proj * view * vec4 (position, 1.0);
+    gl_ClipDistance[0] = 1.0;
+    if (stereo == 1)
+    {
+      gl_Position = stereo_proj[gl_InstanceID] * stereo_view[gl_InstanceID] * vec4 (position, 1.0);
+      float side = 2.0 * float(gl_InstanceID) - 1.0;
+      gl_Position.x = 0.5 * gl_Position.x + 0.5 * side * gl_Position.w;
+      gl_ClipDistance[0] = side * gl_Position.x;
+    }
+    else
+    {
+      gl_Position = proj * view * vec4 (position, 1.0);
+    }
     color_frag = color;
   }
 )";
@@ -305,6 +617,44 @@ R"(#version 150
     overlay_point_fragment_shader_string,
     {},
     shader_overlay_points);
+
+  // Resolve uniform locations once instead of by name on every draw
+  const auto mesh_uniform = [this](const char * name)
+  {
+    return glGetUniformLocation(shader_mesh, name);
+  };
+  uniforms_mesh.view                 = mesh_uniform("view");
+  uniforms_mesh.proj                 = mesh_uniform("proj");
+  uniforms_mesh.normal_matrix        = mesh_uniform("normal_matrix");
+  uniforms_mesh.stereo               = mesh_uniform("stereo");
+  uniforms_mesh.stereo_view          = mesh_uniform("stereo_view");
+  uniforms_mesh.stereo_proj          = mesh_uniform("stereo_proj");
+  uniforms_mesh.stereo_normal_matrix = mesh_uniform("stereo_normal_matrix");
+  uniforms_mesh.specular_exponent    = mesh_uniform("specular_exponent");
+  uniforms_mesh.light_position_eye   = mesh_uniform("light_position_eye");
+  uniforms_mesh.lighting_factor      = mesh_uniform("lighting_factor");
+  uniforms_mesh.fixed_color          = mesh_uniform("fixed_color");
+  uniforms_mesh.texture_factor       = mesh_uniform("texture_factor");
+  uniforms_mesh.matcap_factor        = mesh_uniform("matcap_factor");
+  uniforms_mesh.double_sided         = mesh_uniform("double_sided");
+  material_locations[0] = glGetAttribLocation(shader_mesh, "Ka");
+  material_locations[1] = glGetAttribLocation(shader_mesh, "Kd");
+  material_locations[2] = glGetAttribLocation(shader_mesh, "Ks");
+
+  const auto overlay_uniforms = [](GLuint program, OverlayUniforms & u)
+  {
+    u.view        = glGetUniformLocation(program, "view");
+    u.proj        = glGetUniformLocation(program, "proj");
+    u.stereo      = glGetUniformLocation(program, "stereo");
+    u.stereo_view = glGetUniformLocation(program, "stereo_view");
+    u.stereo_proj = glGetUniformLocation(program, "stereo_proj");
+  };
+  overlay_uniforms(shader_overlay_lines, uniforms_overlay_lines);
+  overlay_uniforms(shader_overlay_points, uniforms_overlay_points);
+
+  // The sampler always reads from texture unit 0
+  gl_state().use_program(shader_mesh);
+  glUniform1i(glGetUniformLocation(shader_mesh, "tex"), 0);
 }
 
 IGL_INLINE void igl::opengl::MeshGL::free()
@@ -13,7 +13,12 @@
 // the data
 
 #include <igl/igl_inline.h>
+#include "StreamingBuffer.h"
+#include "TextureStream.h"
 #include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <map>
+#include <vector>
 
 namespace igl
 {
@@ -68,6 +73,32 @@ public:
   GLuint vbo_points_V;        // Vertices of the point overlay
   GLuint vbo_points_V_colors; // Color values of the point overlay
 
+  GLuint vao_bounds;   // Bounding box drawn for the occlusion query
+  GLuint vbo_bounds_V; // Corners of the bounding box
+  GLuint vbo_bounds_F; // Triangles of the bounding box
+  GLuint query_bounds; // GL_ANY_SAMPLES_PASSED query of the bounding box
+  Eigen::AlignedBox3d bounds_uploaded;
+
+  // Positions and normals are read from these instead of vbo_V and
+  // vbo_V_normals when streaming is set (see ViewerData::stream_vertices)
+  bool streaming = false;
+  StreamingBuffer stream_V;
+  StreamingBuffer stream_V_normals;
+
+  // Upload normals packed to GL_INT_2_10_10_10_REV, colors as RGBA8,
+  // materials that are constant over the mesh as generic attribute values
+  // instead of arrays and indices as 16 bit integers if #V allows it (see
+  // ViewerData::compact_vertices). The CPU side copies stay in float.
+  bool compact = false;
+  // Whether the ambient/diffuse/specular material is passed as the constant
+  // in the corresponding row of material_values (compact only)
+  bool material_constant[3];
+  Eigen::Matrix<float,3,4,Eigen::RowMajor> material_values;
+  // Attribute locations of Ka, Kd and Ks in shader_mesh, resolved by init()
+  int material_locations[3];
+  // Type of the indices in vbo_F (GL_UNSIGNED_INT or GL_UNSIGNED_SHORT)
+  GLuint index_type;
+
   // Temporary copy of the content of each VBO
   typedef Eigen::Matrix<float,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> RowMatrixXf;
   RowMatrixXf V_vbo;
@@ -86,6 +117,15 @@ public:
   GLint tex_filter;
   GLint tex_wrap;
   Eigen::Matrix<char,Eigen::Dynamic,1> tex;
+  // Build the mip chain of tex, store it block compressed and upload
+  // textures of at least tex_stream_texels texels over several frames,
+  // tex_stream_budget bytes per bind_mesh (see
+  // ViewerData::mipmap_texture, compress_texture and stream_texture_texels)
+  bool tex_mipmaps = false;
+  BlockCompressionType tex_compression = BLOCK_COMPRESSION_TYPE_NONE;
+  int tex_stream_texels = 0;
+  std::size_t tex_stream_budget = 8 << 20;
+  TextureStream tex_stream;
 
   Eigen::Matrix<unsigned, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> F_vbo;
   Eigen::Matrix<unsigned, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> lines_F_vbo;
@@ -94,6 +134,39 @@ public:
   // Marks dirty buffers that need to be uploaded to OpenGL
   uint32_t dirty;
 
+  // Rows of the per-vertex buffers to upload with glBufferSubData, keyed by
+  // DirtyFlags (only for attributes whose bit is not set in dirty)
+  std::map<uint32_t, std::vector<int> > dirty_rows;
+
+  // Uniform locations of shader_mesh, resolved once by init()
+  struct MeshUniforms
+  {
+    int view;
+    int proj;
+    int normal_matrix;
+    int stereo;
+    int stereo_view;
+    int stereo_proj;
+    int stereo_normal_matrix;
+    int specular_exponent;
+    int light_position_eye;
+    int lighting_factor;
+    int fixed_color;
+    int texture_factor;
+    int matcap_factor;
+    int double_sided;
+  } uniforms_mesh;
+
+  // Uniform locations of shader_overlay_lines/shader_overlay_points
+  struct OverlayUniforms
+  {
+    int view;
+    int proj;
+    int stereo;
+    int stereo_view;
+    int stereo_proj;
+  } uniforms_overlay_lines, uniforms_overlay_points;
+
   IGL_INLINE MeshGL();
 
   // Initialize shaders and buffers
@@ -108,20 +181,33 @@ public:
   // Bind the underlying OpenGL buffer objects for subsequent mesh draw calls
   IGL_INLINE void bind_mesh();
 
+  // Wait for pending fills of stream_V/stream_V_normals and unmap them
+  IGL_INLINE void finish_streams();
+
   /// Draw the currently buffered mesh (either solid or wireframe)
-  IGL_INLINE void draw_mesh(bool solid);
+  ///
+  /// instances > 1 issues an instanced draw (e.g., 2 for single-pass stereo,
+  /// see the `stereo` uniform of the shaders)
+  IGL_INLINE void draw_mesh(bool solid, int instances = 1);
 
   // Bind the underlying OpenGL buffer objects for subsequent line overlay draw calls
   IGL_INLINE void bind_overlay_lines();
 
   /// Draw the currently buffered line overlay
-  IGL_INLINE void draw_overlay_lines();
+  IGL_INLINE void draw_overlay_lines(int instances = 1);
 
   // Bind the underlying OpenGL buffer objects for subsequent point overlay draw calls
   IGL_INLINE void bind_overlay_points();
 
   /// Draw the currently buffered point overlay
-  IGL_INLINE void draw_overlay_points();
+  IGL_INLINE void draw_overlay_points(int instances = 1);
+
+  // Bind the bounding box box with shader_overlay_lines for an occlusion
+  // query (see ViewerCore::occlusion_culling)
+  IGL_INLINE void bind_bounds(const Eigen::AlignedBox3d & box);
+
+  /// Draw the bounding box as triangles
+  IGL_INLINE void draw_bounds(int instances = 1);
 
   // Release the OpenGL buffer objects
   IGL_INLINE void free_buffers();
@@ -0,0 +1,196 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "StreamingBuffer.h"
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace igl
+{
+namespace opengl
+{
+  namespace StreamingBuffer_detail
+  {
+    // Threads shared by all streaming buffers, started on first use and
+    // joined at exit. Creating a thread per fill costs more than most fills.
+    class Workers
+    {
+    public:
+      Workers(): m_stop(false)
+      {
+        // Leave a core to the render thread
+        const unsigned n = std::max(2u, std::thread::hardware_concurrency()) - 1;
+        for (unsigned i = 0; i < n; ++i)
+          m_threads.emplace_back([this]{ run(); });
+      }
+      ~Workers()
+      {
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          m_stop = true;
+        }
+        m_wake.notify_all();
+        for (std::thread & t : m_threads)
+          t.join();
+      }
+      std::shared_future<void> post(const std::function<void()> & job)
+      {
+        std::packaged_task<void()> task(job);
+        std::shared_future<void> done = task.get_future().share();
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          m_jobs.push_back(std::move(task));
+        }
+        m_wake.notify_one();
+        return done;
+      }
+    private:
+      void run()
+      {
+        for (;;)
+        {
+          std::packaged_task<void()> task;
+          {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]{ return m_stop || !m_jobs.empty(); });
+            if (m_jobs.empty())
+              return;
+            task = std::move(m_jobs.front());
+            m_jobs.pop_front();
+          }
+          // Exceptions are stored in the future
+          task();
+        }
+      }
+      std::vector<std::thread> m_threads;
+      std::deque<std::packaged_task<void()> > m_jobs;
+      std::mutex m_mutex;
+      std::condition_variable m_wake;
+      bool m_stop;
+    };
+
+    inline Workers & workers()
+    {
+      static Workers w;
+      return w;
+    }
+  }
+}
+}
+
+IGL_INLINE igl::opengl::StreamingBuffer::StreamingBuffer():
+  rows(0),
+  cols(0),
+  m_current(0),
+  m_mapped(false)
+{
+  for (int i = 0; i < RING_SIZE; ++i)
+  {
+    m_buffers[i] = 0;
+    m_fences[i] = 0;
+    m_capacity[i] = 0;
+  }
+}
+
+IGL_INLINE void igl::opengl::StreamingBuffer::init()
+{
+  glGenBuffers(RING_SIZE, m_buffers);
+}
+
+IGL_INLINE void igl::opengl::StreamingBuffer::free()
+{
+  unmap();
+  for (int i = 0; i < RING_SIZE; ++i)
+  {
+    if (m_fences[i])
+      glDeleteSync(m_fences[i]);
+    m_fences[i] = 0;
+    m_capacity[i] = 0;
+  }
+  glDeleteBuffers(RING_SIZE, m_buffers);
+  rows = cols = 0;
+}
+
+IGL_INLINE float * igl::opengl::StreamingBuffer::map(int _rows, int _cols)
+{
+  assert(!m_mapped && "unmap() the previous data first");
+  m_current = (m_current + 1) % RING_SIZE;
+
+  // Only blocks if the GPU lags RING_SIZE-1 updates behind
+  GLsync & fence = m_fences[m_current];
+  if (fence)
+  {
+    GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    while (status == GL_TIMEOUT_EXPIRED)
+      status = glClientWaitSync(fence, 0, 1000000);
+    glDeleteSync(fence);
+    fence = 0;
+  }
+
+  rows = _rows;
+  cols = _cols;
+  const std::size_t size = sizeof(float) * rows * cols;
+  glBindBuffer(GL_ARRAY_BUFFER, m_buffers[m_current]);
+  if (m_capacity[m_current] < size)
+  {
+    glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+    m_capacity[m_current] = size;
+  }
+  if (size == 0)
+    return NULL;
+
+  // The fence above guarantees that the GPU is done with this buffer
+  void * ptr = glMapBufferRange(GL_ARRAY_BUFFER, 0, size,
+    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+  m_mapped = ptr != NULL;
+  return static_cast<float *>(ptr);
+}
+
+IGL_INLINE void igl::opengl::StreamingBuffer::fill(const std::function<void()> & job)
+{
+  assert(m_mapped);
+  m_job = StreamingBuffer_detail::workers().post(job);
+}
+
+IGL_INLINE void igl::opengl::StreamingBuffer::unmap()
+{
+  std::shared_future<void> job;
+  std::swap(job, m_job);
+  if (job.valid())
+    job.wait();
+  if (m_mapped)
+  {
+    glBindBuffer(GL_ARRAY_BUFFER, m_buffers[m_current]);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    m_mapped = false;
+  }
+  // Rethrow exceptions of the fill
+  if (job.valid())
+    job.get();
+}
+
+IGL_INLINE void igl::opengl::StreamingBuffer::fence()
+{
+  GLsync & fence = m_fences[m_current];
+  if (fence)
+    glDeleteSync(fence);
+  fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+IGL_INLINE GLuint igl::opengl::StreamingBuffer::buffer() const
+{
+  return m_buffers[m_current];
+}
+
+IGL_INLINE bool igl::opengl::StreamingBuffer::is_mapped() const
+{
+  return m_mapped;
+}
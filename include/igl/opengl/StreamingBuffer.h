@@ -0,0 +1,90 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_OPENGL_STREAMINGBUFFER_H
+#define IGL_OPENGL_STREAMINGBUFFER_H
+#include "../igl_inline.h"
+#include "gl.h"
+#include <cstddef>
+#include <functional>
+#include <future>
+
+namespace igl
+{
+namespace opengl
+{
+  // Ring of vertex buffers for attributes that change every frame.
+  //
+  // Each update writes into the next buffer of the ring through an
+  // unsynchronized mapping, so the upload never waits for the GPU to finish
+  // reading the buffer of the previous frame. A fence inserted after the draw
+  // calls keeps a buffer from being overwritten before the GPU is done with
+  // it. The mapped memory is filled by a pool of worker threads shared by all
+  // streaming buffers while the render thread carries on.
+  //
+  // All member functions except the fill itself must be called from the
+  // thread owning the OpenGL context.
+  //
+  // Example:
+  //   float * dst = stream.map(V.rows(), 3);
+  //   stream.fill([&V,dst]{ Eigen::Map<RowMatrixXf>(dst,V.rows(),3) = V.cast<float>(); });
+  //   ...
+  //   stream.unmap();  // waits for the fill
+  //   glBindBuffer(GL_ARRAY_BUFFER, stream.buffer());
+  //   ... draw ...
+  //   stream.fence();
+  class StreamingBuffer
+  {
+  public:
+    // Number of buffers in the ring (one written by the CPU, one possibly
+    // still read by the GPU, one of slack for drivers queuing frames)
+    enum { RING_SIZE = 3 };
+
+    IGL_INLINE StreamingBuffer();
+
+    // Create/release the OpenGL buffers
+    IGL_INLINE void init();
+    IGL_INLINE void free();
+
+    // Advance to the next buffer of the ring and map it for writing
+    //
+    // Inputs:
+    //   rows  number of vertices
+    //   cols  number of floats per vertex
+    // Returns pointer to rows*cols floats, valid until unmap()
+    IGL_INLINE float * map(int rows, int cols);
+    // Queue job for the worker threads, it must only write the mapped memory
+    IGL_INLINE void fill(const std::function<void()> & job);
+    // Wait for the fill and unmap, buffer() may then be used for drawing.
+    // Does nothing if the buffer is not mapped.
+    IGL_INLINE void unmap();
+    // Mark the current buffer as in use by the draw calls issued so far
+    IGL_INLINE void fence();
+
+    // Buffer holding the most recent data
+    IGL_INLINE GLuint buffer() const;
+    IGL_INLINE bool is_mapped() const;
+
+    // Layout of the most recent data
+    int rows;
+    int cols;
+
+  private:
+    GLuint m_buffers[RING_SIZE];
+    GLsync m_fences[RING_SIZE];
+    std::size_t m_capacity[RING_SIZE];
+    int m_current;
+    bool m_mapped;
+    // Shared so that copies of the owning MeshGL stay copyable
+    std::shared_future<void> m_job;
+  };
+}
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "StreamingBuffer.cpp"
+#endif
+
+#endif
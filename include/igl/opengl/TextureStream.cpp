@@ -0,0 +1,296 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "TextureStream.h"
+#include "GLStateTracker.h"
+#include "../rgba_mipmaps.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+
+// Not part of the OpenGL 3.3 core profile
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#  define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#  define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
+IGL_INLINE igl::opengl::TextureStream::TextureStream():
+  m_pbo(0),
+  m_texture(0),
+  m_swapped(false),
+  m_filter(GL_LINEAR),
+  m_wrap(GL_REPEAT),
+  m_level(-1),
+  m_copied(0),
+  m_mapped(false),
+  m_ptr(NULL)
+{
+}
+
+IGL_INLINE void igl::opengl::TextureStream::init()
+{
+  glGenBuffers(1, &m_pbo);
+}
+
+IGL_INLINE void igl::opengl::TextureStream::free()
+{
+  cancel();
+  if (m_pbo)
+    glDeleteBuffers(1, &m_pbo);
+  m_pbo = 0;
+}
+
+IGL_INLINE void igl::opengl::TextureStream::cancel()
+{
+  if (m_mapped)
+  {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pbo);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    m_mapped = false;
+  }
+  if (m_texture && !m_swapped)
+  {
+    gl_state().forget_texture(m_texture);
+    glDeleteTextures(1, &m_texture);
+  }
+  m_texture = 0;
+  m_swapped = false;
+  m_job = std::shared_future<std::shared_ptr<Levels> >();
+  m_levels.reset();
+  m_level = -1;
+  m_copied = 0;
+}
+
+IGL_INLINE std::shared_ptr<igl::opengl::TextureStream::Levels>
+igl::opengl::TextureStream::prepare(
+  int width,
+  int height,
+  std::vector<unsigned char> & rgba,
+  bool mipmaps,
+  BlockCompressionType compression)
+{
+  std::shared_ptr<Levels> levels = std::make_shared<Levels>();
+  levels->compression = compression;
+  std::vector<std::vector<unsigned char> > mips;
+  if (mipmaps)
+    igl::rgba_mipmaps(width, height, rgba.data(), mips);
+  levels->data.resize(mips.size() + 1);
+  for (size_t l = 0; l < levels->data.size(); ++l)
+  {
+    const int w = std::max(width >> l, 1);
+    const int h = std::max(height >> l, 1);
+    std::vector<unsigned char> & src = l == 0 ? rgba : mips[l - 1];
+    levels->widths.push_back(w);
+    levels->heights.push_back(h);
+    if (compression == BLOCK_COMPRESSION_TYPE_NONE)
+      levels->data[l].swap(src);
+    else
+      igl::block_compress(w, h, src.data(), compression, levels->data[l]);
+  }
+  return levels;
+}
+
+IGL_INLINE void igl::opengl::TextureStream::start(
+  int width,
+  int height,
+  const unsigned char * rgba,
+  GLint filter,
+  GLint wrap,
+  bool mipmaps,
+  BlockCompressionType compression,
+  bool async)
+{
+  cancel();
+
+  m_filter = filter;
+  m_wrap = wrap;
+  if (!is_supported(compression))
+    compression = BLOCK_COMPRESSION_TYPE_NONE;
+  std::shared_ptr<std::vector<unsigned char> > image =
+    std::make_shared<std::vector<unsigned char> >(rgba, rgba + std::size_t(width) * height * 4);
+  if (!async)
+  {
+    m_levels = prepare(width, height, *image, mipmaps, compression);
+    m_level = int(m_levels->data.size()) - 1;
+    return;
+  }
+
+  typedef std::shared_ptr<Levels> LevelsPtr;
+  std::shared_ptr<std::promise<LevelsPtr> > promise =
+    std::make_shared<std::promise<LevelsPtr> >();
+  m_job = promise->get_future().share();
+  // A detached thread: unlike std::async, a dropped upload does not block
+  // until its levels are done
+  std::thread([image, promise, width, height, mipmaps, compression]()
+  {
+    try
+    {
+      promise->set_value(prepare(width, height, *image, mipmaps, compression));
+    }
+    catch (const std::exception & e)
+    {
+      std::cerr << "ERROR (TextureStream): " << e.what() << std::endl;
+      promise->set_value(LevelsPtr());
+    }
+  }).detach();
+}
+
+IGL_INLINE std::size_t igl::opengl::TextureStream::upload(
+  std::size_t budget,
+  GLuint & texture)
+{
+  const std::vector<unsigned char> & data = m_levels->data[m_level];
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pbo);
+  if (m_copied == 0)
+  {
+    // Orphan the storage still read by the previous level's upload
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, data.size(), NULL, GL_STREAM_DRAW);
+    m_ptr = static_cast<unsigned char *>(glMapBufferRange(
+      GL_PIXEL_UNPACK_BUFFER, 0, data.size(),
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    m_mapped = m_ptr != NULL;
+  }
+  const std::size_t n = std::min(budget, data.size() - m_copied);
+  if (m_mapped)
+  {
+    std::memcpy(m_ptr + m_copied, data.data() + m_copied, n);
+  }
+  m_copied += n;
+  if (m_copied == data.size())
+  {
+    // Without a mapping, upload from client memory
+    const void * pixels = data.data();
+    if (m_mapped)
+    {
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      m_mapped = false;
+      pixels = NULL;
+    }
+    else
+    {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    GLStateTracker & state = gl_state();
+    if (!m_texture)
+    {
+      glGenTextures(1, &m_texture);
+      state.bind_texture_2d(m_texture);
+      const bool mipmaps = m_levels->data.size() > 1;
+      state.tex_parameter_2d(GL_TEXTURE_WRAP_S, m_wrap);
+      state.tex_parameter_2d(GL_TEXTURE_WRAP_T, m_wrap);
+      state.tex_parameter_2d(GL_TEXTURE_MIN_FILTER,
+        mipmaps && m_filter == GL_LINEAR ? GL_LINEAR_MIPMAP_LINEAR : m_filter);
+      state.tex_parameter_2d(GL_TEXTURE_MAG_FILTER, m_filter);
+      state.tex_parameter_2d(GL_TEXTURE_MAX_LEVEL, int(m_levels->data.size()) - 1);
+    }
+    state.bind_texture_2d(m_texture);
+    const int w = m_levels->widths[m_level];
+    const int h = m_levels->heights[m_level];
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    switch (m_levels->compression)
+    {
+      case BLOCK_COMPRESSION_TYPE_BC1:
+      case BLOCK_COMPRESSION_TYPE_BC7:
+        glCompressedTexImage2D(GL_TEXTURE_2D, m_level,
+          m_levels->compression == BLOCK_COMPRESSION_TYPE_BC1 ?
+            GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_BPTC_UNORM,
+          w, h, 0, GLsizei(data.size()), pixels);
+        break;
+      default:
+        glTexImage2D(GL_TEXTURE_2D, m_level, GL_RGBA, w, h, 0, GL_RGBA,
+          GL_UNSIGNED_BYTE, pixels);
+    }
+    // Sample the levels uploaded so far
+    state.tex_parameter_2d(GL_TEXTURE_BASE_LEVEL, m_level);
+    if (!m_swapped)
+    {
+      if (texture)
+      {
+        state.forget_texture(texture);
+        glDeleteTextures(1, &texture);
+      }
+      texture = m_texture;
+      m_swapped = true;
+    }
+    m_level--;
+    m_copied = 0;
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  return n;
+}
+
+IGL_INLINE bool igl::opengl::TextureStream::update(
+  GLuint & texture,
+  std::size_t budget)
+{
+  if (!m_levels)
+  {
+    if (!m_job.valid())
+      return true;
+    if (m_job.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+      return false;
+    m_levels = m_job.get();
+    m_job = std::shared_future<std::shared_ptr<Levels> >();
+    if (!m_levels)
+      return true;
+    m_level = int(m_levels->data.size()) - 1;
+  }
+  // A level smaller than the budget left is still uploaded this time
+  while (m_level >= 0 && budget > 0)
+    budget -= upload(budget, texture);
+  if (m_level >= 0)
+    return false;
+  m_levels.reset();
+  return true;
+}
+
+IGL_INLINE void igl::opengl::TextureStream::finish(GLuint & texture)
+{
+  if (m_job.valid())
+    m_job.wait();
+  update(texture, std::numeric_limits<std::size_t>::max());
+}
+
+IGL_INLINE bool igl::opengl::TextureStream::is_streaming() const
+{
+  return m_job.valid() || m_levels;
+}
+
+IGL_INLINE bool igl::opengl::TextureStream::is_supported(
+  BlockCompressionType compression)
+{
+  if (compression == BLOCK_COMPRESSION_TYPE_NONE)
+    return true;
+  // Queried once, the viewer uses a single context
+  static int supported[NUM_BLOCK_COMPRESSION_TYPE] = {1, -1, -1};
+  if (supported[compression] < 0)
+  {
+    GLint major = 0, minor = 0, count = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    supported[BLOCK_COMPRESSION_TYPE_BC1] = 0;
+    supported[BLOCK_COMPRESSION_TYPE_BC7] = major > 4 || (major == 4 && minor >= 2);
+    for (GLint i = 0; i < count; ++i)
+    {
+      const char * name = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+      if (name == NULL)
+        continue;
+      if (std::strcmp(name, "GL_EXT_texture_compression_s3tc") == 0)
+        supported[BLOCK_COMPRESSION_TYPE_BC1] = 1;
+      if (std::strcmp(name, "GL_ARB_texture_compression_bptc") == 0)
+        supported[BLOCK_COMPRESSION_TYPE_BC7] = 1;
+    }
+  }
+  return supported[compression] == 1;
+}
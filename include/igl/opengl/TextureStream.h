@@ -0,0 +1,134 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_OPENGL_TEXTURESTREAM_H
+#define IGL_OPENGL_TEXTURESTREAM_H
+#include "../igl_inline.h"
+#include "../block_compress.h"
+#include "gl.h"
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace igl
+{
+namespace opengl
+{
+  // Upload of an RGBA8 texture with its mip chain spread over several
+  // frames.
+  //
+  // start() hands a copy of the image to a worker thread, which builds the
+  // mip chain (igl::rgba_mipmaps) and block compresses the levels
+  // (igl::block_compress) if asked to. Each update() then copies at most a
+  // budget of bytes into a mapped pixel buffer object and passes every
+  // level completed in it to OpenGL, coarsest level first. The new texture
+  // replaces the one drawn so far as soon as its coarsest level arrived and
+  // sharpens as the finer levels follow, so that a large texture stalls a
+  // frame neither on the CPU work nor on one big glTexImage2D.
+  //
+  // All member functions must be called from the thread owning the OpenGL
+  // context.
+  //
+  // Example:
+  //   stream.start(w,h,rgba,GL_LINEAR,GL_REPEAT,true,BLOCK_COMPRESSION_TYPE_BC7);
+  //   ...
+  //   // every frame
+  //   stream.update(texture,8<<20);
+  //   glBindTexture(GL_TEXTURE_2D,texture);
+  class TextureStream
+  {
+  public:
+    IGL_INLINE TextureStream();
+
+    // Create/release the pixel buffer object (and the texture being
+    // uploaded, unless it replaced the drawn one already)
+    IGL_INLINE void init();
+    IGL_INLINE void free();
+
+    // Start uploading a texture, dropping the upload in progress.
+    //
+    // Inputs:
+    //   width  number of pixels per row
+    //   height  number of rows
+    //   rgba  width*height*4 bytes, row after row (copied)
+    //   filter  GL_LINEAR or GL_NEAREST, minification is trilinear for
+    //     GL_LINEAR if mipmaps is set
+    //   wrap  texture wrap mode
+    //   mipmaps  whether to build and upload the mip chain
+    //   compression  block format, uncompressed if the OpenGL context does
+    //     not support it (see is_supported)
+    //   async  whether to prepare the levels on a worker thread (otherwise
+    //     the levels are prepared before start returns)
+    IGL_INLINE void start(
+      int width,
+      int height,
+      const unsigned char * rgba,
+      GLint filter,
+      GLint wrap,
+      bool mipmaps,
+      BlockCompressionType compression,
+      bool async = true);
+    // Continue the upload.
+    //
+    // Inputs:
+    //   texture  texture drawn so far
+    //   budget  maximum number of bytes to copy
+    // Outputs:
+    //   texture  replaced by (and the previous one deleted for) the uploaded
+    //     texture once its first level arrived
+    // Returns true once the upload is complete (or if there is none)
+    IGL_INLINE bool update(GLuint & texture, std::size_t budget);
+    // Upload everything left, waiting for the worker if needed
+    IGL_INLINE void finish(GLuint & texture);
+    // Drop the upload in progress
+    IGL_INLINE void cancel();
+    // Whether an upload is in progress
+    IGL_INLINE bool is_streaming() const;
+
+    // Whether the current OpenGL context can sample textures of this format
+    IGL_INLINE static bool is_supported(BlockCompressionType compression);
+
+  private:
+    // Image and mip levels prepared by the worker, finest first
+    struct Levels
+    {
+      BlockCompressionType compression;
+      std::vector<int> widths;
+      std::vector<int> heights;
+      std::vector<std::vector<unsigned char> > data;
+    };
+    // Build the levels of a width by height image
+    IGL_INLINE static std::shared_ptr<Levels> prepare(
+      int width,
+      int height,
+      std::vector<unsigned char> & rgba,
+      bool mipmaps,
+      BlockCompressionType compression);
+    // Upload the next (coarser to finer) level of m_levels, copying at
+    // most budget bytes. Returns the number of bytes copied.
+    IGL_INLINE std::size_t upload(std::size_t budget, GLuint & texture);
+
+    GLuint m_pbo;
+    GLuint m_texture;
+    bool m_swapped;
+    GLint m_filter;
+    GLint m_wrap;
+    // Level being copied into the pixel buffer object, and bytes copied
+    int m_level;
+    std::size_t m_copied;
+    bool m_mapped;
+    unsigned char * m_ptr;
+    std::shared_future<std::shared_ptr<Levels> > m_job;
+    std::shared_ptr<Levels> m_levels;
+  };
+}
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "TextureStream.cpp"
+#endif
+
+#endif
@@ -8,6 +8,7 @@
 
 #include "ViewerCore.h"
 #include "ViewerData.h"
+#include "GLStateTracker.h"
 #include "gl.h"
 #include "../quat_to_mat.h"
 #include "../snap_to_fixed_up.h"
@@ -18,6 +19,9 @@
 #include "../barycenter.h"
 #include "../PI.h"
 #include <Eigen/Geometry>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <iostream>
 
 IGL_INLINE void igl::opengl::ViewerCore::align_camera_center(
@@ -115,11 +119,18 @@ IGL_INLINE void igl::opengl::ViewerCore::draw(
   glEnable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+  // Pick up levels of detail built in the background
+  data.update_lods();
+
   /* Bind and potentially refresh mesh/line/point data */
-  if (data.dirty)
+  if (data.dirty || !data.dirty_rows.empty())
   {
+    // V may have been written directly
+    if (data.dirty & MeshGL::DIRTY_POSITION)
+      data.compute_bounds();
     data.updateGL(data, data.invert_normals, data.meshgl);
     data.dirty = MeshGL::DIRTY_NONE;
+    data.dirty_rows.clear();
   }
   data.meshgl.bind_mesh();
 
@@ -158,27 +169,163 @@ IGL_INLINE void igl::opengl::ViewerCore::draw(
     }
   }
 
+  // Both eyes are drawn by a single instanced draw call per mesh
+  const bool stereo = vr && single_pass_stereo;
+  const int instances = stereo ? 2 : 1;
+
+  // Bounding box of everything drawn for this mesh
+  if (data.bounds.isEmpty() && data.V.rows() > 0)
+    data.compute_bounds();
+  Eigen::AlignedBox3d box = data.bounds;
+  if (is_set(data.show_overlay))
+  {
+    const auto extend = [&box](const Eigen::MatrixXd & P, int col)
+    {
+      for (int i = 0; i < P.rows(); ++i)
+        box.extend(P.block<1,3>(i,col).transpose());
+    };
+    extend(data.points, 0);
+    extend(data.lines, 0);
+    extend(data.lines, 3);
+    extend(data.labels_positions, 0);
+  }
+  if (frustum_culling && !box.isEmpty())
+  {
+    // Conservative test: outside if all corners are beyond the same clip
+    // plane
+    const auto outside = [&box](const Eigen::Matrix4f & PV)
+    {
+      int beyond[6] = {0, 0, 0, 0, 0, 0};
+      for (int c = 0; c < 8; ++c)
+      {
+        const Eigen::Vector4f p = PV *
+          box.corner(Eigen::AlignedBox3d::CornerType(c)).cast<float>().homogeneous();
+        for (int k = 0; k < 3; ++k)
+        {
+          beyond[2*k+0] += p(k) < -p(3);
+          beyond[2*k+1] += p(k) > p(3);
+        }
+      }
+      for (int k = 0; k < 6; ++k)
+        if (beyond[k] == 8)
+          return true;
+      return false;
+    };
+    if (stereo ?
+      outside(stereo_proj[0] * stereo_view[0]) && outside(stereo_proj[1] * stereo_view[1]) :
+      outside(proj * view))
+    {
+      return;
+    }
+  }
+
+  if (stereo)
+    glEnable(GL_CLIP_DISTANCE0);
+
+  const auto overlay_uniforms = [&](const MeshGL::OverlayUniforms & o)
+  {
+    glUniformMatrix4fv(o.view, 1, GL_FALSE, view.data());
+    glUniformMatrix4fv(o.proj, 1, GL_FALSE, proj.data());
+    glUniform1i(o.stereo, stereo ? 1 : 0);
+    if (stereo)
+    {
+      glUniformMatrix4fv(o.stereo_view, 2, GL_FALSE, stereo_view[0].data());
+      glUniformMatrix4fv(o.stereo_proj, 2, GL_FALSE, stereo_proj[0].data());
+    }
+  };
+
+  // The query is meaningless if an eye is inside the box: its faces may be
+  // clipped by the near plane
+  const auto contains_eye = [&data](const Eigen::Matrix4f & V)
+  {
+    const Eigen::Vector3f eye = V.inverse().block<3,1>(0,3);
+    return data.bounds.contains(eye.cast<double>());
+  };
+  const bool occlusion_query =
+    occlusion_culling && depth_test && data.V.rows() > 0 &&
+    (is_set(data.show_faces) || is_set(data.show_lines)) &&
+    !(stereo ?
+      contains_eye(stereo_view[0]) || contains_eye(stereo_view[1]) :
+      contains_eye(view));
+  if (occlusion_query)
+  {
+    // Rasterize the box without writing anything and draw the mesh only if
+    // any sample of the box passed the depth test
+    data.meshgl.bind_bounds(data.bounds);
+    overlay_uniforms(data.meshgl.uniforms_overlay_lines);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    glBeginQuery(GL_ANY_SAMPLES_PASSED, data.meshgl.query_bounds);
+    data.meshgl.draw_bounds(instances);
+    glEndQuery(GL_ANY_SAMPLES_PASSED);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+    data.meshgl.bind_mesh();
+    glBeginConditionalRender(data.meshgl.query_bounds, GL_QUERY_WAIT);
+  }
+
+  // Faces and wireframe may come from a simplified mesh
+  MeshGL * meshgl = &data.meshgl;
+  if (level_of_detail && !data.lods.empty() && !data.bounds.isEmpty())
+  {
+    // Diameter in pixels of the bounding sphere, as large as it gets in
+    // either eye
+    const auto screen_size = [&](const Eigen::Matrix4f & V, const Eigen::Matrix4f & P)
+    {
+      const Eigen::Vector3f c = (V * data.bounds.center().cast<float>().homogeneous()).head<3>();
+      const float r = 0.5f * data.bounds.diagonal().norm() * V.block<3,1>(0,0).norm();
+      const bool perspective = P(3,3) == 0;
+      if (perspective && -c(2) <= r)
+        return std::numeric_limits<float>::infinity();
+      return r * P(1,1) * viewport(3) / (perspective ? -c(2) : 1.0f);
+    };
+    const float size = stereo ?
+      std::max(
+        screen_size(stereo_view[0], stereo_proj[0]),
+        screen_size(stereo_view[1], stereo_proj[1])) :
+      screen_size(view, proj);
+    const int levels = data.lods.size();
+    const float s = std::log2(lod_screen_size / size) + 1.0f;
+    int & level = data.lod_level;
+    if (s >= level + 1 + lod_hysteresis || s < level - lod_hysteresis)
+      level = std::max(0, std::min(levels, int(std::floor(s))));
+    if (level > 0)
+    {
+      ViewerData & lod = *data.lods[level - 1];
+      // Options of the mesh apply to its levels of detail
+      lod.compact_vertices = data.compact_vertices;
+      lod.mipmap_texture = data.mipmap_texture;
+      lod.compress_texture = data.compress_texture;
+      lod.stream_texture_texels = data.stream_texture_texels;
+      if (lod.dirty || lod.meshgl.compact != lod.compact_vertices)
+      {
+        data.updateGL(lod, data.invert_normals, lod.meshgl);
+        lod.dirty = MeshGL::DIRTY_NONE;
+      }
+      lod.meshgl.bind_mesh();
+      meshgl = &lod.meshgl;
+    }
+  }
+
   // Send transformations to the GPU
-  GLint viewi  = glGetUniformLocation(data.meshgl.shader_mesh,"view");
-  GLint proji  = glGetUniformLocation(data.meshgl.shader_mesh,"proj");
-  GLint normi  = glGetUniformLocation(data.meshgl.shader_mesh,"normal_matrix");
-  glUniformMatrix4fv(viewi, 1, GL_FALSE, view.data());
-  glUniformMatrix4fv(proji, 1, GL_FALSE, proj.data());
-  glUniformMatrix4fv(normi, 1, GL_FALSE, norm.data());
+  const MeshGL::MeshUniforms & u = meshgl->uniforms_mesh;
+  glUniformMatrix4fv(u.view, 1, GL_FALSE, view.data());
+  glUniformMatrix4fv(u.proj, 1, GL_FALSE, proj.data());
+  glUniformMatrix4fv(u.normal_matrix, 1, GL_FALSE, norm.data());
+  glUniform1i(u.stereo, stereo ? 1 : 0);
+  if (stereo)
+  {
+    // Eigen::Matrix4f has no padding, so the pairs are contiguous mat4[2]
+    glUniformMatrix4fv(u.stereo_view, 2, GL_FALSE, stereo_view[0].data());
+    glUniformMatrix4fv(u.stereo_proj, 2, GL_FALSE, stereo_proj[0].data());
+    glUniformMatrix4fv(u.stereo_normal_matrix, 2, GL_FALSE, stereo_norm[0].data());
+  }
 
   // Light parameters
-  GLint specular_exponenti    = glGetUniformLocation(data.meshgl.shader_mesh,"specular_exponent");
-  GLint light_position_eyei = glGetUniformLocation(data.meshgl.shader_mesh,"light_position_eye");
-  GLint lighting_factori      = glGetUniformLocation(data.meshgl.shader_mesh,"lighting_factor");
-  GLint fixed_colori          = glGetUniformLocation(data.meshgl.shader_mesh,"fixed_color");
-  GLint texture_factori       = glGetUniformLocation(data.meshgl.shader_mesh,"texture_factor");
-  GLint matcap_factori        = glGetUniformLocation(data.meshgl.shader_mesh,"matcap_factor");
-  GLint double_sidedi         = glGetUniformLocation(data.meshgl.shader_mesh,"double_sided");
-
-  glUniform1f(specular_exponenti, data.shininess);
-  glUniform3fv(light_position_eyei, 1, light_position.data());
-  glUniform1f(lighting_factori, lighting_factor); // enables lighting
-  glUniform4f(fixed_colori, 0.0, 0.0, 0.0, 0.0);
+  glUniform1f(u.specular_exponent, data.shininess);
+  glUniform3fv(u.light_position_eye, 1, light_position.data());
+  glUniform1f(u.lighting_factor, lighting_factor); // enables lighting
+  glUniform4f(u.fixed_color, 0.0, 0.0, 0.0, 0.0);
 
   if (data.V.rows()>0)
   {
@@ -186,27 +333,30 @@ IGL_INLINE void igl::opengl::ViewerCore::draw(
     if (is_set(data.show_faces))
     {
       // Texture
-      glUniform1f(texture_factori, is_set(data.show_texture) ? 1.0f : 0.0f);
-      glUniform1f(matcap_factori, is_set(data.use_matcap) ? 1.0f : 0.0f);
-      glUniform1f(double_sidedi, data.double_sided ? 1.0f : 0.0f);
-      data.meshgl.draw_mesh(true);
-      glUniform1f(matcap_factori, 0.0f);
-      glUniform1f(texture_factori, 0.0f);
+      glUniform1f(u.texture_factor, is_set(data.show_texture) ? 1.0f : 0.0f);
+      glUniform1f(u.matcap_factor, is_set(data.use_matcap) ? 1.0f : 0.0f);
+      glUniform1f(u.double_sided, data.double_sided ? 1.0f : 0.0f);
+      meshgl->draw_mesh(true, instances);
+      glUniform1f(u.matcap_factor, 0.0f);
+      glUniform1f(u.texture_factor, 0.0f);
     }
 
     // Render wireframe
     if (is_set(data.show_lines))
     {
       glLineWidth(data.line_width);
-      glUniform4f(fixed_colori,
+      glUniform4f(u.fixed_color,
         data.line_color[0],
         data.line_color[1],
         data.line_color[2], 1.0f);
-      data.meshgl.draw_mesh(false);
-      glUniform4f(fixed_colori, 0.0f, 0.0f, 0.0f, 0.0f);
+      meshgl->draw_mesh(false, instances);
+      glUniform4f(u.fixed_color, 0.0f, 0.0f, 0.0f, 0.0f);
     }
   }
 
+  if (occlusion_query)
+    glEndConditionalRender();
+
   if (is_set(data.show_overlay))
   {
     if (is_set(data.show_overlay_depth))
@@ -217,34 +367,53 @@ IGL_INLINE void igl::opengl::ViewerCore::draw(
     if (data.lines.rows() > 0)
     {
       data.meshgl.bind_overlay_lines();
-      viewi  = glGetUniformLocation(data.meshgl.shader_overlay_lines,"view");
-      proji  = glGetUniformLocation(data.meshgl.shader_overlay_lines,"proj");
-
-      glUniformMatrix4fv(viewi, 1, GL_FALSE, view.data());
-      glUniformMatrix4fv(proji, 1, GL_FALSE, proj.data());
+      overlay_uniforms(data.meshgl.uniforms_overlay_lines);
       // This must be enabled, otherwise glLineWidth has no effect
       glEnable(GL_LINE_SMOOTH);
       glLineWidth(data.line_width);
 
-      data.meshgl.draw_overlay_lines();
+      data.meshgl.draw_overlay_lines(instances);
     }
 
     if (data.points.rows() > 0)
     {
       data.meshgl.bind_overlay_points();
-      viewi  = glGetUniformLocation(data.meshgl.shader_overlay_points,"view");
-      proji  = glGetUniformLocation(data.meshgl.shader_overlay_points,"proj");
-
-      glUniformMatrix4fv(viewi, 1, GL_FALSE, view.data());
-      glUniformMatrix4fv(proji, 1, GL_FALSE, proj.data());
+      overlay_uniforms(data.meshgl.uniforms_overlay_points);
       glPointSize(data.point_size);
 
-      data.meshgl.draw_overlay_points();
+      data.meshgl.draw_overlay_points(instances);
     }
 
     glEnable(GL_DEPTH_TEST);
   }
 
+  if (stereo)
+    glDisable(GL_CLIP_DISTANCE0);
+}
+
+IGL_INLINE std::vector<int> igl::opengl::ViewerCore::draw_order(
+  const std::vector<ViewerData>& data_list) const
+{
+  std::vector<int> order;
+  for (int i = 0; i < (int)data_list.size(); ++i)
+  {
+    if (data_list[i].is_visible & id)
+      order.push_back(i);
+  }
+  if (occlusion_culling)
+  {
+    // Nearby meshes are the likely occluders
+    std::vector<double> distance(data_list.size(), 0);
+    const Eigen::Vector3d eye = view.inverse().block<3,1>(0,3).cast<double>();
+    for (const int i : order)
+    {
+      if (!data_list[i].bounds.isEmpty())
+        distance[i] = (data_list[i].bounds.center() - eye).squaredNorm();
+    }
+    std::stable_sort(order.begin(), order.end(),
+      [&distance](int a, int b) { return distance[a] < distance[b]; });
+  }
+  return order;
 }
 
 IGL_INLINE void igl::opengl::ViewerCore::draw_buffer(ViewerData& data,
@@ -260,6 +429,9 @@ IGL_INLINE void igl::opengl::ViewerCore::draw_buffer(ViewerData& data,
   unsigned width = R.rows();
   unsigned height = R.cols();
 
+  // Might be called outside of Viewer::draw after arbitrary OpenGL calls
+  gl_state().invalidate();
+
   // https://learnopengl.com/Advanced-OpenGL/Anti-Aliasing
   unsigned int framebuffer;
   glGenFramebuffers(1, &framebuffer);
@@ -344,37 +516,97 @@ IGL_INLINE void igl::opengl::ViewerCore::draw_buffer(ViewerData& data,
   free(pixels);
 }
 
+IGL_INLINE void igl::opengl::ViewerCore::update_buffers(
+  std::vector<ViewerData>& data_list)
+{
+  for (auto& data : data_list)
+  {
+    if ((data.is_visible & id) && (data.dirty || !data.dirty_rows.empty()))
+    {
+      if (data.dirty & MeshGL::DIRTY_POSITION)
+        data.compute_bounds();
+      data.updateGL(data, data.invert_normals, data.meshgl);
+      data.dirty = MeshGL::DIRTY_NONE;
+      data.dirty_rows.clear();
+    }
+  }
+}
+
 IGL_INLINE void igl::opengl::ViewerCore::drawVR(
-    ViewerData& data)
+  std::vector<ViewerData>& data_list)
 {
-    VRapp->updatePose();
-    VRapp->handleInput();
-    Eigen::Vector4f viewport_ori = viewport;
-    viewport << 0, 0, VRapp->getHmdWidth() , VRapp->getHmdHeight();
+  // Block on the compositor for this frame's poses and process input once,
+  // regardless of how many meshes are drawn. With late latching the eyes are
+  // drawn with poses queried again right before drawing them.
+  VRapp->updatePose();
+  VRapp->handleInput();
+  Eigen::Vector4f viewport_ori = viewport;
+  viewport << 0, 0, VRapp->getHmdWidth(), VRapp->getHmdHeight();
+
+  VRapp->renderControllerAxes();
 
-    VRapp->renderControllerAxes();
+  // Start all buffer updates before drawing, so that streamed vertices are
+  // converted while other meshes are drawn
+  update_buffers(data_list);
 
+  if (single_pass_stereo)
+  {
+    const int w = VRapp->getHmdWidth();
+    const int h = VRapp->getHmdHeight();
+    // Both eyes are drawn at once, so they share the latest pose
+    VRapp->latchPose();
     for (vr::EVREye eye = vr::EVREye::Eye_Left; eye <= vr::EVREye::Eye_Right; ((int&)eye)++)
     {
-        //camera_translation = VRapp->GetPosition(VRapp->getEyeTransformation(vr::EVREye::Eye_Right));
-        proj = VRapp->getMatrixProjectionEye(eye);
-        //calculates view of eye by multiplying the relative position of eye to head with hmd position
-        view = VRapp->getMatrixPoseEye(eye) * VRapp->getMatrixPoseHmd();
-        norm = view.inverse().transpose();
-
-        VRapp->predraw(eye);
-        draw(data, false);
-        VRapp->drawControllerAxes(view, proj);
-        VRapp->postdraw(eye);
+      stereo_proj[eye] = VRapp->getMatrixProjectionEye(eye);
+      stereo_view[eye] = VRapp->getMatrixPoseEye(eye) * VRapp->getMatrixPoseHmd();
+      stereo_norm[eye] = stereo_view[eye].inverse().transpose();
     }
-    
-       
-    //Updating companion windows
-    viewport = viewport_ori;
-    VRapp->updateCompanionWindow(viewport);
+    // Left eye in the left half, right eye in the right half
+    viewport << 0, 0, 2 * w, h;
 
+    VRapp->predrawStereo();
+    for (const int i : draw_order(data_list))
+    {
+      draw(data_list[i], false);
+    }
+    for (vr::EVREye eye = vr::EVREye::Eye_Left; eye <= vr::EVREye::Eye_Right; ((int&)eye)++)
+    {
+      glViewport(eye * w, 0, w, h);
+      VRapp->drawControllerAxes(stereo_view[eye], stereo_proj[eye]);
+    }
+    VRapp->postdrawStereo();
 
-    VRapp->submitToHMD();
+    // Keep the single eye matrices meaningful for callers (e.g. picking)
+    view = stereo_view[vr::EVREye::Eye_Left];
+    proj = stereo_proj[vr::EVREye::Eye_Left];
+    norm = stereo_norm[vr::EVREye::Eye_Left];
+  }
+  else
+  {
+    for (vr::EVREye eye = vr::EVREye::Eye_Left; eye <= vr::EVREye::Eye_Right; ((int&)eye)++)
+    {
+      VRapp->latchPose(eye);
+      proj = VRapp->getMatrixProjectionEye(eye);
+      // calculates view of eye by multiplying the relative position of eye to
+      // head with hmd position
+      view = VRapp->getMatrixPoseEye(eye) * VRapp->getMatrixPoseHmd();
+      norm = view.inverse().transpose();
+
+      VRapp->predraw(eye);
+      for (const int i : draw_order(data_list))
+      {
+        draw(data_list[i], false);
+      }
+      VRapp->drawControllerAxes(view, proj);
+      VRapp->postdraw(eye);
+    }
+  }
+
+  // Updating companion windows
+  viewport = viewport_ori;
+  VRapp->updateCompanionWindow(viewport);
+
+  VRapp->submitToHMD();
 }
 
 
@@ -443,14 +675,21 @@ IGL_INLINE igl::opengl::ViewerCore::ViewerCore()
   camera_up << 0, 1, 0;
 
   depth_test = true;
+  frustum_culling = true;
+  occlusion_culling = false;
+  level_of_detail = true;
+  lod_screen_size = 400;
+  lod_hysteresis = 0.25f;
 
   is_animating = false;
   animation_max_fps = 30.;
 
   viewport.setZero();
+
+  single_pass_stereo = false;
 }
 
-IGL_INLINE igl::opengl::ViewerCore::ViewerCore(igl::opengl::VRApplication *VRapp)
+IGL_INLINE igl::opengl::ViewerCore::ViewerCore(igl::openvr::VRApplication *VRapp)
 {
     vr = true;
     this->VRapp = VRapp;
@@ -481,11 +720,17 @@ IGL_INLINE igl::opengl::ViewerCore::ViewerCore(igl::opengl::VRApplication *VRapp
     camera_up << 0, 1, 0;
 
     depth_test = true;
+    frustum_culling = true;
+    occlusion_culling = false;
+    level_of_detail = true;
+    lod_screen_size = 400;
+    lod_hysteresis = 0.25f;
 
     is_animating = true;
     animation_max_fps = 120.;
 
     viewport.setZero();
+    single_pass_stereo = false;
     //viewport = Eigen::Vector4f(0, 0, VRapp->getHmdWidth(), VRapp->getHmdWidth());
     VRapp->initGl();
 }
@@ -496,5 +741,8 @@ IGL_INLINE void igl::opengl::ViewerCore::init()
 
 IGL_INLINE void igl::opengl::ViewerCore::shut()
 {
+  if (vr)
+  {
     VRapp->shut();
+  }
 }
@@ -14,6 +14,7 @@
 #include <igl/igl_inline.h>
 #include <Eigen/Geometry>
 #include <Eigen/Core>
+#include <vector>
 
 #include "glfw/Viewer.h"
 
@@ -34,9 +35,9 @@ class ViewerCore
 public:
     bool vr = false;
 
-    VRApplication *VRapp;
+    igl::openvr::VRApplication *VRapp = nullptr;
 
-    IGL_INLINE ViewerCore(VRApplication*);
+    IGL_INLINE ViewerCore(igl::openvr::VRApplication*);
 
   IGL_INLINE ViewerCore();
 
@@ -83,8 +84,32 @@ public:
   // Draw everything
   //
   // data cannot be const because it is being set to "clean"
-  IGL_INLINE void drawVR(ViewerData& data);
   IGL_INLINE void draw(ViewerData& data, bool update_matrices = true);
+
+  // Refresh the buffers of every mesh in data_list visible in this core that
+  // changed since it was last drawn. Streamed vertices (see
+  // ViewerData::stream_vertices) are converted on worker threads until the
+  // mesh is drawn, so calling this before drawing the meshes overlaps the
+  // conversion with the draw calls of the meshes before it.
+  //
+  // Inputs:
+  //   data_list  list of meshes, entries not visible in this core are skipped
+  IGL_INLINE void update_buffers(std::vector<ViewerData>& data_list);
+
+  // Draw one frame of every mesh in data_list visible in this core to both
+  // eyes of the headset. Poses, input, the companion window and the
+  // compositor submission are handled once per call, so this should be
+  // called exactly once per frame (not once per mesh).
+  //
+  // Inputs:
+  //   data_list  list of meshes, entries not visible in this core are skipped
+  IGL_INLINE void drawVR(std::vector<ViewerData>& data_list);
+
+  // Indices of the meshes of data_list visible in this core, in the order
+  // they should be drawn: front to back (by the distance of their bounding
+  // box centers to the eye of the last view matrix) if occlusion_culling is
+  // set, in list order otherwise.
+  IGL_INLINE std::vector<int> draw_order(const std::vector<ViewerData>& data_list) const;
   IGL_INLINE void draw_buffer(
     ViewerData& data,
     bool update_matrices,
@@ -147,6 +172,22 @@ public:
 
   bool depth_test;
 
+  // Skip meshes whose bounding box (ViewerData::bounds, plus overlays) is
+  // outside the view frustum (of both eyes for single-pass stereo)
+  bool frustum_culling;
+  // Draw each mesh under an occlusion query of its bounding box, so that the
+  // GPU skips meshes hidden behind the ones drawn before them. Meshes are
+  // drawn front to back when set.
+  bool occlusion_culling;
+  // Draw the simplified meshes of ViewerData::build_lods for meshes whose
+  // bounding sphere projects to less than lod_screen_size pixels: level k is
+  // used below lod_screen_size/2^(k-1) pixels. The level only changes once
+  // the size crossed a threshold by lod_hysteresis levels, so that it does
+  // not flicker when the size hovers around it.
+  bool level_of_detail;
+  float lod_screen_size;
+  float lod_hysteresis;
+
   // Animation
   bool is_animating;
   double animation_max_fps;
@@ -161,6 +202,14 @@ public:
   Eigen::Matrix4f view;
   Eigen::Matrix4f proj;
   Eigen::Matrix4f norm;
+
+  // Single-pass stereo (VR only): each mesh is bound once and drawn with two
+  // instances into a side-by-side target instead of once per eye. The
+  // per-eye matrices (left, right) are used in place of view/proj/norm.
+  bool single_pass_stereo;
+  Eigen::Matrix4f stereo_view[2];
+  Eigen::Matrix4f stereo_proj[2];
+  Eigen::Matrix4f stereo_norm[2];
   public:
       EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
@@ -198,6 +247,11 @@ namespace igl {
       SERIALIZE_MEMBER(camera_up);
 
       SERIALIZE_MEMBER(depth_test);
+      SERIALIZE_MEMBER(frustum_culling);
+      SERIALIZE_MEMBER(occlusion_culling);
+      SERIALIZE_MEMBER(level_of_detail);
+      SERIALIZE_MEMBER(lod_screen_size);
+      SERIALIZE_MEMBER(lod_hysteresis);
       SERIALIZE_MEMBER(is_animating);
       SERIALIZE_MEMBER(animation_max_fps);
 
@@ -12,20 +12,31 @@
 #include "../per_face_normals.h"
 #include "../material_colors.h"
 #include "../per_vertex_normals.h"
+#include "../per_corner.h"
+#include "../decimate.h"
+#include "../slice.h"
 
 // Really? Just for GL_NEAREST?
 #include "gl.h"
 
+#include <chrono>
 #include <iostream>
+#include <thread>
 
 
 IGL_INLINE igl::opengl::ViewerData::ViewerData()
 : dirty(MeshGL::DIRTY_ALL),
+  lod_level         (0),
   show_faces        (~unsigned(0)),
   show_lines        (~unsigned(0)),
   face_based        (false),
   double_sided      (false),
   invert_normals    (false),
+  stream_vertices   (false),
+  compact_vertices  (false),
+  mipmap_texture    (false),
+  compress_texture  (igl::BLOCK_COMPRESSION_TYPE_NONE),
+  stream_texture_texels(2048*2048),
   show_overlay      (~unsigned(0)),
   show_overlay_depth(~unsigned(0)),
   show_vertid       (false),
@@ -39,7 +50,9 @@ IGL_INLINE igl::opengl::ViewerData::ViewerData()
   label_color(0,0,0.04,1),
   shininess(35.0f),
   id(-1),
-  is_visible        (~unsigned(0))
+  is_visible        (~unsigned(0)),
+  picking_refit     (false),
+  picking_rebuild   (true)
 {
   clear();
 };
@@ -50,6 +63,7 @@ IGL_INLINE void igl::opengl::ViewerData::set_face_based(bool newvalue)
   {
     face_based = newvalue;
     dirty = MeshGL::DIRTY_ALL;
+    discard_lods();
   }
 }
 
@@ -95,6 +109,9 @@ IGL_INLINE void igl::opengl::ViewerData::set_mesh(
       cerr << "ERROR (set_mesh): The new mesh has a different number of vertices/faces. Please clear the mesh before plotting."<<endl;
   }
   dirty |= MeshGL::DIRTY_FACE | MeshGL::DIRTY_POSITION;
+  compute_bounds();
+  discard_lods();
+  picking_rebuild = true;
 }
 
 IGL_INLINE void igl::opengl::ViewerData::set_vertices(const Eigen::MatrixXd& _V)
@@ -102,6 +119,44 @@ IGL_INLINE void igl::opengl::ViewerData::set_vertices(const Eigen::MatrixXd& _V)
   V = _V;
   assert(F.size() == 0 || F.maxCoeff() < V.rows());
   dirty |= MeshGL::DIRTY_POSITION;
+  compute_bounds();
+  discard_lods();
+  picking_refit = true;
+}
+
+IGL_INLINE void igl::opengl::ViewerData::set_vertices(
+  const Eigen::MatrixXd& _V,
+  const Eigen::VectorXi& changed_rows)
+{
+  if (_V.rows() != V.rows() || _V.cols() != V.cols())
+    return set_vertices(_V);
+
+  std::vector<int> & rows = dirty_rows[MeshGL::DIRTY_POSITION];
+  for (int k = 0; k < changed_rows.size(); ++k)
+  {
+    const int i = changed_rows(k);
+    assert(i >= 0 && i < V.rows());
+    V.row(i) = _V.row(i);
+    rows.push_back(i);
+    if (V.cols() == 3)
+      bounds.extend(V.row(i).transpose());
+  }
+  discard_lods();
+  picking_refit = true;
+}
+
+IGL_INLINE void igl::opengl::ViewerData::compute_bounds()
+{
+  bounds.setEmpty();
+  if (V.rows() == 0)
+    return;
+  // 2D vertices are drawn with z = 0
+  const int dim = std::min<int>(V.cols(), 3);
+  Eigen::Vector3d min = Eigen::Vector3d::Zero();
+  Eigen::Vector3d max = Eigen::Vector3d::Zero();
+  min.head(dim) = V.leftCols(dim).colwise().minCoeff().transpose();
+  max.head(dim) = V.leftCols(dim).colwise().maxCoeff().transpose();
+  bounds = Eigen::AlignedBox3d(min, max);
 }
 
 IGL_INLINE void igl::opengl::ViewerData::set_normals(const Eigen::MatrixXd& N)
@@ -222,7 +277,38 @@ IGL_INLINE void igl::opengl::ViewerData::set_colors(const Eigen::MatrixXd &C)
   else
     cerr << "ERROR (set_colors): Please provide a single color, or a color per face or per vertex."<<endl;
   dirty |= MeshGL::DIRTY_DIFFUSE | MeshGL::DIRTY_SPECULAR | MeshGL::DIRTY_AMBIENT;
+  discard_lods();
+
+}
+
+IGL_INLINE void igl::opengl::ViewerData::set_colors(
+  const Eigen::MatrixXd &C,
+  const Eigen::VectorXi &changed_rows)
+{
+  if (face_based || C.rows() != V.rows() || V_material_diffuse.rows() != V.rows() ||
+    !(C.cols() == 3 || C.cols() == 4))
+    return set_colors(C);
 
+  // Same material derivation as set_colors(C)
+  const double grey = 0.3;
+  for (int k = 0; k < changed_rows.size(); ++k)
+  {
+    const int i = changed_rows(k);
+    assert(i >= 0 && i < V.rows());
+    if (C.cols() == 3)
+      V_material_diffuse.row(i) << C.row(i), 1;
+    else
+      V_material_diffuse.row(i) << C.row(i);
+    V_material_ambient.row(i) << 0.1*V_material_diffuse.row(i).head<3>(), V_material_diffuse(i,3);
+    V_material_specular.row(i) <<
+      (grey+0.1*(V_material_diffuse.row(i).head<3>().array()-grey)).matrix(), V_material_diffuse(i,3);
+  }
+  for (const uint32_t flag : {MeshGL::DIRTY_AMBIENT, MeshGL::DIRTY_DIFFUSE, MeshGL::DIRTY_SPECULAR})
+  {
+    std::vector<int> & rows = dirty_rows[flag];
+    rows.insert(rows.end(), changed_rows.data(), changed_rows.data() + changed_rows.size());
+  }
+  discard_lods();
 }
 
 IGL_INLINE void igl::opengl::ViewerData::set_uv(const Eigen::MatrixXd& UV)
@@ -236,6 +322,7 @@ IGL_INLINE void igl::opengl::ViewerData::set_uv(const Eigen::MatrixXd& UV)
   else
     cerr << "ERROR (set_UV): Please provide uv per vertex."<<endl;;
   dirty |= MeshGL::DIRTY_UV;
+  discard_lods();
 }
 
 IGL_INLINE void igl::opengl::ViewerData::set_uv(const Eigen::MatrixXd& UV_V, const Eigen::MatrixXi& UV_F)
@@ -244,6 +331,7 @@ IGL_INLINE void igl::opengl::ViewerData::set_uv(const Eigen::MatrixXd& UV_V, con
   V_uv = UV_V.block(0,0,UV_V.rows(),2);
   F_uv = UV_F;
   dirty |= MeshGL::DIRTY_UV;
+  discard_lods();
 }
 
 IGL_INLINE void igl::opengl::ViewerData::set_texture(
@@ -456,6 +544,10 @@ IGL_INLINE void igl::opengl::ViewerData::clear()
   points                  = Eigen::MatrixXd (0,6);
   labels_positions        = Eigen::MatrixXd (0,3);
   labels_strings.clear();
+  dirty_rows.clear();
+  bounds.setEmpty();
+  discard_lods();
+  picking_rebuild = true;
 
   face_based = false;
   double_sided = false;
@@ -464,6 +556,171 @@ IGL_INLINE void igl::opengl::ViewerData::clear()
   use_matcap = false;
 }
 
+IGL_INLINE void igl::opengl::ViewerData::build_lods(int levels, double ratio)
+{
+  discard_lods();
+  if (levels <= 0 || F.rows() == 0)
+    return;
+
+  // The worker only sees its own copy of the mesh
+  std::shared_ptr<ViewerData> src = std::make_shared<ViewerData>();
+  src->V = V;
+  src->F = F;
+  src->face_based = face_based;
+  if (face_based)
+  {
+    src->F_material_ambient = F_material_ambient;
+    src->F_material_diffuse = F_material_diffuse;
+    src->F_material_specular = F_material_specular;
+  }
+  else
+  {
+    src->V_material_ambient = V_material_ambient;
+    src->V_material_diffuse = V_material_diffuse;
+    src->V_material_specular = V_material_specular;
+  }
+  // Per-corner UVs can not be carried over to the collapsed faces
+  if (V_uv.rows() == V.rows() && F_uv.rows() == 0)
+    src->V_uv = V_uv;
+  src->texture_R = texture_R;
+  src->texture_G = texture_G;
+  src->texture_B = texture_B;
+  src->texture_A = texture_A;
+
+  typedef std::vector<std::shared_ptr<ViewerData> > LodList;
+  std::shared_ptr<std::promise<LodList> > promise =
+    std::make_shared<std::promise<LodList> >();
+  lod_job = promise->get_future().share();
+
+  // A detached thread: unlike std::async, a discarded build does not block
+  // until it finished
+  std::thread([src, promise, levels, ratio]()
+  {
+    LodList lods;
+    try
+    {
+      // Each level simplifies the previous one, J and I map back to the
+      // faces and vertices of the full mesh
+      Eigen::MatrixXd U = src->V;
+      Eigen::MatrixXi G = src->F;
+      Eigen::VectorXi J = Eigen::VectorXi::LinSpaced(G.rows(), 0, G.rows()-1);
+      Eigen::VectorXi I = Eigen::VectorXi::LinSpaced(U.rows(), 0, U.rows()-1);
+      for (int level = 0; level < levels; ++level)
+      {
+        const size_t max_m = size_t(ratio * G.rows());
+        if (max_m < 4)
+          break;
+        Eigen::MatrixXd U_l;
+        Eigen::MatrixXi G_l;
+        Eigen::VectorXi J_l, I_l;
+        igl::decimate(U, G, max_m, U_l, G_l, J_l, I_l);
+        // Stop once collapses get stuck (e.g. on non-manifold parts)
+        if (G_l.rows() == 0 || G_l.rows() > 0.9 * G.rows())
+          break;
+        U = U_l;
+        G = G_l;
+        J = igl::slice(J, J_l);
+        I = igl::slice(I, I_l);
+
+        std::shared_ptr<ViewerData> lod = std::make_shared<ViewerData>();
+        lod->set_mesh(U, G);
+        lod->face_based = src->face_based;
+        if (src->face_based)
+        {
+          if (src->F_material_diffuse.rows() == src->F.rows())
+          {
+            igl::slice(src->F_material_ambient, J, 1, lod->F_material_ambient);
+            igl::slice(src->F_material_diffuse, J, 1, lod->F_material_diffuse);
+            igl::slice(src->F_material_specular, J, 1, lod->F_material_specular);
+          }
+        }
+        else if (src->V_material_diffuse.rows() == src->V.rows())
+        {
+          igl::slice(src->V_material_ambient, I, 1, lod->V_material_ambient);
+          igl::slice(src->V_material_diffuse, I, 1, lod->V_material_diffuse);
+          igl::slice(src->V_material_specular, I, 1, lod->V_material_specular);
+        }
+        if (src->V_uv.rows() == src->V.rows())
+          igl::slice(src->V_uv, I, 1, lod->V_uv);
+        lod->texture_R = src->texture_R;
+        lod->texture_G = src->texture_G;
+        lod->texture_B = src->texture_B;
+        lod->texture_A = src->texture_A;
+        lod->dirty = MeshGL::DIRTY_ALL;
+        lods.push_back(lod);
+      }
+    }
+    catch (const std::exception & e)
+    {
+      std::cerr << "ERROR (build_lods): " << e.what() << std::endl;
+    }
+    // Keep whatever levels were finished
+    promise->set_value(lods);
+  }).detach();
+}
+
+IGL_INLINE void igl::opengl::ViewerData::update_lods()
+{
+  for (auto & lod : lods_discarded)
+    lod->meshgl.free();
+  lods_discarded.clear();
+
+  if (lod_job.valid() &&
+    lod_job.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+  {
+    lods = lod_job.get();
+    lod_job = std::shared_future<std::vector<std::shared_ptr<ViewerData> > >();
+    lod_level = 0;
+  }
+
+  // Normals are inverted while uploading and textures are not simplified
+  const uint32_t shared = dirty & (MeshGL::DIRTY_NORMAL | MeshGL::DIRTY_TEXTURE);
+  if (shared)
+  {
+    for (auto & lod : lods)
+    {
+      if (dirty & MeshGL::DIRTY_TEXTURE)
+      {
+        lod->texture_R = texture_R;
+        lod->texture_G = texture_G;
+        lod->texture_B = texture_B;
+        lod->texture_A = texture_A;
+      }
+      lod->dirty |= shared;
+    }
+  }
+}
+
+IGL_INLINE void igl::opengl::ViewerData::free_lods()
+{
+  discard_lods();
+  update_lods();
+}
+
+IGL_INLINE const igl::FlatAABB<Eigen::MatrixXd,3> &
+igl::opengl::ViewerData::picking_tree()
+{
+  if (picking_rebuild)
+  {
+    picking_aabb.init(V, F);
+  }
+  else if (picking_refit)
+  {
+    picking_aabb.refit(V, F);
+  }
+  picking_rebuild = false;
+  picking_refit = false;
+  return picking_aabb;
+}
+
+IGL_INLINE void igl::opengl::ViewerData::discard_lods()
+{
+  lods_discarded.insert(lods_discarded.end(), lods.begin(), lods.end());
+  lods.clear();
+  lod_job = std::shared_future<std::vector<std::shared_ptr<ViewerData> > >();
+  lod_level = 0;
+}
+
 IGL_INLINE void igl::opengl::ViewerData::compute_normals()
 {
   igl::per_face_normals(V, F, F_normals);
@@ -578,183 +835,187 @@ IGL_INLINE void igl::opengl::ViewerData::updateGL(
 
   meshgl.dirty |= data.dirty;
 
-  // Input:
-  //   X  #F by dim quantity
-  // Output:
-  //   X_vbo  #F*3 by dim scattering per corner
-  const auto per_face = [&data](
-      const Eigen::MatrixXd & X,
-      MeshGL::RowMatrixXf & X_vbo)
-  {
-    assert(X.cols() == 4);
-    X_vbo.resize(data.F.rows()*3,4);
-    for (unsigned i=0; i<data.F.rows();++i)
-      for (unsigned j=0;j<3;++j)
-        X_vbo.row(i*3+j) = X.row(i).cast<float>();
-  };
+  // Attributes are either stored per vertex and indexed by F, or expanded to
+  // one row per corner (face_based, per-corner normals or UVs)
+  const bool per_vertex_layout =
+    !data.face_based && !(per_corner_uv || per_corner_normals);
 
-  // Input:
-  //   X  #V by dim quantity
-  // Output:
-  //   X_vbo  #F*3 by dim scattering per corner
-  const auto per_corner = [&data](
-      const Eigen::MatrixXd & X,
-      MeshGL::RowMatrixXf & X_vbo)
-  {
-    X_vbo.resize(data.F.rows()*3,X.cols());
-    for (unsigned i=0; i<data.F.rows();++i)
-      for (unsigned j=0;j<3;++j)
-        X_vbo.row(i*3+j) = X.row(data.F(i,j)).cast<float>();
-  };
+  if (data.stream_vertices != meshgl.streaming)
+  {
+    // Switch the attributes to the other set of buffers
+    meshgl.streaming = data.stream_vertices;
+    meshgl.dirty |= MeshGL::DIRTY_POSITION | MeshGL::DIRTY_NORMAL;
+  }
+  if (data.compact_vertices != meshgl.compact)
+  {
+    // Re-upload everything stored in a different format
+    meshgl.compact = data.compact_vertices;
+    meshgl.dirty |= MeshGL::DIRTY_NORMAL | MeshGL::DIRTY_AMBIENT |
+      MeshGL::DIRTY_DIFFUSE | MeshGL::DIRTY_SPECULAR | MeshGL::DIRTY_FACE;
+  }
 
-  if (!data.face_based)
+  // Changed rows of already uploaded per-vertex buffers are patched in
+  // place, anything else falls back to a full update of the attribute
+  for (const auto & entry : data.dirty_rows)
+  {
+    if (meshgl.dirty & entry.first)
+      continue;
+    std::vector<int> & rows = meshgl.dirty_rows[entry.first];
+    rows.insert(rows.end(), entry.second.begin(), entry.second.end());
+  }
+  for (auto it = meshgl.dirty_rows.begin(); it != meshgl.dirty_rows.end();)
   {
-    if (!(per_corner_uv || per_corner_normals))
+    const uint32_t flag = it->first;
+    const Eigen::MatrixXd * X = nullptr;
+    MeshGL::RowMatrixXf * X_vbo = nullptr;
+    switch (flag)
     {
-      // Vertex positions
-      if (meshgl.dirty & MeshGL::DIRTY_POSITION)
-        meshgl.V_vbo = data.V.cast<float>();
-
-      // Vertex normals
-      if (meshgl.dirty & MeshGL::DIRTY_NORMAL)
-      {
-        meshgl.V_normals_vbo = data.V_normals.cast<float>();
-        if (invert_normals)
-          meshgl.V_normals_vbo = -meshgl.V_normals_vbo;
-      }
-
-      // Per-vertex material settings
-      if (meshgl.dirty & MeshGL::DIRTY_AMBIENT)
-        meshgl.V_ambient_vbo = data.V_material_ambient.cast<float>();
-      if (meshgl.dirty & MeshGL::DIRTY_DIFFUSE)
-        meshgl.V_diffuse_vbo = data.V_material_diffuse.cast<float>();
-      if (meshgl.dirty & MeshGL::DIRTY_SPECULAR)
-        meshgl.V_specular_vbo = data.V_material_specular.cast<float>();
-
-      // Face indices
-      if (meshgl.dirty & MeshGL::DIRTY_FACE)
-        meshgl.F_vbo = data.F.cast<unsigned>();
-
-      // Texture coordinates
-      if (meshgl.dirty & MeshGL::DIRTY_UV)
-      {
-        meshgl.V_uv_vbo = data.V_uv.cast<float>();
-      }
+      case MeshGL::DIRTY_POSITION:
+        X = &data.V; X_vbo = &meshgl.V_vbo; break;
+      case MeshGL::DIRTY_AMBIENT:
+        X = &data.V_material_ambient; X_vbo = &meshgl.V_ambient_vbo; break;
+      case MeshGL::DIRTY_DIFFUSE:
+        X = &data.V_material_diffuse; X_vbo = &meshgl.V_diffuse_vbo; break;
+      case MeshGL::DIRTY_SPECULAR:
+        X = &data.V_material_specular; X_vbo = &meshgl.V_specular_vbo; break;
     }
-    else
+    if (!(meshgl.dirty & flag))
     {
-
-      // Per vertex properties with per corner UVs
-      if (meshgl.dirty & MeshGL::DIRTY_POSITION)
-      {
-        per_corner(data.V,meshgl.V_vbo);
-      }
-
-      if (meshgl.dirty & MeshGL::DIRTY_AMBIENT)
+      // Packed buffers are rebuilt as a whole
+      const bool packed = meshgl.compact && flag != MeshGL::DIRTY_POSITION;
+      if (!X || !per_vertex_layout || packed || meshgl.streaming ||
+        X_vbo->rows() != X->rows() || X_vbo->cols() != X->cols())
       {
-        meshgl.V_ambient_vbo.resize(data.F.rows()*3,4);
-        for (unsigned i=0; i<data.F.rows();++i)
-          for (unsigned j=0;j<3;++j)
-            meshgl.V_ambient_vbo.row(i*3+j) = data.V_material_ambient.row(data.F(i,j)).cast<float>();
+        meshgl.dirty |= flag;
       }
-      if (meshgl.dirty & MeshGL::DIRTY_DIFFUSE)
+      else
       {
-        meshgl.V_diffuse_vbo.resize(data.F.rows()*3,4);
-        for (unsigned i=0; i<data.F.rows();++i)
-          for (unsigned j=0;j<3;++j)
-            meshgl.V_diffuse_vbo.row(i*3+j) = data.V_material_diffuse.row(data.F(i,j)).cast<float>();
+        for (const int i : it->second)
+          X_vbo->row(i) = X->row(i).cast<float>();
       }
-      if (meshgl.dirty & MeshGL::DIRTY_SPECULAR)
-      {
-        meshgl.V_specular_vbo.resize(data.F.rows()*3,4);
-        for (unsigned i=0; i<data.F.rows();++i)
-          for (unsigned j=0;j<3;++j)
-            meshgl.V_specular_vbo.row(i*3+j) = data.V_material_specular.row(data.F(i,j)).cast<float>();
-      }
-
-      if (meshgl.dirty & MeshGL::DIRTY_NORMAL)
-      {
-        meshgl.V_normals_vbo.resize(data.F.rows()*3,3);
-        for (unsigned i=0; i<data.F.rows();++i)
-          for (unsigned j=0;j<3;++j)
-            meshgl.V_normals_vbo.row(i*3+j) =
-                         per_corner_normals ?
-               data.F_normals.row(i*3+j).cast<float>() :
-               data.V_normals.row(data.F(i,j)).cast<float>();
-
+    }
+    if (meshgl.dirty & flag)
+      it = meshgl.dirty_rows.erase(it);
+    else
+      ++it;
+  }
 
-        if (invert_normals)
-          meshgl.V_normals_vbo = -meshgl.V_normals_vbo;
-      }
+  // Where the rows of an attribute's vertex buffer come from
+  struct Source
+  {
+    const Eigen::MatrixXd * X;
+    igl::PerCornerSourceType type;
+    const Eigen::MatrixXi * F;
+  };
+  const Eigen::MatrixXi & F_uv = per_corner_uv ? data.F_uv : data.F;
+  const Source position = {&data.V, igl::PER_CORNER_SOURCE_TYPE_VERTEX, &data.F};
+  const Source normal =
+    per_corner_normals ?
+      Source{&data.F_normals, igl::PER_CORNER_SOURCE_TYPE_CORNER, &data.F} :
+    data.face_based ?
+      Source{&data.F_normals, igl::PER_CORNER_SOURCE_TYPE_FACE, &data.F} :
+      Source{&data.V_normals, igl::PER_CORNER_SOURCE_TYPE_VERTEX, &data.F};
+  const auto material = [&data](const Eigen::MatrixXd & V_material, const Eigen::MatrixXd & F_material)
+  {
+    return data.face_based ?
+      Source{&F_material, igl::PER_CORNER_SOURCE_TYPE_FACE, &data.F} :
+      Source{&V_material, igl::PER_CORNER_SOURCE_TYPE_VERTEX, &data.F};
+  };
+  const Source uv = {&data.V_uv, igl::PER_CORNER_SOURCE_TYPE_VERTEX, &F_uv};
 
-      if (meshgl.dirty & MeshGL::DIRTY_FACE)
-      {
-        meshgl.F_vbo.resize(data.F.rows(),3);
-        for (unsigned i=0; i<data.F.rows();++i)
-          meshgl.F_vbo.row(i) << i*3+0, i*3+1, i*3+2;
-      }
+  const auto rows = [&data,per_vertex_layout](const Source & s)->Eigen::Index
+  {
+    return per_vertex_layout ? s.X->rows() : 3*data.F.rows();
+  };
+  // Write the rows(s) by #X vertex buffer content to dst, scaled by sign
+  // (may run on a worker thread, so it captures nothing)
+  const auto write = [](const Source & s, bool per_vertex, float sign, Eigen::Index n, float * dst)
+  {
+    Eigen::Map<MeshGL::RowMatrixXf> D(dst, n, s.X->cols());
+    if (per_vertex)
+      D = s.X->cast<float>();
+    else
+      igl::per_corner(*s.X, *s.F, s.type, dst);
+    if (sign != 1.f)
+      D *= sign;
+  };
+  // Resizing keeps the allocation if the size did not change
+  const auto update = [&](const Source & s, MeshGL::RowMatrixXf & X_vbo, float sign)
+  {
+    X_vbo.resize(rows(s), s.X->cols());
+    write(s, per_vertex_layout, sign, X_vbo.rows(), X_vbo.data());
+  };
+  const float normal_sign = invert_normals ? -1.f : 1.f;
 
-      if (meshgl.dirty & MeshGL::DIRTY_UV)
-      {
-        meshgl.V_uv_vbo.resize(data.F.rows()*3,2);
-        for (unsigned i=0; i<data.F.rows();++i)
-          for (unsigned j=0;j<3;++j)
-            meshgl.V_uv_vbo.row(i*3+j) =
-              data.V_uv.row(per_corner_uv ?
-                data.F_uv(i,j) : data.F(i,j)).cast<float>();
-      }
-    }
-  } else
+  if (meshgl.streaming)
   {
-    if (meshgl.dirty & MeshGL::DIRTY_POSITION)
-    {
-      per_corner(data.V,meshgl.V_vbo);
-    }
-    if (meshgl.dirty & MeshGL::DIRTY_AMBIENT)
+    // Convert straight into the mapped buffers on worker threads, the fills
+    // are joined in MeshGL::bind_mesh
+    meshgl.finish_streams();
+    const auto stream = [&](StreamingBuffer & buffer, const Source & s, float sign)
     {
-      per_face(data.F_material_ambient,meshgl.V_ambient_vbo);
-    }
-    if (meshgl.dirty & MeshGL::DIRTY_DIFFUSE)
-    {
-      per_face(data.F_material_diffuse,meshgl.V_diffuse_vbo);
-    }
-    if (meshgl.dirty & MeshGL::DIRTY_SPECULAR)
+      const Eigen::Index n = rows(s);
+      float * dst = buffer.map(n, s.X->cols());
+      if (dst)
+        buffer.fill([write, s, per_vertex_layout, sign, n, dst]()
+        {
+          write(s, per_vertex_layout, sign, n, dst);
+        });
+    };
+    if (meshgl.dirty & MeshGL::DIRTY_POSITION)
     {
-      per_face(data.F_material_specular,meshgl.V_specular_vbo);
+      stream(meshgl.stream_V, position, 1.f);
+      meshgl.V_vbo.resize(0, 0);
     }
-
     if (meshgl.dirty & MeshGL::DIRTY_NORMAL)
     {
-      meshgl.V_normals_vbo.resize(data.F.rows()*3,3);
-      for (unsigned i=0; i<data.F.rows();++i)
-        for (unsigned j=0;j<3;++j)
-          meshgl.V_normals_vbo.row(i*3+j) =
-             per_corner_normals ?
-               data.F_normals.row(i*3+j).cast<float>() :
-               data.F_normals.row(i).cast<float>();
-
-      if (invert_normals)
-        meshgl.V_normals_vbo = -meshgl.V_normals_vbo;
+      stream(meshgl.stream_V_normals, normal, normal_sign);
+      meshgl.V_normals_vbo.resize(0, 0);
     }
+  }
+  else
+  {
+    if (meshgl.dirty & MeshGL::DIRTY_POSITION)
+      update(position, meshgl.V_vbo, 1.f);
+    if (meshgl.dirty & MeshGL::DIRTY_NORMAL)
+      update(normal, meshgl.V_normals_vbo, normal_sign);
+  }
 
-    if (meshgl.dirty & MeshGL::DIRTY_FACE)
-    {
-      meshgl.F_vbo.resize(data.F.rows(),3);
-      for (unsigned i=0; i<data.F.rows();++i)
-        meshgl.F_vbo.row(i) << i*3+0, i*3+1, i*3+2;
-    }
+  // Material settings
+  if (meshgl.dirty & MeshGL::DIRTY_AMBIENT)
+    update(material(data.V_material_ambient, data.F_material_ambient), meshgl.V_ambient_vbo, 1.f);
+  if (meshgl.dirty & MeshGL::DIRTY_DIFFUSE)
+    update(material(data.V_material_diffuse, data.F_material_diffuse), meshgl.V_diffuse_vbo, 1.f);
+  if (meshgl.dirty & MeshGL::DIRTY_SPECULAR)
+    update(material(data.V_material_specular, data.F_material_specular), meshgl.V_specular_vbo, 1.f);
 
-    if( (meshgl.dirty & MeshGL::DIRTY_UV) && data.V_uv.rows()>0)
+  // Texture coordinates
+  if (meshgl.dirty & MeshGL::DIRTY_UV)
+  {
+    if (per_vertex_layout || data.V_uv.rows() > 0)
+      update(uv, meshgl.V_uv_vbo, 1.f);
+    else
+      meshgl.V_uv_vbo.resize(0, 2);
+  }
+
+  // Face indices
+  if (meshgl.dirty & MeshGL::DIRTY_FACE)
+  {
+    if (per_vertex_layout)
+      meshgl.F_vbo = data.F.cast<unsigned>();
+    else
     {
-        meshgl.V_uv_vbo.resize(data.F.rows()*3,2);
-        for (unsigned i=0; i<data.F.rows();++i)
-          for (unsigned j=0;j<3;++j)
-            meshgl.V_uv_vbo.row(i*3+j) = data.V_uv.row(per_corner_uv ? data.F_uv(i,j) : data.F(i,j)).cast<float>();
+      meshgl.F_vbo.resize(data.F.rows(), 3);
+      for (unsigned i = 0; i < meshgl.F_vbo.size(); ++i)
+        meshgl.F_vbo.data()[i] = i;
     }
   }
 
   if (meshgl.dirty & MeshGL::DIRTY_TEXTURE)
   {
+    meshgl.tex_mipmaps = data.mipmap_texture;
+    meshgl.tex_compression = data.compress_texture;
+    meshgl.tex_stream_texels = data.stream_texture_texels;
     meshgl.tex_u = data.texture_R.rows();
     meshgl.tex_v = data.texture_R.cols();
     meshgl.tex.resize(data.texture_R.size()*4);
@@ -9,11 +9,15 @@
 #define IGL_VIEWERDATA_H
 
 #include "MeshGL.h"
+#include <igl/FlatAABB.h>
 #include <igl/igl_inline.h>
 #include <igl/colormap.h>
 #include <cassert>
 #include <cstdint>
 #include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <future>
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -52,8 +56,23 @@ public:
   // Helpers that can draw the most common meshes
   IGL_INLINE void set_mesh(const Eigen::MatrixXd& V, const Eigen::MatrixXi& F);
   IGL_INLINE void set_vertices(const Eigen::MatrixXd& V);
+  // Update some of the vertex positions, only the changed rows are converted
+  // and uploaded to the GPU
+  //
+  // Inputs:
+  //   V  #V by 3 list of vertex positions (same #V as the current mesh)
+  //   changed_rows  list of indices into V of the rows that changed
+  IGL_INLINE void set_vertices(
+    const Eigen::MatrixXd& V,
+    const Eigen::VectorXi& changed_rows);
   IGL_INLINE void set_normals(const Eigen::MatrixXd& N);
 
+  // Recompute bounds from V. set_mesh and set_vertices keep bounds up to
+  // date, and ViewerCore recomputes them when drawing a mesh flagged with
+  // MeshGL::DIRTY_POSITION, so this is only needed to use bounds after
+  // writing V directly and before the next draw.
+  IGL_INLINE void compute_bounds();
+
   IGL_INLINE void set_visible(bool value, unsigned int core_id = 1);
 
   // Set the color of the mesh
@@ -62,6 +81,17 @@ public:
   //   C  #V|#F|1 by 3 list of colors
   IGL_INLINE void set_colors(const Eigen::MatrixXd &C);
 
+  // Update some of the per-vertex colors (e.g. while painting), only the
+  // changed rows are converted and uploaded to the GPU. Falls back to
+  // set_colors(C) if the mesh does not have per-vertex colors yet.
+  //
+  // Inputs:
+  //   C  #V by 3|4 list of colors
+  //   changed_rows  list of indices into C of the rows that changed
+  IGL_INLINE void set_colors(
+    const Eigen::MatrixXd &C,
+    const Eigen::VectorXi &changed_rows);
+
   // Set per-vertex UV coordinates
   //
   // Inputs:
@@ -192,6 +222,31 @@ public:
   // Copy visualization options from one viewport to another
   IGL_INLINE void copy_options(const ViewerCore &from, const ViewerCore &to);
 
+  // Build simplified copies of the mesh with igl::decimate on a worker
+  // thread. ViewerCore::draw picks them up once they are done and draws them
+  // for meshes that are small on screen (see ViewerCore::level_of_detail).
+  // Colors and UVs are taken from the birth vertices/faces of the decimated
+  // mesh. Changing the vertices, faces, colors or face_based discards the
+  // levels of detail (call build_lods again for the new mesh).
+  //
+  // Inputs:
+  //   levels  maximum number of levels of detail
+  //   ratio  fraction of the faces of the previous level kept by each level
+  IGL_INLINE void build_lods(int levels = 4, double ratio = 0.25);
+
+  // Adopt levels of detail whose build finished and free the OpenGL buffers
+  // of discarded ones. Called by ViewerCore::draw with the context current.
+  IGL_INLINE void update_lods();
+
+  // Discard the levels of detail and free their OpenGL buffers
+  IGL_INLINE void free_lods();
+
+  // Bounding volume hierarchy of (V,F) for picking with
+  // igl::unproject_onto_mesh or igl::ray_mesh_intersect. Built on first use
+  // and cached: set_vertices only refits it, set_mesh and clear build it
+  // again on the next call.
+  IGL_INLINE const igl::FlatAABB<Eigen::MatrixXd,3> & picking_tree();
+
   Eigen::MatrixXd V; // Vertices of the current mesh (#V x 3)
   Eigen::MatrixXi F; // Faces of the mesh (#F x 3)
 
@@ -240,6 +295,23 @@ public:
   // Marks dirty buffers that need to be uploaded to OpenGL
   uint32_t dirty;
 
+  // Axis-aligned bounding box of V, used for culling (see
+  // ViewerCore::frustum_culling). Updating a subset of the vertices only
+  // grows it, setting MeshGL::DIRTY_POSITION in dirty recomputes it.
+  Eigen::AlignedBox3d bounds;
+
+  // Per-vertex rows changed since the last upload, keyed by MeshGL::DirtyFlags
+  // (DIRTY_POSITION, DIRTY_AMBIENT, DIRTY_DIFFUSE or DIRTY_SPECULAR). Ignored
+  // for attributes whose bit is set in dirty.
+  std::map<uint32_t, std::vector<int> > dirty_rows;
+
+  // Levels of detail adopted from build_lods, finest first. Only V, F,
+  // normals, materials, UVs and textures of these are meaningful.
+  std::vector<std::shared_ptr<ViewerData> > lods;
+
+  // Level of detail drawn last, 0 for the mesh itself
+  int lod_level;
+
   // Enable per-face or per-vertex properties
   bool face_based;
 
@@ -249,6 +321,31 @@ public:
   // Invert mesh normals
   bool invert_normals;
 
+  // Upload positions and normals through a ring of mapped buffers filled on
+  // a worker thread instead of synchronous glBufferData calls. Meant for
+  // meshes whose vertices change every frame (e.g. deformation or
+  // skinning). Takes effect with the next update of the vertices.
+  bool stream_vertices;
+
+  // Store vertex data on the GPU in compact formats: packed normals, RGBA8
+  // colors, constant materials without per-vertex arrays and 16 bit indices
+  // for meshes with less than 65535 vertex buffer rows. Cuts the GPU memory
+  // and upload size per vertex from 80 to 24 bytes for uniformly colored
+  // meshes, at the cost of quantizing normals to 10 and colors to 8 bits.
+  bool compact_vertices;
+
+  // Build the mip chain of the texture (filtered trilinearly when
+  // minified, e.g. far away in VR) and store it block compressed on the GPU
+  // (uncompressed if the OpenGL context lacks the format). Textures of at
+  // least stream_texture_texels texels (0 for none) are prepared on a
+  // worker thread and uploaded over several frames, coarsest mip level
+  // first, the previous texture showing until then (see
+  // igl::opengl::TextureStream). Take effect with the next update of the
+  // texture.
+  bool mipmap_texture;
+  igl::BlockCompressionType compress_texture;
+  int stream_texture_texels;
+
   // Visualization options
   // Each option is a binary mask specifying on which viewport each option is set.
   // When using a single viewport, standard boolean can still be used for simplicity.
@@ -283,6 +380,21 @@ public:
     const igl::opengl::ViewerData& data,
     const bool invert_normals,
     igl::opengl::MeshGL& meshgl);
+
+  // Drop the levels of detail (and any build in progress) once the mesh
+  // changed. Their buffers are freed by the next update_lods.
+  IGL_INLINE void discard_lods();
+
+  // Levels of detail being built by build_lods
+  std::shared_future<std::vector<std::shared_ptr<ViewerData> > > lod_job;
+  // Discarded levels of detail whose buffers still need to be freed
+  std::vector<std::shared_ptr<ViewerData> > lods_discarded;
+
+  // Hierarchy returned by picking_tree
+  igl::FlatAABB<Eigen::MatrixXd,3> picking_aabb;
+  // Whether picking_aabb needs to be refit to V or built again for F
+  bool picking_refit;
+  bool picking_rebuild;
 };
 
 } // namespace opengl
@@ -322,6 +434,11 @@ namespace igl
       SERIALIZE_MEMBER(show_faces);
       SERIALIZE_MEMBER(show_lines);
       SERIALIZE_MEMBER(invert_normals);
+      SERIALIZE_MEMBER(stream_vertices);
+      SERIALIZE_MEMBER(compact_vertices);
+      SERIALIZE_MEMBER(mipmap_texture);
+      SERIALIZE_MEMBER(compress_texture);
+      SERIALIZE_MEMBER(stream_texture_texels);
       SERIALIZE_MEMBER(show_overlay);
       SERIALIZE_MEMBER(show_overlay_depth);
       SERIALIZE_MEMBER(show_vertid);
@@ -345,6 +462,9 @@ namespace igl
     {
       serialization(false, obj, const_cast<std::vector<char>&>(buffer));
       obj.dirty = igl::opengl::MeshGL::DIRTY_ALL;
+      obj.compute_bounds();
+      obj.discard_lods();
+      obj.picking_rebuild = true;
     }
   }
 }
@@ -14,6 +14,7 @@
 #include <Eigen/LU>
 
 #include "../gl.h"
+#include "../GLStateTracker.h"
 #include <GLFW/glfw3.h>
 
 #include <cmath>
@@ -43,8 +44,92 @@
 #include <igl/snap_to_canonical_view_quat.h>
 #include <igl/unproject.h>
 #include <igl/serialize.h>
+#include <igl/SerializationArchive.h>
 
 
+namespace igl
+{
+namespace opengl
+{
+namespace glfw
+{
+  namespace Viewer_detail
+  {
+    // Read a .off or .obj file into data and compute its normals and
+    // default colors, setting progress (if not null) along the way
+    inline bool read_mesh(
+      const std::string & mesh_file_name_string,
+      ViewerData & data,
+      std::atomic<float> * progress)
+    {
+      size_t last_dot = mesh_file_name_string.rfind('.');
+      if (last_dot == std::string::npos)
+      {
+        std::cerr<<"Error: No file extension found in "<<
+          mesh_file_name_string<<std::endl;
+        return false;
+      }
+
+      std::string extension = mesh_file_name_string.substr(last_dot+1);
+
+      if (extension == "off" || extension =="OFF")
+      {
+        Eigen::MatrixXd V;
+        Eigen::MatrixXi F;
+        if (!igl::readOFF(mesh_file_name_string, V, F))
+          return false;
+        if (progress)
+          *progress = 0.6f;
+        data.set_mesh(V,F);
+      }
+      else if (extension == "obj" || extension =="OBJ")
+      {
+        Eigen::MatrixXd corner_normals;
+        Eigen::MatrixXi fNormIndices;
+
+        Eigen::MatrixXd UV_V;
+        Eigen::MatrixXi UV_F;
+        Eigen::MatrixXd V;
+        Eigen::MatrixXi F;
+
+        if (!(
+              igl::readOBJ(
+                mesh_file_name_string,
+                V, UV_V, corner_normals, F, UV_F, fNormIndices)))
+        {
+          return false;
+        }
+        if (progress)
+          *progress = 0.6f;
+
+        data.set_mesh(V,F);
+        if(!UV_V.rows() != 0 && UV_F.rows() != 0)
+        {
+          data.set_uv(UV_V,UV_F);
+        }
+      }
+      else
+      {
+        // unrecognized file type
+        printf("Error: %s is not a recognized file type.\n",extension.c_str());
+        return false;
+      }
+      if (progress)
+        *progress = 0.7f;
+
+      data.compute_normals();
+      if (progress)
+        *progress = 0.85f;
+      data.uniform_colors(Eigen::Vector3d(51.0/255.0,43.0/255.0,33.3/255.0),
+                     Eigen::Vector3d(255.0/255.0,228.0/255.0,58.0/255.0),
+                     Eigen::Vector3d(255.0/255.0,235.0/255.0,80.0/255.0));
+      return true;
+    }
+  }
+}
+}
+}
+
 // Internal global variables used for glfw event handling
 static igl::opengl::glfw::Viewer * __viewer;
 static double highdpi = 1;
@@ -237,7 +322,8 @@ namespace glfw
       double tic = get_seconds();
       draw();
       glfwSwapBuffers(window);
-      if(core().is_animating || frame_counter++ < num_extra_frames)
+      // Keep drawing while meshes load to pick them up (and report progress)
+      if(core().is_animating || !mesh_loads.empty() || frame_counter++ < num_extra_frames)
       {
         glfwPollEvents();
         // In microseconds
@@ -273,6 +359,7 @@ namespace glfw
     for(auto & data : data_list)
     {
       data.meshgl.free();
+      data.free_lods();
     }
     core().shut(); // Doesn't do anything
     shutdown_plugins();
@@ -340,6 +427,7 @@ namespace glfw
     callback_mouse_scroll = nullptr;
     callback_key_down     = nullptr;
     callback_key_up       = nullptr;
+    callback_load_progress = nullptr;
 
     callback_init_data          = nullptr;
     callback_pre_draw_data      = nullptr;
@@ -350,6 +438,7 @@ namespace glfw
     callback_mouse_scroll_data  = nullptr;
     callback_key_down_data      = nullptr;
     callback_key_up_data        = nullptr;
+    callback_load_progress_data = nullptr;
 
 #ifndef IGL_VIEWER_VIEWER_QUIET
     const std::string usage(R"(igl::opengl::glfw::Viewer usage:
@@ -396,68 +485,117 @@ namespace glfw
     }
     data().clear();
 
-    size_t last_dot = mesh_file_name_string.rfind('.');
-    if (last_dot == std::string::npos)
-    {
-      std::cerr<<"Error: No file extension found in "<<
-        mesh_file_name_string<<std::endl;
+    if (!Viewer_detail::read_mesh(mesh_file_name_string, data(), nullptr))
       return false;
-    }
 
-    std::string extension = mesh_file_name_string.substr(last_dot+1);
+    for(int i=0;i<core_list.size(); i++)
+        core_list[i].align_camera_center(data().V,data().F);
 
-    if (extension == "off" || extension =="OFF")
-    {
-      Eigen::MatrixXd V;
-      Eigen::MatrixXi F;
-      if (!igl::readOFF(mesh_file_name_string, V, F))
-        return false;
-      data().set_mesh(V,F);
-    }
-    else if (extension == "obj" || extension =="OBJ")
-    {
-      Eigen::MatrixXd corner_normals;
-      Eigen::MatrixXi fNormIndices;
+    for (unsigned int i = 0; i<plugins.size(); ++i)
+      if (plugins[i]->post_load())
+        return true;
 
-      Eigen::MatrixXd UV_V;
-      Eigen::MatrixXi UV_F;
-      Eigen::MatrixXd V;
-      Eigen::MatrixXi F;
+    return true;
+  }
 
-      if (!(
-            igl::readOBJ(
-              mesh_file_name_string,
-              V, UV_V, corner_normals, F, UV_F, fNormIndices)))
+  IGL_INLINE int Viewer::load_mesh_from_file_async(
+      const std::string & mesh_file_name_string,
+      int lod_levels)
+  {
+    std::shared_ptr<MeshLoad> load = std::make_shared<MeshLoad>();
+    load->mesh_file_name = mesh_file_name_string;
+    load->id = next_data_id++;
+    load->lod_levels = lod_levels;
+    load->progress = 0.0f;
+    load->reported = 0.0f;
+    load->camera_zoom = 1.0f;
+    load->camera_shift.setZero();
+    load->object_scale = 1.0f;
+    std::shared_ptr<std::promise<bool> > promise =
+      std::make_shared<std::promise<bool> >();
+    load->done = promise->get_future().share();
+    mesh_loads.push_back(load);
+
+    // Detached like ViewerData::build_lods, so that closing the viewer does
+    // not wait for a load
+    std::thread([load, promise]()
+    {
+      bool ok = false;
+      try
       {
-        return false;
+        ok = Viewer_detail::read_mesh(load->mesh_file_name, load->data, &load->progress);
+        if (ok)
+        {
+          // Same fit as ViewerCore::align_camera_center, off the render
+          // thread
+          ViewerCore fit;
+          fit.get_scale_and_shift_to_fit_mesh(
+            load->data.V, load->data.F, load->camera_zoom, load->camera_shift);
+          if (!load->data.bounds.isEmpty())
+            load->object_scale = load->data.bounds.diagonal().norm();
+          // Simplified on yet another thread while the mesh is drawn
+          load->data.build_lods(load->lod_levels);
+          load->progress = 0.95f;
+        }
       }
-
-      data().set_mesh(V,F);
-      if(!UV_V.rows() != 0 && UV_F.rows() != 0)
+      catch (const std::exception & e)
       {
-        data().set_uv(UV_V,UV_F);
+        std::cerr << "ERROR (load_mesh_from_file_async): " << e.what() << std::endl;
+        ok = false;
       }
-    }
-    else
-    {
-      // unrecognized file type
-      printf("Error: %s is not a recognized file type.\n",extension.c_str());
-      return false;
-    }
-
-    data().compute_normals();
-    data().uniform_colors(Eigen::Vector3d(51.0/255.0,43.0/255.0,33.3/255.0),
-                   Eigen::Vector3d(255.0/255.0,228.0/255.0,58.0/255.0),
-                   Eigen::Vector3d(255.0/255.0,235.0/255.0,80.0/255.0));
+      promise->set_value(ok);
+    }).detach();
+    return load->id;
+  }
 
-    for(int i=0;i<core_list.size(); i++)
-        core_list[i].align_camera_center(data().V,data().F);
+  IGL_INLINE void Viewer::update_mesh_loads()
+  {
+    for (size_t i = 0; i < mesh_loads.size(); )
+    {
+      const std::shared_ptr<MeshLoad> load = mesh_loads[i];
+      const bool ready =
+        load->done.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+      const bool ok = ready && load->done.get();
+      const float progress = ready ? (ok ? 1.0f : -1.0f) : load->progress.load();
+      bool cancel = false;
+      if (progress != load->reported)
+      {
+        load->reported = progress;
+        if (callback_load_progress)
+          cancel = callback_load_progress(*this, load->id, load->mesh_file_name, progress);
+      }
+      if (!ready && !cancel)
+      {
+        ++i;
+        continue;
+      }
+      // A cancelled worker finishes on its own
+      mesh_loads.erase(mesh_loads.begin() + i);
+      if (!ok || cancel)
+        continue;
 
-    for (unsigned int i = 0; i<plugins.size(); ++i)
-      if (plugins[i]->post_load())
-        return true;
+      // Create new data slot and set to selected
+      if(!(data().F.rows() == 0  && data().V.rows() == 0))
+      {
+        data_list.emplace_back();
+        selected_data_index = data_list.size()-1;
+      }
+      data().meshgl.free();
+      data().free_lods();
+      data() = std::move(load->data);
+      data().id = load->id;
+      for (size_t c = 0; c < core_list.size(); c++)
+      {
+        data().set_visible(true, core_list[c].id);
+        core_list[c].camera_base_zoom = load->camera_zoom;
+        core_list[c].camera_base_translation = load->camera_shift;
+        core_list[c].object_scale = load->object_scale;
+      }
 
-    return true;
+      for (unsigned int p = 0; p<plugins.size(); ++p)
+        if (plugins[p]->post_load())
+          break;
+    }
   }
 
   IGL_INLINE bool Viewer::save_mesh_to_file(
@@ -858,6 +996,12 @@ namespace glfw
 
   IGL_INLINE bool Viewer::load_scene(std::string fname)
   {
+    igl::ArchiveReader archive;
+    if(archive.open(fname))
+    {
+      return archive.read("Core",core()) && archive.read("Data",data());
+    }
+    // Scenes saved with igl::serialize
     igl::deserialize(core(),"Core",fname.c_str());
     igl::deserialize(data(),"Data",fname.c_str());
     return true;
@@ -873,10 +1017,12 @@ namespace glfw
 
   IGL_INLINE bool Viewer::save_scene(std::string fname)
   {
-    igl::serialize(core(),"Core",fname.c_str(),true);
-    igl::serialize(data(),"Data",fname.c_str());
-
-    return true;
+    igl::ArchiveWriter archive;
+    return
+      archive.open(fname) &&
+      archive.write("Core",core()) &&
+      archive.write("Data",data()) &&
+      archive.close();
   }
 
   IGL_INLINE void Viewer::draw()
@@ -899,6 +1045,9 @@ namespace glfw
       highdpi=highdpi_tmp;
     }
 
+    // Meshes loaded in the background join at a frame boundary
+    update_mesh_loads();
+
     for (auto& core : core_list)
     {
       core.clear_framebuffers();
@@ -919,19 +1068,22 @@ namespace glfw
       }
     }
 
+    // Plugins and callbacks may have changed any OpenGL state
+    gl_state().new_frame();
+
     for (auto& core : core_list)
     {
-      for (auto& mesh : data_list)
+      if (core.vr)
       {
-        if (mesh.is_visible & core.id)
-        {
-            if (core.vr) {
-                core.drawVR(mesh);
-            }
-            else {
-                core.draw(mesh);
-            }
-        }
+        // One pose wait and one submit per frame for the whole scene
+        core.drawVR(data_list);
+        continue;
+      }
+      // Streamed vertices of all meshes are converted while drawing
+      core.update_buffers(data_list);
+      for (const int i : core.draw_order(data_list))
+      {
+        core.draw(data_list[i]);
       }
     }
     for (unsigned int i = 0; i<plugins.size(); ++i)
@@ -1058,6 +1210,7 @@ namespace glfw
       return false;
     }
     data_list[index].meshgl.free();
+    data_list[index].free_lods();
     data_list.erase(data_list.begin() + index);
     if(selected_data_index >= index && selected_data_index > 0)
     {
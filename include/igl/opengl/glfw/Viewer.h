@@ -21,6 +21,10 @@
 #include <Eigen/Core>
 #include <Eigen/Geometry>
 
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
 #include <vector>
 #include <string>
 #include <cstdint>
@@ -60,6 +64,27 @@ namespace glfw
     // Mesh IO
     IGL_INLINE bool load_mesh_from_file(const std::string & mesh_file_name);
     IGL_INLINE bool   save_mesh_to_file(const std::string & mesh_file_name);
+    // Load a mesh on a worker thread without stalling the render loop. The
+    // worker reads the file and computes the normals, colors, bounds and
+    // camera fit; draw() then adds the mesh to data_list at the start of a
+    // frame (reusing the selected slot if it is empty, like
+    // load_mesh_from_file), aligns the cameras to it and calls the plugins'
+    // post_load. Unlike load_mesh_from_file, plugins are not asked to load
+    // the file.
+    //
+    // Inputs:
+    //   mesh_file_name  path to .off or .obj file
+    //   lod_levels  number of levels of detail to build once loaded (see
+    //     ViewerData::build_lods), 0 for none
+    // Returns the id the mesh will have once loaded
+    //
+    // See also: callback_load_progress
+    IGL_INLINE int load_mesh_from_file_async(
+      const std::string & mesh_file_name,
+      int lod_levels = 0);
+    // Report the progress of asynchronous loads and adopt the meshes whose
+    // load finished. Called by draw().
+    IGL_INLINE void update_mesh_loads();
     // Callbacks
     IGL_INLINE bool key_pressed(unsigned int unicode_key,int modifier);
     IGL_INLINE bool key_down(int key,int modifier);
@@ -202,6 +227,24 @@ public:
     bool hack_never_moved;
     // Keep track of the global position of the scrollwheel
     float scroll_position;
+    // Mesh being loaded by load_mesh_from_file_async
+    struct MeshLoad
+    {
+      std::string mesh_file_name;
+      int id;
+      int lod_levels;
+      // Fraction done, written by the worker
+      std::atomic<float> progress;
+      // Last progress passed to callback_load_progress
+      float reported;
+      // Loaded mesh and camera fit, valid once done is ready
+      ViewerData data;
+      float camera_zoom;
+      Eigen::Vector3f camera_shift;
+      float object_scale;
+      std::shared_future<bool> done;
+    };
+    std::vector<std::shared_ptr<MeshLoad> > mesh_loads;
     // C++-style functions
     //
     // Returns **true** if action should be cancelled.
@@ -214,6 +257,10 @@ public:
     std::function<bool(Viewer& viewer, float delta_y)> callback_mouse_scroll;
     std::function<bool(Viewer& viewer, unsigned int key, int modifiers)> callback_key_pressed;
     std::function<bool(Viewer& viewer, int w, int h)> callback_post_resize;
+    // Progress of a load_mesh_from_file_async in [0,1], 1 just before the
+    // mesh is added to data_list and -1 if loading failed. Returning true
+    // cancels the load.
+    std::function<bool(Viewer& viewer, int id, const std::string & mesh_file_name, float progress)> callback_load_progress;
     // THESE SHOULD BE DEPRECATED:
     std::function<bool(Viewer& viewer, unsigned int key, int modifiers)> callback_key_down;
     std::function<bool(Viewer& viewer, unsigned int key, int modifiers)> callback_key_up;
@@ -228,6 +275,7 @@ public:
     void* callback_key_pressed_data;
     void* callback_key_down_data;
     void* callback_key_up_data;
+    void* callback_load_progress_data;
 
   public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -0,0 +1,121 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "PoseSource.h"
+#include <cmath>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace igl
+{
+  namespace openvr
+  {
+    IGL_INLINE CompositorPoseSource::CompositorPoseSource(vr::IVRSystem* hmd) : hmd(hmd)
+    {
+    }
+
+    IGL_INLINE void CompositorPoseSource::waitPoses(vr::TrackedDevicePose_t* poses, uint32_t count)
+    {
+      vr::VRCompositor()->WaitGetPoses(poses, count, nullptr, 0);
+    }
+
+    IGL_INLINE void CompositorPoseSource::predictedPoses(float secondsFromNow, vr::TrackedDevicePose_t* poses, uint32_t count)
+    {
+      hmd->GetDeviceToAbsoluteTrackingPose(
+        vr::VRCompositor()->GetTrackingSpace(), secondsFromNow, poses, count);
+    }
+
+    IGL_INLINE float CompositorPoseSource::secondsToPhotons()
+    {
+      // See the documentation of IVRSystem::GetDeviceToAbsoluteTrackingPose
+      float secondsSinceLastVsync = 0;
+      hmd->GetTimeSinceLastVsync(&secondsSinceLastVsync, nullptr);
+      const float frequency = hmd->GetFloatTrackedDeviceProperty(
+        vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float);
+      const float vsyncToPhotons = hmd->GetFloatTrackedDeviceProperty(
+        vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_SecondsFromVsyncToPhotons_Float);
+      return 1.0f / frequency - secondsSinceLastVsync + vsyncToPhotons;
+    }
+
+    IGL_INLINE double CompositorPoseSource::now()
+    {
+      return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    IGL_INLINE ScriptedPoseSource::ScriptedPoseSource(
+      const std::function<Eigen::Matrix4f(double)>& hmdPose,
+      float latency,
+      double frameDuration,
+      const std::function<double()>& clock) :
+      lastQueryTime(0),
+      lastPredictedTime(0),
+      hmdPose(hmdPose),
+      latency(latency),
+      frameDuration(frameDuration),
+      clock(clock)
+    {
+      if (!this->clock)
+      {
+        const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        this->clock = [t0]()
+        {
+          return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        };
+      }
+    }
+
+    IGL_INLINE void ScriptedPoseSource::waitPoses(vr::TrackedDevicePose_t* poses, uint32_t count)
+    {
+      // The compositor still paces the frames when there is one, otherwise
+      // wait for the next simulated vsync
+      if (vr::VRCompositor())
+      {
+        vr::VRCompositor()->WaitGetPoses(nullptr, 0, nullptr, 0);
+      }
+      else if (frameDuration > 0)
+      {
+        const double now = clock();
+        const double next = std::ceil(now / frameDuration) * frameDuration;
+        if (next > now)
+          std::this_thread::sleep_for(std::chrono::duration<double>(next - now));
+      }
+      posesAt(clock() + latency, poses, count);
+    }
+
+    IGL_INLINE void ScriptedPoseSource::predictedPoses(float secondsFromNow, vr::TrackedDevicePose_t* poses, uint32_t count)
+    {
+      posesAt(clock() + secondsFromNow, poses, count);
+    }
+
+    IGL_INLINE float ScriptedPoseSource::secondsToPhotons()
+    {
+      return latency;
+    }
+
+    IGL_INLINE double ScriptedPoseSource::now()
+    {
+      return clock();
+    }
+
+    IGL_INLINE void ScriptedPoseSource::posesAt(double time, vr::TrackedDevicePose_t* poses, uint32_t count)
+    {
+      lastQueryTime = clock();
+      lastPredictedTime = time;
+      std::memset(poses, 0, sizeof(vr::TrackedDevicePose_t) * count);
+      if (count <= vr::k_unTrackedDeviceIndex_Hmd)
+        return;
+      const Eigen::Matrix4f T = hmdPose(time);
+      vr::TrackedDevicePose_t& pose = poses[vr::k_unTrackedDeviceIndex_Hmd];
+      for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 4; ++j)
+          pose.mDeviceToAbsoluteTracking.m[i][j] = T(i, j);
+      pose.eTrackingResult = vr::TrackingResult_Running_OK;
+      pose.bPoseIsValid = true;
+      pose.bDeviceIsConnected = true;
+    }
+  }
+}
@@ -0,0 +1,90 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_OPENVR_POSESOURCE_H
+#define IGL_OPENVR_POSESOURCE_H
+#include <openvr.h>
+#include "../igl_inline.h"
+#include <Eigen/Core>
+#include <functional>
+
+namespace igl
+{
+  namespace openvr
+  {
+    // Where VRApplication gets the poses of the tracked devices from. Poses
+    // are in the layout of vr::TrackedDevicePose_t, indexed by tracked device
+    // index (vr::k_unTrackedDeviceIndex_Hmd for the headset).
+    class PoseSource
+    {
+    public:
+      virtual ~PoseSource() {}
+      // Block until the next frame may start and return the poses predicted
+      // for the time its photons are emitted
+      virtual void waitPoses(vr::TrackedDevicePose_t* poses, uint32_t count) = 0;
+      // Poses predicted secondsFromNow into the future, without blocking
+      virtual void predictedPoses(float secondsFromNow, vr::TrackedDevicePose_t* poses, uint32_t count) = 0;
+      // Seconds from now until the photons of a frame submitted right now are
+      // emitted
+      virtual float secondsToPhotons() = 0;
+      // Current time in seconds on the clock the poses are predicted with,
+      // VRApplication measures its frame timing with it
+      virtual double now() = 0;
+    };
+
+    // Poses of the compositor and the headset's tracking
+    class CompositorPoseSource : public PoseSource
+    {
+    public:
+      IGL_INLINE CompositorPoseSource(vr::IVRSystem* hmd);
+      IGL_INLINE void waitPoses(vr::TrackedDevicePose_t* poses, uint32_t count) override;
+      IGL_INLINE void predictedPoses(float secondsFromNow, vr::TrackedDevicePose_t* poses, uint32_t count) override;
+      IGL_INLINE float secondsToPhotons() override;
+      IGL_INLINE double now() override;
+    private:
+      vr::IVRSystem* hmd;
+    };
+
+    // Headset poses given as a function of time (e.g. a recorded or
+    // synthetic head motion), for running and testing the viewer without a
+    // headset. Only the headset pose is valid.
+    class ScriptedPoseSource : public PoseSource
+    {
+    public:
+      // Inputs:
+      //   hmdPose  function returning the device-to-tracking transform of the
+      //     headset at a time in seconds
+      //   latency  value of secondsToPhotons()
+      //   frameDuration  without a compositor, waitPoses() blocks until the
+      //     next multiple of this (0 to never block)
+      //   clock  function returning the current time in seconds (defaults to
+      //     a steady clock starting at 0 on construction)
+      IGL_INLINE ScriptedPoseSource(
+        const std::function<Eigen::Matrix4f(double)>& hmdPose,
+        float latency = 0.02f,
+        double frameDuration = 1.0 / 90.0,
+        const std::function<double()>& clock = std::function<double()>());
+      IGL_INLINE void waitPoses(vr::TrackedDevicePose_t* poses, uint32_t count) override;
+      IGL_INLINE void predictedPoses(float secondsFromNow, vr::TrackedDevicePose_t* poses, uint32_t count) override;
+      IGL_INLINE float secondsToPhotons() override;
+      IGL_INLINE double now() override;
+      // Time of the last call to waitPoses or predictedPoses and the time
+      // their poses were predicted for
+      double lastQueryTime, lastPredictedTime;
+    private:
+      IGL_INLINE void posesAt(double time, vr::TrackedDevicePose_t* poses, uint32_t count);
+      std::function<Eigen::Matrix4f(double)> hmdPose;
+      float latency;
+      double frameDuration;
+      std::function<double()> clock;
+    };
+  }
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "PoseSource.cpp"
+#endif
+
+#endif
@@ -1,5 +1,14 @@
 #include "VRApplication.h"
+#include "../opengl/gl.h"
+#include "../opengl/create_shader_program.h"
+#include "../opengl/GLStateTracker.h"
+#include "../frustum.h"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace igl
 {
@@ -62,6 +71,30 @@ namespace igl
       initOpenVR();
     }
 
+    IGL_INLINE VRApplication::VRApplication(
+      const std::shared_ptr<PoseSource>& poseSource,
+      int width,
+      int height) :
+      poseSource(poseSource),
+      hmdWidth(width),
+      hmdHeight(height)
+    {
+      std::memset(trackedDevicePose, 0, sizeof(trackedDevicePose));
+      std::memset(m_rDevClassChar, 0, sizeof(m_rDevClassChar));
+      for (EHand eHand = Left; eHand <= Right; ((int &)eHand)++)
+        m_rHand[eHand].m_bShowController = false;
+      hmdPose.setIdentity();
+      lEyeMat.setIdentity();
+      lEyeMat(0, 3) = -0.032f;
+      rEyeMat.setIdentity();
+      rEyeMat(0, 3) = 0.032f;
+      const float top = nearPlaneZ * height / width;
+      igl::frustum(-nearPlaneZ, nearPlaneZ, -top, top, nearPlaneZ, farPlaneZ, lProjectionMat);
+      rProjectionMat = lProjectionMat;
+      for (int eye = 0; eye < 2; ++eye)
+        eyeRenderPose[eye] = trackedDevicePose[vr::k_unTrackedDeviceIndex_Hmd].mDeviceToAbsoluteTracking;
+    }
+
     IGL_INLINE void VRApplication::initOpenVR()
     {
       vr::EVRInitError err = vr::VRInitError_None;
@@ -118,6 +151,8 @@ namespace igl
       vr::VRInput()->GetActionHandle("/actions/demo/out/Haptic_Right", &m_rHand[Right].m_actionHaptic);
       vr::VRInput()->GetInputSourceHandle("/user/hand/right", &m_rHand[Right].m_source);
       vr::VRInput()->GetActionHandle("/actions/demo/in/Hand_Right", &m_rHand[Right].m_actionPose);
+      poseSource = std::make_shared<CompositorPoseSource>(hmd);
+
       // Initialize the compositor
       vr::IVRCompositor *compositor = vr::VRCompositor();
       if (!compositor)
@@ -162,8 +197,50 @@ namespace igl
 
     IGL_INLINE void VRApplication::updatePose()
     {
-      vr::VRCompositor()->WaitGetPoses(trackedDevicePose, vr::k_unMaxTrackedDeviceCount, nullptr, 0);
+      poseSource->waitPoses(trackedDevicePose, vr::k_unMaxTrackedDeviceCount);
+      poseTime = latchTime = poseSource->now();
+      latchCount = 0;
+      applyPoses();
+      for (int eye = 0; eye < 2; ++eye)
+        eyeRenderPose[eye] = trackedDevicePose[vr::k_unTrackedDeviceIndex_Hmd].mDeviceToAbsoluteTracking;
+    }
+
+    IGL_INLINE void VRApplication::latchPose(int eye)
+    {
+      if (lateLatching)
+      {
+        poseSource->predictedPoses(poseSource->secondsToPhotons(), trackedDevicePose, vr::k_unMaxTrackedDeviceCount);
+        latchTime = poseSource->now();
+        latchCount++;
+        applyPoses();
+      }
+      for (int e = 0; e < 2; ++e)
+        if (eye < 0 || eye == e)
+          eyeRenderPose[e] = trackedDevicePose[vr::k_unTrackedDeviceIndex_Hmd].mDeviceToAbsoluteTracking;
+    }
+
+    IGL_INLINE void VRApplication::setLateLatching(bool value)
+    {
+      lateLatching = value;
+    }
+
+    IGL_INLINE bool VRApplication::getLateLatching()
+    {
+      return lateLatching;
+    }
+
+    IGL_INLINE void VRApplication::setPoseSource(const std::shared_ptr<PoseSource>& source)
+    {
+      poseSource = source;
+    }
 
+    IGL_INLINE const VRApplication::FrameTiming& VRApplication::getFrameTiming()
+    {
+      return frameTiming;
+    }
+
+    IGL_INLINE void VRApplication::applyPoses()
+    {
       validPoseCount = 0;
       //m_strPoseClasses = "";
       for (int nDevice = 0; nDevice < vr::k_unMaxTrackedDeviceCount; ++nDevice)
@@ -172,7 +249,7 @@ namespace igl
         {
           validPoseCount++;
           mat4DevicePose[nDevice] = convertMatrix(trackedDevicePose[nDevice].mDeviceToAbsoluteTracking);
-          if (m_rDevClassChar[nDevice] == 0)
+          if (m_rDevClassChar[nDevice] == 0 && hmd)
           {
             switch (hmd->GetTrackedDeviceClass(nDevice))
             {
@@ -214,11 +291,15 @@ namespace igl
 
     IGL_INLINE Eigen::Matrix4f VRApplication::getMatrixProjectionEye(vr::EVREye eye)
     {
+      if (!hmd)
+        return eye == vr::Eye_Left ? lProjectionMat : rProjectionMat;
       return convertMatrix(hmd->GetProjectionMatrix(eye, nearPlaneZ, farPlaneZ));
     }
 
     IGL_INLINE Eigen::Matrix4f VRApplication::getMatrixPoseEye(vr::EVREye eye)
     {
+      if (!hmd)
+        return (eye == vr::Eye_Left ? lEyeMat : rEyeMat).inverse().eval();
       return convertMatrix(hmd->GetEyeToHeadTransform(eye)).inverse().eval();
 
       //const vr::HmdMatrix34_t head = m_rTrackedDevicePose[vr::k_unTrackedDeviceIndex_Hmd].mDeviceToAbsoluteTracking;
@@ -261,27 +342,38 @@ namespace igl
 
     IGL_INLINE void VRApplication::submitToHMD()
     {
-
-      //vr::EColorSpace colorSpace = vr::ColorSpace_Gamma;
-      vr::Texture_t leftEyeTexture = {(void *)(uintptr_t)leftEyeDesc.resolveTextureId, vr::TextureType_OpenGL, vr::ColorSpace_Gamma};
-      vr::Texture_t rightEyeTexture = {(void *)(uintptr_t)rightEyeDesc.resolveTextureId, vr::TextureType_OpenGL, vr::ColorSpace_Gamma};
-
-      //vr::Texture_t lt = { (void*)(uintptr_t)ltEyeTexture, vr::TextureType_OpenGL, vr::ColorSpace_Gamma };
-
-      //vr::Texture_t lt = { reinterpret_cast<void*>(intptr_t(lTexture)), vr::TextureType_OpenGL, colorSpace };
-      vr::VRCompositor()->Submit(vr::Eye_Left, &leftEyeTexture);
-
-      //vr::Texture_t rt = { (void*)(uintptr_t)rtEyeTexture, vr::TextureType_OpenGL, vr::ColorSpace_Gamma };
-
-      //vr::Texture_t rt = { reinterpret_cast<void*>(intptr_t(rTexture)), vr::TextureType_OpenGL, colorSpace };
-      vr::VRCompositor()->Submit(vr::Eye_Right, &rightEyeTexture);
+      const double now = poseSource->now();
+      frameTiming.frame = 1000.0 * (now - poseTime);
+      frameTiming.latchedPose = 1000.0 * (now - latchTime);
+      frameTiming.saved = frameTiming.frame - frameTiming.latchedPose;
+      frameTiming.latches = latchCount;
+
+      // With the poses the eyes were drawn with, the compositor reprojects
+      // from those instead of the ones of WaitGetPoses
+      const unsigned int textures[2] = {leftEyeDesc.resolveTextureId, rightEyeDesc.resolveTextureId};
+      for (vr::EVREye eye = vr::EVREye::Eye_Left; eye <= vr::EVREye::Eye_Right; ((int&)eye)++)
+      {
+        vr::VRTextureWithPose_t texture;
+        texture.handle = (void *)(uintptr_t)textures[eye];
+        texture.eType = vr::TextureType_OpenGL;
+        texture.eColorSpace = vr::ColorSpace_Gamma;
+        texture.mDeviceToAbsoluteTracking = eyeRenderPose[eye];
+        submit(eye, texture);
+      }
 
       // Tell the compositor to begin work immediately instead of waiting for the next WaitGetPoses() call
-      vr::VRCompositor()->PostPresentHandoff();
+      if (hmd)
+        vr::VRCompositor()->PostPresentHandoff();
       //glClearColor(0, 0, 0, 1);
       //glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     }
 
+    IGL_INLINE void VRApplication::submit(vr::EVREye eye, const vr::VRTextureWithPose_t& texture)
+    {
+      if (hmd)
+        vr::VRCompositor()->Submit(eye, &texture, nullptr, vr::Submit_TextureWithPose);
+    }
+
     IGL_INLINE void VRApplication::shut()
     {
       if (hmd)
@@ -294,19 +386,13 @@ namespace igl
         glDeleteProgram(companionWindowProgramID);
       }
 
-      //delete leftEyeDesc;
-      glDeleteRenderbuffers(1, &leftEyeDesc.depthBufferId);
-      glDeleteTextures(1, &leftEyeDesc.renderTextureId);
-      glDeleteFramebuffers(1, &leftEyeDesc.renderFramebufferId);
-      glDeleteTextures(1, &leftEyeDesc.resolveTextureId);
-      glDeleteFramebuffers(1, &leftEyeDesc.resolveFramebufferId);
-
-      //delete rightEyeDesc;
-      glDeleteRenderbuffers(1, &rightEyeDesc.depthBufferId);
-      glDeleteTextures(1, &rightEyeDesc.renderTextureId);
-      glDeleteFramebuffers(1, &rightEyeDesc.renderFramebufferId);
-      glDeleteTextures(1, &rightEyeDesc.resolveTextureId);
-      glDeleteFramebuffers(1, &rightEyeDesc.resolveFramebufferId);
+      deleteFrameBuffer(leftEyeDesc);
+      deleteFrameBuffer(rightEyeDesc);
+      if (stereoInitialized)
+      {
+        deleteFrameBuffer(stereoDesc);
+        stereoInitialized = false;
+      }
 
       if (companionWindowVAO != 0)
       {
@@ -327,30 +413,34 @@ namespace igl
     IGL_INLINE void VRApplication::updateCompanionWindow(Eigen::Vector4f viewport)
     {
       //companion window
+      igl::opengl::GLStateTracker &state = igl::opengl::gl_state();
       glDisable(GL_DEPTH_TEST);
       glViewport(viewport(0), viewport(1), viewport(2), viewport(3));
 
-      glBindVertexArray(companionWindowVAO);
-      glUseProgram(companionWindowProgramID);
+      state.bind_vertex_array(companionWindowVAO);
+      state.use_program(companionWindowProgramID);
+
+      // Sampling parameters are texture state: after the first frame the
+      // tracker skips all of them
+      const auto bindEyeTexture = [&state](unsigned int texture)
+      {
+        state.bind_texture_2d(texture);
+        state.tex_parameter_2d(GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        state.tex_parameter_2d(GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        state.tex_parameter_2d(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        state.tex_parameter_2d(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+      };
 
       // render left eye (first half of index array )
-      glBindTexture(GL_TEXTURE_2D, leftEyeDesc.resolveTextureId);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+      bindEyeTexture(leftEyeDesc.resolveTextureId);
       glDrawElements(GL_TRIANGLES, companionWindowIndexSize / 2, GL_UNSIGNED_SHORT, 0);
 
       // render right eye (second half of index array )
-      glBindTexture(GL_TEXTURE_2D, rightEyeDesc.resolveTextureId);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+      bindEyeTexture(rightEyeDesc.resolveTextureId);
       glDrawElements(GL_TRIANGLES, companionWindowIndexSize / 2, GL_UNSIGNED_SHORT, (const void *)(uintptr_t)(companionWindowIndexSize));
 
-      glBindVertexArray(0);
-      glUseProgram(0);
+      state.bind_vertex_array(0);
+      state.use_program(0);
     }
 
     IGL_INLINE void VRApplication::predraw(vr::EVREye eye)
@@ -395,6 +485,53 @@ namespace igl
       glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
     }
 
+    IGL_INLINE void VRApplication::predrawStereo()
+    {
+      if (!stereoInitialized)
+      {
+        if (!createFrameBuffer(stereoDesc, 2 * hmdWidth, hmdHeight))
+        {
+          printf("Error creating frame buffers for single-pass stereo");
+        }
+        stereoInitialized = true;
+      }
+      glEnable(GL_MULTISAMPLE);
+      glBindFramebuffer(GL_FRAMEBUFFER, stereoDesc.renderFramebufferId);
+      glClearColor(0.3,
+                   0.3,
+                   0.5,
+                   1.0);
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    IGL_INLINE void VRApplication::postdrawStereo()
+    {
+      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+      glDisable(GL_MULTISAMPLE);
+
+      // Multisample resolve needs identical source and destination
+      // rectangles, so resolve the whole target first...
+      glBindFramebuffer(GL_READ_FRAMEBUFFER, stereoDesc.renderFramebufferId);
+      glBindFramebuffer(GL_DRAW_FRAMEBUFFER, stereoDesc.resolveFramebufferId);
+      glBlitFramebuffer(0, 0, 2 * hmdWidth, hmdHeight, 0, 0, 2 * hmdWidth, hmdHeight,
+                        GL_COLOR_BUFFER_BIT,
+                        GL_LINEAR);
+
+      // ...then copy each half into its eye texture
+      glBindFramebuffer(GL_READ_FRAMEBUFFER, stereoDesc.resolveFramebufferId);
+      glBindFramebuffer(GL_DRAW_FRAMEBUFFER, leftEyeDesc.resolveFramebufferId);
+      glBlitFramebuffer(0, 0, hmdWidth, hmdHeight, 0, 0, hmdWidth, hmdHeight,
+                        GL_COLOR_BUFFER_BIT,
+                        GL_NEAREST);
+      glBindFramebuffer(GL_DRAW_FRAMEBUFFER, rightEyeDesc.resolveFramebufferId);
+      glBlitFramebuffer(hmdWidth, 0, 2 * hmdWidth, hmdHeight, 0, 0, hmdWidth, hmdHeight,
+                        GL_COLOR_BUFFER_BIT,
+                        GL_NEAREST);
+
+      glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+      glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    }
+
     IGL_INLINE void VRApplication::printstuff()
     {
       printf("\naddres: %x\n", &leftEyeDesc);
@@ -424,7 +561,7 @@ namespace igl
       }
       setupCompanionWindow();
 
-      create_shader_program(
+      igl::opengl::create_shader_program(
           // vertex shader
           "#version 410\n"
           "uniform mat4 view;\n"
@@ -452,6 +589,8 @@ namespace igl
           {},
           controllerTransformProgramID);
 
+      controllerViewLocation = glGetUniformLocation(controllerTransformProgramID, "view");
+      controllerProjLocation = glGetUniformLocation(controllerTransformProgramID, "proj");
       //controllerMatrixLocation = glGetUniformLocation(controllerTransformProgramID, "matrix");
       //if (controllerMatrixLocation == -1)
       //{
@@ -460,6 +599,20 @@ namespace igl
     }
 
     IGL_INLINE bool VRApplication::createFrameBuffer(FramebufferDesc &framebufferDesc)
+    {
+      return createFrameBuffer(framebufferDesc, hmdWidth, hmdHeight);
+    }
+
+    IGL_INLINE void VRApplication::deleteFrameBuffer(FramebufferDesc &framebufferDesc)
+    {
+      glDeleteRenderbuffers(1, &framebufferDesc.depthBufferId);
+      glDeleteTextures(1, &framebufferDesc.renderTextureId);
+      glDeleteFramebuffers(1, &framebufferDesc.renderFramebufferId);
+      glDeleteTextures(1, &framebufferDesc.resolveTextureId);
+      glDeleteFramebuffers(1, &framebufferDesc.resolveFramebufferId);
+    }
+
+    IGL_INLINE bool VRApplication::createFrameBuffer(FramebufferDesc &framebufferDesc, int width, int height)
     {
       printf("Creating framebuffers\n");
 
@@ -469,13 +622,13 @@ namespace igl
       // create a multisampled color attachment texture
       glGenTextures(1, &framebufferDesc.renderTextureId);
       glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, framebufferDesc.renderTextureId);
-      glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, 4, GL_RGBA, hmdWidth, hmdHeight, GL_TRUE);
+      glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, 4, GL_RGBA, width, height, GL_TRUE);
       glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE, framebufferDesc.renderTextureId, 0);
 
       // create a (also multisampled) renderbuffer object for depth and stencil attachments
       glGenRenderbuffers(1, &framebufferDesc.depthBufferId);
       glBindRenderbuffer(GL_RENDERBUFFER, framebufferDesc.depthBufferId);
-      glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_DEPTH24_STENCIL8, hmdWidth, hmdHeight);
+      glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_DEPTH24_STENCIL8, width, height);
       glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, framebufferDesc.depthBufferId);
 
       glGenFramebuffers(1, &framebufferDesc.resolveFramebufferId);
@@ -483,7 +636,7 @@ namespace igl
 
       glGenTextures(1, &framebufferDesc.resolveTextureId);
       glBindTexture(GL_TEXTURE_2D, framebufferDesc.resolveTextureId);
-      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, hmdWidth, hmdHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
       glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
       glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, framebufferDesc.resolveTextureId, 0);
@@ -497,6 +650,8 @@ namespace igl
       glBindFramebuffer(GL_FRAMEBUFFER, 0);
       //glBindRenderbuffer(GL_RENDERBUFFER, 0);
       //glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+      // The raw texture binds above bypass the state tracker
+      igl::opengl::gl_state().invalidate();
 
       return true;
     }
@@ -518,10 +673,10 @@ namespace igl
       vVerts.push_back(VertexDataWindow(Vector2(1, 1), Vector2(1, 1)));
 
       GLushort vIndices[] = {0, 1, 3, 0, 3, 2, 4, 5, 7, 4, 7, 6};
-      companionWindowIndexSize = _countof(vIndices);
+      companionWindowIndexSize = sizeof(vIndices) / sizeof(vIndices[0]);
 
       glGenVertexArrays(1, &companionWindowVAO);
-      glBindVertexArray(companionWindowVAO);
+      igl::opengl::gl_state().bind_vertex_array(companionWindowVAO);
 
       glGenBuffers(1, &companionWindowIDVertBuffer);
       glBindBuffer(GL_ARRAY_BUFFER, companionWindowIDVertBuffer);
@@ -537,7 +692,7 @@ namespace igl
       glEnableVertexAttribArray(1);
       glVertexAttribPointer(1, 2, GL_FLOAT, GL_TRUE, sizeof(VertexDataWindow), (void *)offsetof(VertexDataWindow, texCoord));
 
-      glBindVertexArray(0);
+      igl::opengl::gl_state().bind_vertex_array(0);
 
       glDisableVertexAttribArray(0);
       glDisableVertexAttribArray(1);
@@ -545,7 +700,7 @@ namespace igl
       glBindBuffer(GL_ARRAY_BUFFER, 0);
       glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-      create_shader_program(
+      igl::opengl::create_shader_program(
           // vertex shader
           "#version 410 core\n"
           "layout(location = 0) in vec4 position;\n"
@@ -572,31 +727,30 @@ namespace igl
 
     IGL_INLINE void VRApplication::drawControllerAxes(Eigen::Matrix4f view, Eigen::Matrix4f proj)
     {
-      if (!hmd->IsInputAvailable())
+      if (!hmd || !hmd->IsInputAvailable())
         return;
 
       glEnable(GL_DEPTH_TEST);
 
       // draw the controller axis lines
-      glUseProgram(controllerTransformProgramID);
+      igl::opengl::GLStateTracker &state = igl::opengl::gl_state();
+      state.use_program(controllerTransformProgramID);
 
       // Send transformations to the GPU
-      GLint viewi = glGetUniformLocation(controllerTransformProgramID, "view");
-      GLint proji = glGetUniformLocation(controllerTransformProgramID, "proj");
-      glUniformMatrix4fv(viewi, 1, GL_FALSE, view.data());
-      glUniformMatrix4fv(proji, 1, GL_FALSE, proj.data());
+      glUniformMatrix4fv(controllerViewLocation, 1, GL_FALSE, view.data());
+      glUniformMatrix4fv(controllerProjLocation, 1, GL_FALSE, proj.data());
 
       //glUniformMatrix4fv(controllerMatrixLocation, 1, GL_FALSE, viewProjectionMatrix.data());
-      glBindVertexArray(controllerVAO);
+      state.bind_vertex_array(controllerVAO);
       glDrawArrays(GL_LINES, 0, controllerVertCount);
-      glBindVertexArray(0);
+      state.bind_vertex_array(0);
 
-      glUseProgram(0);
+      state.use_program(0);
     }
 
     IGL_INLINE void VRApplication::renderControllerAxes()
     {
-      if (!hmd->IsInputAvailable())
+      if (!hmd || !hmd->IsInputAvailable())
         return;
 
       std::vector<float> vertdataarray;
@@ -660,7 +814,7 @@ namespace igl
       if (controllerVAO == 0)
       {
         glGenVertexArrays(1, &controllerVAO);
-        glBindVertexArray(controllerVAO);
+        igl::opengl::gl_state().bind_vertex_array(controllerVAO);
 
         glGenBuffers(1, &controllerVertBuffer);
         glBindBuffer(GL_ARRAY_BUFFER, controllerVertBuffer);
@@ -675,7 +829,7 @@ namespace igl
         glEnableVertexAttribArray(1);
         glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (const void *)offset);
 
-        glBindVertexArray(0);
+        igl::opengl::gl_state().bind_vertex_array(0);
       }
 
       glBindBuffer(GL_ARRAY_BUFFER, controllerVertBuffer);
@@ -689,6 +843,8 @@ namespace igl
 
     IGL_INLINE void VRApplication::handleInput()
     {
+      if (!hmd)
+        return;
       // Process SteamVR events
       vr::VREvent_t event;
       while (hmd->PollNextEvent(&event, sizeof(event)))
@@ -2,9 +2,11 @@
 #ifndef IGL_OPENVR_VRAPPLICATION_H
 #define IGL_OPENVR_VRAPPLICATION_H
 #include <openvr.h>
+#include "PoseSource.h"
 #include "../igl_inline.h"
 #include <Eigen/Core>
 #include <Eigen/Geometry>
+#include <memory>
 
 
 namespace igl
@@ -76,6 +78,17 @@ namespace igl
 
         Eigen::Matrix4f hmdPose, lEyeMat, rEyeMat, lProjectionMat, rProjectionMat;
 
+        std::shared_ptr<PoseSource> poseSource;
+        bool lateLatching = false;
+        // When the poses used for the current frame were queried, in seconds
+        // on the clock of poseSource
+        double poseTime = 0, latchTime = 0;
+        int latchCount = 0;
+        // Headset pose each eye was drawn with, submitted along with the eye
+        // textures so that the compositor reprojects from it
+        vr::HmdMatrix34_t eyeRenderPose[2];
+        IGL_INLINE void applyPoses();
+
 
         Eigen::Matrix4f convertMatrix(vr::HmdMatrix34_t);
         Eigen::Matrix4f convertMatrix(vr::HmdMatrix44_t);
@@ -108,6 +121,7 @@ namespace igl
         };
         ControllerInfo_t m_rHand[2];
         unsigned int controllerTransformProgramID, controllerMatrixLocation;
+        int controllerViewLocation = -1, controllerProjLocation = -1;
 
         vr::VRActionSetHandle_t m_actionsetDemo = vr::k_ulInvalidActionSetHandle;//TODO: Delete me
 
@@ -116,6 +130,8 @@ namespace igl
         unsigned int companionWindowProgramID;
 
         IGL_INLINE bool createFrameBuffer(FramebufferDesc& framebufferDesc);
+        IGL_INLINE bool createFrameBuffer(FramebufferDesc& framebufferDesc, int width, int height);
+        IGL_INLINE void deleteFrameBuffer(FramebufferDesc& framebufferDesc);
         IGL_INLINE void setupCompanionWindow();
 
         float nearPlaneZ = 0.05f;
@@ -125,7 +141,44 @@ namespace igl
 
         FramebufferDesc leftEyeDesc;
         FramebufferDesc rightEyeDesc;
+        // Side-by-side (2*hmdWidth x hmdHeight) target of single-pass stereo,
+        // created on first use
+        FramebufferDesc stereoDesc;
+        bool stereoInitialized = false;
     public:
+        // Latency of the last submitted frame, in milliseconds on the clock
+        // of the pose source
+        struct FrameTiming
+        {
+            // From waitPoses (start of the frame) to the submission
+            double frame = 0;
+            // From the query of the poses the eyes were drawn with to the
+            // submission
+            double latchedPose = 0;
+            // Age of the drawn poses saved by late latching (frame -
+            // latchedPose)
+            double saved = 0;
+            // Number of poses latched during the frame
+            int latches = 0;
+        };
+
+        // Initialize OpenVR, poses come from the compositor and frames are
+        // submitted to it
+        IGL_INLINE VRApplication();
+        // Without a VR runtime (e.g. for testing): poses come from poseSource,
+        // the eyes are set 64 mm apart with a 90 degree field of view, and
+        // submitted frames are only passed to submit()
+        //
+        // Inputs:
+        //   poseSource  source of the headset pose (e.g. a ScriptedPoseSource)
+        //   width  width of each eye's image
+        //   height  height of each eye's image
+        IGL_INLINE VRApplication(
+          const std::shared_ptr<PoseSource>& poseSource,
+          int width = 1280,
+          int height = 720);
+        virtual ~VRApplication() {}
+
         IGL_INLINE Eigen::Matrix4f getMatrixPoseEye(vr::EVREye);
         IGL_INLINE Eigen::Matrix4f getMatrixProjectionEye(vr::EVREye);
         IGL_INLINE Eigen::Matrix4f getMatrixPoseHmd();
@@ -136,17 +189,48 @@ namespace igl
         IGL_INLINE void printstuff();
         IGL_INLINE void predraw(vr::EVREye);
         IGL_INLINE void postdraw(vr::EVREye);
-        IGL_INLINE void updatePose();
-        IGL_INLINE void submitToHMD();
+        // Single-pass stereo counterparts of predraw/postdraw: bind and clear
+        // the side-by-side target, then resolve its halves into the eye
+        // textures submitted by submitToHMD
+        IGL_INLINE void predrawStereo();
+        IGL_INLINE void postdrawStereo();
+        // Block until the next frame may start and update the poses of all
+        // devices to the ones predicted for its photons. Input handling and
+        // buffer updates of the frame should use these.
+        IGL_INLINE virtual void updatePose();
+        // With late latching on, query the poses again, predicted for the
+        // photons of a frame submitted now. Call right before computing the
+        // view matrices of an eye, after all other work of the frame. The
+        // current headset pose is recorded as the one the eye is drawn with,
+        // late latching on or not.
+        //
+        // Inputs:
+        //   eye  vr::Eye_Left or vr::Eye_Right, -1 for both eyes (single-pass
+        //     stereo)
+        IGL_INLINE virtual void latchPose(int eye = -1);
+        IGL_INLINE void setLateLatching(bool);
+        IGL_INLINE bool getLateLatching();
+        // Replace the poses of the headset's tracking (e.g. by a
+        // ScriptedPoseSource)
+        IGL_INLINE void setPoseSource(const std::shared_ptr<PoseSource>&);
+        IGL_INLINE const FrameTiming& getFrameTiming();
+        // Submit both eye textures with the poses they were drawn with (see
+        // latchPose) and end the frame
+        IGL_INLINE virtual void submitToHMD();
         IGL_INLINE int getHmdWidth();
         IGL_INLINE int getHmdHeight();
-        IGL_INLINE VRApplication();
         IGL_INLINE void initGl();
         IGL_INLINE void updateCompanionWindow(Eigen::Vector4f);
         IGL_INLINE void shut();
         IGL_INLINE void renderControllerAxes();
         IGL_INLINE void drawControllerAxes(Eigen::Matrix4f, Eigen::Matrix4f);
-        IGL_INLINE void handleInput();
+        IGL_INLINE virtual void handleInput();
+    protected:
+        // Hand an eye texture to the compositor (does nothing without a VR
+        // runtime)
+        IGL_INLINE virtual void submit(vr::EVREye eye, const vr::VRTextureWithPose_t& texture);
+    private:
+        FrameTiming frameTiming;
     };
   }
 }
@@ -8,6 +8,7 @@
 #ifndef IGL_PARALLEL_FOR_H
 #define IGL_PARALLEL_FOR_H
 #include "igl_inline.h"
+#include <cstddef>
 #include <functional>
 
 //#warning "Defining IGL_PARALLEL_FOR_FORCE_SERIAL"
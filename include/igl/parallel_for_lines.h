@@ -0,0 +1,139 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_PARALLEL_FOR_LINES_H
+#define IGL_PARALLEL_FOR_LINES_H
+#include "igl_inline.h"
+#include <cstddef>
+
+namespace igl
+{
+  // Call a function on each of the next n lines of a text (e.g. a memory
+  // mapped file) in parallel. The text is cut into line aligned chunks of
+  // about chunk_size bytes, a few per thread at a time; the lines of each
+  // chunk are counted in parallel so that every line is passed with its
+  // index. Only as much of the text as needed is touched.
+  //
+  // Inputs:
+  //   begin  pointer to the first character of the first line
+  //   end  pointer past the last character of the text
+  //   n  number of lines
+  //   func  function handle called as func(i,line,line_end) for i=0..n-1
+  //     (concurrently and in no particular order), where [line,line_end) is
+  //     the i-th line without its '\n'. Returns false to stop.
+  //   chunk_size  approximate number of bytes parsed by one thread at a time
+  // Returns pointer past the n-th line (its '\n' included), or NULL if the
+  // text has fewer than n lines or func returned false
+  //
+  // Example:
+  //   // Read "x y z" on each of the next n lines
+  //   p = parallel_for_lines(p,end,n,[&](size_t i,const char * l,const char * e)
+  //   {
+  //     ...parse l..e into V.row(i)...
+  //     return true;
+  //   });
+  template <typename FunctionType>
+  inline const char * parallel_for_lines(
+    const char * begin,
+    const char * end,
+    const size_t n,
+    const FunctionType & func,
+    const size_t chunk_size = 4<<20);
+}
+
+// Implementation
+
+#include "parallel_for.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+template <typename FunctionType>
+inline const char * igl::parallel_for_lines(
+  const char * begin,
+  const char * end,
+  const size_t n,
+  const FunctionType & func,
+  const size_t chunk_size)
+{
+  const auto next_line = [end](const char * p)->const char *
+  {
+    const char * eol = static_cast<const char *>(memchr(p, '\n', end - p));
+    return eol ? eol + 1 : end;
+  };
+  const size_t batch = 2*std::max(std::thread::hardware_concurrency(), 1u);
+  const char * p = begin;
+  size_t first = 0;
+  while(first < n)
+  {
+    if(p == end)
+    {
+      return NULL;
+    }
+    // Line aligned chunks
+    std::vector<const char *> bounds(1, p);
+    while(bounds.size() <= batch && bounds.back() < end)
+    {
+      const char * b = bounds.back();
+      const char * e = b + std::min<size_t>(std::max<size_t>(chunk_size, 1), end - b);
+      bounds.push_back(e < end ? next_line(e - 1) : end);
+    }
+    const size_t m = bounds.size() - 1;
+    // Index of the first line of each chunk
+    std::vector<size_t> lines(m + 1, 0);
+    parallel_for(m, [&](const size_t c)
+    {
+      size_t count = 0;
+      for(const char * l = bounds[c];l < bounds[c+1];l = next_line(l))
+      {
+        count++;
+      }
+      lines[c+1] = count;
+    }, 2);
+    for(size_t c = 0;c<m;c++)
+    {
+      lines[c+1] += lines[c];
+    }
+    // Pointer past the n-th line if it is in this batch
+    std::vector<const char *> stop(m, (const char *)NULL);
+    std::vector<char> ok(m, 1);
+    parallel_for(m, [&](const size_t c)
+    {
+      size_t i = first + lines[c];
+      for(const char * l = bounds[c];l < bounds[c+1] && i < n;i++)
+      {
+        const char * e = next_line(l);
+        const char * line_end = (e > l && e[-1] == '\n') ? e - 1 : e;
+        if(!func(i, l, line_end))
+        {
+          ok[c] = 0;
+          return;
+        }
+        l = e;
+        if(i + 1 == n)
+        {
+          stop[c] = e;
+        }
+      }
+    }, 2);
+    if(std::find(ok.begin(), ok.end(), 0) != ok.end())
+    {
+      return NULL;
+    }
+    for(size_t c = 0;c<m;c++)
+    {
+      if(stop[c] != NULL)
+      {
+        return stop[c];
+      }
+    }
+    first += lines[m];
+    p = bounds[m];
+  }
+  return p;
+}
+
+#endif
@@ -0,0 +1,188 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "parse_number.h"
+#include <cerrno>
+#include <cfloat>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <locale>
+#include <sstream>
+#include <string>
+#if defined(_WIN32)
+#  include <locale.h>
+#elif defined(__APPLE__)
+#  include <xlocale.h>
+#elif defined(__GLIBC__)
+#  include <locale.h>
+#endif
+
+IGL_INLINE const char * igl::parse_number(
+  const char * s,
+  const char * end,
+  double & x)
+{
+  const char * p = s;
+  bool negative = false;
+  if(p < end && (*p == '+' || *p == '-'))
+  {
+    negative = *p == '-';
+    p++;
+  }
+  // Up to 19 significant digits fit in 64 bits
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool truncated = false;
+  const char * first_digit = p;
+  for(;p < end && *p >= '0' && *p <= '9';p++)
+  {
+    if(digits < 19)
+    {
+      mantissa = 10*mantissa + (*p - '0');
+      digits += mantissa > 0;
+    }else
+    {
+      truncated = true;
+      exponent++;
+    }
+  }
+  bool any_digit = p > first_digit;
+  if(p < end && *p == '.')
+  {
+    p++;
+    const char * first_fraction = p;
+    for(;p < end && *p >= '0' && *p <= '9';p++)
+    {
+      if(digits < 19)
+      {
+        mantissa = 10*mantissa + (*p - '0');
+        digits += mantissa > 0;
+        exponent--;
+      }else
+      {
+        truncated = true;
+      }
+    }
+    any_digit = any_digit || p > first_fraction;
+  }
+  if(!any_digit)
+  {
+    return NULL;
+  }
+  if(p < end && (*p == 'e' || *p == 'E'))
+  {
+    p++;
+    bool negative_exponent = false;
+    if(p < end && (*p == '+' || *p == '-'))
+    {
+      negative_exponent = *p == '-';
+      p++;
+    }
+    if(p == end || *p < '0' || *p > '9')
+    {
+      return NULL;
+    }
+    int e = 0;
+    for(;p < end && *p >= '0' && *p <= '9';p++)
+    {
+      // Saturate, anything this large is inf or 0 anyway
+      if(e < 100000)
+      {
+        e = 10*e + (*p - '0');
+      }
+    }
+    exponent += negative_exponent ? -e : e;
+  }
+
+  // Clinger's fast path: both the mantissa and the power of ten are exact
+  // doubles, so a single correctly rounded operation gives the correctly
+  // rounded result
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+  static const double powers[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  if(!truncated && mantissa <= (uint64_t(1) << 53) &&
+    exponent >= -22 && exponent <= 22)
+  {
+    double value = double(mantissa);
+    value = exponent < 0 ? value / powers[-exponent] : value * powers[exponent];
+    x = negative ? -value : value;
+    return p;
+  }
+#endif
+  // Longer numbers (e.g. written with %.17g) with strtod of the "C" locale
+  // where available, much faster than a stream
+#if defined(_WIN32) || defined(__APPLE__) || defined(__GLIBC__)
+  char buffer[64];
+  if(std::size_t(p - s) < sizeof(buffer))
+  {
+#  if defined(_WIN32)
+    static const _locale_t c_locale = _create_locale(LC_NUMERIC, "C");
+#  else
+    static const locale_t c_locale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+#  endif
+    std::memcpy(buffer, s, p - s);
+    buffer[p - s] = '\0';
+    char * parsed = NULL;
+    errno = 0;
+#  if defined(_WIN32)
+    const double value = c_locale ? _strtod_l(buffer, &parsed, c_locale) : 0;
+#  else
+    const double value = c_locale ? strtod_l(buffer, &parsed, c_locale) : 0;
+#  endif
+    if(c_locale && parsed == buffer + (p - s) && errno != ERANGE)
+    {
+      x = value;
+      return p;
+    }
+  }
+#endif
+  std::istringstream stream(std::string(s, p));
+  stream.imbue(std::locale::classic());
+  stream >> x;
+  // Out of range values fail to parse, strtod would return +-inf or 0
+  if(stream.fail())
+  {
+    return NULL;
+  }
+  return p;
+}
+
+IGL_INLINE const char * igl::parse_number(
+  const char * s,
+  const char * end,
+  long & x)
+{
+  const char * p = s;
+  bool negative = false;
+  if(p < end && (*p == '+' || *p == '-'))
+  {
+    negative = *p == '-';
+    p++;
+  }
+  if(p == end || *p < '0' || *p > '9')
+  {
+    return NULL;
+  }
+  unsigned long value = 0;
+  for(;p < end && *p >= '0' && *p <= '9';p++)
+  {
+    const unsigned long digit = *p - '0';
+    if(value > (ULONG_MAX - digit) / 10)
+    {
+      return NULL;
+    }
+    value = 10*value + digit;
+  }
+  if(value > (unsigned long)LONG_MAX + (negative ? 1 : 0))
+  {
+    return NULL;
+  }
+  x = negative ? (long)(0 - value) : (long)value;
+  return p;
+}
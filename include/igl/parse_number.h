@@ -0,0 +1,36 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_PARSE_NUMBER_H
+#define IGL_PARSE_NUMBER_H
+#include "igl_inline.h"
+namespace igl
+{
+  // Parse a decimal number at the start of a character range, independent of
+  // the current locale. Results are correctly rounded and hence identical to
+  // strtod in the "C" locale: most numbers take an exact fast path, the rest
+  // is handed to strtod_l with the "C" locale (or a stream with the classic
+  // locale where that is not available).
+  //
+  // Inputs:
+  //   s  pointer to the first character of the number (no leading
+  //     whitespace)
+  //   end  pointer past the last character that may be read
+  // Outputs:
+  //   x  parsed value
+  // Returns pointer past the number, or NULL if [s,end) does not start with
+  // a plain decimal number ([+-]digits[.digits][(e|E)[+-]digits]; no inf,
+  // nan or hexadecimal floats)
+  IGL_INLINE const char * parse_number(const char * s, const char * end, double & x);
+  // Returns pointer past the integer ([+-]digits), or NULL if there is none
+  // or it overflows
+  IGL_INLINE const char * parse_number(const char * s, const char * end, long & x);
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "parse_number.cpp"
+#endif
+
+#endif
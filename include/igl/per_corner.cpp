@@ -0,0 +1,81 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "per_corner.h"
+#include "parallel_for.h"
+#include <cassert>
+
+template <typename DerivedX, typename DerivedF, typename Scalar>
+IGL_INLINE void igl::per_corner(
+  const Eigen::MatrixBase<DerivedX> & X,
+  const Eigen::MatrixBase<DerivedF> & F,
+  const PerCornerSourceType type,
+  Scalar * C)
+{
+  assert(F.cols() == 3 && "F should contain triangles");
+  const Eigen::Index m = F.rows();
+  const Eigen::Index dim = X.cols();
+  assert(type != PER_CORNER_SOURCE_TYPE_FACE || X.rows() == m);
+  assert(type != PER_CORNER_SOURCE_TYPE_CORNER || X.rows() == 3*m);
+  // Plain loops: dim is tiny (2-4) and only known at runtime
+  const auto copy_row = [&X,dim](const Eigen::Index i, Scalar * dst)
+  {
+    for(Eigen::Index d = 0;d<dim;d++)
+    {
+      dst[d] = static_cast<Scalar>(X(i,d));
+    }
+  };
+  // Faces are independent and write disjoint parts of C, so no
+  // synchronization is needed
+  const size_t min_parallel = 10000;
+  switch(type)
+  {
+    case PER_CORNER_SOURCE_TYPE_VERTEX:
+      parallel_for(m,[&](const Eigen::Index f)
+      {
+        for(int c = 0;c<3;c++)
+        {
+          copy_row(F(f,c),C+(3*f+c)*dim);
+        }
+      },min_parallel);
+      break;
+    case PER_CORNER_SOURCE_TYPE_FACE:
+      parallel_for(m,[&](const Eigen::Index f)
+      {
+        Scalar * dst = C+3*f*dim;
+        for(Eigen::Index d = 0;d<dim;d++)
+        {
+          dst[d] = dst[dim+d] = dst[2*dim+d] = static_cast<Scalar>(X(f,d));
+        }
+      },min_parallel);
+      break;
+    default:
+      parallel_for(3*m,[&](const Eigen::Index i)
+      {
+        copy_row(i,C+i*dim);
+      },min_parallel);
+      break;
+  }
+}
+
+template <typename DerivedX, typename DerivedF, typename DerivedC>
+IGL_INLINE void igl::per_corner(
+  const Eigen::MatrixBase<DerivedX> & X,
+  const Eigen::MatrixBase<DerivedF> & F,
+  const PerCornerSourceType type,
+  Eigen::PlainObjectBase<DerivedC> & C)
+{
+  static_assert(
+    DerivedC::IsRowMajor || DerivedC::ColsAtCompileTime == 1,
+    "C must be row-major");
+  C.resize(F.rows()*3,X.cols());
+  per_corner(X,F,type,C.data());
+}
+
+#ifdef IGL_STATIC_LIBRARY
+// Explicit template instantiation
+template void igl::per_corner<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, float>(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, igl::PerCornerSourceType, float*);
+template void igl::per_corner<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<float, -1, -1, 1, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, igl::PerCornerSourceType, Eigen::PlainObjectBase<Eigen::Matrix<float, -1, -1, 1, -1, -1> >&);
+#endif
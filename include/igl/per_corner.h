@@ -0,0 +1,57 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_PER_CORNER_H
+#define IGL_PER_CORNER_H
+#include "igl_inline.h"
+#include <Eigen/Core>
+namespace igl
+{
+  enum PerCornerSourceType
+  {
+    // Corner c of face f takes row F(f,c) of X
+    PER_CORNER_SOURCE_TYPE_VERTEX = 0,
+    // Corner c of face f takes row f of X
+    PER_CORNER_SOURCE_TYPE_FACE = 1,
+    // Corner c of face f takes row 3*f+c of X
+    PER_CORNER_SOURCE_TYPE_CORNER = 2,
+    NUM_PER_CORNER_SOURCE_TYPE = 3
+  };
+  // Expand per-vertex, per-face or per-corner values to one row per triangle
+  // corner (row 3*f+c for corner c of face f), e.g. to build the vertex
+  // buffers of a mesh drawn with flat shading or seams. Runs in parallel and
+  // writes the converted values directly to the output memory.
+  //
+  // Inputs:
+  //   X  #X by dim list of values
+  //   F  #F by 3 list of triangle indices into rows of X (only used for
+  //     PER_CORNER_SOURCE_TYPE_VERTEX, but determines #F for all types)
+  //   type  which rows of X the corners take
+  // Outputs:
+  //   C  pointer to #F*3*dim values, written as a row-major #F*3 by dim
+  //     matrix (e.g. memory of a mapped OpenGL buffer)
+  //
+  // See also: per_vertex_normals, per_corner_normals
+  template <typename DerivedX, typename DerivedF, typename Scalar>
+  IGL_INLINE void per_corner(
+    const Eigen::MatrixBase<DerivedX> & X,
+    const Eigen::MatrixBase<DerivedF> & F,
+    const PerCornerSourceType type,
+    Scalar * C);
+  // Outputs:
+  //   C  #F*3 by dim row-major matrix, only reallocated if its size changes
+  template <typename DerivedX, typename DerivedF, typename DerivedC>
+  IGL_INLINE void per_corner(
+    const Eigen::MatrixBase<DerivedX> & X,
+    const Eigen::MatrixBase<DerivedF> & F,
+    const PerCornerSourceType type,
+    Eigen::PlainObjectBase<DerivedC> & C);
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "per_corner.cpp"
+#endif
+
+#endif
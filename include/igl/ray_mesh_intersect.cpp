@@ -6,11 +6,8 @@
 // v. 2.0. If a copy of the MPL was not distributed with this file, You can
 // obtain one at http://mozilla.org/MPL/2.0/.
 #include "ray_mesh_intersect.h"
-
-extern "C"
-{
-#include "raytri.c"
-}
+#include "FlatAABB.h"
+#include "ray_triangle_intersect.h"
 
 template <
   typename Derivedsource,
@@ -26,24 +23,21 @@ IGL_INLINE bool igl::ray_mesh_intersect(
 {
   using namespace Eigen;
   using namespace std;
-  // Should be but can't be const
-  Vector3d s_d = s.template cast<double>();
-  Vector3d dir_d = dir.template cast<double>();
+  const Vector3d s_d = s.template cast<double>();
+  const Vector3d dir_d = dir.template cast<double>();
   hits.clear();
   hits.reserve(F.rows());
 
   // loop over all triangles
   for(int f = 0;f<F.rows();f++)
   {
-    // Should be but can't be const
-    RowVector3d v0 = V.row(F(f,0)).template cast<double>();
-    RowVector3d v1 = V.row(F(f,1)).template cast<double>();
-    RowVector3d v2 = V.row(F(f,2)).template cast<double>();
+    const RowVector3d v0 = V.row(F(f,0)).template cast<double>();
+    const RowVector3d v1 = V.row(F(f,1)).template cast<double>();
+    const RowVector3d v2 = V.row(F(f,2)).template cast<double>();
     // shoot ray, record hit
     double t,u,v;
-    if(intersect_triangle1(
-      s_d.data(), dir_d.data(), v0.data(), v1.data(), v2.data(), &t, &u, &v) &&
-      t>0)
+    if(ray_triangle_intersect(
+      s_d.data(), dir_d.data(), v0.data(), v1.data(), v2.data(), t, u, v))
     {
       hits.push_back({(int)f,(int)-1,(float)u,(float)v,(float)t});
     }
@@ -80,6 +74,48 @@ IGL_INLINE bool igl::ray_mesh_intersect(
   }
 }
 
+template <
+  typename Derivedsource,
+  typename Deriveddir,
+  typename DerivedV,
+  typename DerivedF>
+IGL_INLINE bool igl::ray_mesh_intersect(
+  const Eigen::MatrixBase<Derivedsource> & source,
+  const Eigen::MatrixBase<Deriveddir> & dir,
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedF> & F,
+  const igl::FlatAABB<DerivedV,3> & tree,
+  std::vector<igl::Hit> & hits)
+{
+  typedef typename igl::FlatAABB<DerivedV,3>::RowVectorDIMS RowVector3S;
+  return tree.intersect_ray(
+    V,F,
+    RowVector3S(source.template cast<typename DerivedV::Scalar>()),
+    RowVector3S(dir.template cast<typename DerivedV::Scalar>()),
+    hits);
+}
+
+template <
+  typename Derivedsource,
+  typename Deriveddir,
+  typename DerivedV,
+  typename DerivedF>
+IGL_INLINE bool igl::ray_mesh_intersect(
+  const Eigen::MatrixBase<Derivedsource> & source,
+  const Eigen::MatrixBase<Deriveddir> & dir,
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedF> & F,
+  const igl::FlatAABB<DerivedV,3> & tree,
+  igl::Hit & hit)
+{
+  typedef typename igl::FlatAABB<DerivedV,3>::RowVectorDIMS RowVector3S;
+  return tree.intersect_ray(
+    V,F,
+    RowVector3S(source.template cast<typename DerivedV::Scalar>()),
+    RowVector3S(dir.template cast<typename DerivedV::Scalar>()),
+    hit);
+}
+
 #ifdef IGL_STATIC_LIBRARY
 // Explicit template instantiation
 // generated by autoexplicit.sh
@@ -87,4 +123,6 @@ template bool igl::ray_mesh_intersect<Eigen::Matrix<float, 3, 1, 0, 3, 1>, Eigen
 template bool igl::ray_mesh_intersect<Eigen::Matrix<float, 3, 1, 0, 3, 1>, Eigen::Matrix<float, 3, 1, 0, 3, 1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<float, 3, 1, 0, 3, 1> > const&, Eigen::MatrixBase<Eigen::Matrix<float, 3, 1, 0, 3, 1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, std::vector<igl::Hit, std::allocator<igl::Hit> >&);
 template bool igl::ray_mesh_intersect<Eigen::Matrix<float, 3, 1, 0, 3, 1>, Eigen::Matrix<float, 3, 1, 0, 3, 1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<float, 3, 1, 0, 3, 1> > const&, Eigen::MatrixBase<Eigen::Matrix<float, 3, 1, 0, 3, 1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, igl::Hit&);
 template bool igl::ray_mesh_intersect<Eigen::Matrix<double, 1, 3, 1, 1, 3>, Eigen::Matrix<double, 1, 3, 1, 1, 3>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Block<Eigen::Matrix<int, -1, -1, 0, -1, -1> const, 1, -1, false> >(Eigen::MatrixBase<Eigen::Matrix<double, 1, 3, 1, 1, 3> > const&, Eigen::MatrixBase<Eigen::Matrix<double, 1, 3, 1, 1, 3> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Block<Eigen::Matrix<int, -1, -1, 0, -1, -1> const, 1, -1, false> > const&, igl::Hit&);
+template bool igl::ray_mesh_intersect<Eigen::Matrix<float, 3, 1, 0, 3, 1>, Eigen::Matrix<float, 3, 1, 0, 3, 1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<float, 3, 1, 0, 3, 1> > const&, Eigen::MatrixBase<Eigen::Matrix<float, 3, 1, 0, 3, 1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, igl::FlatAABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3> const&, std::vector<igl::Hit, std::allocator<igl::Hit> >&);
+template bool igl::ray_mesh_intersect<Eigen::Matrix<float, 3, 1, 0, 3, 1>, Eigen::Matrix<float, 3, 1, 0, 3, 1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(Eigen::MatrixBase<Eigen::Matrix<float, 3, 1, 0, 3, 1> > const&, Eigen::MatrixBase<Eigen::Matrix<float, 3, 1, 0, 3, 1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, igl::FlatAABB<Eigen::Matrix<double, -1, -1, 0, -1, -1>, 3> const&, igl::Hit&);
 #endif
@@ -13,6 +13,7 @@
 #include <vector>
 namespace igl
 {
+  template <typename DerivedV, int DIM> class FlatAABB;
   // Shoot a ray against a mesh (V,F) and collect all hits.
   //
   // Inputs:
@@ -49,6 +50,35 @@ namespace igl
     const Eigen::MatrixBase<DerivedV> & V,
     const Eigen::MatrixBase<DerivedF> & F,
     igl::Hit & hit);
+  // Shoot a ray through a prebuilt bounding volume hierarchy of (V,F) instead
+  // of testing every face, e.g. for picking on large meshes.
+  //
+  // Inputs:
+  //   tree  hierarchy built with tree.init(V,F)
+  template <
+    typename Derivedsource,
+    typename Deriveddir,
+    typename DerivedV, 
+    typename DerivedF> 
+  IGL_INLINE bool ray_mesh_intersect(
+    const Eigen::MatrixBase<Derivedsource> & source,
+    const Eigen::MatrixBase<Deriveddir> & dir,
+    const Eigen::MatrixBase<DerivedV> & V,
+    const Eigen::MatrixBase<DerivedF> & F,
+    const igl::FlatAABB<DerivedV,3> & tree,
+    std::vector<igl::Hit> & hits);
+  template <
+    typename Derivedsource,
+    typename Deriveddir,
+    typename DerivedV, 
+    typename DerivedF> 
+  IGL_INLINE bool ray_mesh_intersect(
+    const Eigen::MatrixBase<Derivedsource> & source,
+    const Eigen::MatrixBase<Deriveddir> & dir,
+    const Eigen::MatrixBase<DerivedV> & V,
+    const Eigen::MatrixBase<DerivedF> & F,
+    const igl::FlatAABB<DerivedV,3> & tree,
+    igl::Hit & hit);
 }
 #ifndef IGL_STATIC_LIBRARY
 #  include "ray_mesh_intersect.cpp"
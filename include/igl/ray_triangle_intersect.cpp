@@ -0,0 +1,76 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "ray_triangle_intersect.h"
+#include <cmath>
+#include <utility>
+
+IGL_INLINE bool igl::ray_triangle_intersect(
+  const double source[3],
+  const double dir[3],
+  const double v0[3],
+  const double v1[3],
+  const double v2[3],
+  double & t,
+  double & u,
+  double & v)
+{
+  // Dominant axis of the ray becomes z, keeping the winding
+  int kz = 0;
+  for(int c = 1;c<3;c++)
+  {
+    if(std::abs(dir[c]) > std::abs(dir[kz]))
+    {
+      kz = c;
+    }
+  }
+  if(dir[kz] == 0)
+  {
+    return false;
+  }
+  int kx = (kz+1)%3;
+  int ky = (kx+1)%3;
+  if(dir[kz] < 0)
+  {
+    std::swap(kx,ky);
+  }
+  // Shear taking the ray to the z-axis
+  const double Sx = dir[kx]/dir[kz];
+  const double Sy = dir[ky]/dir[kz];
+  const double Sz = 1./dir[kz];
+  const double A[3] = {v0[0]-source[0],v0[1]-source[1],v0[2]-source[2]};
+  const double B[3] = {v1[0]-source[0],v1[1]-source[1],v1[2]-source[2]};
+  const double C[3] = {v2[0]-source[0],v2[1]-source[1],v2[2]-source[2]};
+  const double Ax = A[kx]-Sx*A[kz];
+  const double Ay = A[ky]-Sy*A[kz];
+  const double Bx = B[kx]-Sx*B[kz];
+  const double By = B[ky]-Sy*B[kz];
+  const double Cx = C[kx]-Sx*C[kz];
+  const double Cy = C[ky]-Sy*C[kz];
+  // Scaled barycentric coordinates, the ray passes inside when they agree
+  // in sign (zero on an edge)
+  const double U = Cx*By-Cy*Bx;
+  const double V = Ax*Cy-Ay*Cx;
+  const double W = Bx*Ay-By*Ax;
+  if((U<0 || V<0 || W<0) && (U>0 || V>0 || W>0))
+  {
+    return false;
+  }
+  const double det = U+V+W;
+  if(det == 0)
+  {
+    return false;
+  }
+  const double T = U*Sz*A[kz] + V*Sz*B[kz] + W*Sz*C[kz];
+  const double t_hit = T/det;
+  if(!(t_hit > 0))
+  {
+    return false;
+  }
+  t = t_hit;
+  u = V/det;
+  v = W/det;
+  return true;
+}
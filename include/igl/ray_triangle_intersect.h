@@ -0,0 +1,43 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_RAY_TRIANGLE_INTERSECT_H
+#define IGL_RAY_TRIANGLE_INTERSECT_H
+#include "igl_inline.h"
+namespace igl
+{
+  // Intersect a ray with a triangle (either side), watertight: a ray through
+  // an edge or vertex shared by several triangles hits at least one of them.
+  //
+  // The triangle is transformed to a space where the ray runs along the z-axis
+  // from the origin, so that the edge tests are 2D cross products computed the
+  // same way for both triangles sharing an edge ("Watertight Ray/Triangle
+  // Intersection", Woop et al. 2013).
+  //
+  // Inputs:
+  //   source  3-vector origin of ray
+  //   dir  3-vector direction of ray
+  //   v0  3-vector first corner of triangle
+  //   v1  3-vector second corner of triangle
+  //   v2  3-vector third corner of triangle
+  // Outputs:
+  //   t  distance so that the hit is at source + t*dir, set only on hit
+  //   u  barycentric coordinate of v1 at the hit, set only on hit
+  //   v  barycentric coordinate of v2 at the hit, set only on hit
+  // Returns true if the ray hits the triangle at t > 0
+  IGL_INLINE bool ray_triangle_intersect(
+    const double source[3],
+    const double dir[3],
+    const double v0[3],
+    const double v1[3],
+    const double v2[3],
+    double & t,
+    double & u,
+    double & v);
+}
+#ifndef IGL_STATIC_LIBRARY
+#  include "ray_triangle_intersect.cpp"
+#endif
+#endif
@@ -235,6 +235,220 @@ IGL_INLINE bool igl::readMESH(
 
 #include <Eigen/Core>
 #include "list_to_matrix.h"
+#include "MappedFile.h"
+#include "parallel_for_lines.h"
+#include "parse_number.h"
+#include <climits>
+#include <cstring>
+#include <string>
+
+// Parallel reader of the Eigen wrapper taking a file name: the file is
+// memory mapped, the keywords and counts are read in order, and the records
+// of each section (one per line) are parsed in parallel straight into the
+// outputs. Anything it does not reproduce exactly (records spanning lines,
+// unusual number formats, comments inside sections, ...) makes it give up,
+// and the reader of an opened FILE below handles the file instead.
+namespace igl
+{
+  namespace readMESH_detail
+  {
+    inline bool is_space(const char c)
+    {
+      return c==' ' || c=='\t' || c=='\n' || c=='\r' || c=='\v' || c=='\f';
+    }
+
+    inline const char * skip_space(const char * p, const char * end)
+    {
+      while(p < end && is_space(*p)) p++;
+      return p;
+    }
+
+    // Parse an int followed by whitespace or the end, like fscanf(" %d")
+    inline const char * parse_int(const char * p, const char * end, int & x)
+    {
+      long l;
+      p = igl::parse_number(skip_space(p, end), end, l);
+      if(p == NULL || (p < end && !is_space(*p)) || l < INT_MIN || l > INT_MAX)
+      {
+        return NULL;
+      }
+      x = int(l);
+      return p;
+    }
+
+    // Parse a line of exactly k numbers, the first k_double of them doubles
+    // and the rest ints
+    inline bool parse_record(
+      const char * p,
+      const char * end,
+      const int k_double,
+      const int k,
+      double * x,
+      int * a)
+    {
+      for(int j = 0;j<k;j++)
+      {
+        if(j < k_double)
+        {
+          p = igl::parse_number(skip_space(p, end), end, x[j]);
+          if(p == NULL || (p < end && !is_space(*p)))
+          {
+            return false;
+          }
+        }else if((p = parse_int(p, end, a[j-k_double])) == NULL)
+        {
+          return false;
+        }
+      }
+      return skip_space(p, end) == end;
+    }
+
+    // Skip lines starting with '#' or empty like the comment loops of the
+    // FILE reader, and check the first word of the next line. The value
+    // after the keyword (if requested) is read from the same line or else
+    // from the following text.
+    inline bool keyword(
+      const char *& p,
+      const char * end,
+      const char * name,
+      int * value)
+    {
+      const char * line;
+      do
+      {
+        if(p == end)
+        {
+          return false;
+        }
+        line = p;
+        const char * eol = static_cast<const char *>(memchr(p, '\n', end - p));
+        p = eol ? eol + 1 : end;
+      }while(line[0] == '#' || line[0] == '\n');
+      const char * word = skip_space(line, p);
+      const char * word_end = word;
+      while(word_end < p && !is_space(*word_end)) word_end++;
+      if(std::string(word, word_end) != name)
+      {
+        return false;
+      }
+      if(value == NULL)
+      {
+        return true;
+      }
+      const char * q = parse_int(word_end, p, *value);
+      if(q == NULL)
+      {
+        // Anything but whitespace after the keyword is left to the FILE
+        // reader
+        if(skip_space(word_end, p) != p || (p = parse_int(p, end, *value)) == NULL)
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Read the count of a section, call resize(count) and then set(i,x,a)
+    // for each record of k_double doubles x and then ints a.
+    template <typename ResizeType, typename SetType>
+    inline bool section(
+      const char *& p,
+      const char * end,
+      const char * name,
+      const int max_count,
+      const int k_double,
+      const int k,
+      const ResizeType & resize,
+      const SetType & set)
+    {
+      int count;
+      if(!keyword(p, end, name, NULL) ||
+        (p = parse_int(p, end, count)) == NULL ||
+        count < 0 || count > max_count)
+      {
+        return false;
+      }
+      resize(count);
+      if(count == 0)
+      {
+        return true;
+      }
+      // Rest of the line of the count
+      const char * first = skip_space(p, end);
+      const char * line = p;
+      while(line < first && *line != '\n') line++;
+      if(line == first)
+      {
+        return false;
+      }
+      const char * last = igl::parallel_for_lines(line + 1, end, count,
+        [&](const size_t i, const char * l, const char * e)
+        {
+          double x[3];
+          int a[5];
+          if(!parse_record(l, e, k_double, k, x, a))
+          {
+            return false;
+          }
+          set(i, x, a);
+          return true;
+        });
+      if(last == NULL)
+      {
+        return false;
+      }
+      // Back to just past the last number: the FILE reader continues there
+      if(last[-1] == '\n') last--;
+      while(last > line && is_space(last[-1])) last--;
+      p = last;
+      return true;
+    }
+
+    template <typename DerivedV, typename DerivedF, typename DerivedT>
+    IGL_INLINE bool read(
+      const std::string & mesh_file_name,
+      Eigen::PlainObjectBase<DerivedV>& V,
+      Eigen::PlainObjectBase<DerivedT>& T,
+      Eigen::PlainObjectBase<DerivedF>& F)
+    {
+      igl::MappedFile file;
+      if(!file.open(mesh_file_name) || file.size() == 0)
+      {
+        return false;
+      }
+      const char * p = file.data();
+      const char * end = p + file.size();
+      int one = -1, three = -1;
+      if(!keyword(p, end, "MeshVersionFormatted", &one) || one != 1 ||
+        !keyword(p, end, "Dimension", &three) || three != 3)
+      {
+        return false;
+      }
+      typedef typename DerivedV::Scalar Scalar;
+      typedef typename DerivedT::Scalar TIndex;
+      typedef typename DerivedF::Scalar FIndex;
+      return
+        section(p, end, "Vertices", 1000000000, 3, 4,
+          [&V](const int n){ V.resize(n,3); },
+          [&V](const size_t i, const double * x, const int *)
+          {
+            for(int j = 0;j<3;j++) V(i,j) = Scalar(x[j]);
+          }) &&
+        section(p, end, "Triangles", INT_MAX, 0, 4,
+          [&F](const int n){ F.resize(n,3); },
+          [&F](const size_t i, const double *, const int * a)
+          {
+            for(int j = 0;j<3;j++) F(i,j) = FIndex(a[j]-1);
+          }) &&
+        section(p, end, "Tetrahedra", INT_MAX, 0, 5,
+          [&T](const int n){ T.resize(n,4); },
+          [&T](const size_t i, const double *, const int * a)
+          {
+            for(int j = 0;j<4;j++) T(i,j) = TIndex(a[j]-1);
+          });
+    }
+  }
+}
 
 
 template <typename DerivedV, typename DerivedF, typename DerivedT>
@@ -245,6 +459,10 @@ IGL_INLINE bool igl::readMESH(
   Eigen::PlainObjectBase<DerivedF>& F)
 {
   using namespace std;
+  if(readMESH_detail::read(mesh_file_name,V,T,F))
+  {
+    return true;
+  }
   FILE * mesh_file = fopen(mesh_file_name.c_str(),"r");
   if(NULL==mesh_file)
   {
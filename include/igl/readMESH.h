@@ -47,6 +47,10 @@ namespace igl
     std::vector<std::vector<Index > > & T,
     std::vector<std::vector<Index > > & F);
 
+  // The file is memory mapped and the records of each section are parsed
+  // in parallel (falling back to reading the opened file below if the
+  // records are not one per line).
+  //
   // Input:
   //   mesh_file_name  path of .mesh file
   // Outputs:
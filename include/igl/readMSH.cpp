@@ -1,506 +1,821 @@
-
 // This file is part of libigl, a simple c++ geometry processing library.
-// 
+//
 // Copyright (C) 2018 Alec Jacobson <alecjacobson@gmail.com>
-// 
-// This Source Code Form is subject to the terms of the Mozilla Public License 
-// v. 2.0. If a copy of the MPL was not distributed with this file, You can 
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
 // obtain one at http://mozilla.org/MPL/2.0/.
 //
 #include "readMSH.h"
+#include "MappedFile.h"
+#include "parallel_for.h"
+#include "parallel_for_lines.h"
+#include "parse_number.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
-#include <sstream>
-#include <fstream>
+#include <type_traits>
 #include <vector>
-#include <map>
 
-template <
-  typename DerivedV,
-  typename DerivedT>
-IGL_INLINE bool igl::readMSH(
-  const std::string & filename,
-  Eigen::PlainObjectBase<DerivedV> & V,
-  Eigen::PlainObjectBase<DerivedT> & T)
+// The file is memory mapped. Records of ASCII sections (one per line) are
+// parsed in parallel with parallel_for_lines, records of binary sections
+// have fixed sizes and are copied in parallel, node coordinates with a
+// single memcpy where the layouts agree.
+namespace igl
 {
-  // https://github.com/Yixin-Hu/TetWild/blob/master/pymesh/MshSaver.cpp
-  // Original copyright: /* This file is part of PyMesh. Copyright (c) 2015 by Qingnan Zhou */
-  typedef typename DerivedV::Scalar Float;
-  typedef Eigen::Matrix<Float,Eigen::Dynamic,1> VectorF;
-  typedef Eigen::Matrix<int,Eigen::Dynamic,1> VectorI;
-  typedef std::map<std::string, VectorF> FieldMap;
-  typedef std::vector<std::string> FieldNames;
-  VectorF m_nodes;
-  VectorI m_elements;
-  FieldMap m_node_fields;
-  FieldMap m_element_fields;
-
-  bool m_binary;
-  size_t m_data_size;
-  size_t m_nodes_per_element;
-  size_t m_element_type;
-  std::ifstream fin(filename.c_str(), std::ios::in | std::ios::binary);
-  if (!fin.is_open())
+  namespace readMSH_detail
   {
-    std::stringstream err_msg;
-    err_msg << "failed to open file \"" << filename << "\"";
-    return false;
-  }
-  // Parse header
-  std::string buf;
-  double version;
-  int type;
-  fin >> buf;
-  const auto invalid_format = []()->bool
-  {
-    assert(false && "Invalid format");
-    return false;
-  };
-  const auto not_implemented = []()->bool
-  {
-    assert(false && "Not implemented");
-    return false;
-  };
-  if (buf != "$MeshFormat") { return invalid_format(); }
+    inline bool is_space(const char c)
+    {
+      return c==' ' || c=='\t' || c=='\n' || c=='\r' || c=='\v' || c=='\f';
+    }
 
-  fin >> version >> type >> m_data_size;
-  m_binary = (type == 1);
+    inline const char * skip_space(const char * p, const char * end)
+    {
+      while(p < end && is_space(*p)) p++;
+      return p;
+    }
 
-  // Some sanity check.
-  if (m_data_size != 8) {
-      std::cerr << "Error: data size must be 8 bytes." << std::endl;
-      return not_implemented();
-  }
-  if (sizeof(int) != 4) {
-      std::cerr << "Error: code must be compiled with int size 4 bytes." << std::endl;
-      return not_implemented();
-  }
-  const auto eat_white_space = [](std::ifstream& fin)
-  {
-    char next = fin.peek();
-    while (next == '\n' || next == ' ' || next == '\t' || next == '\r') 
+    // Next whitespace separated word
+    inline std::string word(const char *& p, const char * end)
     {
-      fin.get();
-      next = fin.peek();
+      p = skip_space(p, end);
+      const char * w = p;
+      while(p < end && !is_space(*p)) p++;
+      return std::string(w, p);
     }
-  };
 
-  // Read in extra info from binary header.
-  if (m_binary) {
-      int one;
-      eat_white_space(fin);
-      fin.read(reinterpret_cast<char*>(&one), sizeof(int));
-      if (one != 1) {
-          std::cerr << "Warning: binary msh file " << filename
-              << " is saved with different endianness than this machine."
-              << std::endl;
-          return not_implemented();
+    // Next whitespace separated number (double or long)
+    template <typename T>
+    inline bool number(const char *& p, const char * end, T & x)
+    {
+      const char * q = igl::parse_number(skip_space(p, end), end, x);
+      if(q == NULL || (q < end && !is_space(*q)))
+      {
+        return false;
       }
-  }
-
-  fin >> buf;
-  if (buf != "$EndMeshFormat") { return not_implemented(); }
-
-  const auto num_nodes_per_elem_type = [](int elem_type)->int 
-  {
-    size_t nodes_per_element = 0;
-    switch (elem_type) {
-        case 2:
-            nodes_per_element = 3; // Triangle
-            break;
-        case 3:
-            nodes_per_element = 4; // Quad
-            break;
-        case 4:
-            nodes_per_element = 4; // Tet
-            break;
-        case 5:
-            nodes_per_element = 8; // hexahedron
-            break;
-        default:
-            assert(false && "not implemented");
-            nodes_per_element = -1;
-            break;
+      p = q;
+      return true;
     }
-    return nodes_per_element;
-  };
-
-  const auto parse_nodes = [&](std::ifstream& fin) 
-  {
-    size_t num_nodes;
-    fin >> num_nodes;
-    m_nodes.resize(num_nodes*3);
-
-    if (m_binary) {
-        size_t num_bytes = (4+3*m_data_size) * num_nodes;
-        char* data = new char[num_bytes];
-        eat_white_space(fin);
-        fin.read(data, num_bytes);
 
-        for (size_t i=0; i<num_nodes; i++) {
-            int node_idx          = *reinterpret_cast<int*>  (&data[i*(4+3*m_data_size)]) - 1;
-            m_nodes[node_idx*3]   = *reinterpret_cast<Float*>(&data[i*(4+3*m_data_size) + 4]);
-            m_nodes[node_idx*3+1] = *reinterpret_cast<Float*>(&data[i*(4+3*m_data_size) + 4 + m_data_size]);
-            m_nodes[node_idx*3+2] = *reinterpret_cast<Float*>(&data[i*(4+3*m_data_size) + 4 + 2*m_data_size]);
-        }
-
-        delete [] data;
-    } else {
-        int node_idx;
-        for (size_t i=0; i<num_nodes; i++) {
-            fin >> node_idx;
-            node_idx -= 1;
-            fin >> m_nodes[node_idx*3]
-                >> m_nodes[node_idx*3+1]
-                >> m_nodes[node_idx*3+2];
+    // Next k non-negative integers
+    inline bool counts(const char *& p, const char * end, long * x, const int k)
+    {
+      for(int j = 0;j<k;j++)
+      {
+        if(!number(p, end, x[j]) || x[j] < 0)
+        {
+          return false;
         }
+      }
+      return true;
     }
-  };
-
-  const auto parse_elements = [&](std::ifstream& fin) 
-  {
-    size_t num_elements;
-    fin >> num_elements;
-
-    // Tmp storage of elements;
-    std::vector<int> triangle_element_idx;
-    std::vector<int> triangle_elements;
-    std::vector<int> quad_element_idx;
-    std::vector<int> quad_elements;
-    std::vector<int> tet_element_idx;
-    std::vector<int> tet_elements;
-    std::vector<int> hex_element_idx;
-    std::vector<int> hex_elements;
-
-    auto get_element_storage = [&](int elem_type) -> std::vector<int>* {
-        switch (elem_type) {
-            default:
-                assert(false && "Unsupported element type encountered");
-            case 2:
-                return &triangle_elements;
-            case 3:
-                return &quad_elements;
-            case 4:
-                return &tet_elements;
-            case 5:
-                return &hex_elements;
-        };
-    };
-
-    auto get_element_idx_storage = [&](int elem_type) -> std::vector<int>* {
-        switch (elem_type) {
-            default:
-                assert(false && "Unsupported element type encountered");
-            case 2:
-                return &triangle_element_idx;
-            case 3:
-                return &quad_element_idx;
-            case 4:
-                return &tet_element_idx;
-            case 5:
-                return &hex_element_idx;
-        };
-    };
-
-    size_t nodes_per_element;
-    int glob_elem_type = -1;
-
-
-  if (m_binary) 
-  {
-    eat_white_space(fin);
-    int elem_read = 0;
-    while (elem_read < num_elements) {
-        // Parse element header.
-        int elem_type, num_elems, num_tags;
-        fin.read((char*)&elem_type, sizeof(int));
-        fin.read((char*)&num_elems, sizeof(int));
-        fin.read((char*)&num_tags, sizeof(int));
-        nodes_per_element = num_nodes_per_elem_type(elem_type);
-        std::vector<int>& elements = *get_element_storage(elem_type);
-        std::vector<int>& element_idx = *get_element_idx_storage(elem_type);
-
-        for (size_t i=0; i<num_elems; i++) {
-            int elem_idx;
-            fin.read((char*)&elem_idx, sizeof(int));
-            elem_idx -= 1;
-            element_idx.push_back(elem_idx);
 
-            // Eat up tags.
-            for (size_t j=0; j<num_tags; j++) {
-                int tag;
-                fin.read((char*)&tag, sizeof(int));
-            }
-
-            // Element values.
-            for (size_t j=0; j<nodes_per_element; j++) {
-                int idx;
-                fin.read((char*)&idx, sizeof(int));
-                elements.push_back(idx-1);
-            }
+    // Pointer past the end of the current line, NULL if anything but
+    // whitespace is left on it
+    inline const char * line_after(const char * p, const char * end)
+    {
+      for(;p < end && *p != '\n';p++)
+      {
+        if(!is_space(*p))
+        {
+          return NULL;
         }
+      }
+      return p < end ? p + 1 : p;
+    }
 
-        elem_read += num_elems;
+    template <typename T>
+    inline T get(const char * p)
+    {
+      T x;
+      std::memcpy(&x, p, sizeof(T));
+      return x;
     }
-  } else 
-  {
-        for (size_t i=0; i<num_elements; i++) {
-            // Parse per element header
-            int elem_num, elem_type, num_tags;
-            fin >> elem_num >> elem_type >> num_tags;
-            for (size_t j=0; j<num_tags; j++) {
-                int tag;
-                fin >> tag;
-            }
-            nodes_per_element = num_nodes_per_elem_type(elem_type);
-            std::vector<int>& elements = *get_element_storage(elem_type);
-            std::vector<int>& element_idx = *get_element_idx_storage(elem_type);
 
-            elem_num -= 1;
-            element_idx.push_back(elem_num);
+    // Number of nodes of an element type, -1 if unknown
+    inline int nodes_per_element(const long type)
+    {
+      switch(type)
+      {
+        case 1: return 2; // line
+        case 2: return 3; // triangle
+        case 3: return 4; // quadrangle
+        case 4: return 4; // tetrahedron
+        case 5: return 8; // hexahedron
+        case 6: return 6; // prism
+        case 7: return 5; // pyramid
+        case 8: return 3; // second order line
+        case 9: return 6; // second order triangle
+        case 10: return 9; // second order quadrangle
+        case 11: return 10; // second order tetrahedron
+        case 12: return 27; // second order hexahedron
+        case 13: return 18; // second order prism
+        case 14: return 14; // second order pyramid
+        case 15: return 1; // point
+        case 16: return 8; // 8-node quadrangle
+        case 17: return 20; // 20-node hexahedron
+        case 18: return 15; // 15-node prism
+        case 19: return 13; // 13-node pyramid
+        default: return -1;
+      }
+    }
 
-            // Parse node idx.
-            for (size_t j=0; j<nodes_per_element; j++) {
-                int idx;
-                fin >> idx;
-                elements.push_back(idx-1); // msh index starts from 1.
-            }
+    // The elements output: all tetrahedra, or else all hexahedra, triangles
+    // or quadrangles (in this order), given the number of elements of types
+    // 0..5. Triangle if there are none.
+    inline long output_type(const std::size_t * count)
+    {
+      const long types[] = {4, 5, 2, 3};
+      for(const long type : types)
+      {
+        if(count[type] > 0)
+        {
+          return type;
         }
+      }
+      return 2;
     }
 
-    auto copy_to_array = [&](
-            const std::vector<int>& elements,
-            const int nodes_per_element) {
-        const size_t num_elements = elements.size() / nodes_per_element;
-        if (elements.size() % nodes_per_element != 0) {
-            assert(false && "parsing element failed");
-            return;
+    // Nodes are numbered by their tags: row tag-1 if the tags are 1..#V,
+    // else rows in the order of the file
+    struct NodeRows
+    {
+      std::size_t num_nodes;
+      // Row of each tag if not 1..#V
+      std::vector<long> index;
+      NodeRows():num_nodes(0){}
+      long row(const long tag) const
+      {
+        if(index.empty())
+        {
+          return (tag >= 1 && std::size_t(tag) <= num_nodes) ? tag - 1 : -1;
         }
-        m_elements.resize(elements.size());
-        std::copy(elements.begin(), elements.end(), m_elements.data());
-        m_nodes_per_element = nodes_per_element;
+        return (tag >= 0 && std::size_t(tag) < index.size()) ? index[tag] : -1;
+      }
     };
 
-    if (!tet_elements.empty()) {
-        copy_to_array(tet_elements, 4);
-        m_element_type = 4;
-    } else if (!hex_elements.empty()) {
-        copy_to_array(hex_elements, 8);
-        m_element_type = 5;
-    } else if (!triangle_elements.empty()) {
-        copy_to_array(triangle_elements, 3);
-        m_element_type = 2;
-    } else if (!quad_elements.empty()) {
-        copy_to_array(quad_elements, 4);
-        m_element_type = 3;
-    } else {
-        // 0 elements, use triangle by default.
-        m_element_type = 2;
+    // $Nodes of version 2: #V, then #V records of tag x y z
+    template <typename DerivedV>
+    IGL_INLINE bool read_nodes_2(
+      const char *& p,
+      const char * end,
+      const bool binary,
+      Eigen::PlainObjectBase<DerivedV> & V,
+      NodeRows & nodes)
+    {
+      typedef typename DerivedV::Scalar Scalar;
+      long n;
+      if(!counts(p, end, &n, 1) || (p = line_after(p, end)) == NULL)
+      {
+        return false;
+      }
+      nodes.num_nodes = n;
+      nodes.index.clear();
+      V.resize(n, 3);
+      if(binary)
+      {
+        const std::size_t record = sizeof(int) + 3*sizeof(double);
+        if(std::size_t(n) > std::size_t(end - p)/record)
+        {
+          return false;
+        }
+        std::atomic<bool> ok(true);
+        const char * data = p;
+        igl::parallel_for(n, [&](const long i)
+        {
+          const char * r = data + i*record;
+          const long row = nodes.row(get<int>(r));
+          if(row < 0)
+          {
+            ok = false;
+            return;
+          }
+          for(int j = 0;j<3;j++)
+          {
+            V(row,j) = Scalar(get<double>(r + sizeof(int) + j*sizeof(double)));
+          }
+        }, 1000);
+        p += n*record;
+        return ok;
+      }
+      p = igl::parallel_for_lines(p, end, n,
+        [&](const std::size_t, const char * l, const char * e)
+        {
+          long tag;
+          double x[3];
+          if(!number(l, e, tag) ||
+            !number(l, e, x[0]) || !number(l, e, x[1]) || !number(l, e, x[2]) ||
+            skip_space(l, e) != e)
+          {
+            return false;
+          }
+          const long row = nodes.row(tag);
+          if(row < 0)
+          {
+            return false;
+          }
+          for(int j = 0;j<3;j++)
+          {
+            V(row,j) = Scalar(x[j]);
+          }
+          return true;
+        });
+      return p != NULL;
     }
-  };
-  const auto parse_element_field = [&](std::ifstream& fin) 
-  {
-    size_t num_string_tags;
-    size_t num_real_tags;
-    size_t num_int_tags;
 
-    fin >> num_string_tags;
-    std::string* str_tags = new std::string[num_string_tags];
-    for (size_t i=0; i<num_string_tags; i++) {
-        eat_white_space(fin);
-        if (fin.peek() == '\"') {
-            // Handle field name between quoates.
-            char buf[128];
-            fin.get(); // remove the quote at the beginning.
-            fin.getline(buf, 128, '\"');
-            str_tags[i] = std::string(buf);
-        } else {
-            fin >> str_tags[i];
+    // $Nodes of version 4.1: #blocks #V min_tag max_tag, then per entity
+    // block: dim entity parametric #nodes, its #nodes tags and then its
+    // #nodes coordinates (x y z followed by dim parametric coordinates if
+    // parametric)
+    template <typename DerivedV>
+    IGL_INLINE bool read_nodes_4(
+      const char *& p,
+      const char * end,
+      const bool binary,
+      Eigen::PlainObjectBase<DerivedV> & V,
+      NodeRows & nodes)
+    {
+      typedef typename DerivedV::Scalar Scalar;
+      long h[4];
+      if(binary)
+      {
+        if((p = line_after(p, end)) == NULL || std::size_t(end - p) < 4*sizeof(std::uint64_t))
+        {
+          return false;
+        }
+        for(int j = 0;j<4;j++)
+        {
+          h[j] = long(get<std::uint64_t>(p + j*sizeof(std::uint64_t)));
+        }
+        p += 4*sizeof(std::uint64_t);
+      }else if(!counts(p, end, h, 4))
+      {
+        return false;
+      }
+      const long num_blocks = h[0];
+      nodes.num_nodes = h[1];
+      nodes.index.clear();
+      if(h[1] > 0 && !(h[2] == 1 && h[3] == h[1]))
+      {
+        nodes.index.assign(h[3] + 1, -1);
+      }
+      V.resize(h[1], 3);
+      long next_row = 0;
+      for(long b = 0;b<num_blocks;b++)
+      {
+        long dim, parametric, n;
+        if(binary)
+        {
+          const std::size_t header = 3*sizeof(int) + sizeof(std::uint64_t);
+          if(std::size_t(end - p) < header)
+          {
+            return false;
+          }
+          dim = get<int>(p);
+          parametric = get<int>(p + 2*sizeof(int));
+          n = long(get<std::uint64_t>(p + 3*sizeof(int)));
+          p += header;
+        }else
+        {
+          long entity;
+          if(!number(p, end, dim) || !number(p, end, entity) ||
+            !number(p, end, parametric) || !number(p, end, n) ||
+            (p = line_after(p, end)) == NULL)
+          {
+            return false;
+          }
+        }
+        const int cols = 3 + (parametric ? int(dim) : 0);
+        if(n < 0 || n > h[1] - next_row || dim < 0 || dim > 3)
+        {
+          return false;
+        }
+        // Tags, replaced by rows
+        std::vector<long> rows(n);
+        if(binary)
+        {
+          if(std::size_t(n) > std::size_t(end - p)/(sizeof(std::uint64_t) + cols*sizeof(double)))
+          {
+            return false;
+          }
+          for(long k = 0;k<n;k++)
+          {
+            rows[k] = long(get<std::uint64_t>(p + k*sizeof(std::uint64_t)));
+          }
+          p += n*sizeof(std::uint64_t);
+        }else
+        {
+          p = igl::parallel_for_lines(p, end, n,
+            [&](const std::size_t k, const char * l, const char * e)
+            {
+              return number(l, e, rows[k]) && skip_space(l, e) == e;
+            });
+          if(p == NULL)
+          {
+            return false;
+          }
+        }
+        bool contiguous = true;
+        for(long k = 0;k<n;k++)
+        {
+          const long tag = rows[k];
+          if(!nodes.index.empty() && tag >= 0 && std::size_t(tag) < nodes.index.size())
+          {
+            nodes.index[tag] = next_row + k;
+          }
+          rows[k] = nodes.row(tag);
+          if(rows[k] < 0)
+          {
+            return false;
+          }
+          contiguous = contiguous && rows[k] == rows[0] + k;
         }
+        next_row += n;
+        if(binary)
+        {
+          const char * data = p;
+          if(std::is_same<Scalar,double>::value && DerivedV::IsRowMajor &&
+            cols == 3 && contiguous && n > 0)
+          {
+            // Same layout as the rows of V
+            std::memcpy(V.data() + rows[0]*3, data, n*3*sizeof(double));
+          }else
+          {
+            igl::parallel_for(n, [&](const long k)
+            {
+              for(int j = 0;j<3;j++)
+              {
+                V(rows[k],j) = Scalar(get<double>(data + (k*cols + j)*sizeof(double)));
+              }
+            }, 1000);
+          }
+          p += n*cols*sizeof(double);
+        }else
+        {
+          p = igl::parallel_for_lines(p, end, n,
+            [&](const std::size_t k, const char * l, const char * e)
+            {
+              double x[6];
+              for(int j = 0;j<cols;j++)
+              {
+                if(!number(l, e, x[j]))
+                {
+                  return false;
+                }
+              }
+              if(skip_space(l, e) != e)
+              {
+                return false;
+              }
+              for(int j = 0;j<3;j++)
+              {
+                V(rows[k],j) = Scalar(x[j]);
+              }
+              return true;
+            });
+          if(p == NULL)
+          {
+            return false;
+          }
+        }
+      }
+      return next_row == h[1];
     }
 
-    fin >> num_real_tags;
-    Float* real_tags = new Float[num_real_tags];
-    for (size_t i=0; i<num_real_tags; i++)
-        fin >> real_tags[i];
-
-    fin >> num_int_tags;
-    int* int_tags = new int[num_int_tags];
-    for (size_t i=0; i<num_int_tags; i++)
-        fin >> int_tags[i];
+    // Block of elements of one type
+    struct ElementBlock
+    {
+      long type;
+      std::size_t count;
+      // First record: a line for ASCII and bytes for binary files
+      const char * begin;
+      // Tags (version 2) before the nodes of each element
+      long num_tags;
+      // First row in the output if of the output type
+      std::size_t row;
+    };
 
-    if (num_string_tags <= 0 || num_int_tags <= 2) {
-        delete[] str_tags;
-        delete[] real_tags;
-        delete[] int_tags;
-        assert(false && "invalid format");
-        return;
+    // Store the node tags of an element as row of T
+    template <typename DerivedT, typename TagType>
+    inline bool set_element(
+      const NodeRows & nodes,
+      const std::size_t row,
+      const TagType * tags,
+      Eigen::PlainObjectBase<DerivedT> & T)
+    {
+      typedef typename DerivedT::Scalar Index;
+      for(int j = 0;j<T.cols();j++)
+      {
+        const long v = nodes.row(long(tags[j]));
+        if(v < 0)
+        {
+          return false;
+        }
+        T(row,j) = Index(v);
+      }
+      return true;
     }
-    std::string fieldname = str_tags[0];
-    int num_components = int_tags[1];
-    int num_entries = int_tags[2];
-    VectorF field(num_entries * num_components);
-
-    delete [] str_tags;
-    delete [] real_tags;
-    delete [] int_tags;
 
-    if (m_binary) {
-        size_t num_bytes = (num_components * m_data_size + 4) * num_entries;
-        char* data = new char[num_bytes];
-        eat_white_space(fin);
-        fin.read(data, num_bytes);
-        for (size_t i=0; i<num_entries; i++) {
-            int elem_idx = *reinterpret_cast<int*>(&data[i*(4+num_components*m_data_size)]);
-            elem_idx -= 1;
-            size_t base_idx = i*(4+num_components*m_data_size) + 4;
-            for (size_t j=0; j<num_components; j++) {
-                field[elem_idx * num_components + j] = *reinterpret_cast<Float*>(&data[base_idx+j*m_data_size]);
-            }
+    // Output the elements of the output type among blocks
+    template <typename DerivedT>
+    IGL_INLINE bool read_element_blocks(
+      std::vector<ElementBlock> & blocks,
+      const bool binary,
+      const int tag_size,
+      const NodeRows & nodes,
+      const char * end,
+      Eigen::PlainObjectBase<DerivedT> & T)
+    {
+      std::size_t count[6] = {0,0,0,0,0,0};
+      for(ElementBlock & block : blocks)
+      {
+        if(block.type >= 0 && block.type < 6)
+        {
+          block.row = count[block.type];
+          count[block.type] += block.count;
         }
-        delete [] data;
-    } else {
-        int elem_idx;
-        for (size_t i=0; i<num_entries; i++) {
-            fin >> elem_idx;
-            elem_idx -= 1;
-            for (size_t j=0; j<num_components; j++) {
-                fin >> field[elem_idx * num_components + j];
+      }
+      const long type = output_type(count);
+      const int ss = nodes_per_element(type);
+      T.resize(count[type], ss);
+      for(const ElementBlock & block : blocks)
+      {
+        if(block.type != type)
+        {
+          continue;
+        }
+        if(binary)
+        {
+          const std::size_t record = (1 + block.num_tags + ss)*tag_size;
+          const std::size_t first = (1 + block.num_tags)*tag_size;
+          std::atomic<bool> ok(true);
+          igl::parallel_for(block.count, [&](const std::size_t i)
+          {
+            const char * r = block.begin + i*record + first;
+            long tags[8];
+            for(int j = 0;j<ss;j++)
+            {
+              tags[j] = tag_size == sizeof(int) ?
+                long(get<int>(r + j*tag_size)) : long(get<std::uint64_t>(r + j*tag_size));
+            }
+            if(!set_element(nodes, block.row + i, tags, T))
+            {
+              ok = false;
             }
+          }, 1000);
+          if(!ok)
+          {
+            return false;
+          }
+        }else if(igl::parallel_for_lines(block.begin, end, block.count,
+          [&](const std::size_t i, const char * l, const char * e)
+          {
+            long tags[1 + 8];
+            for(int j = 0;j<1+ss;j++)
+            {
+              if(!number(l, e, tags[j]))
+              {
+                return false;
+              }
+            }
+            return skip_space(l, e) == e && set_element(nodes, block.row + i, tags + 1, T);
+          }) == NULL)
+        {
+          return false;
         }
+      }
+      return true;
     }
 
-    m_element_fields[fieldname] = field;
-  };
-
-  const auto parse_node_field = [&](std::ifstream& fin) 
-  {
-    size_t num_string_tags;
-    size_t num_real_tags;
-    size_t num_int_tags;
-
-    fin >> num_string_tags;
-    std::string* str_tags = new std::string[num_string_tags];
-    for (size_t i=0; i<num_string_tags; i++) {
-        eat_white_space(fin);
-        if (fin.peek() == '\"') {
-            // Handle field name between quoates.
-            char buf[128];
-            fin.get(); // remove the quote at the beginning.
-            fin.getline(buf, 128, '\"');
-            str_tags[i] = std::string(buf);
-        } else {
-            fin >> str_tags[i];
+    // $Elements of version 2: #T, then #T records of tag type #tags tags...
+    // nodes... In binary files the records are grouped in blocks of a type,
+    // each preceded by its type, size and #tags.
+    template <typename DerivedT>
+    IGL_INLINE bool read_elements_2(
+      const char *& p,
+      const char * end,
+      const bool binary,
+      const NodeRows & nodes,
+      Eigen::PlainObjectBase<DerivedT> & T)
+    {
+      long n;
+      if(!counts(p, end, &n, 1) || (p = line_after(p, end)) == NULL)
+      {
+        return false;
+      }
+      std::vector<ElementBlock> blocks;
+      if(binary)
+      {
+        for(long read = 0;read < n;)
+        {
+          if(std::size_t(end - p) < 3*sizeof(int))
+          {
+            return false;
+          }
+          ElementBlock block;
+          block.type = get<int>(p);
+          const long count = get<int>(p + sizeof(int));
+          block.num_tags = get<int>(p + 2*sizeof(int));
+          block.begin = p + 3*sizeof(int);
+          const int ss = nodes_per_element(block.type);
+          if(ss < 0 || count <= 0 || count > n - read || block.num_tags < 0)
+          {
+            return false;
+          }
+          const std::size_t record = (1 + block.num_tags + ss)*sizeof(int);
+          block.count = count;
+          if(std::size_t(count) > std::size_t(end - block.begin)/record)
+          {
+            return false;
+          }
+          blocks.push_back(block);
+          p = block.begin + count*record;
+          read += count;
         }
+        return read_element_blocks(blocks, binary, sizeof(int), nodes, end, T);
+      }
+      // ASCII lines of any types: count the types first
+      std::vector<unsigned char> types(n);
+      const char * begin = p;
+      p = igl::parallel_for_lines(p, end, n,
+        [&](const std::size_t i, const char * l, const char * e)
+        {
+          long tag, type;
+          if(!number(l, e, tag) || !number(l, e, type))
+          {
+            return false;
+          }
+          types[i] = (type > 0 && type < 6) ? (unsigned char)type : 0;
+          return true;
+        });
+      if(p == NULL)
+      {
+        return false;
+      }
+      std::size_t count[6] = {0,0,0,0,0,0};
+      for(long i = 0;i<n;i++)
+      {
+        count[types[i]]++;
+      }
+      const long type = output_type(count);
+      const int ss = nodes_per_element(type);
+      T.resize(count[type], ss);
+      // Row of the first line of each run of the output type
+      std::vector<std::pair<std::size_t,std::size_t> > runs;
+      std::size_t row = 0;
+      for(long i = 0;i<n;i++)
+      {
+        if(types[i] == type)
+        {
+          if(i == 0 || types[i-1] != type)
+          {
+            runs.push_back(std::make_pair(std::size_t(i), row));
+          }
+          row++;
+        }
+      }
+      return igl::parallel_for_lines(begin, end, n,
+        [&](const std::size_t i, const char * l, const char * e)
+        {
+          if(types[i] != type)
+          {
+            return true;
+          }
+          long header[3];
+          long tags[8];
+          if(!number(l, e, header[0]) || !number(l, e, header[1]) ||
+            !number(l, e, header[2]) || header[2] < 0)
+          {
+            return false;
+          }
+          for(long j = 0;j<header[2];j++)
+          {
+            if(!number(l, e, tags[0]))
+            {
+              return false;
+            }
+          }
+          for(int j = 0;j<ss;j++)
+          {
+            if(!number(l, e, tags[j]))
+            {
+              return false;
+            }
+          }
+          const auto run = std::upper_bound(runs.begin(), runs.end(),
+            std::make_pair(i, std::size_t(-1))) - 1;
+          return skip_space(l, e) == e &&
+            set_element(nodes, run->second + (i - run->first), tags, T);
+        }) != NULL;
     }
 
-    fin >> num_real_tags;
-    Float* real_tags = new Float[num_real_tags];
-    for (size_t i=0; i<num_real_tags; i++)
-        fin >> real_tags[i];
-
-    fin >> num_int_tags;
-    int* int_tags = new int[num_int_tags];
-    for (size_t i=0; i<num_int_tags; i++)
-        fin >> int_tags[i];
-
-    if (num_string_tags <= 0 || num_int_tags <= 2) {
-        delete[] str_tags;
-        delete[] real_tags;
-        delete[] int_tags;
-        assert(false && "invalid format");
-        return;
-    }
-    std::string fieldname = str_tags[0];
-    int num_components = int_tags[1];
-    int num_entries = int_tags[2];
-    VectorF field(num_entries * num_components);
-
-    delete [] str_tags;
-    delete [] real_tags;
-    delete [] int_tags;
-
-    if (m_binary) {
-        size_t num_bytes = (num_components * m_data_size + 4) * num_entries;
-        char* data = new char[num_bytes];
-        eat_white_space(fin);
-        fin.read(data, num_bytes);
-        for (size_t i=0; i<num_entries; i++) {
-            int node_idx = *reinterpret_cast<int*>(&data[i*(4+num_components*m_data_size)]);
-            node_idx -= 1;
-            size_t base_idx = i*(4+num_components*m_data_size) + 4;
-            for (size_t j=0; j<num_components; j++) {
-                field[node_idx * num_components + j] = *reinterpret_cast<Float*>(&data[base_idx+j*m_data_size]);
-            }
+    // $Elements of version 4.1: #blocks #T min_tag max_tag, then per entity
+    // block: dim entity type #elements and its records of tag nodes...
+    template <typename DerivedT>
+    IGL_INLINE bool read_elements_4(
+      const char *& p,
+      const char * end,
+      const bool binary,
+      const NodeRows & nodes,
+      Eigen::PlainObjectBase<DerivedT> & T)
+    {
+      long h[4];
+      if(binary)
+      {
+        if((p = line_after(p, end)) == NULL || std::size_t(end - p) < 4*sizeof(std::uint64_t))
+        {
+          return false;
         }
-        delete [] data;
-    } else {
-        int node_idx;
-        for (size_t i=0; i<num_entries; i++) {
-            fin >> node_idx;
-            node_idx -= 1;
-            for (size_t j=0; j<num_components; j++) {
-                fin >> field[node_idx * num_components + j];
-            }
+        for(int j = 0;j<4;j++)
+        {
+          h[j] = long(get<std::uint64_t>(p + j*sizeof(std::uint64_t)));
+        }
+        p += 4*sizeof(std::uint64_t);
+      }else if(!counts(p, end, h, 4))
+      {
+        return false;
+      }
+      std::vector<ElementBlock> blocks;
+      long read = 0;
+      for(long b = 0;b<h[0];b++)
+      {
+        ElementBlock block;
+        block.num_tags = 0;
+        long count;
+        if(binary)
+        {
+          const std::size_t header = 3*sizeof(int) + sizeof(std::uint64_t);
+          if(std::size_t(end - p) < header)
+          {
+            return false;
+          }
+          block.type = get<int>(p + 2*sizeof(int));
+          count = long(get<std::uint64_t>(p + 3*sizeof(int)));
+          p += header;
+        }else
+        {
+          long dim, entity;
+          if(!number(p, end, dim) || !number(p, end, entity) ||
+            !number(p, end, block.type) || !number(p, end, count) ||
+            (p = line_after(p, end)) == NULL)
+          {
+            return false;
+          }
         }
+        if(count < 0 || count > h[1] - read)
+        {
+          return false;
+        }
+        block.count = count;
+        block.begin = p;
+        if(binary)
+        {
+          const int ss = nodes_per_element(block.type);
+          const std::size_t record = (1 + ss)*sizeof(std::uint64_t);
+          if(ss < 0 || std::size_t(count) > std::size_t(end - p)/record)
+          {
+            return false;
+          }
+          p += count*record;
+        }else if((p = igl::parallel_for_lines(p, end, count,
+          [](const std::size_t, const char *, const char *){ return true; })) == NULL)
+        {
+          return false;
+        }
+        blocks.push_back(block);
+        read += count;
+      }
+      return read == h[1] &&
+        read_element_blocks(blocks, binary, sizeof(std::uint64_t), nodes, end, T);
     }
+  }
+}
 
-    m_node_fields[fieldname] = field;
-  };
-  const auto parse_unknown_field = [](std::ifstream& fin,
-        const std::string& fieldname) 
+template <
+  typename DerivedV,
+  typename DerivedT>
+IGL_INLINE bool igl::readMSH(
+  const std::string & filename,
+  Eigen::PlainObjectBase<DerivedV> & V,
+  Eigen::PlainObjectBase<DerivedT> & T)
+{
+  using namespace readMSH_detail;
+  igl::MappedFile file;
+  if(!file.open(filename))
   {
-    std::cerr << "Warning: \"" << fieldname << "\" not supported yet.  Ignored." << std::endl;
-    std::string endmark = fieldname.substr(0,1) + "End"
-        + fieldname.substr(1,fieldname.size()-1);
-
-    std::string buf("");
-    while (buf != endmark && !fin.eof()) {
-        fin >> buf;
-    }
+    std::cerr << "readMSH: failed to open file \"" << filename << "\"" << std::endl;
+    return false;
+  }
+  const char * p = file.data();
+  const char * end = p + file.size();
+  const auto invalid_format = [&filename](const std::string & where)->bool
+  {
+    std::cerr << "readMSH: invalid format in " << where << " of " << filename << std::endl;
+    return false;
   };
 
-
-  while (!fin.eof()) {
-      buf.clear();
-      fin >> buf;
-      if (buf == "$Nodes") {
-          parse_nodes(fin);
-          fin >> buf;
-          if (buf != "$EndNodes") { return invalid_format(); }
-      } else if (buf == "$Elements") {
-          parse_elements(fin);
-          fin >> buf;
-          if (buf != "$EndElements") { return invalid_format(); }
-      } else if (buf == "$NodeData") {
-          parse_node_field(fin);
-          fin >> buf;
-          if (buf != "$EndNodeData") { return invalid_format(); }
-      } else if (buf == "$ElementData") {
-          parse_element_field(fin);
-          fin >> buf;
-          if (buf != "$EndElementData") { return invalid_format(); }
-      } else if (fin.eof()) {
-          break;
-      } else {
-          parse_unknown_field(fin, buf);
-      }
+  // Parse header
+  double version;
+  long type, data_size;
+  if(word(p, end) != "$MeshFormat" ||
+    !number(p, end, version) || !number(p, end, type) || !number(p, end, data_size))
+  {
+    return invalid_format("$MeshFormat");
+  }
+  const bool binary = (type == 1);
+  int major = int(std::floor(version));
+  if(major == 4 && std::fabs(version - 4.1) > 1e-6)
+  {
+    // 4.0 has a different layout
+    major = 0;
   }
-  fin.close();
-  V.resize(m_nodes.rows()/3,3);
-  for (int i = 0; i < m_nodes.rows() / 3; i++) 
+  if(major != 2 && major != 4)
   {
-    for (int j = 0; j < 3; j++)
+    std::cerr << "readMSH: version " << version << " of " << filename <<
+      " not supported (only 2.x and 4.1)" << std::endl;
+    return false;
+  }
+  if(data_size != 8)
+  {
+    std::cerr << "readMSH: data size must be 8 bytes." << std::endl;
+    return false;
+  }
+  if(binary)
+  {
+    p = skip_space(p, end);
+    if(std::size_t(end - p) < sizeof(int))
     {
-      V(i,j) = m_nodes(i * 3 + j);
+      return invalid_format("$MeshFormat");
     }
+    if(get<int>(p) != 1)
+    {
+      std::cerr << "readMSH: binary msh file " << filename <<
+        " is saved with different endianness than this machine." << std::endl;
+      return false;
+    }
+    p += sizeof(int);
   }
-  int ss = num_nodes_per_elem_type(m_element_type);
-  T.resize(m_elements.rows()/ss,ss);
-  for (int i = 0; i < m_elements.rows() / ss; i++) 
+  if(word(p, end) != "$EndMeshFormat")
+  {
+    return invalid_format("$MeshFormat");
+  }
+
+  NodeRows nodes;
+  V.resize(0, 3);
+  T.resize(0, 3);
+  while(true)
   {
-    for (int j = 0; j < ss; j++)
+    const std::string section = word(p, end);
+    if(section.empty())
+    {
+      break;
+    }
+    if(section == "$Nodes")
+    {
+      if(!(major == 2 ?
+        read_nodes_2(p, end, binary, V, nodes) :
+        read_nodes_4(p, end, binary, V, nodes)))
+      {
+        return invalid_format(section);
+      }
+    }else if(section == "$Elements")
+    {
+      if(!(major == 2 ?
+        read_elements_2(p, end, binary, nodes, T) :
+        read_elements_4(p, end, binary, nodes, T)))
+      {
+        return invalid_format(section);
+      }
+    }else if(section[0] == '$')
+    {
+      // Skip other sections
+      if(section != "$Entities" && section != "$PartitionedEntities" &&
+        section != "$PhysicalNames" && section != "$Periodic" &&
+        section != "$GhostElements" && section != "$Parametrizations" &&
+        section != "$NodeData" && section != "$ElementData" &&
+        section != "$ElementNodeData" && section != "$InterpolationScheme" &&
+        section != "$Comments")
+      {
+        std::cerr << "Warning: \"" << section << "\" not supported yet.  Ignored." << std::endl;
+      }
+      const std::string end_mark = "$End" + section.substr(1);
+      p = std::search(p, end, end_mark.begin(), end_mark.end());
+      if(p < end)
+      {
+        p += end_mark.size();
+      }
+      continue;
+    }else
+    {
+      return invalid_format(section);
+    }
+    if(word(p, end) != "$End" + section.substr(1))
     {
-      T(i, j) = m_elements(i * ss + j);
+      return invalid_format(section);
     }
   }
   return true;
@@ -511,4 +826,6 @@ IGL_INLINE bool igl::readMSH(
 // Explicit template instantiation
 // generated by autoexplicit.sh
 template bool igl::readMSH<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(std::basic_string<char, std::char_traits<char>, std::allocator<char> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> >&);
+template bool igl::readMSH<Eigen::Matrix<double, -1, 3, 1, -1, 3>, Eigen::Matrix<int, -1, -1, 1, -1, -1> >(std::basic_string<char, std::char_traits<char>, std::allocator<char> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 3, 1, -1, 3> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 1, -1, -1> >&);
+template bool igl::readMSH<Eigen::Matrix<float, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(std::basic_string<char, std::char_traits<char>, std::allocator<char> > const&, Eigen::PlainObjectBase<Eigen::Matrix<float, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> >&);
 #endif
@@ -14,12 +14,17 @@
 
 namespace igl
 {
-  // Read a mesh (e.g., tet mesh) from a gmsh .msh file
+  // Read a mesh (e.g., tet mesh) from a gmsh .msh file, ASCII or binary of
+  // version 2.x or 4.1. The file is memory mapped and parsed in parallel.
+  // Only one type of elements is output: tetrahedra if there are any, else
+  // hexahedra, triangles or quadrangles. Other elements (points, lines,
+  // ...) and data sections are skipped.
   // 
   // Inputs:
   //   filename  path to .msh file
   // Outputs:
-  //    V  #V by 3 list of 3D mesh vertex positions
+  //    V  #V by 3 list of 3D mesh vertex positions, row i for node tag i+1
+  //      if the tags are 1..#V and else in the order of the file
   //    T  #T by ss list of 3D ss-element indices into V (e.g., ss=4 for tets)
   // Returns true on success
   template <
@@ -10,12 +10,17 @@
 #include "list_to_matrix.h"
 #include "max_size.h"
 #include "min_size.h"
+#include "MappedFile.h"
+#include "parallel_for.h"
+#include "parse_number.h"
 
 #include <iostream>
 #include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <iterator>
+#include <thread>
 
 template <typename Scalar, typename Index>
 IGL_INLINE bool igl::readOBJ(
@@ -285,6 +290,476 @@ IGL_INLINE bool igl::readOBJ(
   return readOBJ(obj_file_name,V,TC,N,F,FTC,FN);
 }
 
+// Parallel reader of the Eigen wrappers: the file is memory mapped, split
+// into line aligned chunks, and each chunk is parsed straight into the
+// output matrices at rows known from counting lines in a first pass.
+// Anything it does not reproduce exactly (irregular rows, unusual number or
+// index formats, overlong lines, ...) makes it give up, and the line-by-line
+// reader above handles the file, so the results are identical.
+namespace igl
+{
+  namespace readOBJ_detail
+  {
+    inline bool is_space(const char c)
+    {
+      return c==' ' || c=='\t' || c=='\n' || c=='\r' || c=='\v' || c=='\f';
+    }
+
+    inline const char * skip_space(const char * p, const char * end)
+    {
+      while(p < end && is_space(*p)) p++;
+      return p;
+    }
+
+    inline const char * skip_word(const char * p, const char * end)
+    {
+      while(p < end && !is_space(*p)) p++;
+      return p;
+    }
+
+    enum LineType
+    {
+      LINE_EMPTY,
+      LINE_V,
+      LINE_VT,
+      LINE_VN,
+      LINE_F,
+      // Comments, groups, materials, ...
+      LINE_IGNORED,
+      // Reported with a warning
+      LINE_UNKNOWN,
+      // Leading whitespace before v/vt/vn/f: left to the line-by-line reader
+      LINE_UNSUPPORTED
+    };
+
+    // Same classification as the first word read by sscanf(line,"%s",type)
+    inline LineType classify(const char * line, const char * end, const char *& rest)
+    {
+      const char * type = skip_space(line, end);
+      if(type == end)
+      {
+        return LINE_EMPTY;
+      }
+      rest = skip_word(type, end);
+      const size_t n = rest - type;
+      LineType t = LINE_UNKNOWN;
+      if(n == 1 && type[0] == 'v') t = LINE_V;
+      else if(n == 2 && type[0] == 'v' && type[1] == 't') t = LINE_VT;
+      else if(n == 2 && type[0] == 'v' && type[1] == 'n') t = LINE_VN;
+      else if(n == 1 && type[0] == 'f') t = LINE_F;
+      else if(type[0] == '#' || type[0] == 'g' || type[0] == 's' ||
+        (n == 6 && std::string(type, n) == "usemtl") ||
+        (n == 6 && std::string(type, n) == "mtllib"))
+      {
+        return LINE_IGNORED;
+      }
+      else return LINE_UNKNOWN;
+      return type == line ? t : LINE_UNSUPPORTED;
+    }
+
+    // Parse all whitespace separated numbers into x (like reading doubles
+    // from a stream until the end). Returns the count, or -1 on a word that
+    // is not a plain number or more than max numbers.
+    inline int parse_numbers(const char * p, const char * end, double * x, const int max)
+    {
+      int count = 0;
+      while(true)
+      {
+        p = skip_space(p, end);
+        if(p == end)
+        {
+          return count;
+        }
+        if(count == max)
+        {
+          return -1;
+        }
+        const char * q = igl::parse_number(p, end, x[count]);
+        if(q == NULL || (q < end && !is_space(*q)))
+        {
+          return -1;
+        }
+        count++;
+        p = q;
+      }
+    }
+
+    // Parse up to max numbers like sscanf(p,"%lf %lf %lf") for max=3: words
+    // after them are ignored. Returns the count, or -1 if a word that sscanf
+    // might read is not a plain number.
+    inline int parse_leading_numbers(const char * p, const char * end, double * x, const int max)
+    {
+      int count = 0;
+      for(;count<max;count++)
+      {
+        p = skip_space(p, end);
+        if(p == end)
+        {
+          break;
+        }
+        const char * q = igl::parse_number(p, end, x[count]);
+        if(q == NULL || (q < end && !is_space(*q)))
+        {
+          return -1;
+        }
+        p = q;
+      }
+      return count;
+    }
+
+    // Face corner in one of the formats i, i/t, i//n or i/t/n
+    struct Corner
+    {
+      long i = 0, t = 0, n = 0;
+      bool has_t = false, has_n = false;
+    };
+
+    inline const char * parse_corner(const char * p, const char * end, Corner & c)
+    {
+      c.has_t = c.has_n = false;
+      p = igl::parse_number(p, end, c.i);
+      if(p == NULL)
+      {
+        return NULL;
+      }
+      if(p < end && *p == '/')
+      {
+        p++;
+        if(p < end && *p == '/')
+        {
+          p = igl::parse_number(p+1, end, c.n);
+          c.has_n = true;
+        }else
+        {
+          p = igl::parse_number(p, end, c.t);
+          c.has_t = true;
+          if(p != NULL && p < end && *p == '/')
+          {
+            p = igl::parse_number(p+1, end, c.n);
+            c.has_n = true;
+          }
+        }
+        if(p == NULL)
+        {
+          return NULL;
+        }
+      }
+      return (p == end || is_space(*p)) ? p : NULL;
+    }
+
+    struct Chunk
+    {
+      const char * begin = NULL;
+      const char * end = NULL;
+      // Lines of each type in this chunk
+      long lines = 0, v = 0, vt = 0, vn = 0, f = 0;
+      // Columns of the first v and vt line, degree and format of the first
+      // face (-1 if none)
+      int v_cols = -1, vt_cols = -1, f_degree = -1;
+      bool f_t = false, f_n = false;
+      // Lines warned about: pointer to the line and line number in the chunk
+      std::vector<std::pair<const char *, long> > unknown;
+      bool ok = true;
+    };
+
+    // Counts the lines of a chunk
+    inline void count(Chunk & c)
+    {
+      c.lines = c.v = c.vt = c.vn = c.f = 0;
+      c.v_cols = c.vt_cols = c.f_degree = -1;
+      c.f_t = c.f_n = false;
+      c.ok = true;
+      const char * line = c.begin;
+      while(line < c.end)
+      {
+        const char * eol = static_cast<const char *>(memchr(line, '\n', c.end - line));
+        eol = eol ? eol + 1 : c.end;
+        // fgets in the line-by-line reader splits longer lines
+        if(eol - line >= IGL_LINE_MAX - 1)
+        {
+          c.ok = false;
+          return;
+        }
+        const char * rest = NULL;
+        switch(classify(line, eol, rest))
+        {
+          case LINE_V:
+            if(c.v_cols < 0)
+            {
+              double x[64];
+              c.v_cols = parse_numbers(rest, eol, x, 64);
+            }
+            c.v++;
+            break;
+          case LINE_VT:
+            if(c.vt_cols < 0)
+            {
+              double x[3];
+              c.vt_cols = parse_leading_numbers(rest, eol, x, 3);
+            }
+            c.vt++;
+            break;
+          case LINE_VN:
+            c.vn++;
+            break;
+          case LINE_F:
+            if(c.f_degree < 0)
+            {
+              c.f_degree = 0;
+              const char * p = skip_space(rest, eol);
+              while(p < eol)
+              {
+                Corner corner;
+                p = parse_corner(p, eol, corner);
+                if(p == NULL)
+                {
+                  c.ok = false;
+                  return;
+                }
+                c.f_t = corner.has_t;
+                c.f_n = corner.has_n;
+                c.f_degree++;
+                p = skip_space(p, eol);
+              }
+            }
+            c.f++;
+            break;
+          case LINE_UNKNOWN:
+            c.unknown.push_back(std::make_pair(line, c.lines));
+            break;
+          case LINE_UNSUPPORTED:
+            c.ok = false;
+            return;
+          default:
+            break;
+        }
+        c.lines++;
+        line = eol;
+      }
+    }
+
+    template <
+      typename DerivedV,
+      typename DerivedTC,
+      typename DerivedCN,
+      typename DerivedF,
+      typename DerivedFTC,
+      typename DerivedFN>
+    IGL_INLINE bool read(
+      const std::string & path,
+      Eigen::PlainObjectBase<DerivedV>& V,
+      Eigen::PlainObjectBase<DerivedTC>& TC,
+      Eigen::PlainObjectBase<DerivedCN>& CN,
+      Eigen::PlainObjectBase<DerivedF>& F,
+      Eigen::PlainObjectBase<DerivedFTC>& FTC,
+      Eigen::PlainObjectBase<DerivedFN>& FN)
+    {
+      igl::MappedFile file;
+      if(!file.open(path) || file.size() == 0)
+      {
+        return false;
+      }
+      const char * begin = file.data();
+      const char * end = begin + file.size();
+
+      // Line aligned chunks of about 4MB, enough to keep all threads busy
+      const size_t target = 4 << 20;
+      std::vector<Chunk> chunks;
+      for(const char * b = begin;b < end;)
+      {
+        const char * e = b + std::min<size_t>(target, end - b);
+        if(e < end)
+        {
+          const char * eol = static_cast<const char *>(memchr(e, '\n', end - e));
+          e = eol ? eol + 1 : end;
+        }
+        Chunk c;
+        c.begin = b;
+        c.end = e;
+        chunks.push_back(c);
+        b = e;
+      }
+      const size_t n = chunks.size();
+      igl::parallel_for(n, [&chunks](const size_t i){ count(chunks[i]); }, 2);
+
+      // Offsets of each chunk into the outputs and global formats
+      std::vector<long> lines(n+1,0), v(n+1,0), vt(n+1,0), vn(n+1,0), f(n+1,0);
+      int v_cols = -1, vt_cols = -1, f_degree = -1;
+      bool f_t = false, f_n = false;
+      for(size_t i = 0;i<n;i++)
+      {
+        const Chunk & c = chunks[i];
+        if(!c.ok)
+        {
+          return false;
+        }
+        lines[i+1] = lines[i] + c.lines;
+        v[i+1] = v[i] + c.v;
+        vt[i+1] = vt[i] + c.vt;
+        vn[i+1] = vn[i] + c.vn;
+        f[i+1] = f[i] + c.f;
+        if(v_cols < 0) v_cols = c.v_cols;
+        if(vt_cols < 0) vt_cols = c.vt_cols;
+        if(f_degree < 0)
+        {
+          f_degree = c.f_degree;
+          f_t = c.f_t;
+          f_n = c.f_n;
+        }
+      }
+      // Empty outputs and degenerate rows are left to the other reader
+      if(v[n] == 0 || f[n] == 0 || v_cols < 3 || f_degree <= 0 ||
+        (vt[n] > 0 && vt_cols != 2 && vt_cols != 3))
+      {
+        return false;
+      }
+      const bool has_TC = vt[n] > 0;
+      const bool has_CN = vn[n] > 0;
+      const auto fits = [](const int compile_time_cols, const int cols)
+      {
+        return compile_time_cols == Eigen::Dynamic || compile_time_cols == cols;
+      };
+      if(!fits(DerivedV::ColsAtCompileTime, v_cols) ||
+        !fits(DerivedF::ColsAtCompileTime, f_degree) ||
+        (has_TC && !fits(DerivedTC::ColsAtCompileTime, vt_cols)) ||
+        (has_CN && !fits(DerivedCN::ColsAtCompileTime, 3)) ||
+        (f_t && !fits(DerivedFTC::ColsAtCompileTime, f_degree)) ||
+        (f_n && !fits(DerivedFN::ColsAtCompileTime, f_degree)))
+      {
+        return false;
+      }
+
+      // Parse into temporaries so that the outputs stay untouched if the
+      // other reader has to take over
+      DerivedV tV(v[n], v_cols);
+      DerivedTC tTC;
+      DerivedCN tCN;
+      DerivedF tF(f[n], f_degree);
+      DerivedFTC tFTC;
+      DerivedFN tFN;
+      if(has_TC) tTC.resize(vt[n], vt_cols);
+      if(has_CN) tCN.resize(vn[n], 3);
+      if(f_t) tFTC.resize(f[n], f_degree);
+      if(f_n) tFN.resize(f[n], f_degree);
+
+      const auto parse = [&](const size_t i)
+      {
+        Chunk & c = chunks[i];
+        long iv = v[i], ivt = vt[i], ivn = vn[i], iff = f[i];
+        const auto shift = [](const long i, const long size)->int
+        {
+          return i<0 ? int(i)+size : int(i)-1;
+        };
+        double x[64];
+        for(const char * line = c.begin;line < c.end;)
+        {
+          const char * eol = static_cast<const char *>(memchr(line, '\n', c.end - line));
+          eol = eol ? eol + 1 : c.end;
+          const char * rest = NULL;
+          switch(classify(line, eol, rest))
+          {
+            case LINE_V:
+              if(parse_numbers(rest, eol, x, 64) != v_cols)
+              {
+                c.ok = false;
+                return;
+              }
+              for(int j = 0;j<v_cols;j++)
+              {
+                tV(iv,j) = x[j];
+              }
+              iv++;
+              break;
+            case LINE_VT:
+              if(parse_leading_numbers(rest, eol, x, 3) != vt_cols)
+              {
+                c.ok = false;
+                return;
+              }
+              for(int j = 0;j<vt_cols;j++)
+              {
+                tTC(ivt,j) = x[j];
+              }
+              ivt++;
+              break;
+            case LINE_VN:
+              if(parse_leading_numbers(rest, eol, x, 3) != 3)
+              {
+                c.ok = false;
+                return;
+              }
+              for(int j = 0;j<3;j++)
+              {
+                tCN(ivn,j) = x[j];
+              }
+              ivn++;
+              break;
+            case LINE_F:
+            {
+              const char * p = skip_space(rest, eol);
+              int k = 0;
+              for(;p < eol;k++)
+              {
+                Corner corner;
+                p = parse_corner(p, eol, corner);
+                if(p == NULL || k == f_degree ||
+                  corner.has_t != f_t || corner.has_n != f_n)
+                {
+                  c.ok = false;
+                  return;
+                }
+                // Relative indices count the elements read so far
+                tF(iff,k) = shift(corner.i, iv);
+                if(f_t) tFTC(iff,k) = shift(corner.t, ivt);
+                if(f_n) tFN(iff,k) = shift(corner.n, ivn);
+                p = skip_space(p, eol);
+              }
+              if(k != f_degree)
+              {
+                c.ok = false;
+                return;
+              }
+              iff++;
+              break;
+            }
+            default:
+              break;
+          }
+          line = eol;
+        }
+      };
+      igl::parallel_for(n, parse, 2);
+      for(size_t i = 0;i<n;i++)
+      {
+        if(!chunks[i].ok)
+        {
+          return false;
+        }
+      }
+
+      for(size_t i = 0;i<n;i++)
+      {
+        for(const auto & u : chunks[i].unknown)
+        {
+          const char * eol = static_cast<const char *>(memchr(u.first, '\n', end - u.first));
+          eol = eol ? eol + 1 : end;
+          fprintf(stderr,
+                  "Warning: readOBJ() ignored non-comment line %d:\n  %s",
+                  int(lines[i] + u.second + 1),
+                  std::string(u.first, eol).c_str());
+        }
+      }
+      V.swap(tV);
+      F.swap(tF);
+      if(has_TC) TC.swap(tTC);
+      if(has_CN) CN.swap(tCN);
+      if(f_t) FTC.swap(tFTC);
+      if(f_n) FN.swap(tFN);
+      return true;
+    }
+  }
+}
+
 template <
   typename DerivedV, 
   typename DerivedTC, 
@@ -301,6 +776,10 @@ IGL_INLINE bool igl::readOBJ(
   Eigen::PlainObjectBase<DerivedFTC>& FTC,
   Eigen::PlainObjectBase<DerivedFN>& FN)
 {
+  if(readOBJ_detail::read(str,V,TC,CN,F,FTC,FN))
+  {
+    return true;
+  }
   std::vector<std::vector<double> > vV,vTC,vN;
   std::vector<std::vector<int> > vF,vFTC,vFN;
   bool success = igl::readOBJ(str,vV,vTC,vN,vF,vFTC,vFN);
@@ -372,6 +851,14 @@ IGL_INLINE bool igl::readOBJ(
   Eigen::PlainObjectBase<DerivedV>& V,
   Eigen::PlainObjectBase<DerivedF>& F)
 {
+  // Texture coordinates and normals are still parsed, to fail on the same
+  // files as the line-by-line reader
+  Eigen::MatrixXd TC,CN;
+  Eigen::MatrixXi FTC,FN;
+  if(readOBJ_detail::read(str,V,TC,CN,F,FTC,FN))
+  {
+    return true;
+  }
   std::vector<std::vector<double> > vV,vTC,vN;
   std::vector<std::vector<int> > vF,vFTC,vFN;
   bool success = igl::readOBJ(str,vV,vTC,vN,vF,vFTC,vFN);
@@ -7,38 +7,340 @@
 // obtain one at http://mozilla.org/MPL/2.0/.
 #include "readSTL.h"
 #include "list_to_matrix.h"
+#include "MappedFile.h"
+#include "parallel_for.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <memory>
+
+namespace igl
+{
+  namespace readSTL_detail
+  {
+    // Binary files: 80 byte header, triangle count, then 50 byte records of
+    // normal, three corners (12 floats) and an attribute byte count
+    const std::size_t HEADER_SIZE = 84;
+    const std::size_t RECORD_SIZE = 50;
+
+    inline float get_float(const char * p)
+    {
+      float x;
+      std::memcpy(&x, p, sizeof(float));
+      return x;
+    }
+
+    // Same test as for FILE*: the file is binary unless its first word is
+    // "solid" and its size does not match the triangle count
+    inline bool is_binary(const char * data, const std::size_t size)
+    {
+      if(size < HEADER_SIZE)
+      {
+        return size >= 80;
+      }
+      std::size_t i = 0;
+      while(i < 80 && std::isspace((unsigned char)data[i]))
+      {
+        i++;
+      }
+      const bool solid = i + 5 <= 80 && std::strncmp(data + i, "solid", 5) == 0 &&
+        (i + 5 == 80 || data[i+5] == '\0' || std::isspace((unsigned char)data[i+5]));
+      if(!solid)
+      {
+        return true;
+      }
+      std::uint32_t num_tri;
+      std::memcpy(&num_tri, data + 80, sizeof(num_tri));
+      return size == HEADER_SIZE + RECORD_SIZE * std::size_t(num_tri);
+    }
+
+    // Welds n vertices given by position(i,d) with a concurrent open
+    // addressing hash table: every table slot holds the smallest index of
+    // the vertices with its key, which becomes their representative.
+    //
+    // Outputs:
+    //   I  #unique list of representatives, in increasing order
+    //   J  n list of indices into I
+    template <typename PositionFunction>
+    inline void weld(
+      const std::size_t n,
+      const double epsilon,
+      const PositionFunction & position,
+      std::vector<std::uint32_t> & I,
+      std::vector<std::uint32_t> & J)
+    {
+      using namespace std;
+      const uint32_t EMPTY = 0xffffffff;
+      // Key of vertex i, (+0.0 so that -0 and 0 agree)
+      const auto key = [&](const size_t i, double k[3])
+      {
+        for(int d = 0;d<3;d++)
+        {
+          const double x = position(i,d);
+          if(epsilon > 0)
+          {
+            // Same rounding as remove_duplicate_vertices
+            const double r = x/(10.0*epsilon);
+            k[d] = ((r > 0.0) ? floor(r + 0.5) : ceil(r - 0.5)) + 0.0;
+          }else
+          {
+            k[d] = x + 0.0;
+          }
+        }
+      };
+      const auto hash = [](const double k[3])
+      {
+        uint64_t h = 0x9e3779b97f4a7c15ULL;
+        for(int d = 0;d<3;d++)
+        {
+          uint64_t b;
+          memcpy(&b, k + d, sizeof(b));
+          h = (h ^ b) * 0xff51afd7ed558ccdULL;
+          h ^= h >> 32;
+        }
+        return h;
+      };
+      // At most half full
+      size_t m = 16;
+      while(m < 2*n)
+      {
+        m *= 2;
+      }
+      unique_ptr<atomic<uint32_t>[]> table(new atomic<uint32_t>[m]);
+      parallel_for(m,[&table,EMPTY](const size_t s)
+      {
+        table[s].store(EMPTY, memory_order_relaxed);
+      },1<<16);
+
+      // Slot of each vertex, then its representative
+      J.resize(n);
+      parallel_for(n,[&](const size_t i)
+      {
+        double k[3];
+        key(i,k);
+        size_t s = hash(k) & (m-1);
+        while(true)
+        {
+          uint32_t cur = table[s].load();
+          if(cur == EMPTY)
+          {
+            if(table[s].compare_exchange_weak(cur, uint32_t(i)))
+            {
+              break;
+            }
+            // Lost the race (or spurious failure): look at this slot again
+            continue;
+          }
+          double other[3];
+          key(cur,other);
+          if(k[0] == other[0] && k[1] == other[1] && k[2] == other[2])
+          {
+            // Slots only change between vertices with the same key
+            while(i < cur && !table[s].compare_exchange_weak(cur, uint32_t(i)))
+            {
+            }
+            break;
+          }
+          s = (s+1) & (m-1);
+        }
+        J[i] = uint32_t(s);
+      },1000);
+      parallel_for(n,[&](const size_t i)
+      {
+        J[i] = table[J[i]].load(memory_order_relaxed);
+      },1<<16);
+      table.reset();
+
+      // Number representatives in order with per chunk counts
+      const size_t chunk_size = 1<<16;
+      const size_t num_chunks = (n + chunk_size - 1)/chunk_size;
+      vector<size_t> offset(num_chunks+1,0);
+      parallel_for(num_chunks,[&](const size_t c)
+      {
+        const size_t end = min(n, (c+1)*chunk_size);
+        for(size_t i = c*chunk_size;i<end;i++)
+        {
+          offset[c+1] += J[i] == i;
+        }
+      },1);
+      for(size_t c = 0;c<num_chunks;c++)
+      {
+        offset[c+1] += offset[c];
+      }
+      I.resize(offset[num_chunks]);
+      // New index of representatives (allocated after freeing the table)
+      vector<uint32_t> index(n);
+      parallel_for(num_chunks,[&](const size_t c)
+      {
+        size_t next = offset[c];
+        const size_t end = min(n, (c+1)*chunk_size);
+        for(size_t i = c*chunk_size;i<end;i++)
+        {
+          if(J[i] == i)
+          {
+            I[next] = uint32_t(i);
+            index[i] = uint32_t(next++);
+          }
+        }
+      },1);
+      parallel_for(n,[&](const size_t i)
+      {
+        J[i] = index[J[i]];
+      },1<<16);
+    }
+  }
+}
+
+template <typename DerivedV, typename DerivedF, typename DerivedN>
+IGL_INLINE bool igl::readSTL(
+  const std::string & filename,
+  Eigen::PlainObjectBase<DerivedV> & V,
+  Eigen::PlainObjectBase<DerivedF> & F,
+  Eigen::PlainObjectBase<DerivedN> & N)
+{
+  return readSTL(filename,-1.0,V,F,N);
+}
+
 template <typename DerivedV, typename DerivedF, typename DerivedN>
 IGL_INLINE bool igl::readSTL(
   const std::string & filename,
+  const double epsilon,
   Eigen::PlainObjectBase<DerivedV> & V,
   Eigen::PlainObjectBase<DerivedF> & F,
   Eigen::PlainObjectBase<DerivedN> & N)
 {
   using namespace std;
-  vector<vector<typename DerivedV::Scalar> > vV;
-  vector<vector<typename DerivedN::Scalar> > vN;
-  vector<vector<typename DerivedF::Scalar> > vF;
-  if(!readSTL(filename,vV,vF,vN))
+  using namespace readSTL_detail;
+  typedef typename DerivedV::Scalar VScalar;
+  typedef typename DerivedF::Scalar FScalar;
+  typedef typename DerivedN::Scalar NScalar;
+  // Negative epsilon (only used internally) means no welding
+  const bool do_weld = epsilon >= 0;
+  MappedFile file;
+  if(!file.open(filename))
   {
+    fprintf(stderr,"IOError: %s could not be opened...\n",
+            filename.c_str());
     return false;
   }
-
-  if(!list_to_matrix(vV,V))
+  if(is_binary(file.data(),file.size()))
   {
-    return false;
+    if(file.size() < HEADER_SIZE)
+    {
+      cerr<<"IOError: bad format (7)."<<endl;
+      return false;
+    }
+    uint32_t num_tri;
+    memcpy(&num_tri, file.data() + 80, sizeof(num_tri));
+    if(file.size() < HEADER_SIZE + RECORD_SIZE * size_t(num_tri))
+    {
+      cerr<<"IOError: bad format (8)."<<endl;
+      return false;
+    }
+    const size_t n = 3*size_t(num_tri);
+    if(do_weld && n >= 0xffffffff)
+    {
+      cerr<<"Error: too many triangles to weld."<<endl;
+      return false;
+    }
+    const char * records = file.data() + HEADER_SIZE;
+    // Coordinate d of corner c
+    const auto corner = [records](const size_t c, const int d)
+    {
+      return get_float(records + RECORD_SIZE*(c/3) + 12 + 12*(c%3) + 4*d);
+    };
+    N.resize(num_tri,3);
+    F.resize(num_tri,3);
+    parallel_for(num_tri,[&](const uint32_t t)
+    {
+      for(int d = 0;d<3;d++)
+      {
+        N(t,d) = NScalar(get_float(records + RECORD_SIZE*t + 4*d));
+      }
+    },1000);
+    if(do_weld)
+    {
+      vector<uint32_t> I,J;
+      weld(n,epsilon,
+        [&corner](const size_t c, const int d){ return double(corner(c,d)); },I,J);
+      V.resize(I.size(),3);
+      parallel_for(I.size(),[&](const size_t i)
+      {
+        for(int d = 0;d<3;d++)
+        {
+          V(i,d) = VScalar(corner(I[i],d));
+        }
+      },1000);
+      parallel_for(num_tri,[&](const uint32_t t)
+      {
+        for(int c = 0;c<3;c++)
+        {
+          F(t,c) = FScalar(J[3*size_t(t)+c]);
+        }
+      },1000);
+    }else
+    {
+      V.resize(n,3);
+      parallel_for(num_tri,[&](const uint32_t t)
+      {
+        for(int c = 0;c<3;c++)
+        {
+          const size_t i = 3*size_t(t)+c;
+          F(t,c) = FScalar(i);
+          for(int d = 0;d<3;d++)
+          {
+            V(i,d) = VScalar(corner(i,d));
+          }
+        }
+      },1000);
+    }
+    return true;
   }
+  file.close();
 
-  if(!list_to_matrix(vF,F))
+  // Ascii
+  vector<vector<VScalar> > vV;
+  vector<vector<NScalar> > vN;
+  vector<vector<FScalar> > vF;
+  if(!readSTL(filename,vV,vF,vN))
   {
     return false;
   }
-
   if(!list_to_matrix(vN,N))
   {
     return false;
   }
+  if(!do_weld)
+  {
+    return list_to_matrix(vV,V) && list_to_matrix(vF,F);
+  }
+  if(!list_to_matrix(vF,F))
+  {
+    return false;
+  }
+  vector<uint32_t> I,J;
+  weld(vV.size(),epsilon,
+    [&vV](const size_t i, const int d){ return double(vV[i][d]); },I,J);
+  V.resize(I.size(),3);
+  for(size_t i = 0;i<I.size();i++)
+  {
+    for(int d = 0;d<3;d++)
+    {
+      V(i,d) = vV[I[i]][d];
+    }
+  }
+  for(Eigen::Index f = 0;f<F.rows();f++)
+  {
+    for(Eigen::Index c = 0;c<F.cols();c++)
+    {
+      F(f,c) = FScalar(J[F(f,c)]);
+    }
+  }
   return true;
 }
 
@@ -287,4 +589,5 @@ template bool igl::readSTL<Eigen::Matrix<double, -1, 3, 0, -1, 3>, Eigen::Matrix
 template bool igl::readSTL<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(std::basic_string<char, std::char_traits<char>, std::allocator<char> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&);
 template bool igl::readSTL<Eigen::Matrix<float, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<float, -1, -1, 0, -1, -1> >(std::basic_string<char, std::char_traits<char>, std::allocator<char> > const&, Eigen::PlainObjectBase<Eigen::Matrix<float, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<float, -1, -1, 0, -1, -1> >&);
 template bool igl::readSTL<Eigen::Matrix<double, -1, 3, 1, -1, 3>, Eigen::Matrix<int, -1, 3, 1, -1, 3>, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(std::basic_string<char, std::char_traits<char>, std::allocator<char> > const&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, 3, 1, -1, 3> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, 3, 1, -1, 3> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&);
+template bool igl::readSTL<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(std::basic_string<char, std::char_traits<char>, std::allocator<char> > const&, double, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> >&, Eigen::PlainObjectBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> >&);
 #endif
@@ -31,6 +31,8 @@ namespace igl
   //   N  double matrix of surface normals #F by 3
   // Returns true on success, false on errors
   //
+  // Binary files are memory mapped and decoded in parallel.
+  //
   // Example:
   //   bool success = readSTL(filename,temp_V,F,N);
   //   remove_duplicate_vertices(temp_V,0,V,SVI,SVJ);
@@ -42,6 +44,32 @@ namespace igl
     Eigen::PlainObjectBase<DerivedV> & V,
     Eigen::PlainObjectBase<DerivedF> & F,
     Eigen::PlainObjectBase<DerivedN> & N);
+  // Read a mesh from an ascii/binary stl file, welding duplicate vertices
+  // while reading. Vertices are merged like remove_duplicate_vertices(V,
+  // epsilon,...) would, but with a concurrent hash table rather than by
+  // sorting, and are numbered in order of first appearance.
+  //
+  // Inputs:
+  //   filename path to .stl file
+  //   epsilon  uniqueness tolerance: vertices whose coordinates rounded to
+  //     multiples of 10*epsilon agree are merged, 0 merges exactly equal
+  //     vertices
+  // Outputs:
+  //   V  double matrix of unique vertex positions  #V by 3
+  //   F  index matrix of triangle indices into V #F by 3
+  //   N  double matrix of surface normals #F by 3
+  // Returns true on success, false on errors
+  //
+  // Example:
+  //   bool success = readSTL(filename,0,V,F,N);
+  //   writeOBJ("Downloads/cat.obj",V,F);
+  template <typename DerivedV, typename DerivedF, typename DerivedN>
+  IGL_INLINE bool readSTL(
+    const std::string & filename,
+    const double epsilon,
+    Eigen::PlainObjectBase<DerivedV> & V,
+    Eigen::PlainObjectBase<DerivedF> & F,
+    Eigen::PlainObjectBase<DerivedN> & N);
   // Inputs:
   //   stl_file  pointer to already opened .stl file 
   // Outputs:
@@ -14,12 +14,14 @@
 #include "readSTL.h"
 #include "readPLY.h"
 #include "readWRL.h"
+#include "MeshCache.h"
 #include "pathinfo.h"
 #include "boundary_facets.h"
 #include "polygon_mesh_to_triangle_mesh.h"
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
 
 
 template <typename Scalar, typename Index>
@@ -84,6 +86,31 @@ IGL_INLINE bool igl::read_triangle_mesh(
   pathinfo(filename,dir,base,ext,name);
   // Convert extension to lower case
   transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+  // Load the binary cache instead of parsing while the file is unchanged
+  const bool is_cache = ext == "iglmesh";
+  const bool use_cache = MeshCache::enabled() && !is_cache;
+  const string cache_path = MeshCache::cache_path(filename);
+  if(is_cache || use_cache)
+  {
+    MeshCache cache;
+    if(cache.open(is_cache ? filename : cache_path) &&
+      (is_cache || cache.is_current(filename)) &&
+      (DerivedV::ColsAtCompileTime == Dynamic ||
+        DerivedV::ColsAtCompileTime == cache.V().cols()) &&
+      (DerivedF::ColsAtCompileTime == Dynamic ||
+        DerivedF::ColsAtCompileTime == cache.F().cols()))
+    {
+      V = cache.V().template cast<typename DerivedV::Scalar>();
+      F = cache.F().template cast<typename DerivedF::Scalar>();
+      return true;
+    }
+    if(is_cache)
+    {
+      fprintf(stderr,"IOError: %s is not a valid mesh cache...\n",
+              filename.c_str());
+      return false;
+    }
+  }
   FILE * fp = fopen(filename.c_str(),"rb");
   if(NULL==fp)
   {
@@ -91,7 +118,24 @@ IGL_INLINE bool igl::read_triangle_mesh(
             filename.c_str());
     return false;
   }
-  return read_triangle_mesh(ext,fp,V,F);
+  if(!read_triangle_mesh(ext,fp,V,F))
+  {
+    return false;
+  }
+  // Only cache full precision: a cache written from a float read would later
+  // be handed to double reads of the same file
+  typedef typename DerivedV::Scalar VScalar;
+  typedef typename DerivedF::Scalar FScalar;
+  const bool full_precision =
+    std::numeric_limits<VScalar>::digits >= std::numeric_limits<double>::digits &&
+    std::numeric_limits<FScalar>::digits >= std::numeric_limits<int>::digits;
+  if(use_cache && full_precision && V.size() > 0)
+  {
+    // Failing to write the cache (e.g. read-only directory) is not an error
+    MeshCache::write(
+      cache_path,V.template cast<double>(),F.template cast<int>(),filename);
+  }
+  return true;
 }
 
 template <typename DerivedV, typename DerivedF>
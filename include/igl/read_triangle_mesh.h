@@ -22,7 +22,12 @@
 namespace igl
 {
   // read mesh from an ascii file with automatic detection of file format.
-  // supported: obj, off, stl, wrl, ply, mesh)
+  // supported: obj, off, stl, wrl, ply, mesh, iglmesh)
+  //
+  // The Eigen overloads taking a path keep a binary copy of the result next
+  // to the file (see MeshCache) and load that instead while the file is
+  // unchanged. The copy is only written when reading into double (or wider)
+  // positions and int (or wider) indices.
   // 
   // Templates:
   //   Scalar  type for positions and vectors (will be read as double and cast
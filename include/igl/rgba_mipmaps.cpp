@@ -0,0 +1,58 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#include "rgba_mipmaps.h"
+#include "parallel_for.h"
+#include <algorithm>
+
+IGL_INLINE void igl::rgba_mipmaps(
+  const int width,
+  const int height,
+  const unsigned char * rgba,
+  std::vector<std::vector<unsigned char> > & levels)
+{
+  levels.clear();
+  const unsigned char * src = rgba;
+  int w = width;
+  int h = height;
+  while (w > 1 || h > 1)
+  {
+    const int dw = std::max(w/2,1);
+    const int dh = std::max(h/2,1);
+    levels.push_back(std::vector<unsigned char>(std::size_t(dw)*dh*4));
+    unsigned char * dst = levels.back().data();
+    // Source rows/columns averaged into destination row/column i (3 for the
+    // last one of an odd size, 1 if the size is already 1)
+    const auto span = [](const int i, const int n, const int dn)
+    {
+      return n == 1 ? 1 : (i == dn-1 && n%2 == 1 ? 3 : 2);
+    };
+    igl::parallel_for(dh,[&](const int y)
+    {
+      const int ny = span(y,h,dh);
+      for (int x = 0; x < dw; x++)
+      {
+        const int nx = span(x,w,dw);
+        unsigned sum[4] = {0,0,0,0};
+        for (int j = 0; j < ny; j++)
+        {
+          const unsigned char * row = src + (std::size_t(2*y+j)*w + 2*x)*4;
+          for (int i = 0; i < nx*4; i++)
+          {
+            sum[i%4] += row[i];
+          }
+        }
+        const unsigned n = nx*ny;
+        for (int c = 0; c < 4; c++)
+        {
+          dst[(std::size_t(y)*dw + x)*4 + c] = (unsigned char)((sum[c] + n/2)/n);
+        }
+      }
+    },64);
+    src = dst;
+    w = dw;
+    h = dh;
+  }
+}
@@ -0,0 +1,37 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_RGBA_MIPMAPS_H
+#define IGL_RGBA_MIPMAPS_H
+#include "igl_inline.h"
+#include <vector>
+
+namespace igl
+{
+  // Build the mip chain of an RGBA8 image, halving it down to 1 by 1 with a
+  // 2 by 2 box filter (like glGenerateMipmap, the last row/column of odd
+  // sizes is averaged into its neighbor).
+  //
+  // Inputs:
+  //   width  number of pixels per row
+  //   height  number of rows
+  //   rgba  width*height*4 bytes, row after row
+  // Outputs:
+  //   levels  list of floor(log2(max(width,height))) images, where
+  //     levels[l-1] is mip level l of max(width>>l,1) by max(height>>l,1)
+  //     pixels (level 0 is rgba itself)
+  //
+  IGL_INLINE void rgba_mipmaps(
+    const int width,
+    const int height,
+    const unsigned char * rgba,
+    std::vector<std::vector<unsigned char> > & levels);
+}
+
+#ifndef IGL_STATIC_LIBRARY
+#  include "rgba_mipmaps.cpp"
+#endif
+
+#endif
@@ -132,6 +132,18 @@ IGL_INLINE void igl::signed_distance(
   I.resize(P.rows(),1);
   C.resize(P.rows(),dim);
 
+  // Without bounds, find all closest points in one batch, which walks nearby
+  // points through the tree together
+  const bool batched = dim == 3 && low_sqr_d == 0 &&
+    up_sqr_d == std::numeric_limits<Scalar>::infinity();
+  Eigen::Matrix<Scalar,Eigen::Dynamic,1> batch_sqrD;
+  Eigen::Matrix<int,Eigen::Dynamic,1> batch_I;
+  Eigen::Matrix<Scalar,Eigen::Dynamic,Eigen::Dynamic> batch_C;
+  if(batched)
+  {
+    tree3.squared_distance(V,F,P,batch_sqrD,batch_I,batch_C);
+  }
+
   parallel_for(P.rows(),[&](const int p)
   //for(int p = 0;p<P.rows();p++)
   {
@@ -153,9 +165,17 @@ IGL_INLINE void igl::signed_distance(
     Eigen::Matrix<typename DerivedV::Scalar,1,2>  c2;
     int i=-1;
     // in all cases compute squared unsiged distances
-    sqrd = dim==3?
-      tree3.squared_distance(V,F,q3,low_sqr_d,up_sqr_d,i,c3):
-      tree2.squared_distance(V,F,q2,low_sqr_d,up_sqr_d,i,c2);
+    if(batched)
+    {
+      sqrd = batch_sqrD(p);
+      i = batch_I(p);
+      c3 = batch_C.row(p);
+    }else
+    {
+      sqrd = dim==3?
+        tree3.squared_distance(V,F,q3,low_sqr_d,up_sqr_d,i,c3):
+        tree2.squared_distance(V,F,q2,low_sqr_d,up_sqr_d,i,c2);
+    }
     if(sqrd >= up_sqr_d || sqrd < low_sqr_d)
     {
       // Out of bounds gets a nan (nans on grids can be flood filled later using
@@ -401,37 +401,76 @@ IGL_INLINE void PlyFile::PlyFileImpl::write_binary_internal(std::ostream & os) n
     write_header(os);
 
     uint8_t listSize[4] = { 0, 0, 0, 0 };
-    size_t dummyCount = 0;
 
     auto element_property_lookup = make_property_lookup_table();
 
+    // Records are gathered in a buffer and written in large blocks
+    const size_t flushSize = size_t(1) << 20;
+    std::vector<char> chunk;
+    chunk.reserve(flushSize + 256);
+    auto append = [&chunk](const uint8_t * src, const size_t n)
+    {
+        chunk.insert(chunk.end(), reinterpret_cast<const char *>(src), reinterpret_cast<const char *>(src) + n);
+    };
+
     size_t element_idx = 0;
     for (auto & e : elements)
     {
+        auto & lookups = element_property_lookup[element_idx];
+
+        // Elements whose properties all come from one user buffer without
+        // lists are that buffer verbatim: write it in one go
+        PlyData * single = nullptr;
+        size_t row_stride = 0;
+        bool contiguous = !lookups.empty();
+        for (size_t k = 0; k < lookups.size() && contiguous; ++k)
+        {
+            auto & f = lookups[k];
+            if (f.skip || f.helper == nullptr || e.properties[k].isList) { contiguous = false; break; }
+            if (single == nullptr) single = f.helper->data.get();
+            contiguous = single == f.helper->data.get();
+            row_stride += f.prop_stride;
+        }
+        if (contiguous)
+        {
+            os.write(reinterpret_cast<const char *>(single->buffer.get()), e.size * row_stride);
+            element_idx++;
+            continue;
+        }
+
         for (size_t i = 0; i < e.size; ++i)
         {
             size_t property_index = 0;
             for (auto & p : e.properties)
             {   
-                auto & f = element_property_lookup[element_idx][property_index];
+                auto & f = lookups[property_index];
                 auto * helper = f.helper;
                 if (f.skip || helper == nullptr) continue;
 
                 if (p.isList)
                 {
                     std::memcpy(listSize, &p.listCount, sizeof(uint32_t));
-                    write_property_binary(os, listSize, dummyCount, f.list_stride);
-                    write_property_binary(os, (helper->data->buffer.get() + helper->cursor->byteOffset), helper->cursor->byteOffset, f.prop_stride * p.listCount);
+                    append(listSize, f.list_stride);
+                    const size_t n = f.prop_stride * p.listCount;
+                    append(helper->data->buffer.get() + helper->cursor->byteOffset, n);
+                    helper->cursor->byteOffset += n;
                 }
                 else
                 {
-                    write_property_binary(os, (helper->data->buffer.get() + helper->cursor->byteOffset), helper->cursor->byteOffset, f.prop_stride);
+                    append(helper->data->buffer.get() + helper->cursor->byteOffset, f.prop_stride);
+                    helper->cursor->byteOffset += f.prop_stride;
                 }
                 property_index++;
             }
+            if (chunk.size() >= flushSize)
+            {
+                os.write(chunk.data(), chunk.size());
+                chunk.clear();
+            }
         }
         element_idx++;
     }
+    os.write(chunk.data(), chunk.size());
 }
 
 IGL_INLINE void PlyFile::PlyFileImpl::write_ascii_internal(std::ostream & os) noexcept
@@ -14,6 +14,7 @@
 
 namespace igl
 {
+  template <typename DerivedV, int DIM> class FlatAABB;
   // Unproject a screen location (using current opengl viewport, projection, and
   // model view) to a 3D position _onto_ a given mesh, if the ray through the
   // given screen location (x,y) _hits_ the mesh.
@@ -39,6 +40,20 @@ namespace igl
     const Eigen::MatrixBase<DerivedF> & F,
     int & fid,
     Eigen::PlainObjectBase<Derivedbc> & bc);
+  // Inputs:
+  //    tree  bounding volume hierarchy built with tree.init(V,F), so that
+  //      picking costs O(log #F) instead of O(#F)
+  template < typename DerivedV, typename DerivedF, typename Derivedbc>
+  IGL_INLINE bool unproject_onto_mesh(
+    const Eigen::Vector2f& pos,
+    const Eigen::Matrix4f& model,
+    const Eigen::Matrix4f& proj,
+    const Eigen::Vector4f& viewport,
+    const Eigen::MatrixBase<DerivedV> & V,
+    const Eigen::MatrixBase<DerivedF> & F,
+    const igl::FlatAABB<DerivedV,3> & tree,
+    int & fid,
+    Eigen::PlainObjectBase<Derivedbc> & bc);
   //
   // Inputs:
   //    pos        screen space coordinates
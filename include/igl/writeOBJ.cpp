@@ -6,6 +6,7 @@
 // v. 2.0. If a copy of the MPL was not distributed with this file, You can
 // obtain one at http://mozilla.org/MPL/2.0/.
 #include "writeOBJ.h"
+#include "write_rows.h"
 
 #include <iostream>
 #include <limits>
@@ -36,28 +37,40 @@ IGL_INLINE bool igl::writeOBJ(
     printf("IOError: %s could not be opened for writing...",str.c_str());
     return false;
   }
+  bool ok = true;
   // Loop over V
-  for(int i = 0;i<(int)V.rows();i++)
+  ok = ok && write_rows(obj_file,(int)V.rows(),
+    [&V](const int begin,const int end,std::string & out)
   {
-    fprintf(obj_file,"v");
-    for(int j = 0;j<(int)V.cols();++j)
+    for(int i = begin;i<end;i++)
     {
-      fprintf(obj_file," %0.17g", V(i,j));
+      out += 'v';
+      for(int j = 0;j<(int)V.cols();++j)
+      {
+        out += ' ';
+        append_number(out,V(i,j),17);
+      }
+      out += '\n';
     }
-    fprintf(obj_file,"\n");
-  }
+  });
   bool write_N = CN.rows() >0;
 
   if(write_N)
   {
-    for(int i = 0;i<(int)CN.rows();i++)
+    ok = ok && write_rows(obj_file,(int)CN.rows(),
+      [&CN](const int begin,const int end,std::string & out)
     {
-      fprintf(obj_file,"vn %0.17g %0.17g %0.17g\n",
-              CN(i,0),
-              CN(i,1),
-              CN(i,2)
-              );
-    }
+      for(int i = begin;i<end;i++)
+      {
+        out += "vn";
+        for(int j = 0;j<3;++j)
+        {
+          out += ' ';
+          append_number(out,CN(i,j),17);
+        }
+        out += '\n';
+      }
+    });
     fprintf(obj_file,"\n");
   }
 
@@ -65,36 +78,50 @@ IGL_INLINE bool igl::writeOBJ(
 
   if(write_texture_coords)
   {
-    for(int i = 0;i<(int)TC.rows();i++)
+    ok = ok && write_rows(obj_file,(int)TC.rows(),
+      [&TC](const int begin,const int end,std::string & out)
     {
-      fprintf(obj_file, "vt %0.17g %0.17g\n",TC(i,0),TC(i,1));
-    }
+      for(int i = begin;i<end;i++)
+      {
+        out += "vt ";
+        append_number(out,TC(i,0),17);
+        out += ' ';
+        append_number(out,TC(i,1),17);
+        out += '\n';
+      }
+    });
     fprintf(obj_file,"\n");
   }
 
   // loop over F
-  for(int i = 0;i<(int)F.rows();++i)
+  ok = ok && write_rows(obj_file,(int)F.rows(),
+    [&](const int begin,const int end,std::string & out)
   {
-    fprintf(obj_file,"f");
-    for(int j = 0; j<(int)F.cols();++j)
+    for(int i = begin;i<end;++i)
     {
-      // OBJ is 1-indexed
-      fprintf(obj_file," %u",F(i,j)+1);
-
-      if(write_texture_coords)
-        fprintf(obj_file,"/%u",FTC(i,j)+1);
-      if(write_N)
+      out += 'f';
+      for(int j = 0; j<(int)F.cols();++j)
       {
-        if (write_texture_coords)
-          fprintf(obj_file,"/%u",FN(i,j)+1);
-        else
-          fprintf(obj_file,"//%u",FN(i,j)+1);
+        // OBJ is 1-indexed (written like "%u")
+        out += ' ';
+        append_integer(out,(unsigned)(F(i,j)+1));
+
+        if(write_texture_coords)
+        {
+          out += '/';
+          append_integer(out,(unsigned)(FTC(i,j)+1));
+        }
+        if(write_N)
+        {
+          out += write_texture_coords ? "/" : "//";
+          append_integer(out,(unsigned)(FN(i,j)+1));
+        }
       }
+      out += '\n';
     }
-    fprintf(obj_file,"\n");
-  }
-  fclose(obj_file);
-  return true;
+  });
+  ok = fclose(obj_file) == 0 && ok;
+  return ok;
 }
 
 template <typename DerivedV, typename DerivedF>
@@ -106,16 +133,18 @@ IGL_INLINE bool igl::writeOBJ(
   using namespace std;
   using namespace Eigen;
   assert(V.cols() == 3 && "V should have 3 columns");
-  ofstream s(str);
-  if(!s.is_open())
+  FILE * obj_file = fopen(str.c_str(),"w");
+  if(NULL==obj_file)
   {
     fprintf(stderr,"IOError: writeOBJ() could not open %s\n",str.c_str());
     return false;
   }
-  s<<
-    V.format(IOFormat(FullPrecision,DontAlignCols," ","\n","v ","","","\n"))<<
-    (F.array()+1).format(IOFormat(FullPrecision,DontAlignCols," ","\n","f ","","","\n"));
-  return true;
+  // Same text as streaming V.format(IOFormat(FullPrecision,DontAlignCols,
+  // " ","\n","v ","","","\n")) and likewise (F.array()+1) with "f "
+  const bool ok =
+    write_matrix_rows(obj_file,V,"v ") &&
+    write_matrix_rows(obj_file,(F.array()+1).matrix(),"f ");
+  return fclose(obj_file) == 0 && ok;
 }
 
 template <typename DerivedV, typename T>
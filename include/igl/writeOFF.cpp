@@ -6,8 +6,8 @@
 // v. 2.0. If a copy of the MPL was not distributed with this file, You can
 // obtain one at http://mozilla.org/MPL/2.0/.
 #include "writeOFF.h"
+#include "write_rows.h"
 #include <cstdio>
-#include <fstream>
 
 // write mesh to an ascii off file
 template <typename DerivedV, typename DerivedF>
@@ -19,18 +19,22 @@ IGL_INLINE bool igl::writeOFF(
   using namespace std;
   using namespace Eigen;
   assert(V.cols() == 3 && "V should have 3 columns");
-  ofstream s(fname);
-  if(!s.is_open())
+  FILE * off_file = fopen(fname.c_str(),"w");
+  if(NULL==off_file)
   {
     fprintf(stderr,"IOError: writeOFF() could not open %s\n",fname.c_str());
     return false;
   }
-
-  s<<
-    "OFF\n"<<V.rows()<<" "<<F.rows()<<" 0\n"<<
-    V.format(IOFormat(FullPrecision,DontAlignCols," ","\n","","","","\n"))<<
-    (F.array()).format(IOFormat(FullPrecision,DontAlignCols," ","\n","3 ","","","\n"));
-  return true;
+  string header = "OFF\n";
+  append_integer(header,V.rows());
+  header += ' ';
+  append_integer(header,F.rows());
+  header += " 0\n";
+  const bool ok =
+    fputs(header.c_str(),off_file) >= 0 &&
+    write_matrix_rows(off_file,V,"") &&
+    write_matrix_rows(off_file,F,"3 ");
+  return fclose(off_file) == 0 && ok;
 }
 
 // write mesh and colors-by-vertex to an ascii off file
@@ -52,8 +56,8 @@ IGL_INLINE bool igl::writeOFF(
     return false;
   }
 
-  ofstream s(fname);
-  if(!s.is_open())
+  FILE * off_file = fopen(fname.c_str(),"w");
+  if(NULL==off_file)
   {
     fprintf(stderr,"IOError: writeOFF() could not open %s\n",fname.c_str());
     return false;
@@ -65,15 +69,38 @@ IGL_INLINE bool igl::writeOFF(
   // (https://github.com/libigl/libigl/pull/679)
   Eigen::Matrix<typename DerivedC::Scalar,Eigen::Dynamic,Eigen::Dynamic> RGB_Array = rgbScale * C;
 
-  s<< "COFF\n"<<V.rows()<<" "<<F.rows()<<" 0\n";
-  for (unsigned i=0; i< V.rows(); i++)
-  {
-    s <<V.row(i).format(IOFormat(FullPrecision,DontAlignCols," "," ","","",""," "));
-    s << unsigned(RGB_Array(i,0)) << " " << unsigned(RGB_Array(i,1)) << " " << unsigned(RGB_Array(i,2)) << " 255\n";
-  }
-
-  s<<(F.array()).format(IOFormat(FullPrecision,DontAlignCols," ","\n","3 ","","","\n"));
-  return true;
+  string header = "COFF\n";
+  append_integer(header,V.rows());
+  header += ' ';
+  append_integer(header,F.rows());
+  header += " 0\n";
+  // Vertex positions at Eigen's FullPrecision, followed by the color
+  typedef typename DerivedV::Scalar VScalar;
+  const int precision = NumTraits<VScalar>::IsInteger ? 0 :
+    int(Eigen::internal::significant_decimals_impl<VScalar>::run());
+  const bool ok =
+    fputs(header.c_str(),off_file) >= 0 &&
+    write_rows(off_file,V.rows(),
+      [&](const Index begin,const Index end,string & out)
+    {
+      for(Index i = begin;i<end;i++)
+      {
+        for(int j = 0;j<3;j++)
+        {
+          write_rows_detail::append(
+            out,V(i,j),precision,std::is_integral<VScalar>());
+          out += ' ';
+        }
+        for(int c = 0;c<3;c++)
+        {
+          append_integer(out,unsigned(RGB_Array(i,c)));
+          out += ' ';
+        }
+        out += "255\n";
+      }
+    }) &&
+    write_matrix_rows(off_file,F,"3 ");
+  return fclose(off_file) == 0 && ok;
 }
 
 #ifdef IGL_STATIC_LIBRARY
@@ -1,5 +1,6 @@
 #include "writePLY.h"
 #include <fstream>
+#include <type_traits>
 
 #include "tinyply.h"
 
@@ -16,6 +17,44 @@ namespace igl
   template <> tinyply::Type IGL_INLINE tynyply_type<float>(){ return tinyply::Type::FLOAT32; }
   template <> tinyply::Type IGL_INLINE tynyply_type<double>(){ return tinyply::Type::FLOAT64; }
 
+  // Row-major entries of M for tinyply: M's own storage if it already is
+  // laid out that way, otherwise a copy in tmp
+  template <
+    typename Scalar,
+    typename Derived,
+    bool Direct =
+      bool(Derived::Flags & Eigen::DirectAccessBit) &&
+      bool(Derived::IsRowMajor) &&
+      std::is_same<Scalar, typename Derived::Scalar>::value>
+  struct ply_row_major_data
+  {
+    static uint8_t * run(
+      const Eigen::MatrixBase<Derived> & M,
+      std::vector<Scalar> & tmp)
+    {
+      tmp.resize(M.size());
+      Eigen::Map<Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> >(
+        tmp.data(), M.rows(), M.cols()) = M;
+      return reinterpret_cast<uint8_t*>(tmp.data());
+    }
+  };
+  template <typename Scalar, typename Derived>
+  struct ply_row_major_data<Scalar, Derived, true>
+  {
+    static uint8_t * run(
+      const Eigen::MatrixBase<Derived> & M,
+      std::vector<Scalar> & tmp)
+    {
+      const Derived & D = M.derived();
+      if(D.innerStride() == 1 && D.outerStride() == D.cols())
+      {
+        // tinyply only reads from it
+        return reinterpret_cast<uint8_t*>(const_cast<Scalar*>(D.data()));
+      }
+      return ply_row_major_data<Scalar, Derived, false>::run(M, tmp);
+    }
+  };
+
 
 template <
   typename DerivedV,
@@ -59,7 +98,7 @@ bool writePLY(
     typedef typename DerivedED::Scalar EDScalar;
     
     // temporary storage for data to be passed to tinyply internals
-    std::vector<NScalar> _v;
+    std::vector<VScalar> _v;
     std::vector<NScalar> _n;
     std::vector<UVScalar> _uv;
     std::vector<VDScalar> _vd;
@@ -75,27 +114,19 @@ bool writePLY(
     }
     tinyply::PlyFile file;
 
-    _v.resize(V.size());
-    Eigen::Map< Eigen::Matrix<VScalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor > >( &_v[0], V.rows(), V.cols() ) = V;
-
     file.add_properties_to_element("vertex", { "x", "y", "z" }, 
-        tynyply_type<VScalar>(), V.rows(), reinterpret_cast<uint8_t*>( &_v[0] ), tinyply::Type::INVALID, 0);
+        tynyply_type<VScalar>(), V.rows(), ply_row_major_data<VScalar, DerivedV>::run(V, _v), tinyply::Type::INVALID, 0);
 
     if(N.rows()>0) 
     {
-        _n.resize(N.size());
-        Eigen::Map<Eigen::Matrix<NScalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor > >( &_n[0], N.rows(), N.cols() ) = N;
         file.add_properties_to_element("vertex", { "nx", "ny", "nz" },
-            tynyply_type<NScalar>(), N.rows(), reinterpret_cast<uint8_t*>( &_n[0] ),tinyply::Type::INVALID, 0);
+            tynyply_type<NScalar>(), N.rows(), ply_row_major_data<NScalar, DerivedN>::run(N, _n),tinyply::Type::INVALID, 0);
     }
 
     if(UV.rows()>0) 
     {
-        _uv.resize(UV.size());
-        Eigen::Map<Eigen::Matrix<UVScalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor > >( &_uv[0], UV.rows(), UV.cols() ) = UV;
-
         file.add_properties_to_element("vertex", { "u", "v" },
-            tynyply_type<UVScalar>(), UV.rows() , reinterpret_cast<uint8_t*>( &_uv[0] ), tinyply::Type::INVALID, 0);
+            tynyply_type<UVScalar>(), UV.rows() , ply_row_major_data<UVScalar, DerivedUV>::run(UV, _uv), tinyply::Type::INVALID, 0);
     }
 
     if(VD.cols()>0)
@@ -103,40 +134,30 @@ bool writePLY(
         assert(VD.cols() == VDheader.size());
         assert(VD.rows() == V.rows());
 
-        _vd.resize(VD.size());
-        Eigen::Map< Eigen::Matrix<VDScalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor > >( &_vd[0], VD.rows(), VD.cols() ) = VD;
-
         file.add_properties_to_element("vertex", VDheader,
-            tynyply_type<VDScalar>(), VD.rows(), reinterpret_cast<uint8_t*>( &_vd[0] ), tinyply::Type::INVALID, 0);
+            tynyply_type<VDScalar>(), VD.rows(), ply_row_major_data<VDScalar, DerivedVD>::run(VD, _vd), tinyply::Type::INVALID, 0);
     }
 
 
 
-    std::vector<FScalar> _f(F.size());
-    Eigen::Map<Eigen::Matrix<FScalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor > >( &_f[0], F.rows(), F.cols() ) = F;
+    std::vector<FScalar> _f;
     file.add_properties_to_element("face", { "vertex_indices" },
-        tynyply_type<FScalar>(), F.rows(), reinterpret_cast<uint8_t*>(&_f[0]), tinyply::Type::UINT8, F.cols() );
+        tynyply_type<FScalar>(), F.rows(), ply_row_major_data<FScalar, DerivedF>::run(F, _f), tinyply::Type::UINT8, F.cols() );
 
     if(FD.cols()>0)
     {
         assert(FD.rows()==F.rows());
         assert(FD.cols() == FDheader.size());
 
-        _fd.resize(FD.size());
-        Eigen::Map<Eigen::Matrix<FDScalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor > >( &_fd[0], FD.rows(), FD.cols() ) = FD;
-
         file.add_properties_to_element("face", FDheader,
-            tynyply_type<FDScalar>(), FD.rows(), reinterpret_cast<uint8_t*>( &_fd[0] ), tinyply::Type::INVALID, 0);
+            tynyply_type<FDScalar>(), FD.rows(), ply_row_major_data<FDScalar, DerivedFD>::run(FD, _fd), tinyply::Type::INVALID, 0);
     }
 
     if(E.rows()>0) 
     {
         assert(E.cols()==2);
-        _ev.resize(E.size());
-        Eigen::Map<Eigen::Matrix<EScalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor > >( &_ev[0], E.rows(), E.cols() ) = E;
-
         file.add_properties_to_element("edge", { "vertex1", "vertex2" },
-            tynyply_type<EScalar>(), E.rows() , reinterpret_cast<uint8_t*>( &_ev[0] ), tinyply::Type::INVALID, 0);
+            tynyply_type<EScalar>(), E.rows() , ply_row_major_data<EScalar, DerivedE>::run(E, _ev), tinyply::Type::INVALID, 0);
     }
 
     if(ED.cols()>0)
@@ -144,11 +165,8 @@ bool writePLY(
         assert(ED.rows()==F.rows());
         assert(ED.cols() == EDheader.size());
 
-        _ed.resize(ED.size());
-        Eigen::Map<Eigen::Matrix<EDScalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor > >( &_ed[0], ED.rows(), ED.cols() ) = ED;
-
         file.add_properties_to_element("face", FDheader,
-            tynyply_type<EDScalar>(), ED.rows(), reinterpret_cast<uint8_t*>( &_ed[0] ), tinyply::Type::INVALID, 0);
+            tynyply_type<EDScalar>(), ED.rows(), ply_row_major_data<EDScalar, DerivedED>::run(ED, _ed), tinyply::Type::INVALID, 0);
     }
 
     for(auto a:comments)
@@ -316,6 +334,48 @@ bool writePLY(
                          _dummy, _dummy_header, _dummy, _dummy_header, _dummy_header, force_ascii);
 }
 
+template <
+  typename DerivedV,
+  typename DerivedF
+>
+bool writePLY(
+  const std::string & filename,
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedF> & F,
+  const FileEncoding encoding
+   )
+{
+  Eigen::MatrixXd _dummy(0,0);
+  std::vector<std::string> _dummy_header;
+
+  return writePLY(filename,V,F,_dummy, _dummy,_dummy, _dummy, _dummy_header,
+                         _dummy, _dummy_header, _dummy, _dummy_header, _dummy_header,
+                         encoding == FileEncoding::Binary);
+}
+
+template <
+  typename DerivedV,
+  typename DerivedF,
+  typename DerivedN,
+  typename DerivedUV
+>
+bool writePLY(
+  const std::string & filename,
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedF> & F,
+  const Eigen::MatrixBase<DerivedN> & N,
+  const Eigen::MatrixBase<DerivedUV> & UV,
+  const FileEncoding encoding
+   )
+{
+  Eigen::MatrixXd _dummy(0,0);
+  std::vector<std::string> _dummy_header;
+
+  return writePLY(filename,V,F,_dummy, N,UV, _dummy, _dummy_header,
+                         _dummy, _dummy_header, _dummy, _dummy_header, _dummy_header,
+                         encoding == FileEncoding::Binary);
+}
+
 template <
   typename DerivedV,
   typename DerivedF,
@@ -405,4 +465,5 @@ bool writePLY(
 // Explicit template instantiation
 template bool igl::writePLY<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(std::basic_string<char, std::char_traits<char>, std::allocator<char> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&);
 template bool igl::writePLY<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<double, -1, -1, 0, -1, -1> >(std::basic_string<char, std::char_traits<char>, std::allocator<char> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, std::vector<std::basic_string<char, std::char_traits<char>, std::allocator<char> >, std::allocator<std::basic_string<char, std::char_traits<char>, std::allocator<char> > > > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, std::vector<std::basic_string<char, std::char_traits<char>, std::allocator<char> >, std::allocator<std::basic_string<char, std::char_traits<char>, std::allocator<char> > > > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, std::vector<std::basic_string<char, std::char_traits<char>, std::allocator<char> >, std::allocator<std::basic_string<char, std::char_traits<char>, std::allocator<char> > > > const&, std::vector<std::basic_string<char, std::char_traits<char>, std::allocator<char> >, std::allocator<std::basic_string<char, std::char_traits<char>, std::allocator<char> > > > const&, bool);
+template bool igl::writePLY<Eigen::Matrix<double, -1, -1, 0, -1, -1>, Eigen::Matrix<int, -1, -1, 0, -1, -1> >(std::basic_string<char, std::char_traits<char>, std::allocator<char> > const&, Eigen::MatrixBase<Eigen::Matrix<double, -1, -1, 0, -1, -1> > const&, Eigen::MatrixBase<Eigen::Matrix<int, -1, -1, 0, -1, -1> > const&, igl::FileEncoding);
 #endif
@@ -1,6 +1,7 @@
 #ifndef IGL_WRITEPLY_H
 #define IGL_WRITEPLY_H
 #include <igl/igl_inline.h>
+#include "FileEncoding.h"
 
 #include <string>
 #include <iostream>
@@ -167,6 +168,8 @@ bool writePLY(
    );
 
 
+// Note: despite its name, force_ascii = true writes a binary file (it is
+// passed on as isBinary). Prefer the FileEncoding overloads.
 template <
   typename DerivedV,
   typename DerivedF
@@ -178,6 +181,35 @@ bool writePLY(
   bool force_ascii
    );   
 
+// Inputs:
+//   encoding  FileEncoding::Binary (default of the other overloads) or
+//     FileEncoding::Ascii
+template <
+  typename DerivedV,
+  typename DerivedF
+>
+bool writePLY(
+  const std::string & filename,
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedF> & F,
+  const FileEncoding encoding
+   );
+
+template <
+  typename DerivedV,
+  typename DerivedF,
+  typename DerivedN,
+  typename DerivedUV
+>
+bool writePLY(
+  const std::string & filename,
+  const Eigen::MatrixBase<DerivedV> & V,
+  const Eigen::MatrixBase<DerivedF> & F,
+  const Eigen::MatrixBase<DerivedN> & N,
+  const Eigen::MatrixBase<DerivedUV> & UV,
+  const FileEncoding encoding
+   );
+
 template <
   typename DerivedV,
   typename DerivedF,
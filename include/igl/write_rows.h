@@ -0,0 +1,226 @@
+// This file is part of libigl, a simple c++ geometry processing library.
+//
+// This Source Code Form is subject to the terms of the Mozilla Public License
+// v. 2.0. If a copy of the MPL was not distributed with this file, You can
+// obtain one at http://mozilla.org/MPL/2.0/.
+#ifndef IGL_WRITE_ROWS_H
+#define IGL_WRITE_ROWS_H
+#include "igl_inline.h"
+#include <Eigen/Core>
+#include <cstdio>
+#include <string>
+
+namespace igl
+{
+  // Write the text of n rows (e.g. the vertex lines of a mesh file) to a
+  // file. Chunks of rows are formatted in parallel into separate buffers,
+  // which are then written in order with large writes, so the output is the
+  // same as formatting row by row.
+  //
+  // Inputs:
+  //   fp  file opened for writing
+  //   n  number of rows
+  //   format_rows  function handle appending the text of rows [begin,end) to
+  //     a string: format_rows(begin,end,out)
+  //   chunk_size  number of rows per chunk
+  // Returns false if writing failed
+  //
+  // Example:
+  //   igl::write_rows(fp,V.rows(),
+  //     [&V](const int begin,const int end,std::string & out)
+  //     {
+  //       for(int i = begin;i<end;i++)
+  //       {
+  //         out += "v";
+  //         for(int j = 0;j<V.cols();j++)
+  //         {
+  //           out += ' ';
+  //           igl::append_number(out,V(i,j),17);
+  //         }
+  //         out += '\n';
+  //       }
+  //     });
+  template <typename Index, typename FormatFunctionType>
+  inline bool write_rows(
+    FILE * fp,
+    const Index n,
+    const FormatFunctionType & format_rows,
+    const Index chunk_size = 16384);
+  // Write the rows of a matrix with write_rows, producing the same text as
+  // streaming M.format(Eigen::IOFormat(Eigen::FullPrecision,
+  // Eigen::DontAlignCols," ","\n",row_prefix,"","","\n"))
+  //
+  // Inputs:
+  //   fp  file opened for writing
+  //   M  #M by dim matrix (or expression)
+  //   row_prefix  text written before each row
+  // Returns false if writing failed
+  template <typename DerivedM>
+  inline bool write_matrix_rows(
+    FILE * fp,
+    const Eigen::MatrixBase<DerivedM> & M,
+    const std::string & row_prefix);
+  // Append a number formatted like printf("%.*g",precision,x). Integral
+  // values are formatted directly, others by snprintf.
+  inline void append_number(std::string & out, const double x, const int precision);
+  // Append an integer formatted like printf("%d") (or "%u" for unsigned
+  // types)
+  template <typename Integer>
+  inline void append_integer(std::string & out, const Integer x);
+}
+
+// Implementation
+
+#include "parallel_for.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+template <typename Index, typename FormatFunctionType>
+inline bool igl::write_rows(
+  FILE * fp,
+  const Index n,
+  const FormatFunctionType & format_rows,
+  const Index chunk_size)
+{
+  const Index num_chunks = (n + chunk_size - 1) / chunk_size;
+  // Format a few chunks per thread at a time to bound memory
+  const Index batch = Index(4*std::max(std::thread::hardware_concurrency(), 1u));
+  std::vector<std::string> text(std::size_t(std::min(batch, num_chunks)));
+  for(Index first = 0;first<num_chunks;first += batch)
+  {
+    const Index count = std::min(batch, num_chunks - first);
+    parallel_for(count,[&](const Index c)
+    {
+      std::string & out = text[c];
+      out.clear();
+      const Index begin = (first + c)*chunk_size;
+      format_rows(begin, std::min(begin + chunk_size, n), out);
+    },2);
+    for(Index c = 0;c<count;c++)
+    {
+      if(fwrite(text[c].data(), 1, text[c].size(), fp) != text[c].size())
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+namespace igl
+{
+  namespace write_rows_detail
+  {
+    template <typename Scalar>
+    inline void append(std::string & out, const Scalar x, const int, std::true_type)
+    {
+      append_integer(out, x);
+    }
+    template <typename Scalar>
+    inline void append(std::string & out, const Scalar x, const int precision, std::false_type)
+    {
+      append_number(out, double(x), precision);
+    }
+  }
+}
+
+template <typename DerivedM>
+inline bool igl::write_matrix_rows(
+  FILE * fp,
+  const Eigen::MatrixBase<DerivedM> & M,
+  const std::string & row_prefix)
+{
+  typedef typename DerivedM::Scalar Scalar;
+  // Eigen prints only the suffix of empty matrices
+  if(M.size() == 0)
+  {
+    return fputs("\n", fp) >= 0;
+  }
+  // Precision used by Eigen for FullPrecision (depends on its version)
+  const int precision = Eigen::NumTraits<Scalar>::IsInteger ? 0 :
+    int(Eigen::internal::significant_decimals_impl<Scalar>::run());
+  return write_rows(fp, M.rows(),
+    [&M,&row_prefix,precision](
+      const Eigen::Index begin,
+      const Eigen::Index end,
+      std::string & out)
+  {
+    for(Eigen::Index i = begin;i<end;i++)
+    {
+      out += row_prefix;
+      for(Eigen::Index j = 0;j<M.cols();j++)
+      {
+        if(j > 0)
+        {
+          out += ' ';
+        }
+        write_rows_detail::append(out, M.coeff(i,j), precision,
+          std::is_integral<Scalar>());
+      }
+      out += '\n';
+    }
+  });
+}
+
+inline void igl::append_number(std::string & out, const double x, const int precision)
+{
+  // %g prints integers with at most precision digits exactly, without a
+  // decimal point or exponent
+  if(precision >= 1 && precision <= 17 && std::isfinite(x) && x == std::trunc(x))
+  {
+    static const double pow10[18] = {1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,
+      1e10,1e11,1e12,1e13,1e14,1e15,1e16,1e17};
+    if(std::abs(x) < pow10[precision])
+    {
+      if(x == 0 && std::signbit(x))
+      {
+        out += "-0";
+      }else
+      {
+        append_integer(out, static_cast<long long>(x));
+      }
+      return;
+    }
+  }
+  char buf[64];
+  const int len = snprintf(buf, sizeof(buf), "%.*g", precision, x);
+  if(len < int(sizeof(buf)))
+  {
+    out.append(buf, std::size_t(std::max(len, 0)));
+    return;
+  }
+  // Huge precisions
+  std::vector<char> big(len + 1);
+  snprintf(big.data(), big.size(), "%.*g", precision, x);
+  out.append(big.data(), len);
+}
+
+template <typename Integer>
+inline void igl::append_integer(std::string & out, const Integer x)
+{
+  static_assert(std::is_integral<Integer>::value, "x must be an integer");
+  typedef typename std::make_unsigned<Integer>::type Unsigned;
+  // Magnitude (also of the most negative value) as unsigned
+  Unsigned u = static_cast<Unsigned>(x);
+  // (not x < 0, which unsigned types warn about)
+  if(x < Integer(1) && x != Integer(0))
+  {
+    out += '-';
+    u = Unsigned(0) - u;
+  }
+  char buf[std::numeric_limits<Unsigned>::digits10 + 2];
+  char * end = buf + sizeof(buf);
+  char * p = end;
+  do
+  {
+    *--p = char('0' + u % 10);
+    u /= 10;
+  }while(u != 0);
+  out.append(p, end);
+}
+
+#endif
@@ -0,0 +1,87 @@
+#include <test_common.h>
+#include <igl/AABB.h>
+#include <igl/point_mesh_squared_distance.h>
+#include <igl/triangulated_grid.h>
+
+TEST_CASE("AABB: refit", "[igl]")
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  igl::triangulated_grid(30,30,V,F);
+  igl::AABB<Eigen::MatrixXd,2> tree;
+  tree.init(V,F);
+  // Shear and fold
+  Eigen::MatrixXd U = V;
+  for(int v = 0;v<U.rows();v++)
+  {
+    U(v,0) = std::abs(U(v,0)-0.5) + 0.3*U(v,1);
+  }
+  tree.refit(U,F);
+  igl::AABB<Eigen::MatrixXd,2> fresh;
+  fresh.init(U,F);
+  REQUIRE(tree.m_box.min() == fresh.m_box.min());
+  REQUIRE(tree.m_box.max() == fresh.m_box.max());
+  const Eigen::MatrixXd P = Eigen::MatrixXd::Random(500,2);
+  Eigen::VectorXd sqrD, sqrD_exact;
+  Eigen::VectorXi I, I_exact;
+  Eigen::MatrixXd C, C_exact;
+  igl::point_mesh_squared_distance(P,U,F,sqrD_exact,I_exact,C_exact);
+  tree.squared_distance(U,F,P,sqrD,I,C);
+  test_common::assert_near(sqrD,sqrD_exact,1e-15);
+}
+
+TEST_CASE("AABB: intersect_rays", "[igl]")
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::bumpy_torus(40,V,F);
+  igl::AABB<Eigen::MatrixXd,3> tree;
+  tree.init(V,F);
+  // Some rays from the surface, some from the outside, one degenerate
+  Eigen::MatrixXd O(1001,3), D(1001,3);
+  O.topRows(500) = V.topRows(500);
+  O.middleRows(500,500) = 2.*Eigen::MatrixXd::Random(500,3);
+  D.topRows(1000) = Eigen::MatrixXd::Random(1000,3);
+  O.row(1000) << 0,0,0;
+  D.row(1000) << 0,0,0;
+  for(int r = 0;r<O.rows();r++)
+  {
+    D(r,r%3) = r%7 == 0 ? 0 : D(r,r%3);
+  }
+  for(const int packet_size : {4, 8, 16})
+  {
+    std::vector<igl::Hit> hits, any_hits;
+    const int num_hits =
+      tree.intersect_rays(
+        V,F,O,D,std::numeric_limits<double>::infinity(),false,hits,
+        packet_size);
+    REQUIRE(int(hits.size()) == O.rows());
+    REQUIRE(num_hits > 100);
+    REQUIRE(
+      tree.intersect_rays(V,F,O,D,1.,true,any_hits,packet_size) <= num_hits);
+    int expected_hits = 0;
+    for(int r = 0;r<O.rows();r++)
+    {
+      const Eigen::RowVector3d o = O.row(r);
+      const Eigen::RowVector3d d = D.row(r);
+      igl::Hit hit;
+      const bool any = tree.intersect_ray(V,F,o,d,hit);
+      expected_hits += any;
+      REQUIRE((hits[r].id >= 0) == any);
+      if(any)
+      {
+        REQUIRE(hits[r].id == hit.id);
+        REQUIRE(hits[r].t == hit.t);
+        REQUIRE(hits[r].u == hit.u);
+        REQUIRE(hits[r].v == hit.v);
+      }
+      // Any hit before t = 1
+      REQUIRE((any_hits[r].id >= 0) == (any && hit.t < 1));
+      if(any_hits[r].id >= 0)
+      {
+        REQUIRE(any_hits[r].t < 1);
+      }
+    }
+    REQUIRE(num_hits == expected_hits);
+  }
+}
@@ -0,0 +1,264 @@
+#include <test_common.h>
+#include <igl/FlatAABB.h>
+#include <igl/AABB.h>
+#include <igl/point_mesh_squared_distance.h>
+#include <igl/ray_mesh_intersect.h>
+#include <igl/triangulated_grid.h>
+
+TEST_CASE("FlatAABB: squared_distance", "[igl]")
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::wavy_grid(40,V,F);
+  const Eigen::MatrixXd P = Eigen::MatrixXd::Random(1000,3);
+  Eigen::VectorXd sqrD_exact;
+  Eigen::VectorXi I_exact;
+  Eigen::MatrixXd C_exact;
+  igl::point_mesh_squared_distance(P,V,F,sqrD_exact,I_exact,C_exact);
+  for(const int max_leaf_size : {1, 4, 16})
+  {
+    igl::FlatAABB<Eigen::MatrixXd,3> tree;
+    tree.init(V,F,max_leaf_size);
+    REQUIRE(sizeof(igl::FlatAABB<Eigen::MatrixXd,3>::Node) == 32);
+    REQUIRE(int(tree.m_primitives.size()) == F.rows());
+    Eigen::VectorXd sqrD;
+    Eigen::VectorXi I;
+    Eigen::MatrixXd C;
+    tree.squared_distance(V,F,P,sqrD,I,C);
+    test_common::assert_near(sqrD,sqrD_exact,1e-15);
+    test_common::assert_near(C,C_exact,1e-14);
+  }
+  // Upper bound
+  igl::FlatAABB<Eigen::MatrixXd,3> tree;
+  tree.init(V,F);
+  int i = -1;
+  Eigen::RowVector3d c;
+  const Eigen::RowVector3d p(0.5,0.5,1);
+  REQUIRE(tree.squared_distance(V,F,p,0.1,i,c) == 0.1);
+  REQUIRE(i == -1);
+  REQUIRE(tree.squared_distance(V,F,p,i,c) < 1);
+  REQUIRE(i >= 0);
+}
+
+TEST_CASE("FlatAABB: intersect_ray", "[igl]")
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::wavy_grid(40,V,F);
+  igl::FlatAABB<Eigen::MatrixXd,3> tree;
+  tree.init(V,F);
+  const Eigen::MatrixXd O = Eigen::MatrixXd::Random(200,3);
+  const Eigen::MatrixXd D = Eigen::MatrixXd::Random(200,3);
+  int num_hits = 0;
+  for(int r = 0;r<O.rows();r++)
+  {
+    const Eigen::RowVector3d o = O.row(r);
+    const Eigen::RowVector3d d = D.row(r);
+    std::vector<igl::Hit> hits_exact, hits;
+    const bool any = igl::ray_mesh_intersect(o,d,V,F,hits_exact);
+    REQUIRE(tree.intersect_ray(V,F,o,d,hits) == any);
+    REQUIRE(hits.size() == hits_exact.size());
+    igl::Hit hit;
+    REQUIRE(tree.intersect_ray(V,F,o,d,hit) == any);
+    if(any)
+    {
+      num_hits++;
+      REQUIRE(hit.t == hits_exact.front().t);
+      REQUIRE(hits.front().t == hits_exact.front().t);
+      // Nothing closer than the first hit
+      REQUIRE(!tree.intersect_ray(V,F,o,d,hit.t*0.999,hit));
+    }
+  }
+  REQUIRE(num_hits > 0);
+  // Axis aligned
+  const Eigen::RowVector3d o(0.5,0.5,1), d(0,0,-1);
+  igl::Hit hit, hit_exact;
+  REQUIRE(igl::ray_mesh_intersect(o,d,V,F,hit_exact));
+  REQUIRE(tree.intersect_ray(V,F,o,d,hit));
+  REQUIRE(hit.t == hit_exact.t);
+  REQUIRE(hit.id == hit_exact.id);
+}
+
+TEST_CASE("FlatAABB: find", "[igl]")
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  igl::triangulated_grid(30,30,V,F);
+  igl::FlatAABB<Eigen::MatrixXd,2> tree;
+  tree.init(V,F);
+  igl::AABB<Eigen::MatrixXd,2> aabb;
+  aabb.init(V,F);
+  const Eigen::MatrixXd Q = Eigen::MatrixXd::Random(300,2)*0.6;
+  for(int q = 0;q<Q.rows();q++)
+  {
+    const Eigen::RowVectorXd Qq = Q.row(q);
+    std::vector<int> found = tree.find(V,F,Qq);
+    std::vector<int> found_exact = aabb.find(V,F,Qq);
+    std::sort(found.begin(),found.end());
+    std::sort(found_exact.begin(),found_exact.end());
+    REQUIRE(found == found_exact);
+    REQUIRE(tree.find(V,F,Qq,true).size() == std::min<size_t>(found.size(),1));
+  }
+  tree.deinit();
+  REQUIRE(tree.empty());
+  REQUIRE(tree.find(V,F,Eigen::RowVector2d(0.5,0.5)).empty());
+}
+
+TEST_CASE("FlatAABB: refit", "[igl]")
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::wavy_grid(60,V,F);
+  igl::FlatAABB<Eigen::MatrixXd,3> tree;
+  tree.init(V,F);
+  const Eigen::MatrixXd P = Eigen::MatrixXd::Random(500,3);
+  const auto check = [&](const Eigen::MatrixXd & U)
+  {
+    Eigen::VectorXd sqrD, sqrD_exact;
+    Eigen::VectorXi I, I_exact;
+    Eigen::MatrixXd C, C_exact;
+    igl::point_mesh_squared_distance(P,U,F,sqrD_exact,I_exact,C_exact);
+    tree.squared_distance(U,F,P,sqrD,I,C);
+    test_common::assert_near(sqrD,sqrD_exact,1e-15);
+    for(int r = 0;r<50;r++)
+    {
+      const Eigen::RowVector3d o = P.row(r);
+      const Eigen::RowVector3d d = P.row(P.rows()-1-r);
+      igl::Hit hit, hit_exact;
+      REQUIRE(
+        tree.intersect_ray(U,F,o,d,hit) ==
+        igl::ray_mesh_intersect(o,d,U,F,hit_exact));
+    }
+  };
+  // Moving and scaling the mesh keeps the tree as good as new
+  Eigen::MatrixXd U = (2.*V).rowwise() + Eigen::RowVector3d(0.3,-0.2,0.1);
+  REQUIRE(tree.refit(U,F) == 0);
+  check(U);
+  // Folding the left half over the right half makes the halves overlap
+  U = V;
+  for(int v = 0;v<U.rows();v++)
+  {
+    U(v,0) = U(v,0) < 0.5 ? 1.-U(v,0) : U(v,0);
+  }
+  igl::FlatAABB<Eigen::MatrixXd,3> refit_only = tree;
+  REQUIRE(refit_only.refit(U,F,std::numeric_limits<float>::infinity()) == 0);
+  REQUIRE(refit_only.m_nodes.size() == tree.m_nodes.size());
+  const int rebuilt = tree.refit(U,F);
+  REQUIRE(rebuilt > 0);
+  check(U);
+  // The halves of the refit tree now coincide, the rebuilt one split
+  // elsewhere
+  REQUIRE(refit_only.overlap(0) > 0.9);
+  REQUIRE(tree.overlap(0) < 0.5);
+  // and stays good
+  REQUIRE(tree.refit(U,F) == 0);
+  check(U);
+  // Unfolding
+  REQUIRE(tree.refit(V,F) > 0);
+  check(V);
+  tree = refit_only;
+  check(U);
+  // Folding within each half only rebuilds below the root
+  tree.init(V,F);
+  U = V;
+  for(int v = 0;v<U.rows();v++)
+  {
+    U(v,0) = U(v,0) < 0.25 ? 0.5-U(v,0) : U(v,0) > 0.75 ? 1.5-U(v,0) : U(v,0);
+  }
+  const int rebuilt_halves = tree.refit(U,F);
+  REQUIRE(rebuilt_halves > 1);
+  check(U);
+  // Every element in exactly one leaf, every box containing its children
+  std::vector<int> seen(F.rows(),0);
+  for(int id = 0;id<int(tree.m_nodes.size());id++)
+  {
+    const auto & node = tree.m_nodes[id];
+    if(node.is_leaf())
+    {
+      for(int k = node.offset;k<node.offset+node.count;k++)
+      {
+        seen[tree.m_primitives[k]]++;
+      }
+      continue;
+    }
+    REQUIRE(node.offset > id+1);
+    REQUIRE(node.offset < int(tree.m_nodes.size()));
+    for(const int child : {id+1, node.offset})
+    {
+      for(int d = 0;d<3;d++)
+      {
+        REQUIRE(node.min[d] <= tree.m_nodes[child].min[d]);
+        REQUIRE(node.max[d] >= tree.m_nodes[child].max[d]);
+      }
+    }
+  }
+  REQUIRE(std::count(seen.begin(),seen.end(),1) == F.rows());
+}
+
+TEST_CASE("FlatAABB: benchmark", "[igl][.][benchmark]")
+{
+  // 2M triangles; hidden, run with libigl_tests "[benchmark]"
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::wavy_grid(1001,V,F);
+  const Eigen::MatrixXd P = Eigen::MatrixXd::Random(100000,3);
+  const Eigen::MatrixXd O = Eigen::MatrixXd::Random(100000,3);
+  const Eigen::MatrixXd D = Eigen::MatrixXd::Random(100000,3);
+  igl::AABB<Eigen::MatrixXd,3> aabb;
+  igl::FlatAABB<Eigen::MatrixXd,3> tree;
+  BENCHMARK("AABB::init")
+  {
+    aabb.init(V,F);
+    return aabb.m_box.volume();
+  };
+  BENCHMARK("FlatAABB::init")
+  {
+    tree.init(V,F);
+    return tree.m_nodes.size();
+  };
+  const Eigen::MatrixXd U = V*1.01;
+  BENCHMARK("AABB::refit")
+  {
+    aabb.refit(U,F);
+    return aabb.m_box.volume();
+  };
+  BENCHMARK("FlatAABB::refit")
+  {
+    return tree.refit(U,F);
+  };
+  Eigen::VectorXd sqrD;
+  Eigen::VectorXi I;
+  Eigen::MatrixXd C;
+  BENCHMARK("AABB::squared_distance, 100K points")
+  {
+    aabb.squared_distance(V,F,P,sqrD,I,C);
+    return sqrD.sum();
+  };
+  BENCHMARK("FlatAABB::squared_distance, 100K points")
+  {
+    tree.squared_distance(V,F,P,sqrD,I,C);
+    return sqrD.sum();
+  };
+  BENCHMARK("AABB::intersect_ray, 100K rays")
+  {
+    int hits = 0;
+    for(int r = 0;r<O.rows();r++)
+    {
+      igl::Hit hit;
+      hits += aabb.intersect_ray(
+        V,F,Eigen::RowVector3d(O.row(r)),Eigen::RowVector3d(D.row(r)),hit);
+    }
+    return hits;
+  };
+  BENCHMARK("FlatAABB::intersect_ray, 100K rays")
+  {
+    int hits = 0;
+    for(int r = 0;r<O.rows();r++)
+    {
+      igl::Hit hit;
+      hits += tree.intersect_ray(
+        V,F,Eigen::RowVector3d(O.row(r)),Eigen::RowVector3d(D.row(r)),hit);
+    }
+    return hits;
+  };
+}
@@ -0,0 +1,112 @@
+#include <test_common.h>
+#include <igl/MappedDMAT.h>
+#include <igl/readDMAT.h>
+#include <igl/writeDMAT.h>
+#include <cstdint>
+#include <cstdio>
+
+TEST_CASE("MappedDMAT: append frames", "[igl]")
+{
+  const std::string path = "test_MappedDMAT_frames.dmat";
+  const int n = 1000;
+  Eigen::MatrixXd frames = Eigen::MatrixXd::Random(3*n,10);
+  {
+    igl::DMATWriter writer;
+    REQUIRE(writer.open(path,3*n));
+    for(int f = 0;f<6;f++)
+    {
+      // A frame as a #V by 3 matrix
+      const Eigen::Map<const Eigen::MatrixXd> V(frames.col(f).data(),n,3);
+      REQUIRE(writer.append(Eigen::Map<const Eigen::VectorXd>(V.data(),V.size())));
+    }
+    // Wrong number of rows
+    REQUIRE(!writer.append(Eigen::MatrixXd::Zero(n,3)));
+    REQUIRE(writer.cols() == 6);
+    // Readable while still open
+    igl::MappedDMAT partial;
+    REQUIRE(partial.open(path));
+    REQUIRE(partial.cols() == 6);
+    REQUIRE(writer.close());
+  }
+  {
+    // Continue the file, with float columns
+    igl::DMATWriter writer;
+    REQUIRE(!writer.open(path,n,true));
+    REQUIRE(writer.open(path,3*n,true));
+    REQUIRE(writer.cols() == 6);
+    REQUIRE(writer.append(frames.rightCols(4).cast<float>().cast<double>()));
+    REQUIRE(writer.close());
+  }
+  igl::MappedDMAT mapped;
+  REQUIRE(mapped.open(path));
+  REQUIRE(mapped.is_mapped());
+  // Data starts at a page
+  REQUIRE(std::uintptr_t(mapped.matrix().data()) % 4096 == 0);
+  REQUIRE(mapped.rows() == 3*n);
+  REQUIRE(mapped.cols() == 10);
+  REQUIRE(mapped.matrix().leftCols(6) == frames.leftCols(6));
+  REQUIRE(mapped.columns(6,4) == frames.rightCols(4).cast<float>().cast<double>());
+  // Still a valid .dmat
+  Eigen::MatrixXd W;
+  REQUIRE(igl::readDMAT(path,W));
+  REQUIRE(W == mapped.matrix());
+  mapped.close();
+  std::remove(path.c_str());
+}
+
+TEST_CASE("MappedDMAT: other dmat files", "[igl]")
+{
+  const std::string path = "test_MappedDMAT_other.dmat";
+  const Eigen::MatrixXd W = Eigen::MatrixXd::Random(7,3);
+  for(const bool ascii : {true, false})
+  {
+    REQUIRE(igl::writeDMAT(path,W,ascii));
+    igl::MappedDMAT mapped;
+    REQUIRE(mapped.open(path));
+    REQUIRE(mapped.matrix() == W);
+    // Not padded for appending
+    igl::DMATWriter writer;
+    REQUIRE(!writer.open(path,7,true));
+  }
+  std::remove(path.c_str());
+  igl::MappedDMAT mapped;
+  REQUIRE(!mapped.open(path));
+  // Appending to a missing file creates it
+  igl::DMATWriter writer;
+  REQUIRE(writer.open(path,7,true));
+  REQUIRE(writer.append(W));
+  REQUIRE(writer.close());
+  REQUIRE(mapped.open(path));
+  REQUIRE(mapped.matrix() == W);
+  mapped.close();
+  std::remove(path.c_str());
+}
+
+TEST_CASE("MappedDMAT: benchmark", "[igl]" IGL_DEBUG_OFF)
+{
+  // 200 frames of 100K vertices
+  const std::string path = "test_MappedDMAT_benchmark.dmat";
+  const Eigen::MatrixXd frame = Eigen::MatrixXd::Random(300000,1);
+  {
+    igl::DMATWriter writer;
+    REQUIRE(writer.open(path,frame.rows()));
+    for(int f = 0;f<200;f++)
+    {
+      REQUIRE(writer.append(frame));
+    }
+    REQUIRE(writer.close());
+  }
+  Eigen::MatrixXd W;
+  BENCHMARK("readDMAT, one frame")
+  {
+    igl::readDMAT(path,W);
+    return W.col(100).sum();
+  };
+  BENCHMARK("MappedDMAT, one frame")
+  {
+    igl::MappedDMAT mapped;
+    mapped.open(path);
+    return mapped.columns(100,1).sum();
+  };
+  std::remove(path.c_str());
+}
@@ -0,0 +1,162 @@
+#include <test_common.h>
+#include <igl/MeshCache.h>
+#include <igl/file_exists.h>
+#include <igl/triangulated_grid.h>
+#include <igl/writeOBJ.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+
+TEST_CASE("MeshCache: round trip", "[igl]")
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  igl::triangulated_grid(30,20,V,F);
+  const Eigen::MatrixXd N = Eigen::MatrixXd::Random(V.rows(),3);
+  const Eigen::MatrixXd UV = V.leftCols(2);
+  const Eigen::MatrixXd S = Eigen::MatrixXd::Random(V.rows(),1);
+  const Eigen::MatrixXd empty;
+  const std::string path = "test_MeshCache.iglmesh";
+  REQUIRE(igl::MeshCache::write(path,V,F,N,UV,empty,S));
+
+  igl::MeshCache cache;
+  REQUIRE(cache.open(path));
+  REQUIRE(cache.V() == V);
+  REQUIRE(cache.F() == F);
+  REQUIRE(cache.N() == N);
+  REQUIRE(cache.UV() == UV);
+  REQUIRE(cache.S() == S);
+  REQUIRE(cache.C().size() == 0);
+  // Views point into the mapping
+  REQUIRE(reinterpret_cast<std::uintptr_t>(cache.V().data()) % 64 == 0);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(cache.F().data()) % 64 == 0);
+  // No source recorded
+  REQUIRE(!cache.is_current(path));
+  cache.close();
+  REQUIRE(cache.V().size() == 0);
+
+  // Flip a byte of the vertex data
+  {
+    std::fstream s(path,std::ios::in|std::ios::out|std::ios::binary);
+    s.seekg(200);
+    const char c = char(s.get() ^ 0x40);
+    s.seekp(200);
+    s.put(c);
+  }
+  REQUIRE(!cache.open(path));
+  REQUIRE(cache.open(path,false));
+  std::remove(path.c_str());
+}
+
+TEST_CASE("MeshCache: read_triangle_mesh reuses cache of unchanged file", "[igl]")
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::grid_mesh(10,V,F);
+  const std::string path = "test_MeshCache_grid.obj";
+  const std::string cache_path = igl::MeshCache::cache_path(path);
+  std::remove(cache_path.c_str());
+  REQUIRE(igl::writeOBJ(path,V,F));
+
+  Eigen::MatrixXd V1,V2;
+  Eigen::MatrixXi F1,F2;
+  REQUIRE(igl::read_triangle_mesh(path,V1,F1));
+  REQUIRE(igl::file_exists(cache_path));
+  {
+    igl::MeshCache cache;
+    REQUIRE(cache.open(cache_path));
+    REQUIRE(cache.is_current(path));
+  }
+  REQUIRE(igl::read_triangle_mesh(path,V2,F2));
+  REQUIRE(V2 == V1);
+  REQUIRE(F2 == F1);
+  // Also readable directly
+  REQUIRE(igl::read_triangle_mesh(cache_path,V2,F2));
+  REQUIRE(V2 == V1);
+  REQUIRE(F2 == F1);
+
+  // A cache recorded for the current file is trusted
+  const Eigen::MatrixXd V3 = 2*V1;
+  REQUIRE(igl::MeshCache::write(cache_path,V3,F1,path));
+  REQUIRE(igl::read_triangle_mesh(path,V2,F2));
+  REQUIRE(V2 == V3);
+
+  // Changing the file invalidates it
+  {
+    std::ofstream s(path,std::ios::app);
+    s<<"# changed\n";
+  }
+  REQUIRE(igl::read_triangle_mesh(path,V2,F2));
+  REQUIRE(V2 == V1);
+
+  // Fixed column types are filled from the cache too
+  Eigen::Matrix<float,Eigen::Dynamic,3,Eigen::RowMajor> Vf;
+  Eigen::Matrix<int,Eigen::Dynamic,3,Eigen::RowMajor> Ff;
+  REQUIRE(igl::read_triangle_mesh(path,Vf,Ff));
+  REQUIRE(Vf == V1.cast<float>());
+  REQUIRE(Ff == F1);
+
+  igl::MeshCache::enabled() = false;
+  std::remove(cache_path.c_str());
+  REQUIRE(igl::read_triangle_mesh(path,V2,F2));
+  REQUIRE(!igl::file_exists(cache_path));
+  igl::MeshCache::enabled() = true;
+  std::remove(path.c_str());
+}
+
+TEST_CASE("MeshCache: float read does not cache rounded positions", "[igl]")
+{
+  const std::string path = "test_MeshCache_float.obj";
+  const std::string cache_path = igl::MeshCache::cache_path(path);
+  std::remove(cache_path.c_str());
+  {
+    std::ofstream s(path);
+    s<<"v 0.1 0.2 0.3\nv 1.1 0.2 0.3\nv 0.1 1.2 0.3\nf 1 2 3\n";
+  }
+  Eigen::MatrixXf Vf;
+  Eigen::MatrixXi F;
+  REQUIRE(igl::read_triangle_mesh(path,Vf,F));
+  REQUIRE(Vf(0,0) == 0.1f);
+  REQUIRE(!igl::file_exists(cache_path));
+  Eigen::MatrixXd V;
+  REQUIRE(igl::read_triangle_mesh(path,V,F));
+  REQUIRE(V(0,0) == 0.1);
+  REQUIRE(igl::file_exists(cache_path));
+  // Float reads still use the cache written by the double read
+  REQUIRE(igl::read_triangle_mesh(path,Vf,F));
+  REQUIRE(Vf == V.cast<float>());
+  REQUIRE(igl::read_triangle_mesh(path,V,F));
+  REQUIRE(V(0,0) == 0.1);
+  std::remove(cache_path.c_str());
+  std::remove(path.c_str());
+}
+
+TEST_CASE("MeshCache: benchmark", "[igl]" IGL_DEBUG_OFF)
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::grid_mesh(300,V,F);
+  const std::string path = "test_MeshCache_benchmark.obj";
+  REQUIRE(igl::writeOBJ(path,V,F));
+  REQUIRE(igl::MeshCache::write(igl::MeshCache::cache_path(path),V,F,path));
+
+  BENCHMARK("parse obj") {
+    igl::MeshCache::enabled() = false;
+    igl::read_triangle_mesh(path,V,F);
+    igl::MeshCache::enabled() = true;
+    return V.rows();
+  };
+
+  BENCHMARK("read_triangle_mesh from cache") {
+    igl::read_triangle_mesh(path,V,F);
+    return V.rows();
+  };
+
+  BENCHMARK("map cache") {
+    igl::MeshCache cache;
+    cache.open(igl::MeshCache::cache_path(path),false);
+    return cache.V().rows();
+  };
+  std::remove(igl::MeshCache::cache_path(path).c_str());
+  std::remove(path.c_str());
+}
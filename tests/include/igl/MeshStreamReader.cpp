@@ -0,0 +1,162 @@
+#include <test_common.h>
+#include <igl/MeshStreamReader.h>
+#include <igl/MeshStreamWriter.h>
+#include <igl/doublearea.h>
+#include <igl/readPLY.h>
+#include <igl/readSTL.h>
+#include <igl/writePLY.h>
+#include <igl/writeSTL.h>
+#include <cstdio>
+
+namespace
+{
+  // Concatenate all blocks of a reader
+  void read_all(
+    igl::MeshStreamReader & reader,
+    Eigen::MatrixXd & V,
+    Eigen::MatrixXi & F)
+  {
+    Eigen::MatrixXd Vb;
+    Eigen::MatrixXi Fb;
+    V.resize(0,3);
+    F.resize(0,3);
+    while(reader.read_vertices(Vb))
+    {
+      REQUIRE(Vb.rows() <= reader.block_size);
+      V.conservativeResize(V.rows()+Vb.rows(),3);
+      V.bottomRows(Vb.rows()) = Vb;
+    }
+    while(reader.read_faces(Fb))
+    {
+      F.conservativeResize(F.rows()+Fb.rows(),3);
+      F.bottomRows(Fb.rows()) = Fb;
+    }
+  }
+}
+
+TEST_CASE("MeshStreamReader: binary PLY", "[igl]")
+{
+  Eigen::MatrixXd V,N,UV;
+  Eigen::MatrixXi F;
+  test_common::grid_mesh(40,V,F);
+  N = Eigen::MatrixXd::Random(V.rows(),3);
+  UV = V.leftCols(2);
+  // Extra properties are skipped
+  const std::string path = "test_MeshStreamReader.ply";
+  REQUIRE(igl::writePLY(path,V,F,N,UV));
+
+  igl::MeshStreamReader reader(100);
+  REQUIRE(reader.open(path));
+  REQUIRE(reader.num_vertices() == V.rows());
+  REQUIRE(reader.num_faces() == F.rows());
+  Eigen::MatrixXd sV;
+  Eigen::MatrixXi sF;
+  read_all(reader,sV,sF);
+  REQUIRE(sV == V);
+  REQUIRE(sF == F);
+
+  // Blockwise bounding box, interleaving vertices and faces
+  REQUIRE(reader.rewind());
+  Eigen::MatrixXd Vb;
+  Eigen::MatrixXi Fb;
+  Eigen::RowVector3d min_corner = Eigen::RowVector3d::Constant(1e300);
+  int max_index = -1;
+  while(reader.read_vertices(Vb))
+  {
+    min_corner = min_corner.cwiseMin(Vb.colwise().minCoeff());
+    if(reader.read_faces(Fb))
+    {
+      max_index = std::max(max_index,Fb.maxCoeff());
+    }
+  }
+  while(reader.read_faces(Fb))
+  {
+    max_index = std::max(max_index,Fb.maxCoeff());
+  }
+  REQUIRE(min_corner == V.colwise().minCoeff());
+  REQUIRE(max_index == F.maxCoeff());
+
+  // Round trip through the streaming writer
+  const std::string out_path = "test_MeshStreamWriter.ply";
+  {
+    REQUIRE(reader.rewind());
+    igl::MeshStreamWriter writer;
+    REQUIRE(writer.open(out_path));
+    while(reader.read_vertices(Vb))
+    {
+      REQUIRE(writer.write_vertices(Vb));
+    }
+    while(reader.read_faces(Fb))
+    {
+      REQUIRE(writer.write_faces(Fb));
+    }
+    REQUIRE(!writer.write_vertices(V));
+    REQUIRE(writer.close());
+  }
+  Eigen::MatrixXd rV;
+  Eigen::MatrixXi rF;
+  REQUIRE(igl::readPLY(out_path,rV,rF));
+  REQUIRE(rV == V);
+  REQUIRE(rF == F);
+  std::remove(path.c_str());
+  std::remove(out_path.c_str());
+}
+
+TEST_CASE("MeshStreamReader: binary STL", "[igl]")
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::grid_mesh(30,V,F);
+  const std::string path = "test_MeshStreamReader.stl";
+  REQUIRE(igl::writeSTL(path,V,F,false));
+  Eigen::MatrixXd eV,eN;
+  Eigen::MatrixXi eF;
+  REQUIRE(igl::readSTL(path,eV,eF,eN));
+
+  igl::MeshStreamReader reader(256);
+  REQUIRE(reader.open(path));
+  REQUIRE(reader.num_faces() == F.rows());
+  Eigen::MatrixXd sV;
+  Eigen::MatrixXi sF;
+  read_all(reader,sV,sF);
+  REQUIRE(sV == eV);
+  REQUIRE(sF == eF);
+
+  // Area of the soup block by block
+  REQUIRE(reader.rewind());
+  Eigen::MatrixXd Vb;
+  Eigen::VectorXd A;
+  double area = 0;
+  while(reader.read_vertices(Vb))
+  {
+    const Eigen::Index m = Vb.rows()/3;
+    Eigen::MatrixXi Fb(m,3);
+    for(Eigen::Index f = 0;f<m;f++)
+    {
+      Fb.row(f) << 3*f, 3*f+1, 3*f+2;
+    }
+    igl::doublearea(Vb,Fb,A);
+    area += A.sum();
+  }
+  igl::doublearea(eV,eF,A);
+  REQUIRE(area == Approx(A.sum()));
+
+  // Soup written block by block
+  const std::string out_path = "test_MeshStreamWriter.stl";
+  {
+    igl::MeshStreamWriter writer;
+    REQUIRE(writer.open(out_path));
+    REQUIRE(!writer.write_vertices(V));
+    const Eigen::Index half = F.rows()/2;
+    REQUIRE(writer.write_triangles(V,F.topRows(half).eval()));
+    REQUIRE(writer.write_triangles(V,F.bottomRows(F.rows()-half).eval()));
+    REQUIRE(writer.close());
+  }
+  Eigen::MatrixXd rV,rN;
+  Eigen::MatrixXi rF;
+  REQUIRE(igl::readSTL(out_path,rV,rF,rN));
+  REQUIRE(rV == eV);
+  REQUIRE(rF == eF);
+  std::remove(path.c_str());
+  std::remove(out_path.c_str());
+}
@@ -0,0 +1,241 @@
+#include <test_common.h>
+#include <igl/SerializationArchive.h>
+#include <igl/lz4_block.h>
+#include <igl/serialize.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+namespace
+{
+  struct Session : public igl::Serializable
+  {
+    Eigen::MatrixXd V;
+    Eigen::MatrixXi F;
+    std::string name;
+    std::map<std::string,int> counts;
+    void InitSerialization()
+    {
+      Add(V,"V");
+      Add(F,"F");
+      Add(name,"name");
+      Add(counts,"counts");
+    }
+  };
+
+  // Compressible smooth data
+  Eigen::MatrixXd smooth_data(const int n)
+  {
+    Eigen::MatrixXd V(n,3);
+    for(int i = 0;i<n;i++)
+    {
+      V.row(i) << i%100, (i/100)%100, 0.25*(i%7);
+    }
+    return V;
+  }
+
+  std::size_t file_size(const std::string & path)
+  {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    return std::size_t(f.tellg());
+  }
+}
+
+TEST_CASE("lz4_block: round trip", "[igl]")
+{
+  std::vector<std::vector<char> > inputs;
+  for(const std::size_t n : {0, 1, 5, 12, 13, 17, 100, 70000, 300000})
+  {
+    std::vector<char> random(n), repetitive(n);
+    for(std::size_t i = 0;i<n;i++)
+    {
+      random[i] = char(std::rand());
+      repetitive[i] = char("abcabcabd"[i%9] + (i/1000)%3);
+    }
+    inputs.push_back(random);
+    inputs.push_back(repetitive);
+    inputs.push_back(std::vector<char>(n,'x'));
+  }
+  for(const auto & input : inputs)
+  {
+    std::vector<char> compressed;
+    igl::lz4_compress_block(input.data(),input.size(),compressed);
+    REQUIRE(compressed.size() <= igl::lz4_compress_bound(input.size()));
+    std::vector<char> output(input.size());
+    REQUIRE(igl::lz4_decompress_block(
+      compressed.data(),compressed.size(),output.data(),output.size()));
+    REQUIRE(output == input);
+    if(input.size() > 100)
+    {
+      // Truncated and wrong size blocks are rejected
+      REQUIRE(!igl::lz4_decompress_block(
+        compressed.data(),compressed.size()-1,output.data(),output.size()));
+      REQUIRE(!igl::lz4_decompress_block(
+        compressed.data(),compressed.size(),output.data(),output.size()-1));
+    }
+  }
+  // Block following the format specification: a literal, a match of 14
+  // bytes at offset 1 and 5 final literals
+  const char reference[] = {0x1a, 'a', 0x01, 0x00, 0x50, 'a','a','a','a','a'};
+  char output[20];
+  REQUIRE(igl::lz4_decompress_block(reference,sizeof(reference),output,20));
+  REQUIRE(std::string(output,20) == std::string(20,'a'));
+}
+
+TEST_CASE("SerializationArchive: round trip", "[igl]")
+{
+  const std::string path = "test_SerializationArchive.igl";
+  Session session;
+  session.V = smooth_data(500000);
+  session.F = Eigen::MatrixXi::Random(1000,3);
+  session.name = "bunny";
+  session.counts["faces"] = 1000;
+  const Eigen::MatrixXd noise = Eigen::MatrixXd::Random(1000,3);
+  std::vector<int> list(300);
+  std::iota(list.begin(),list.end(),0);
+  Eigen::SparseMatrix<double> S(100,100);
+  S.insert(3,4) = 1.5;
+  S.insert(99,0) = -2;
+  S.makeCompressed();
+
+  for(const bool compress : {true, false})
+  {
+    {
+      igl::ArchiveWriter archive;
+      REQUIRE(archive.open(path,compress));
+      REQUIRE(archive.write("session",session));
+      REQUIRE(archive.write("noise",noise));
+      REQUIRE(archive.write("list",list));
+      REQUIRE(archive.write("sparse",S));
+      REQUIRE(archive.write("empty",std::string()));
+      REQUIRE(archive.write("list",std::vector<int>(1,7)));
+      REQUIRE(archive.close());
+    }
+    if(compress)
+    {
+      REQUIRE(file_size(path) < session.V.size()*sizeof(double)/4);
+    }else
+    {
+      REQUIRE(file_size(path) > session.V.size()*sizeof(double));
+    }
+
+    igl::ArchiveReader archive;
+    REQUIRE(archive.open(path));
+    REQUIRE(archive.names() ==
+      std::vector<std::string>({"empty","list","noise","session","sparse"}));
+    // Single members, in any order
+    Eigen::MatrixXd rnoise;
+    REQUIRE(archive.read("noise",rnoise));
+    REQUIRE(rnoise == noise);
+    Session rsession;
+    REQUIRE(archive.read("session",rsession));
+    REQUIRE(rsession.V == session.V);
+    REQUIRE(rsession.F == session.F);
+    REQUIRE(rsession.name == session.name);
+    REQUIRE(rsession.counts == session.counts);
+    // Later member replaces the earlier one
+    std::vector<int> rlist;
+    REQUIRE(archive.read("list",rlist));
+    REQUIRE(rlist == std::vector<int>(1,7));
+    Eigen::SparseMatrix<double> rS;
+    REQUIRE(archive.read("sparse",rS));
+    REQUIRE(rS.nonZeros() == 2);
+    REQUIRE(rS.coeff(99,0) == -2);
+    std::string empty = "not empty";
+    REQUIRE(archive.read("empty",empty));
+    REQUIRE(empty.empty());
+    // Missing member or wrong type
+    REQUIRE(!archive.contains("missing"));
+    REQUIRE(!archive.read("missing",rnoise));
+    Eigen::MatrixXf wrong;
+    REQUIRE(!archive.read("noise",wrong));
+    REQUIRE(wrong.size() == 0);
+  }
+  std::remove(path.c_str());
+}
+
+TEST_CASE("SerializationArchive: invalid files", "[igl]")
+{
+  const std::string path = "test_SerializationArchive_invalid.igl";
+  // Not an archive
+  const Eigen::MatrixXd V = smooth_data(200000);
+  REQUIRE(igl::serialize(V,"V",path,true));
+  igl::ArchiveReader archive;
+  REQUIRE(!archive.open(path));
+
+  {
+    igl::ArchiveWriter writer;
+    REQUIRE(writer.open(path));
+    REQUIRE(writer.write("V",V));
+    REQUIRE(writer.close());
+  }
+  std::vector<char> bytes(file_size(path));
+  {
+    std::ifstream f(path, std::ios::binary);
+    f.read(bytes.data(),bytes.size());
+  }
+  const auto write_bytes = [&path](const std::vector<char> & b)
+  {
+    std::ofstream f(path, std::ios::binary);
+    f.write(b.data(),b.size());
+  };
+  Eigen::MatrixXd rV;
+
+  // Corrupt compressed data
+  std::vector<char> corrupt = bytes;
+  for(std::size_t i = 100;i<corrupt.size()/2;i += 97)
+  {
+    corrupt[i] = char(i);
+  }
+  write_bytes(corrupt);
+  REQUIRE(archive.open(path));
+  REQUIRE(!archive.read("V",rV));
+
+  // Truncated
+  write_bytes(std::vector<char>(bytes.begin(),bytes.begin()+bytes.size()/2));
+  REQUIRE(!archive.open(path));
+
+  // Newer version
+  corrupt = bytes;
+  corrupt[8] = 2;
+  write_bytes(corrupt);
+  REQUIRE(!archive.open(path));
+
+  write_bytes(bytes);
+  REQUIRE(archive.open(path));
+  REQUIRE(archive.read("V",rV));
+  REQUIRE(rV == V);
+  archive.close();
+  std::remove(path.c_str());
+}
+
+TEST_CASE("SerializationArchive: benchmark", "[igl]" IGL_DEBUG_OFF)
+{
+  Session session;
+  session.V = smooth_data(2000000);
+  session.F = Eigen::MatrixXi::Random(2000000,3);
+  const std::string path = "test_SerializationArchive_benchmark.igl";
+  const std::string old_path = "test_SerializationArchive_benchmark.bin";
+  Session loaded;
+  BENCHMARK("serialize")
+  {
+    return igl::serialize(session,"session",old_path,true);
+  };
+  BENCHMARK("deserialize")
+  {
+    return igl::deserialize(loaded,"session",old_path);
+  };
+  BENCHMARK("ArchiveWriter")
+  {
+    igl::ArchiveWriter archive;
+    return archive.open(path) && archive.write("session",session) && archive.close();
+  };
+  BENCHMARK("ArchiveReader")
+  {
+    igl::ArchiveReader archive;
+    return archive.open(path) && archive.read("session",loaded);
+  };
+  REQUIRE(loaded.V == session.V);
+  std::remove(path.c_str());
+  std::remove(old_path.c_str());
+}
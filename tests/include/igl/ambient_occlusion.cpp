@@ -0,0 +1,68 @@
+#include <test_common.h>
+#include <igl/ambient_occlusion.h>
+#include <igl/AABB.h>
+#include <igl/per_vertex_normals.h>
+
+namespace
+{
+  // One ray at a time through the tree
+  template <typename DerivedV>
+  std::function<bool(const Eigen::Vector3f&,const Eigen::Vector3f&)>
+    shoot_ray(
+      const igl::AABB<DerivedV,3> & aabb,
+      const Eigen::MatrixXd & V,
+      const Eigen::MatrixXi & F)
+  {
+    return [&aabb,&V,&F](const Eigen::Vector3f& _s, const Eigen::Vector3f& dir)
+    {
+      const Eigen::Vector3f s = _s+1e-4*dir;
+      igl::Hit hit;
+      return aabb.intersect_ray(
+        V,F,Eigen::RowVector3d(s.cast<double>()),
+        Eigen::RowVector3d(dir.cast<double>()),hit);
+    };
+  }
+}
+
+TEST_CASE("ambient_occlusion: AABB", "[igl]")
+{
+  Eigen::MatrixXd V, N;
+  Eigen::MatrixXi F;
+  test_common::bumpy_torus(40,V,F);
+  igl::per_vertex_normals(V,F,N);
+  igl::AABB<Eigen::MatrixXd,3> aabb;
+  aabb.init(V,F);
+  Eigen::VectorXd S, S_exact;
+  // Same random directions
+  srand(0);
+  igl::ambient_occlusion(shoot_ray(aabb,V,F),V,N,64,S_exact);
+  srand(0);
+  igl::ambient_occlusion(aabb,V,F,V,N,64,S);
+  test_common::assert_eq(S,S_exact);
+  // The inside of the ring is more occluded than the outside
+  REQUIRE(S.maxCoeff() > 0.2);
+  REQUIRE(S.minCoeff() < 0.1);
+}
+
+TEST_CASE("ambient_occlusion: benchmark", "[igl][.][benchmark]")
+{
+  // Per-vertex bake of a 90K-vertex mesh; hidden, run with
+  // libigl_tests "[benchmark]" --benchmark-samples 3
+  Eigen::MatrixXd V, N;
+  Eigen::MatrixXi F;
+  test_common::bumpy_torus(300,V,F);
+  igl::per_vertex_normals(V,F,N);
+  igl::AABB<Eigen::MatrixXd,3> aabb;
+  aabb.init(V,F);
+  Eigen::VectorXd S;
+  BENCHMARK("ambient_occlusion, one ray at a time, 90K points, 64 samples")
+  {
+    igl::ambient_occlusion(shoot_ray(aabb,V,F),V,N,64,S);
+    return S.sum();
+  };
+  BENCHMARK("ambient_occlusion, packets, 90K points, 64 samples")
+  {
+    igl::ambient_occlusion(aabb,V,F,V,N,64,S);
+    return S.sum();
+  };
+}
@@ -0,0 +1,159 @@
+#include <test_common.h>
+#include <igl/block_compress.h>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+  // Reference decoders of BC1 (four color mode) and BC7 mode 6
+  void decode_bc1(const unsigned char * b, unsigned char (&px)[16][4])
+  {
+    const int c0 = b[0] | (b[1]<<8);
+    const int c1 = b[2] | (b[3]<<8);
+    REQUIRE(c0 >= c1);
+    int palette[4][3];
+    const int c[2] = {c0,c1};
+    for(int k = 0;k<2;k++)
+    {
+      const int r = c[k]>>11, g = (c[k]>>5)&63, bl = c[k]&31;
+      palette[k][0] = (r<<3)|(r>>2);
+      palette[k][1] = (g<<2)|(g>>4);
+      palette[k][2] = (bl<<3)|(bl>>2);
+    }
+    for(int j = 0;j<3;j++)
+    {
+      palette[2][j] = (2*palette[0][j]+palette[1][j])/3;
+      palette[3][j] = (palette[0][j]+2*palette[1][j])/3;
+    }
+    const std::uint32_t bits = b[4] | (b[5]<<8) | (b[6]<<16) | (std::uint32_t(b[7])<<24);
+    for(int i = 0;i<16;i++)
+    {
+      const int k = c0 == c1 ? 0 : (bits>>(2*i))&3;
+      for(int j = 0;j<3;j++) px[i][j] = palette[k][j];
+      px[i][3] = 255;
+    }
+  }
+
+  unsigned get_bits(const unsigned char * b, int & pos, const int n)
+  {
+    unsigned v = 0;
+    for(int i = 0;i<n;i++,pos++)
+    {
+      v |= unsigned((b[pos/8]>>(pos%8))&1) << i;
+    }
+    return v;
+  }
+
+  void decode_bc7_mode6(const unsigned char * b, unsigned char (&px)[16][4])
+  {
+    static const int weights[16] =
+      {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+    int pos = 0;
+    REQUIRE(get_bits(b,pos,7) == 64);
+    int e[2][4];
+    for(int c = 0;c<4;c++)
+    {
+      e[0][c] = get_bits(b,pos,7);
+      e[1][c] = get_bits(b,pos,7);
+    }
+    const int p0 = get_bits(b,pos,1);
+    const int p1 = get_bits(b,pos,1);
+    for(int c = 0;c<4;c++)
+    {
+      e[0][c] = 2*e[0][c]+p0;
+      e[1][c] = 2*e[1][c]+p1;
+    }
+    for(int i = 0;i<16;i++)
+    {
+      const int w = weights[get_bits(b,pos,i == 0 ? 3 : 4)];
+      for(int c = 0;c<4;c++) px[i][c] = ((64-w)*e[0][c] + w*e[1][c] + 32)>>6;
+    }
+    REQUIRE(pos == 128);
+  }
+
+  // Root mean squared error of the first C channels after a round trip
+  double rmse(
+    const int w,
+    const int h,
+    const std::vector<unsigned char> & rgba,
+    const igl::BlockCompressionType type,
+    const int C)
+  {
+    std::vector<unsigned char> blocks;
+    igl::block_compress(w,h,rgba.data(),type,blocks);
+    REQUIRE(blocks.size() == igl::block_compress_size(w,h,type));
+    const int bw = (w+3)/4;
+    double sum = 0;
+    for(int by = 0;by<(h+3)/4;by++)
+    {
+      for(int bx = 0;bx<bw;bx++)
+      {
+        unsigned char px[16][4];
+        if(type == igl::BLOCK_COMPRESSION_TYPE_BC1)
+        {
+          decode_bc1(blocks.data()+(by*bw+bx)*8,px);
+        }else
+        {
+          decode_bc7_mode6(blocks.data()+(by*bw+bx)*16,px);
+        }
+        for(int i = 0;i<16;i++)
+        {
+          const int x = 4*bx+i%4, y = 4*by+i/4;
+          if(x >= w || y >= h) continue;
+          for(int c = 0;c<C;c++)
+          {
+            const double d = double(px[i][c]) - rgba[(y*w+x)*4+c];
+            sum += d*d;
+          }
+        }
+      }
+    }
+    return std::sqrt(sum/(w*h*C));
+  }
+}
+
+TEST_CASE("block_compress: round trip", "[igl]")
+{
+  // Gradient along a line of colors, with a partial block at the border
+  const int w = 37, h = 22;
+  std::vector<unsigned char> rgba(w*h*4);
+  for(int y = 0;y<h;y++)
+  {
+    for(int x = 0;x<w;x++)
+    {
+      unsigned char * p = rgba.data()+(y*w+x)*4;
+      const int g = 255*(x+2*y)/(w+2*h);
+      p[0] = (unsigned char)g;
+      p[1] = (unsigned char)(g/2+50);
+      p[2] = (unsigned char)(255-g);
+      p[3] = 255;
+    }
+  }
+  REQUIRE(rmse(w,h,rgba,igl::BLOCK_COMPRESSION_TYPE_BC1,3) < 3.0);
+  REQUIRE(rmse(w,h,rgba,igl::BLOCK_COMPRESSION_TYPE_BC7,4) < 1.0);
+  // Independent smooth channels do not lie on a line in each block
+  for(int y = 0;y<h;y++)
+  {
+    for(int x = 0;x<w;x++)
+    {
+      unsigned char * p = rgba.data()+(y*w+x)*4;
+      p[0] = (unsigned char)(255*x/(w-1));
+      p[1] = (unsigned char)(255*y/(h-1));
+      p[2] = (unsigned char)(128+100*std::sin(0.3*x+0.2*y));
+      p[3] = (unsigned char)(255-3*y);
+    }
+  }
+  REQUIRE(rmse(w,h,rgba,igl::BLOCK_COMPRESSION_TYPE_BC1,3) < 10.0);
+  REQUIRE(rmse(w,h,rgba,igl::BLOCK_COMPRESSION_TYPE_BC7,4) < 7.0);
+  // Noise is harder, but still bounded
+  for(auto & v : rgba) v = (unsigned char)(std::rand()%256);
+  REQUIRE(rmse(w,h,rgba,igl::BLOCK_COMPRESSION_TYPE_BC1,3) < 80.0);
+  REQUIRE(rmse(w,h,rgba,igl::BLOCK_COMPRESSION_TYPE_BC7,4) < 80.0);
+  // Constant blocks
+  std::fill(rgba.begin(),rgba.end(),(unsigned char)200);
+  REQUIRE(rmse(w,h,rgba,igl::BLOCK_COMPRESSION_TYPE_BC1,3) < 4.0);
+  REQUIRE(rmse(w,h,rgba,igl::BLOCK_COMPRESSION_TYPE_BC7,4) == 0.0);
+  std::vector<unsigned char> copy;
+  igl::block_compress(w,h,rgba.data(),igl::BLOCK_COMPRESSION_TYPE_NONE,copy);
+  REQUIRE(copy == rgba);
+}
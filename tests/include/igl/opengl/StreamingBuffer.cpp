@@ -0,0 +1,82 @@
+#include <test_common.h>
+#include "hidden_window.h"
+#include <igl/opengl/StreamingBuffer.h>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+  // Contents of buffer as rows*cols floats
+  std::vector<float> read_buffer(const GLuint buffer, const int rows, const int cols)
+  {
+    std::vector<float> data(rows*cols);
+    glBindBuffer(GL_ARRAY_BUFFER,buffer);
+    glGetBufferSubData(GL_ARRAY_BUFFER,0,sizeof(float)*data.size(),data.data());
+    return data;
+  }
+}
+
+TEST_CASE("StreamingBuffer: round trips through the ring", "[igl/opengl]")
+{
+  if(!test_common::hidden_window())
+  {
+    WARN("No OpenGL context, skipped");
+    return;
+  }
+  igl::opengl::StreamingBuffer stream;
+  stream.init();
+  // Unmapping without a mapping does nothing
+  stream.unmap();
+  REQUIRE(!stream.is_mapped());
+
+  // More frames than buffers, growing, so that fenced buffers are reused and
+  // reallocated
+  std::vector<GLuint> buffers;
+  for(int frame = 0;frame<2*igl::opengl::StreamingBuffer::RING_SIZE+1;frame++)
+  {
+    const int rows = 100*(frame+1), cols = 3;
+    float * dst = stream.map(rows,cols);
+    REQUIRE(dst != nullptr);
+    REQUIRE(stream.is_mapped());
+    stream.fill([dst,rows,cols,frame]
+    {
+      for(int i = 0;i<rows*cols;i++)
+      {
+        dst[i] = float(frame*100000+i);
+      }
+    });
+    stream.unmap();
+    REQUIRE(!stream.is_mapped());
+    REQUIRE(stream.rows == rows);
+    REQUIRE(stream.cols == cols);
+    const std::vector<float> data = read_buffer(stream.buffer(),rows,cols);
+    int wrong = 0;
+    for(int i = 0;i<rows*cols;i++)
+    {
+      wrong += data[i] != float(frame*100000+i) ? 1 : 0;
+    }
+    REQUIRE(wrong == 0);
+    stream.fence();
+    buffers.push_back(stream.buffer());
+  }
+  // Consecutive frames go to the next buffer of the ring
+  for(size_t f = 1;f<buffers.size();f++)
+  {
+    REQUIRE(buffers[f] != buffers[f-1]);
+  }
+  REQUIRE(buffers[igl::opengl::StreamingBuffer::RING_SIZE] == buffers[0]);
+
+  // Exceptions of the fill come out of unmap, which still unmaps
+  float * dst = stream.map(10,3);
+  REQUIRE(dst != nullptr);
+  stream.fill([]{ throw std::runtime_error("fill failed"); });
+  REQUIRE_THROWS_AS(stream.unmap(),std::runtime_error);
+  REQUIRE(!stream.is_mapped());
+
+  // Nothing to map for empty data
+  REQUIRE(stream.map(0,3) == nullptr);
+  REQUIRE(!stream.is_mapped());
+  stream.unmap();
+  REQUIRE(glGetError() == GL_NO_ERROR);
+  stream.free();
+}
@@ -0,0 +1,183 @@
+#include <test_common.h>
+#include "hidden_window.h"
+#include <igl/opengl/ViewerCore.h>
+#include <igl/opengl/ViewerData.h>
+#include <igl/frustum.h>
+#include <igl/look_at.h>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+  // Framebuffer with color and depth of size w by h, bound for drawing
+  struct Framebuffer
+  {
+    GLuint framebuffer, color, depth;
+    Framebuffer(const int w, const int h)
+    {
+      glGenFramebuffers(1,&framebuffer);
+      glBindFramebuffer(GL_FRAMEBUFFER,framebuffer);
+      glGenTextures(1,&color);
+      glBindTexture(GL_TEXTURE_2D,color);
+      glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA8,w,h,0,GL_RGBA,GL_UNSIGNED_BYTE,nullptr);
+      glFramebufferTexture2D(
+        GL_FRAMEBUFFER,GL_COLOR_ATTACHMENT0,GL_TEXTURE_2D,color,0);
+      glGenRenderbuffers(1,&depth);
+      glBindRenderbuffer(GL_RENDERBUFFER,depth);
+      glRenderbufferStorage(GL_RENDERBUFFER,GL_DEPTH24_STENCIL8,w,h);
+      glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER,GL_DEPTH_STENCIL_ATTACHMENT,GL_RENDERBUFFER,depth);
+      glClearColor(0.3f,0.3f,0.5f,1.0f);
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+    ~Framebuffer()
+    {
+      glBindFramebuffer(GL_FRAMEBUFFER,0);
+      glDeleteRenderbuffers(1,&depth);
+      glDeleteTextures(1,&color);
+      glDeleteFramebuffers(1,&framebuffer);
+    }
+  };
+
+  // Draw data for two eyes into the halves of a 2w by h RGBA image, either
+  // with single-pass stereo or with one pass per eye
+  std::vector<unsigned char> draw_stereo(
+    igl::opengl::ViewerCore & core,
+    igl::opengl::ViewerData & data,
+    const Eigen::Matrix4f (&view)[2],
+    const Eigen::Matrix4f (&proj)[2],
+    const int w,
+    const int h,
+    const bool single_pass_stereo)
+  {
+    std::vector<unsigned char> image(2*w*h*4);
+    core.single_pass_stereo = single_pass_stereo;
+    if(single_pass_stereo)
+    {
+      Framebuffer target(2*w,h);
+      core.viewport << 0, 0, 2*w, h;
+      for(int eye = 0;eye<2;eye++)
+      {
+        core.stereo_view[eye] = view[eye];
+        core.stereo_proj[eye] = proj[eye];
+        core.stereo_norm[eye] = view[eye].inverse().transpose();
+      }
+      core.draw(data,false);
+      glReadPixels(0,0,2*w,h,GL_RGBA,GL_UNSIGNED_BYTE,image.data());
+      return image;
+    }
+    std::vector<unsigned char> eye_image(w*h*4);
+    core.viewport << 0, 0, w, h;
+    for(int eye = 0;eye<2;eye++)
+    {
+      Framebuffer target(w,h);
+      core.view = view[eye];
+      core.proj = proj[eye];
+      core.norm = view[eye].inverse().transpose();
+      core.draw(data,false);
+      glReadPixels(0,0,w,h,GL_RGBA,GL_UNSIGNED_BYTE,eye_image.data());
+      for(int y = 0;y<h;y++)
+      {
+        std::copy(
+          eye_image.begin()+y*w*4,eye_image.begin()+(y+1)*w*4,
+          image.begin()+(y*2*w+eye*w)*4);
+      }
+    }
+    return image;
+  }
+}
+
+TEST_CASE("ViewerCore: single-pass stereo matches two passes", "[igl/opengl]")
+{
+  if(!test_common::hidden_window())
+  {
+    WARN("No OpenGL context, skipped");
+    return;
+  }
+  const int w = 64, h = 48;
+  // Two overlapping triangles, one tilted in depth, with points
+  Eigen::MatrixXd V(4,3);
+  V << -1,-1,0, 1,-1,0, 1,1,0, -1,1,0.5;
+  Eigen::MatrixXi F(2,3);
+  F << 0,1,2, 0,2,3;
+  igl::opengl::ViewerData data;
+  data.set_mesh(V,F);
+  data.add_points(V,Eigen::RowVector3d(1,0,0));
+
+  igl::opengl::ViewerCore core;
+  core.vr = true;
+  // Eyes apart with asymmetric frusta, as on a headset
+  Eigen::Matrix4f view[2], proj[2];
+  for(int eye = 0;eye<2;eye++)
+  {
+    igl::look_at(
+      Eigen::Vector3f(eye ? 0.3f : -0.3f,0,4),Eigen::Vector3f(0,0,0),
+      Eigen::Vector3f(0,1,0),view[eye]);
+    igl::frustum(-0.5f-0.1f*eye,0.5f,-0.4f,0.4f,1.f,100.f,proj[eye]);
+  }
+
+  const std::vector<unsigned char> two_pass =
+    draw_stereo(core,data,view,proj,w,h,false);
+  const std::vector<unsigned char> single_pass =
+    draw_stereo(core,data,view,proj,w,h,true);
+  REQUIRE(glGetError() == GL_NO_ERROR);
+  // Something was drawn in both eyes (red of the background is 0.3)
+  int covered[2] = {0,0};
+  for(int p = 0;p<2*w*h;p++)
+  {
+    covered[(p%(2*w))/w] += std::abs(int(two_pass[p*4])-77) > 1 ? 1 : 0;
+  }
+  REQUIRE(covered[0] > 0);
+  REQUIRE(covered[1] > 0);
+  REQUIRE(covered[0] != covered[1]);
+  // Triangles and points rasterize the same in both halves
+  int differing = 0;
+  for(size_t i = 0;i<two_pass.size();i++)
+  {
+    differing += single_pass[i] != two_pass[i] ? 1 : 0;
+  }
+  REQUIRE(differing == 0);
+
+  // Lines end on other subpixel positions after squeezing each eye into its
+  // half, so they may shift by a pixel
+  data.add_edges(
+    V.topRows(2).array()+0.6,V.bottomRows(2).array()+0.6,
+    Eigen::RowVector3d(0,1,0));
+  const std::vector<unsigned char> two_pass_lines =
+    draw_stereo(core,data,view,proj,w,h,false);
+  const std::vector<unsigned char> single_pass_lines =
+    draw_stereo(core,data,view,proj,w,h,true);
+  REQUIRE(two_pass_lines != two_pass);
+  // Whether the pixel at x,y is covered by a (green) line
+  const auto line = [&](const std::vector<unsigned char> & image, int x, int y)
+  {
+    return image[(y*2*w+x)*4+1] > 160 && image[(y*2*w+x)*4] < 96;
+  };
+  // Each line pixel of one image has one in the other at most a pixel away,
+  // within the same eye
+  int unmatched = 0;
+  for(int y = 0;y<h;y++)
+  {
+    for(int x = 0;x<2*w;x++)
+    {
+      bool matched[2] = {!line(two_pass_lines,x,y),!line(single_pass_lines,x,y)};
+      for(int dy = -1;dy<=1;dy++)
+      {
+        for(int dx = -1;dx<=1;dx++)
+        {
+          const int nx = x+dx, ny = y+dy;
+          if(ny<0 || ny>=h || nx<0 || nx>=2*w || nx/w != x/w)
+          {
+            continue;
+          }
+          matched[0] = matched[0] || line(single_pass_lines,nx,ny);
+          matched[1] = matched[1] || line(two_pass_lines,nx,ny);
+        }
+      }
+      unmatched += (matched[0] ? 0 : 1) + (matched[1] ? 0 : 1);
+    }
+  }
+  REQUIRE(unmatched == 0);
+  data.meshgl.free();
+}
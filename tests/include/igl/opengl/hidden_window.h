@@ -0,0 +1,44 @@
+#ifndef IGL_TESTS_OPENGL_HIDDEN_WINDOW_H
+#define IGL_TESTS_OPENGL_HIDDEN_WINDOW_H
+#include <igl/opengl/gl.h>
+#include <GLFW/glfw3.h>
+
+namespace test_common
+{
+  // Make the OpenGL 4.1 core context of a hidden window current, created on
+  // first use. Returns false if there is no display or driver to create one
+  // (e.g. a CI runner without Xvfb), tests needing OpenGL then skip.
+  inline bool hidden_window()
+  {
+    static GLFWwindow * window = nullptr;
+    static bool failed = false;
+    if(!window && !failed)
+    {
+      failed = true;
+      if(!glfwInit())
+      {
+        return false;
+      }
+      glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+      glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+      glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+      glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+      glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+      window = glfwCreateWindow(64, 64, "libigl_tests", nullptr, nullptr);
+      if(!window)
+      {
+        return false;
+      }
+      glfwMakeContextCurrent(window);
+      failed = !gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+    }
+    if(failed)
+    {
+      return false;
+    }
+    glfwMakeContextCurrent(window);
+    return true;
+  }
+}
+
+#endif
@@ -0,0 +1,156 @@
+#include <test_common.h>
+#include "../opengl/hidden_window.h"
+#include <igl/openvr/VRApplication.h>
+#include <igl/openvr/PoseSource.h>
+#include <igl/opengl/ViewerCore.h>
+#include <igl/opengl/ViewerData.h>
+#include <memory>
+#include <vector>
+
+namespace
+{
+  // Headset sliding along x at 1 m/s
+  Eigen::Matrix4f slide(const double t)
+  {
+    Eigen::Matrix4f T = Eigen::Matrix4f::Identity();
+    T(0,3) = float(t);
+    return T;
+  }
+
+  // Scripted poses on a manual clock, counting the frames it paced
+  class CountingPoseSource : public igl::openvr::ScriptedPoseSource
+  {
+  public:
+    CountingPoseSource(const double & now):
+      igl::openvr::ScriptedPoseSource(slide,0.02f,0,[&now]{ return now; }),
+      waits(0)
+    {}
+    void waitPoses(vr::TrackedDevicePose_t* poses, uint32_t count) override
+    {
+      waits++;
+      igl::openvr::ScriptedPoseSource::waitPoses(poses,count);
+    }
+    int waits;
+  };
+
+  // Application without a VR runtime, recording what it submits
+  class RecordingVRApplication : public igl::openvr::VRApplication
+  {
+  public:
+    RecordingVRApplication(const std::shared_ptr<igl::openvr::PoseSource>& source):
+      igl::openvr::VRApplication(source,64,48),
+      frames(0)
+    {}
+    void submitToHMD() override
+    {
+      frames++;
+      igl::openvr::VRApplication::submitToHMD();
+    }
+    int frames;
+    std::vector<vr::VRTextureWithPose_t> textures;
+  protected:
+    void submit(vr::EVREye, const vr::VRTextureWithPose_t& texture) override
+    {
+      textures.push_back(texture);
+    }
+  };
+}
+
+TEST_CASE("VRApplication: late latching with a scripted pose source", "[igl/openvr]")
+{
+  double now = 0;
+  const auto source = std::make_shared<CountingPoseSource>(now);
+  RecordingVRApplication app(source);
+  app.setLateLatching(true);
+
+  app.updatePose();
+  REQUIRE(source->waits == 1);
+  // Predicted for the photons of the frame (getMatrixPoseHmd is the inverse)
+  REQUIRE(app.getMatrixPoseHmd()(0,3) == Approx(-0.02));
+  now = 0.005;
+  app.latchPose(vr::Eye_Left);
+  REQUIRE(app.getMatrixPoseHmd()(0,3) == Approx(-0.025));
+  now = 0.008;
+  app.latchPose(vr::Eye_Right);
+  now = 0.010;
+  app.submitToHMD();
+  REQUIRE(source->waits == 1);
+  {
+    // Timed on the clock of the pose source
+    const igl::openvr::VRApplication::FrameTiming & timing = app.getFrameTiming();
+    REQUIRE(timing.latches == 2);
+    REQUIRE(timing.frame == Approx(10));
+    REQUIRE(timing.latchedPose == Approx(2));
+    REQUIRE(timing.saved == Approx(8));
+  }
+  // Each eye goes to the compositor with the pose it was drawn with
+  REQUIRE(app.textures.size() == 2);
+  REQUIRE(app.textures[vr::Eye_Left].mDeviceToAbsoluteTracking.m[0][3] == Approx(0.025));
+  REQUIRE(app.textures[vr::Eye_Right].mDeviceToAbsoluteTracking.m[0][3] == Approx(0.028));
+
+  // Without late latching both eyes use the poses of the wait
+  app.setLateLatching(false);
+  app.textures.clear();
+  now = 0.011;
+  app.updatePose();
+  now = 0.015;
+  app.latchPose(vr::Eye_Left);
+  app.latchPose(vr::Eye_Right);
+  app.submitToHMD();
+  {
+    const igl::openvr::VRApplication::FrameTiming & timing = app.getFrameTiming();
+    REQUIRE(timing.latches == 0);
+    REQUIRE(timing.frame == Approx(4));
+    REQUIRE(timing.saved == Approx(0).margin(1e-9));
+  }
+  REQUIRE(app.textures.size() == 2);
+  REQUIRE(app.textures[vr::Eye_Left].mDeviceToAbsoluteTracking.m[0][3] == Approx(0.031));
+  REQUIRE(app.textures[vr::Eye_Right].mDeviceToAbsoluteTracking.m[0][3] == Approx(0.031));
+}
+
+TEST_CASE("VRApplication: one pose wait and one submission per frame", "[igl/openvr]")
+{
+  if(!test_common::hidden_window())
+  {
+    WARN("No OpenGL context, skipped");
+    return;
+  }
+  double now = 0;
+  const auto source = std::make_shared<CountingPoseSource>(now);
+  RecordingVRApplication app(source);
+  app.setLateLatching(true);
+  igl::opengl::ViewerCore core(&app);
+
+  // A row of triangles in front of the headset
+  const int n = 10;
+  std::vector<igl::opengl::ViewerData> data_list(n);
+  for(int i = 0;i<n;i++)
+  {
+    Eigen::MatrixXd V(3,3);
+    V << -0.1, -0.1, -2,
+          0.1, -0.1, -2,
+          0.0,  0.1, -2;
+    V.col(0).array() += 0.3*(i-n/2);
+    data_list[i].set_mesh(V,Eigen::RowVector3i(0,1,2));
+  }
+
+  const int frames = 3;
+  for(const bool single_pass_stereo : {false, true})
+  {
+    core.single_pass_stereo = single_pass_stereo;
+    const int waits = source->waits;
+    const int submitted = app.frames;
+    for(int f = 0;f<frames;f++)
+    {
+      core.drawVR(data_list);
+      // Two-pass stereo latches before each eye, single-pass once
+      REQUIRE(app.getFrameTiming().latches == (single_pass_stereo ? 1 : 2));
+      now += 1.0/90.0;
+    }
+    REQUIRE(source->waits - waits == frames);
+    REQUIRE(app.frames - submitted == frames);
+  }
+  REQUIRE(app.textures.size() == 2*2*frames);
+  REQUIRE(glGetError() == GL_NO_ERROR);
+  core.shut();
+}
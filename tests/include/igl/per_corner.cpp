@@ -0,0 +1,81 @@
+#include <test_common.h>
+#include <igl/per_corner.h>
+#include <igl/triangulated_grid.h>
+
+namespace
+{
+  // Row-by-row reference implementation (what the viewer used to do)
+  template <typename Index>
+  void per_corner_serial(
+    const Eigen::MatrixXd & X,
+    const Eigen::MatrixXi & F,
+    const Index & index,
+    Eigen::Matrix<float,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> & C)
+  {
+    C.resize(F.rows()*3,X.cols());
+    for (int f = 0; f < F.rows(); ++f)
+      for (int c = 0; c < 3; ++c)
+        C.row(f*3+c) = X.row(index(f,c)).template cast<float>();
+  }
+}
+
+TEST_CASE("per_corner: matches serial scatter", "[igl]")
+{
+  typedef Eigen::Matrix<float,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> RowMatrixXf;
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  igl::triangulated_grid(40,30,V,F);
+  const Eigen::MatrixXd XV = Eigen::MatrixXd::Random(V.rows(),4);
+  const Eigen::MatrixXd XF = Eigen::MatrixXd::Random(F.rows(),3);
+  const Eigen::MatrixXd XC = Eigen::MatrixXd::Random(F.rows()*3,3);
+
+  RowMatrixXf expected, C;
+  per_corner_serial(XV,F,[&F](int f,int c){ return F(f,c); },expected);
+  igl::per_corner(XV,F,igl::PER_CORNER_SOURCE_TYPE_VERTEX,C);
+  REQUIRE(C.rows() == F.rows()*3);
+  REQUIRE(C == expected);
+
+  per_corner_serial(XF,F,[](int f,int){ return f; },expected);
+  igl::per_corner(XF,F,igl::PER_CORNER_SOURCE_TYPE_FACE,C);
+  REQUIRE(C == expected);
+
+  // Raw output (e.g. a mapped buffer)
+  std::vector<float> raw(F.rows()*3*XF.cols());
+  igl::per_corner(XF,F,igl::PER_CORNER_SOURCE_TYPE_FACE,raw.data());
+  REQUIRE(Eigen::Map<RowMatrixXf>(raw.data(),F.rows()*3,XF.cols()) == expected);
+
+  per_corner_serial(XC,F,[](int f,int c){ return 3*f+c; },expected);
+  igl::per_corner(XC,F,igl::PER_CORNER_SOURCE_TYPE_CORNER,C);
+  REQUIRE(C == expected);
+}
+
+TEST_CASE("per_corner: benchmark", "[igl]" IGL_DEBUG_OFF)
+{
+  typedef Eigen::Matrix<float,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> RowMatrixXf;
+  // 5M faces
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  igl::triangulated_grid(1582,1582,V,F);
+  const Eigen::MatrixXd N = Eigen::MatrixXd::Random(F.rows(),3);
+  RowMatrixXf C;
+
+  BENCHMARK("serial per vertex") {
+    per_corner_serial(V,F,[&F](int f,int c){ return F(f,c); },C);
+    return C(0,0);
+  };
+
+  BENCHMARK("igl::per_corner per vertex") {
+    igl::per_corner(V,F,igl::PER_CORNER_SOURCE_TYPE_VERTEX,C);
+    return C(0,0);
+  };
+
+  BENCHMARK("serial per face") {
+    per_corner_serial(N,F,[](int f,int){ return f; },C);
+    return C(0,0);
+  };
+
+  BENCHMARK("igl::per_corner per face") {
+    igl::per_corner(N,F,igl::PER_CORNER_SOURCE_TYPE_FACE,C);
+    return C(0,0);
+  };
+}
@@ -0,0 +1,130 @@
+#include <test_common.h>
+#include <igl/point_mesh_squared_distance.h>
+#include <igl/point_simplex_squared_distance.h>
+#include <igl/AABB.h>
+#include <igl/triangulated_grid.h>
+
+namespace
+{
+  // Points scattered around random vertices of V
+  Eigen::MatrixXd near_surface(
+    const Eigen::MatrixXd & V,
+    const int n,
+    const double noise)
+  {
+    Eigen::MatrixXd P = noise*Eigen::MatrixXd::Random(n,V.cols());
+    for(int p = 0;p<n;p++)
+    {
+      P.row(p) += V.row(std::rand()%V.rows());
+    }
+    return P;
+  }
+  // Compare batched squared distances against one query at a time
+  template <typename DerivedV, int DIM>
+  void check_batch(
+    const Eigen::MatrixBase<DerivedV> & V,
+    const Eigen::MatrixXi & F,
+    const Eigen::MatrixBase<DerivedV> & P,
+    const typename DerivedV::Scalar eps)
+  {
+    typedef typename DerivedV::Scalar Scalar;
+    typedef Eigen::Matrix<Scalar,1,DIM> RowVectorDIMS;
+    igl::AABB<DerivedV,DIM> tree;
+    tree.init(V,F);
+    Eigen::Matrix<Scalar,Eigen::Dynamic,1> sqrD;
+    Eigen::VectorXi I;
+    Eigen::Matrix<Scalar,Eigen::Dynamic,Eigen::Dynamic> C;
+    tree.squared_distance(V,F,P,sqrD,I,C);
+    REQUIRE(sqrD.size() == P.rows());
+    REQUIRE(C.rows() == P.rows());
+    REQUIRE(C.cols() == DIM);
+    for(int p = 0;p<P.rows();p++)
+    {
+      int i;
+      RowVectorDIMS c;
+      const RowVectorDIMS q = P.row(p);
+      const Scalar sqr_d = tree.squared_distance(V,F,q,i,c);
+      REQUIRE(std::abs(sqrD(p)-sqr_d) <= eps);
+      // Ties may pick another element, but never another point
+      REQUIRE((C.row(p)-c).norm() <= std::sqrt(eps));
+      Scalar sqr_d_i;
+      RowVectorDIMS c_i;
+      igl::point_simplex_squared_distance<DIM>(q,V,F,I(p),sqr_d_i,c_i);
+      REQUIRE(std::abs(sqr_d_i-sqrD(p)) <= eps);
+    }
+  }
+}
+
+TEST_CASE("point_mesh_squared_distance: packets", "[igl]")
+{
+  std::srand(0);
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::bumpy_torus(60,V,F);
+  // A degenerate triangle with two equal corners
+  F.conservativeResize(F.rows()+1,3);
+  F.bottomRows(1) << 0, 0, 61;
+  // Near the surface, away from it and on it
+  Eigen::MatrixXd P(4000,3);
+  P.topRows(2000) = near_surface(V,2000,0.05);
+  P.middleRows(2000,1000) = 1.5*Eigen::MatrixXd::Random(1000,3);
+  P.bottomRows(1000) = V.topRows(1000);
+  check_batch<Eigen::MatrixXd,3>(V,F,P,1e-15);
+  const Eigen::MatrixXf Vf = V.cast<float>();
+  const Eigen::MatrixXf Pf = P.cast<float>();
+  check_batch<Eigen::MatrixXf,3>(Vf,F,Pf,1e-6f);
+  // Points not filling a packet
+  check_batch<Eigen::MatrixXd,3>(V,F,Eigen::MatrixXd(P.topRows(5)),1e-15);
+  // 2D triangles
+  Eigen::MatrixXd V2;
+  Eigen::MatrixXi F2;
+  igl::triangulated_grid(30,30,V2,F2);
+  check_batch<Eigen::MatrixXd,2>(
+    V2,F2,Eigen::MatrixXd(Eigen::MatrixXd::Random(1000,2)),1e-15);
+  // Same answer through point_mesh_squared_distance
+  Eigen::VectorXd sqrD;
+  Eigen::VectorXi I;
+  Eigen::MatrixXd C;
+  igl::point_mesh_squared_distance(P,V,F,sqrD,I,C);
+  igl::AABB<Eigen::MatrixXd,3> tree;
+  tree.init(V,F);
+  for(int p = 0;p<P.rows();p+=97)
+  {
+    int i;
+    Eigen::RowVector3d c;
+    const double sqr_d =
+      tree.squared_distance(V,F,Eigen::RowVector3d(P.row(p)),i,c);
+    REQUIRE(std::abs(sqrD(p)-sqr_d) <= 1e-15);
+  }
+}
+
+TEST_CASE("point_mesh_squared_distance: benchmark", "[igl][.][benchmark]")
+{
+  // 10M points near a 1M-triangle torus; hidden, run with
+  // libigl_tests "[benchmark]" --benchmark-samples 3
+  std::srand(0);
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::bumpy_torus(708,V,F);
+  const Eigen::MatrixXd P = near_surface(V,10000000,0.05);
+  igl::AABB<Eigen::MatrixXd,3> tree;
+  tree.init(V,F);
+  Eigen::VectorXd sqrD(P.rows());
+  Eigen::VectorXi I;
+  Eigen::MatrixXd C;
+  BENCHMARK("one point at a time")
+  {
+    for(int p = 0;p<P.rows();p++)
+    {
+      int i;
+      Eigen::RowVector3d c;
+      sqrD(p) = tree.squared_distance(V,F,Eigen::RowVector3d(P.row(p)),i,c);
+    }
+    return sqrD.sum();
+  };
+  BENCHMARK("AABB::squared_distance")
+  {
+    tree.squared_distance(V,F,P,sqrD,I,C);
+    return sqrD.sum();
+  };
+}
@@ -0,0 +1,88 @@
+#include <test_common.h>
+#include <igl/ray_mesh_intersect.h>
+#include <igl/unproject_onto_mesh.h>
+#include <igl/FlatAABB.h>
+
+TEST_CASE("ray_mesh_intersect: tree", "[igl]")
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::wavy_grid(30,V,F);
+  igl::FlatAABB<Eigen::MatrixXd,3> tree;
+  tree.init(V,F);
+  int num_hits = 0;
+  for(int r = 0;r<200;r++)
+  {
+    const Eigen::Vector3f s = Eigen::Vector3f::Random();
+    const Eigen::Vector3f d = Eigen::Vector3f::Random();
+    std::vector<igl::Hit> hits_exact, hits;
+    const bool any = igl::ray_mesh_intersect(s,d,V,F,hits_exact);
+    REQUIRE(igl::ray_mesh_intersect(s,d,V,F,tree,hits) == any);
+    REQUIRE(hits.size() == hits_exact.size());
+    igl::Hit hit;
+    REQUIRE(igl::ray_mesh_intersect(s,d,V,F,tree,hit) == any);
+    if(any)
+    {
+      num_hits++;
+      REQUIRE(hit.id == hits_exact.front().id);
+      REQUIRE(hit.t == hits_exact.front().t);
+      REQUIRE(hit.u == hits_exact.front().u);
+      REQUIRE(hit.v == hits_exact.front().v);
+    }
+  }
+  REQUIRE(num_hits > 0);
+}
+
+TEST_CASE("unproject_onto_mesh: tree", "[igl]")
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::wavy_grid(30,V,F);
+  igl::FlatAABB<Eigen::MatrixXd,3> tree;
+  tree.init(V,F);
+  // Orthographic view of [-1,1]³, the grid covering the top right quarter
+  const Eigen::Matrix4f model = Eigen::Matrix4f::Identity();
+  const Eigen::Matrix4f proj = Eigen::Matrix4f::Identity();
+  const Eigen::Vector4f viewport(0,0,100,100);
+  for(int x = 5;x<100;x+=10)
+  {
+    for(int y = 5;y<100;y+=10)
+    {
+      const Eigen::Vector2f pos(x,y);
+      int fid_exact, fid;
+      Eigen::Vector3f bc_exact, bc;
+      const bool any =
+        igl::unproject_onto_mesh(pos,model,proj,viewport,V,F,fid_exact,bc_exact);
+      REQUIRE(any == (x > 50 && y > 50));
+      REQUIRE(
+        igl::unproject_onto_mesh(pos,model,proj,viewport,V,F,tree,fid,bc) ==
+        any);
+      if(any)
+      {
+        REQUIRE(fid == fid_exact);
+        test_common::assert_eq(bc,bc_exact);
+      }
+    }
+  }
+}
+
+TEST_CASE("ray_mesh_intersect: benchmark", "[igl]" IGL_DEBUG_OFF)
+{
+  // 2M triangles
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::wavy_grid(1001,V,F);
+  igl::FlatAABB<Eigen::MatrixXd,3> tree;
+  tree.init(V,F);
+  const Eigen::Vector3f s(0.3f,0.4f,1.f), d(0.1f,0.05f,-1.f);
+  BENCHMARK("ray_mesh_intersect, 1 ray")
+  {
+    igl::Hit hit;
+    return igl::ray_mesh_intersect(s,d,V,F,hit);
+  };
+  BENCHMARK("ray_mesh_intersect with FlatAABB, 1 ray")
+  {
+    igl::Hit hit;
+    return igl::ray_mesh_intersect(s,d,V,F,tree,hit);
+  };
+}
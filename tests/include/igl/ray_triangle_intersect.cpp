@@ -0,0 +1,73 @@
+#include <test_common.h>
+#include <igl/ray_triangle_intersect.h>
+#include <igl/ray_mesh_intersect.h>
+#include <igl/triangulated_grid.h>
+#include <Eigen/Geometry>
+
+TEST_CASE("ray_triangle_intersect: hit", "[igl]")
+{
+  const double v0[3] = {0,0,0}, v1[3] = {2,0,0}, v2[3] = {0,2,0};
+  const double s[3] = {0.5,0.25,1}, d[3] = {0,0,-0.5};
+  double t,u,v;
+  REQUIRE(igl::ray_triangle_intersect(s,d,v0,v1,v2,t,u,v));
+  REQUIRE(t == Approx(2));
+  REQUIRE(u == Approx(0.25));
+  REQUIRE(v == Approx(0.125));
+  // Either side
+  const double s_below[3] = {0.5,0.25,-1}, d_up[3] = {0,0,1};
+  REQUIRE(igl::ray_triangle_intersect(s_below,d_up,v0,v1,v2,t,u,v));
+  REQUIRE(t == Approx(1));
+  // Behind the source, outside, parallel
+  const double d_away[3] = {0,0,1};
+  REQUIRE(!igl::ray_triangle_intersect(s,d_away,v0,v1,v2,t,u,v));
+  const double s_out[3] = {1.5,1.5,1};
+  REQUIRE(!igl::ray_triangle_intersect(s_out,d,v0,v1,v2,t,u,v));
+  const double d_flat[3] = {1,0,0};
+  REQUIRE(!igl::ray_triangle_intersect(s,d_flat,v0,v1,v2,t,u,v));
+}
+
+TEST_CASE("ray_triangle_intersect: watertight", "[igl]")
+{
+  // Tilted grid, rays through every vertex and edge midpoint from random
+  // directions never slip between the triangles
+  Eigen::MatrixXd GV;
+  Eigen::MatrixXi F;
+  igl::triangulated_grid(11,11,GV,F);
+  Eigen::MatrixXd V = Eigen::MatrixXd::Zero(GV.rows(),3);
+  V.leftCols(2) = GV;
+  const Eigen::Matrix3d R =
+    Eigen::AngleAxisd(0.3,Eigen::Vector3d(1,2,3).normalized()).matrix();
+  V = (V*R.transpose()).eval();
+  const Eigen::RowVector3d n = Eigen::RowVector3d(0,0,1)*R.transpose();
+  std::vector<Eigen::RowVector3d> targets;
+  for(int f = 0;f<F.rows();f++)
+  {
+    for(int c = 0;c<3;c++)
+    {
+      targets.push_back(V.row(F(f,c)));
+      targets.push_back(0.5*(V.row(F(f,c))+V.row(F(f,(c+1)%3))));
+    }
+  }
+  for(const auto & target : targets)
+  {
+    // Skip the boundary of the grid
+    const Eigen::RowVector3d g = target*R;
+    if(g.head<2>().minCoeff() < 1e-8 || g.head<2>().maxCoeff() > 1-1e-8)
+    {
+      continue;
+    }
+    for(int r = 0;r<4;r++)
+    {
+      Eigen::RowVector3d d = Eigen::RowVector3d::Random();
+      // Come from above
+      if(d.dot(n) > -0.1)
+      {
+        d -= (d.dot(n)+0.5)*n;
+      }
+      const Eigen::RowVector3d s = target - 2.*d;
+      std::vector<igl::Hit> hits;
+      REQUIRE(igl::ray_mesh_intersect(s,d,V,F,hits));
+      REQUIRE(hits.front().t == Approx(2));
+    }
+  }
+}
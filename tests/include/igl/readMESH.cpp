@@ -0,0 +1,110 @@
+#include <test_common.h>
+#include <igl/readMESH.h>
+#include <igl/writeMESH.h>
+#include <igl/boundary_facets.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+  // The reader of an opened FILE, which the Eigen reader taking a file name
+  // falls back to
+  bool readMESH_FILE(
+    const std::string & path,
+    Eigen::MatrixXd & V,
+    Eigen::MatrixXi & T,
+    Eigen::MatrixXi & F)
+  {
+    FILE * fp = fopen(path.c_str(),"r");
+    return fp != NULL && igl::readMESH(fp,V,T,F);
+  }
+}
+
+TEST_CASE("readMESH: parallel reader matches FILE reader", "[igl]")
+{
+  // Large enough for several chunks
+  const std::string path = "test_readMESH_grid.mesh";
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi T,F;
+  test_common::tet_grid(60,V,T);
+  igl::boundary_facets(T,F);
+  REQUIRE(igl::writeMESH(path,V,T,F));
+  Eigen::MatrixXd rV,eV;
+  Eigen::MatrixXi rT,rF,eT,eF;
+  REQUIRE(readMESH_FILE(path,eV,eT,eF));
+  REQUIRE(igl::readMESH(path,rV,rT,rF));
+  REQUIRE(rV.size() == eV.size());
+  REQUIRE(std::memcmp(rV.data(),eV.data(),sizeof(double)*rV.size()) == 0);
+  REQUIRE(rT == eT);
+  REQUIRE(rF == eF);
+  REQUIRE(rV == V);
+  REQUIRE(rT == T);
+  REQUIRE(rF == F);
+
+  Eigen::Matrix<float,Eigen::Dynamic,3,Eigen::RowMajor> Vf;
+  Eigen::MatrixXi Tf;
+  Eigen::Matrix<unsigned int,Eigen::Dynamic,3,Eigen::RowMajor> Ff;
+  REQUIRE(igl::readMESH(path,Vf,Tf,Ff));
+  REQUIRE(Vf == V.cast<float>());
+  REQUIRE(Ff == F.cast<unsigned int>());
+  std::remove(path.c_str());
+}
+
+TEST_CASE("readMESH: irregular files fall back to FILE reader", "[igl]")
+{
+  const std::string path = "test_readMESH_irregular.mesh";
+  const char * files[] = {
+    // Records spanning lines, version on the next line
+    "# comment\nMeshVersionFormatted\n1\nDimension 3\nVertices\n4\n"
+    "0 0 0 1\n1 0\n0 1\n0 1 0 1 0 0 1 1\nTriangles\n1\n1 2 3 0\n"
+    "Tetrahedra\n1\n1 2 3 4 0\n",
+    // Comments between sections, no triangles, no final newline
+    "MeshVersionFormatted 1\n\nDimension 3\n# vertices\nVertices\n4\n"
+    "0 0 0 1\n1 0 0 1\n0 1 0 1\n0 0 1e0 1\n\nTriangles\n0\nTetrahedra\n1\n1 2 3 4 0"};
+  for(const char * contents : files)
+  {
+    {
+      std::ofstream s(path);
+      s << contents;
+    }
+    Eigen::MatrixXd V,eV;
+    Eigen::MatrixXi T,F,eT,eF;
+    REQUIRE(readMESH_FILE(path,eV,eT,eF));
+    REQUIRE(igl::readMESH(path,V,T,F));
+    REQUIRE(V == eV);
+    REQUIRE(T == eT);
+    REQUIRE(F == eF);
+    REQUIRE(V.rows() == 4);
+    REQUIRE(T.rows() == 1);
+    REQUIRE(T.row(0) == Eigen::RowVector4i(0,1,2,3));
+  }
+  {
+    std::ofstream s(path);
+    s << "MeshVersionFormatted 2\nDimension 3\n";
+  }
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi T,F;
+  REQUIRE(!igl::readMESH(path,V,T,F));
+  std::remove(path.c_str());
+}
+
+TEST_CASE("readMESH: benchmark", "[igl]" IGL_DEBUG_OFF)
+{
+  // About 2M tets
+  const std::string path = "test_readMESH_benchmark.mesh";
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi T,F;
+  test_common::tet_grid(70,V,T);
+  igl::boundary_facets(T,F);
+  REQUIRE(igl::writeMESH(path,V,T,F));
+  BENCHMARK("FILE reader")
+  {
+    return readMESH_FILE(path,V,T,F);
+  };
+  BENCHMARK("igl::readMESH")
+  {
+    return igl::readMESH(path,V,T,F);
+  };
+  std::remove(path.c_str());
+}
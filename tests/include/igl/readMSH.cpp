@@ -0,0 +1,250 @@
+#include <test_common.h>
+#include <igl/readMSH.h>
+#include <igl/boundary_facets.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
+namespace
+{
+  template <typename T>
+  void put(std::ofstream & s, const T x)
+  {
+    s.write(reinterpret_cast<const char *>(&x),sizeof(T));
+  }
+
+  // Write V, a point, the boundary triangles and the tets T like gmsh (in
+  // version 2.2 or 4.1). Node tags are first+stride*i.
+  void write_msh(
+    const std::string & path,
+    const int version,
+    const bool binary,
+    const Eigen::MatrixXd & V,
+    const Eigen::MatrixXi & T,
+    const int first = 1,
+    const int stride = 1)
+  {
+    Eigen::MatrixXi F;
+    igl::boundary_facets(T,F);
+    std::ofstream s(path, std::ios::binary);
+    s << std::setprecision(17);
+    s << "$MeshFormat\n" << (version == 2 ? "2.2" : "4.1") << " " << binary << " 8\n";
+    if(binary)
+    {
+      put(s,int(1));
+      s << "\n";
+    }
+    s << "$EndMeshFormat\n";
+    s << "$PhysicalNames\n1\n3 1 \"volume\"\n$EndPhysicalNames\n";
+    const auto tag = [&](const int i){ return first + stride*i; };
+    // Element blocks of a type and nodes
+    const Eigen::MatrixXi P = Eigen::MatrixXi::Zero(1,1);
+    const Eigen::MatrixXi * blocks[] = {&P, &F, &T};
+    const int types[] = {15, 2, 4};
+    if(version == 2)
+    {
+      s << "$Nodes\n" << V.rows() << "\n";
+      for(int i = 0;i<V.rows();i++)
+      {
+        if(binary)
+        {
+          put(s,int(tag(i)));
+          for(int j = 0;j<3;j++) put(s,V(i,j));
+        }else
+        {
+          s << tag(i) << " " << V(i,0) << " " << V(i,1) << " " << V(i,2) << "\n";
+        }
+      }
+      s << (binary ? "\n" : "") << "$EndNodes\n";
+      s << "$Elements\n" << (1+F.rows()+T.rows()) << "\n";
+      int e = 1;
+      for(int b = 0;b<3;b++)
+      {
+        const Eigen::MatrixXi & E = *blocks[b];
+        if(binary)
+        {
+          put(s,types[b]);
+          put(s,int(E.rows()));
+          put(s,2);
+        }
+        for(int i = 0;i<E.rows();i++,e++)
+        {
+          if(binary)
+          {
+            put(s,e);
+            put(s,1);
+            put(s,b);
+            for(int j = 0;j<E.cols();j++) put(s,tag(E(i,j)));
+          }else
+          {
+            s << e << " " << types[b] << " 2 1 " << b;
+            for(int j = 0;j<E.cols();j++) s << " " << tag(E(i,j));
+            s << "\n";
+          }
+        }
+      }
+      s << (binary ? "\n" : "") << "$EndElements\n";
+      s << "$NodeData\n1\n\"u\"\n0\n3\n0\n1\n0\n$EndNodeData\n";
+      return;
+    }
+    s << "$Entities\n1 0 0 1\n1 0 0 0\n1 0 0 0 1 1 1 1 1 0\n$EndEntities\n";
+    // Nodes in two blocks
+    const std::int64_t half = V.rows()/2;
+    const std::int64_t sizes[] = {half, V.rows()-half};
+    s << "$Nodes\n";
+    const std::int64_t header[] = {2, V.rows(), tag(0), tag(V.rows()-1)};
+    for(int j = 0;j<4;j++)
+    {
+      if(binary) put(s,std::uint64_t(header[j])); else s << header[j] << (j<3 ? " " : "\n");
+    }
+    for(int b = 0;b<2;b++)
+    {
+      const int begin = b == 0 ? 0 : half;
+      if(binary)
+      {
+        put(s,3); put(s,1); put(s,0); put(s,std::uint64_t(sizes[b]));
+        for(int i = begin;i<begin+sizes[b];i++) put(s,std::uint64_t(tag(i)));
+        for(int i = begin;i<begin+sizes[b];i++) for(int j = 0;j<3;j++) put(s,V(i,j));
+      }else
+      {
+        s << "3 1 0 " << sizes[b] << "\n";
+        for(int i = begin;i<begin+sizes[b];i++) s << tag(i) << "\n";
+        for(int i = begin;i<begin+sizes[b];i++)
+        {
+          s << V(i,0) << " " << V(i,1) << " " << V(i,2) << "\n";
+        }
+      }
+    }
+    s << (binary ? "\n" : "") << "$EndNodes\n";
+    const std::int64_t count = 1+F.rows()+T.rows();
+    const std::int64_t eheader[] = {3, count, 1, count};
+    s << "$Elements\n";
+    for(int j = 0;j<4;j++)
+    {
+      if(binary) put(s,std::uint64_t(eheader[j])); else s << eheader[j] << (j<3 ? " " : "\n");
+    }
+    int e = 1;
+    for(int b = 0;b<3;b++)
+    {
+      const Eigen::MatrixXi & E = *blocks[b];
+      if(binary)
+      {
+        put(s,b == 0 ? 0 : b+1); put(s,1); put(s,types[b]); put(s,std::uint64_t(E.rows()));
+      }else
+      {
+        s << (b == 0 ? 0 : b+1) << " 1 " << types[b] << " " << E.rows() << "\n";
+      }
+      for(int i = 0;i<E.rows();i++,e++)
+      {
+        if(binary)
+        {
+          put(s,std::uint64_t(e));
+          for(int j = 0;j<E.cols();j++) put(s,std::uint64_t(tag(E(i,j))));
+        }else
+        {
+          s << e;
+          for(int j = 0;j<E.cols();j++) s << " " << tag(E(i,j));
+          s << "\n";
+        }
+      }
+    }
+    s << (binary ? "\n" : "") << "$EndElements\n";
+  }
+}
+
+TEST_CASE("readMSH: versions 2.2 and 4.1", "[igl]")
+{
+  // Large enough for several chunks
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi T;
+  test_common::tet_grid(40,V,T);
+  const std::string path = "test_readMSH.msh";
+  for(const int version : {2, 4})
+  {
+    for(const bool binary : {false, true})
+    {
+      write_msh(path,version,binary,V,T);
+      Eigen::MatrixXd rV;
+      Eigen::MatrixXi rT;
+      REQUIRE(igl::readMSH(path,rV,rT));
+      REQUIRE(rV == V);
+      REQUIRE(rT == T);
+      // Row major output of binary coordinates
+      Eigen::Matrix<double,Eigen::Dynamic,3,Eigen::RowMajor> Vr;
+      Eigen::Matrix<int,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> Tr;
+      REQUIRE(igl::readMSH(path,Vr,Tr));
+      REQUIRE(Vr == V);
+      REQUIRE(Tr == T);
+      Eigen::MatrixXf Vf;
+      REQUIRE(igl::readMSH(path,Vf,rT));
+      REQUIRE(Vf == V.cast<float>());
+    }
+  }
+  // Node tags other than 1..#V
+  for(const bool binary : {false, true})
+  {
+    write_msh(path,4,binary,V,T,10,3);
+    Eigen::MatrixXd rV;
+    Eigen::MatrixXi rT;
+    REQUIRE(igl::readMSH(path,rV,rT));
+    REQUIRE(rV == V);
+    REQUIRE(rT == T);
+  }
+  std::remove(path.c_str());
+}
+
+TEST_CASE("readMSH: invalid files", "[igl]")
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi T;
+  test_common::tet_grid(4,V,T);
+  const std::string path = "test_readMSH_invalid.msh";
+  Eigen::MatrixXd rV;
+  Eigen::MatrixXi rT;
+  {
+    std::ofstream s(path);
+    s << "$MeshFormat\n4.0 0 8\n$EndMeshFormat\n";
+  }
+  REQUIRE(!igl::readMSH(path,rV,rT));
+  // Node out of range
+  T(3,2) = V.rows();
+  write_msh(path,2,false,V,T);
+  REQUIRE(!igl::readMSH(path,rV,rT));
+  // Truncated
+  T(3,2) = 0;
+  write_msh(path,4,true,V,T);
+  std::string contents;
+  {
+    std::ifstream s(path, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(s),std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream s(path, std::ios::binary);
+    s << contents.substr(0,contents.size()/2);
+  }
+  REQUIRE(!igl::readMSH(path,rV,rT));
+  std::remove(path.c_str());
+}
+
+TEST_CASE("readMSH: benchmark", "[igl]" IGL_DEBUG_OFF)
+{
+  // About 2M tets
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi T;
+  test_common::tet_grid(70,V,T);
+  const std::string ascii = "test_readMSH_benchmark_ascii.msh";
+  const std::string binary = "test_readMSH_benchmark_binary.msh";
+  write_msh(ascii,2,false,V,T);
+  write_msh(binary,4,true,V,T);
+  BENCHMARK("ASCII 2.2")
+  {
+    return igl::readMSH(ascii,V,T);
+  };
+  BENCHMARK("binary 4.1")
+  {
+    return igl::readMSH(binary,V,T);
+  };
+  std::remove(ascii.c_str());
+  std::remove(binary.c_str());
+}
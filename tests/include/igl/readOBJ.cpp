@@ -1,5 +1,11 @@
 #include <igl/readOBJ.h>
+#include <igl/list_to_matrix.h>
+#include <igl/triangulated_grid.h>
 #include <test_common.h>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <string>
 #include <tuple>
@@ -39,3 +45,139 @@ TEST_CASE("readOBJ: Obj with material", "[igl]")
     }
     REQUIRE (FM.size() == 2);
 }
+
+namespace
+{
+  // What the Eigen wrappers of readOBJ returned before the parallel reader
+  bool readOBJ_line_by_line(
+    const std::string & path,
+    Eigen::MatrixXd & V,
+    Eigen::MatrixXd & TC,
+    Eigen::MatrixXd & N,
+    Eigen::MatrixXi & F,
+    Eigen::MatrixXi & FTC,
+    Eigen::MatrixXi & FN)
+  {
+    std::vector<std::vector<double> > vV,vTC,vN;
+    std::vector<std::vector<int> > vF,vFTC,vFN;
+    return
+      igl::readOBJ(path,vV,vTC,vN,vF,vFTC,vFN) &&
+      igl::list_to_matrix(vV,V) &&
+      igl::list_to_matrix(vF,F) &&
+      (vN.empty() || igl::list_to_matrix(vN,N)) &&
+      (vTC.empty() || igl::list_to_matrix(vTC,TC)) &&
+      (vFN.empty() || vFN[0].empty() || igl::list_to_matrix(vFN,FN)) &&
+      (vFTC.empty() || vFTC[0].empty() || igl::list_to_matrix(vFTC,FTC));
+  }
+
+  // Grid with texture coordinates and normals, using all number formats
+  // and relative indices in the second half
+  void write_grid_obj(const std::string & path, const int n)
+  {
+    Eigen::MatrixXd V;
+    Eigen::MatrixXi F;
+    igl::triangulated_grid(n,n,V,F);
+    V = (V.array() * 1e3 - 0.1).matrix();
+    std::ofstream s(path);
+    s << "# generated\nmtllib grid.mtl\no grid\r\n";
+    for(int i = 0;i<V.rows();i++)
+    {
+      s << "v " << std::setprecision(i%3 == 0 ? 17 : 6) << V(i,0) << "\t" <<
+        V(i,1) << " " << (i%5 == 0 ? "1e-3" : "-0.0") << "\n";
+      s << "vt " << std::setprecision(i%50 == 0 ? 23 : 9) << V(i,0)/1e3 << " " << V(i,1)/1e3 << "\n";
+      s << "vn 0 0 " << (i%2 ? "+1" : "1.") << "\n";
+    }
+    s << "g faces\nusemtl red\ns off\n";
+    for(int f = 0;f<F.rows();f++)
+    {
+      s << "f";
+      for(int c = 0;c<3;c++)
+      {
+        const int i = f < F.rows()/2 ? F(f,c)+1 : F(f,c)-int(V.rows());
+        s << " " << i << "/" << i << "/" << i;
+      }
+      s << (f%7 ? "\n" : "\r\n");
+    }
+  }
+}
+
+TEST_CASE("readOBJ: parallel reader matches line-by-line reader", "[igl]")
+{
+  // Large enough for several chunks
+  const std::string path = "test_readOBJ_grid.obj";
+  write_grid_obj(path,200);
+  Eigen::MatrixXd V,TC,N,eV,eTC,eN;
+  Eigen::MatrixXi F,FTC,FN,eF,eFTC,eFN;
+  REQUIRE(readOBJ_line_by_line(path,eV,eTC,eN,eF,eFTC,eFN));
+  REQUIRE(igl::readOBJ(path,V,TC,N,F,FTC,FN));
+  REQUIRE(V.rows() == 200*200);
+  // Bitwise: == on doubles would not distinguish 0.0 and -0.0
+  REQUIRE(V.size() == eV.size());
+  REQUIRE(std::memcmp(V.data(),eV.data(),sizeof(double)*V.size()) == 0);
+  REQUIRE(TC.size() == eTC.size());
+  REQUIRE(std::memcmp(TC.data(),eTC.data(),sizeof(double)*TC.size()) == 0);
+  REQUIRE(N == eN);
+  REQUIRE(F == eF);
+  REQUIRE(FTC == eFTC);
+  REQUIRE(FN == eFN);
+
+  Eigen::Matrix<float,Eigen::Dynamic,3,Eigen::RowMajor> Vf;
+  Eigen::Matrix<unsigned int,Eigen::Dynamic,3,Eigen::RowMajor> Ff;
+  REQUIRE(igl::readOBJ(path,Vf,Ff));
+  REQUIRE(Vf == eV.cast<float>());
+  REQUIRE(Ff == eF.cast<unsigned int>());
+}
+
+TEST_CASE("readOBJ: irregular files fall back to line-by-line reader", "[igl]")
+{
+  const std::string path = "test_readOBJ_mixed.obj";
+  {
+    // Mixed triangles and quads
+    std::ofstream s(path);
+    s << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3\nf 1 2 3 4\n";
+  }
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  REQUIRE(!igl::readOBJ(path,V,F));
+  {
+    // Vertices with an extra weight and a trailing comment, which the
+    // parallel reader leaves alone
+    std::ofstream s(path);
+    s << "v 0 0 0 1\nv 1 0 0 1\nv 0 1 0 1 # top\nf -3 -2 -1\n";
+  }
+  Eigen::MatrixXd TC,N,eV,eTC,eN;
+  Eigen::MatrixXi FTC,FN,eF,eFTC,eFN;
+  REQUIRE(readOBJ_line_by_line(path,eV,eTC,eN,eF,eFTC,eFN));
+  REQUIRE(igl::readOBJ(path,V,TC,N,F,FTC,FN));
+  REQUIRE(V == eV);
+  REQUIRE(F == eF);
+}
+
+TEST_CASE("readOBJ: benchmark", "[igl][.][benchmark]")
+{
+  // About 4.5M faces; hidden, run with libigl_tests "[benchmark]"
+  const std::string path = "test_readOBJ_benchmark.obj";
+  write_grid_obj(path,1500);
+  std::ifstream in(path, std::ifstream::ate | std::ifstream::binary);
+  const double megabytes = double(in.tellg()) / (1 << 20);
+  Eigen::MatrixXd V,TC,N;
+  Eigen::MatrixXi F,FTC,FN;
+
+  BENCHMARK("line by line") {
+    return readOBJ_line_by_line(path,V,TC,N,F,FTC,FN);
+  };
+
+  BENCHMARK("igl::readOBJ") {
+    return igl::readOBJ(path,V,TC,N,F,FTC,FN);
+  };
+
+  const auto throughput = [&](const std::function<bool()> & read)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    read();
+    return megabytes /
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+  WARN("line by line: " << throughput([&]{ return readOBJ_line_by_line(path,V,TC,N,F,FTC,FN); }) << " MB/s");
+  WARN("igl::readOBJ: " << throughput([&]{ return igl::readOBJ(path,V,TC,N,F,FTC,FN); }) << " MB/s");
+}
@@ -0,0 +1,150 @@
+#include <test_common.h>
+#include <igl/readSTL.h>
+#include <igl/remove_duplicate_vertices.h>
+#include <igl/writeSTL.h>
+#include <cstdio>
+#include <map>
+
+namespace
+{
+  // Welded (V,F) merges the corners of the soup (sV,sF) like
+  // remove_duplicate_vertices
+  void check_weld(
+    const Eigen::MatrixXd & sV,
+    const Eigen::MatrixXi & sF,
+    const double epsilon,
+    const Eigen::MatrixXd & V,
+    const Eigen::MatrixXi & F)
+  {
+    Eigen::MatrixXd SV;
+    Eigen::VectorXi SVI,SVJ;
+    Eigen::MatrixXi SF;
+    igl::remove_duplicate_vertices(sV,sF,epsilon,SV,SVI,SVJ,SF);
+    REQUIRE(V.rows() == SV.rows());
+    REQUIRE(F.rows() == sF.rows());
+    // Same partition of the corners
+    std::map<int,int> to_SF;
+    for(int f = 0;f<F.rows();f++)
+    {
+      for(int c = 0;c<3;c++)
+      {
+        const auto it = to_SF.insert(std::make_pair(F(f,c),SF(f,c))).first;
+        REQUIRE(it->second == SF(f,c));
+        if(epsilon == 0)
+        {
+          REQUIRE(V.row(F(f,c)) == sV.row(sF(f,c)));
+        }
+      }
+    }
+    REQUIRE(to_SF.size() == std::size_t(SV.rows()));
+    // Numbered by first appearance
+    REQUIRE(F(0,0) == 0);
+    REQUIRE(V.row(0) == sV.row(sF(0,0)));
+  }
+}
+
+TEST_CASE("readSTL: binary", "[igl]")
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::grid_mesh(60,V,F);
+  const std::string path = "test_readSTL.stl";
+  REQUIRE(igl::writeSTL(path,V,F,false));
+
+  // Same soup as reading with stdio
+  std::vector<std::vector<double> > vV,vN;
+  std::vector<std::vector<int> > vF;
+  REQUIRE(igl::readSTL(path,vV,vF,vN));
+  Eigen::MatrixXd sV,sN;
+  Eigen::MatrixXi sF;
+  REQUIRE(igl::readSTL(path,sV,sF,sN));
+  REQUIRE(sV.rows() == 3*F.rows());
+  for(int i = 0;i<sV.rows();i++)
+  {
+    REQUIRE(sV(i,0) == vV[i][0]);
+    REQUIRE(sV(i,1) == vV[i][1]);
+    REQUIRE(sV(i,2) == vV[i][2]);
+  }
+  for(int f = 0;f<sF.rows();f++)
+  {
+    REQUIRE(sF.row(f) == Eigen::RowVector3i(vF[f][0],vF[f][1],vF[f][2]));
+    REQUIRE(sN.row(f) == Eigen::RowVector3d(vN[f][0],vN[f][1],vN[f][2]));
+  }
+
+  Eigen::MatrixXd wV,wN;
+  Eigen::MatrixXi wF;
+  REQUIRE(igl::readSTL(path,0,wV,wF,wN));
+  REQUIRE(wV.rows() == V.rows());
+  REQUIRE(wN == sN);
+  check_weld(sV,sF,0,wV,wF);
+  // Float positions written for the grid are welded back to the grid
+  const Eigen::MatrixXd fV = V.cast<float>().cast<double>();
+  for(int f = 0;f<F.rows();f++)
+  {
+    for(int c = 0;c<3;c++)
+    {
+      REQUIRE(wV.row(wF(f,c)) == fV.row(F(f,c)));
+    }
+  }
+
+  for(const double epsilon : {1e-7, 1e-3, 0.05})
+  {
+    REQUIRE(igl::readSTL(path,epsilon,wV,wF,wN));
+    check_weld(sV,sF,epsilon,wV,wF);
+  }
+
+  // Truncated file
+  {
+    FILE * fp = fopen(path.c_str(),"rb");
+    std::vector<char> head(84+50*10);
+    REQUIRE(fread(head.data(),1,head.size(),fp) == head.size());
+    fclose(fp);
+    fp = fopen(path.c_str(),"wb");
+    fwrite(head.data(),1,head.size(),fp);
+    fclose(fp);
+  }
+  REQUIRE(!igl::readSTL(path,wV,wF,wN));
+  REQUIRE(!igl::readSTL(path,0,wV,wF,wN));
+  std::remove(path.c_str());
+}
+
+TEST_CASE("readSTL: ascii", "[igl]")
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::grid_mesh(20,V,F);
+  const std::string path = "test_readSTL_ascii.stl";
+  REQUIRE(igl::writeSTL(path,V,F,true));
+  Eigen::MatrixXd sV,sN,wV,wN;
+  Eigen::MatrixXi sF,wF;
+  REQUIRE(igl::readSTL(path,sV,sF,sN));
+  REQUIRE(sV.rows() == 3*F.rows());
+  REQUIRE(igl::readSTL(path,0,wV,wF,wN));
+  REQUIRE(wN == sN);
+  check_weld(sV,sF,0,wV,wF);
+  std::remove(path.c_str());
+}
+
+TEST_CASE("readSTL: welding benchmark", "[igl]" IGL_DEBUG_OFF)
+{
+  Eigen::MatrixXd V;
+  Eigen::MatrixXi F;
+  test_common::grid_mesh(300,V,F);
+  const std::string path = "test_readSTL_benchmark.stl";
+  REQUIRE(igl::writeSTL(path,V,F,false));
+  Eigen::MatrixXd sV,sN,SV;
+  Eigen::MatrixXi sF,SF;
+  Eigen::VectorXi SVI,SVJ;
+  BENCHMARK("readSTL + remove_duplicate_vertices")
+  {
+    igl::readSTL(path,sV,sF,sN);
+    igl::remove_duplicate_vertices(sV,sF,0,SV,SVI,SVJ,SF);
+    return SV.rows();
+  };
+  BENCHMARK("readSTL welding")
+  {
+    igl::readSTL(path,0,sV,sF,sN);
+    return sV.rows();
+  };
+  std::remove(path.c_str());
+}
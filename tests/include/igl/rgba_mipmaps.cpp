@@ -0,0 +1,42 @@
+#include <test_common.h>
+#include <igl/rgba_mipmaps.h>
+
+TEST_CASE("rgba_mipmaps: sizes and averages", "[igl]")
+{
+  const int w = 13, h = 6;
+  std::vector<unsigned char> rgba(w*h*4);
+  for(int i = 0;i<w*h*4;i++)
+  {
+    rgba[i] = (unsigned char)((i*37)%256);
+  }
+  std::vector<std::vector<unsigned char> > levels;
+  igl::rgba_mipmaps(w,h,rgba.data(),levels);
+  // 6x3, 3x1, 1x1
+  REQUIRE(levels.size() == 3);
+  REQUIRE(levels[0].size() == 6*3*4);
+  REQUIRE(levels[1].size() == 3*1*4);
+  REQUIRE(levels[2].size() == 1*1*4);
+  const auto at = [&](int x,int y,int c){ return int(rgba[(y*w+x)*4+c]); };
+  // Pixel (1,2) of level 1 averages the 2x2 block at (2,4)
+  for(int c = 0;c<4;c++)
+  {
+    const int sum = at(2,4,c)+at(3,4,c)+at(2,5,c)+at(3,5,c);
+    REQUIRE(int(levels[0][(2*6+1)*4+c]) == (sum+2)/4);
+    // Last column of an odd width averages three columns
+    int sum3 = 0;
+    for(int x = 10;x<13;x++) sum3 += at(x,0,c)+at(x,1,c);
+    REQUIRE(int(levels[0][5*4+c]) == (sum3+3)/6);
+  }
+  // Constant images stay constant
+  std::vector<unsigned char> gray(w*h*4,77);
+  igl::rgba_mipmaps(w,h,gray.data(),levels);
+  for(const auto & level : levels)
+  {
+    for(const unsigned char v : level)
+    {
+      REQUIRE(v == 77);
+    }
+  }
+  igl::rgba_mipmaps(1,1,gray.data(),levels);
+  REQUIRE(levels.empty());
+}
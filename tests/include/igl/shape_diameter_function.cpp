@@ -0,0 +1,49 @@
+#include <test_common.h>
+#include <igl/shape_diameter_function.h>
+#include <igl/AABB.h>
+#include <igl/per_vertex_normals.h>
+#include <igl/triangulated_grid.h>
+#include <igl/PI.h>
+
+TEST_CASE("shape_diameter_function: AABB", "[igl]")
+{
+  // Torus with tube radius 0.4, n by n vertices
+  Eigen::MatrixXd UV, V, N;
+  Eigen::MatrixXi F;
+  igl::triangulated_grid(40,40,UV,F);
+  V.resize(UV.rows(),3);
+  for(int v = 0;v<V.rows();v++)
+  {
+    const double a = 2.*igl::PI*UV(v,0);
+    const double b = 2.*igl::PI*UV(v,1);
+    V.row(v) << (1.+0.4*cos(b))*cos(a), (1.+0.4*cos(b))*sin(a), 0.4*sin(b);
+  }
+  igl::per_vertex_normals(V,F,N);
+  igl::AABB<Eigen::MatrixXd,3> aabb;
+  aabb.init(V,F);
+  const auto & shoot_ray = [&aabb,&V,&F](
+    const Eigen::Vector3f& _s,
+    const Eigen::Vector3f& dir)->double
+  {
+    const Eigen::Vector3f s = _s+1e-4*dir;
+    igl::Hit hit;
+    if(aabb.intersect_ray(
+      V,F,Eigen::RowVector3d(s.cast<double>()),
+      Eigen::RowVector3d(dir.cast<double>()),hit))
+    {
+      return hit.t;
+    }
+    return std::numeric_limits<double>::infinity();
+  };
+  Eigen::VectorXd S, S_exact;
+  // Same random directions
+  srand(0);
+  igl::shape_diameter_function(shoot_ray,V,N,32,S_exact);
+  srand(0);
+  igl::shape_diameter_function(aabb,V,F,V,N,32,S);
+  test_common::assert_eq(S,S_exact);
+  // Rays inward across the tube, on average not much longer than its
+  // diameter
+  REQUIRE(S.minCoeff() > 0.2);
+  REQUIRE(S.maxCoeff() < 1);
+}
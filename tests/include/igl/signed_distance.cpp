@@ -1,5 +1,7 @@
 #include <test_common.h>
 #include <igl/signed_distance.h>
+#include <igl/triangulated_grid.h>
+#include <igl/PI.h>
 
 TEST_CASE("signed_distance: single_tet", "[igl]")
 {
@@ -63,3 +65,48 @@ TEST_CASE("signed_distance: single_triangle", "[igl]")
     test_common::assert_near(S,Sexact,1e-15);
   }
 }
+
+TEST_CASE("signed_distance: bounds", "[igl]")
+{
+  // Torus around the z-axis
+  Eigen::MatrixXd UV, V;
+  Eigen::MatrixXi F;
+  igl::triangulated_grid(40,40,UV,F);
+  V.resize(UV.rows(),3);
+  for(int v = 0;v<V.rows();v++)
+  {
+    const double a = 2.*igl::PI*UV(v,0);
+    const double b = 2.*igl::PI*UV(v,1);
+    V.row(v) << (1.+0.4*cos(b))*cos(a), (1.+0.4*cos(b))*sin(a), 0.4*sin(b);
+  }
+  const Eigen::MatrixXd P = 1.5*Eigen::MatrixXd::Random(2000,3);
+  for(const igl::SignedDistanceType type :
+      {
+      igl::SIGNED_DISTANCE_TYPE_PSEUDONORMAL  ,
+      igl::SIGNED_DISTANCE_TYPE_WINDING_NUMBER,
+      igl::SIGNED_DISTANCE_TYPE_UNSIGNED      })
+  {
+    // Unbounded queries all at once, loose bounds one at a time
+    Eigen::VectorXd S, S_bounded;
+    Eigen::VectorXi I, I_bounded;
+    Eigen::MatrixXd C, C_bounded, N, N_bounded;
+    igl::signed_distance(P,V,F,type,S,I,C,N);
+    igl::signed_distance(
+      P,V,F,type,-10.,10.,S_bounded,I_bounded,C_bounded,N_bounded);
+    test_common::assert_near(S,S_bounded,1e-12);
+    test_common::assert_near(C,C_bounded,1e-7);
+    // Tight bounds leave far points out
+    igl::signed_distance(
+      P,V,F,type,-0.1,0.1,S_bounded,I_bounded,C_bounded,N_bounded);
+    for(int p = 0;p<P.rows();p++)
+    {
+      if(std::abs(S(p)) < 0.05)
+      {
+        REQUIRE(std::abs(S_bounded(p)-S(p)) < 1e-12);
+      }else if(std::abs(S(p)) > 0.15)
+      {
+        REQUIRE(std::isnan(S_bounded(p)));
+      }
+    }
+  }
+}
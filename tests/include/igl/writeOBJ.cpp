@@ -0,0 +1,182 @@
+#include <test_common.h>
+#include <igl/readOBJ.h>
+#include <igl/writeOBJ.h>
+#include <igl/write_rows.h>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace
+{
+  std::string file_contents(const std::string & path)
+  {
+    std::ifstream f(path, std::ios::binary);
+    std::stringstream s;
+    s << f.rdbuf();
+    return s.str();
+  }
+
+  // Values that exercise every branch of the number formatting
+  Eigen::MatrixXd awkward_values(const int n)
+  {
+    Eigen::MatrixXd V = Eigen::MatrixXd::Random(n,3);
+    V.col(1) *= 1e6;
+    V.col(2) = (V.col(2)*1000).array().round();
+    V(0,0) = -0.0;
+    V(0,1) = 1e300;
+    V(0,2) = std::numeric_limits<double>::denorm_min();
+    V(1,0) = 1e17;
+    V(1,1) = 99999999999999999.0;
+    V(1,2) = -12345678901234567.0;
+    V(2,0) = 0.1;
+    V(2,1) = -std::numeric_limits<double>::max();
+    V(2,2) = 1e-5;
+    return V;
+  }
+
+  // Compare to the previous implementation streaming Eigen::IOFormat
+  template <typename DerivedV>
+  void check_same_as_ioformat(
+    const Eigen::MatrixBase<DerivedV> & V,
+    const Eigen::MatrixXi & F)
+  {
+    using namespace Eigen;
+    std::ofstream s("test_writeOBJ_reference.obj");
+    s<<
+      V.format(IOFormat(FullPrecision,DontAlignCols," ","\n","v ","","","\n"))<<
+      (F.array()+1).format(IOFormat(FullPrecision,DontAlignCols," ","\n","f ","","","\n"));
+    s.close();
+    REQUIRE(igl::writeOBJ("test_writeOBJ.obj",V,F));
+    REQUIRE(file_contents("test_writeOBJ.obj") ==
+      file_contents("test_writeOBJ_reference.obj"));
+  }
+}
+
+TEST_CASE("append_number: printf", "[igl]")
+{
+  const Eigen::MatrixXd V = awkward_values(1000);
+  for(const int precision : {1, 6, 9, 15, 16, 17, 30})
+  {
+    for(Eigen::Index i = 0;i<V.size();i++)
+    {
+      char buf[128];
+      snprintf(buf,sizeof(buf),"%.*g",precision,V(i));
+      std::string out;
+      igl::append_number(out,V(i),precision);
+      REQUIRE(out == buf);
+    }
+  }
+  for(const long long x :
+    {0LL, 7LL, -7LL, std::numeric_limits<long long>::min(),
+      std::numeric_limits<long long>::max()})
+  {
+    std::string out;
+    igl::append_integer(out,x);
+    REQUIRE(out == std::to_string(x));
+  }
+  std::string out;
+  igl::append_integer(out,std::numeric_limits<unsigned>::max());
+  REQUIRE(out == std::to_string(std::numeric_limits<unsigned>::max()));
+}
+
+TEST_CASE("writeOBJ: same text as fprintf", "[igl]")
+{
+  const Eigen::MatrixXd V = awkward_values(50000);
+  Eigen::MatrixXi F = (Eigen::MatrixXd::Random(70000,3).array().abs()*
+    (V.rows()-1)).cast<int>();
+  const Eigen::MatrixXd CN = Eigen::MatrixXd::Random(300,3);
+  const Eigen::MatrixXd TC = Eigen::MatrixXd::Random(200,2);
+  const Eigen::MatrixXi FN = (F.array()*CN.rows())/V.rows();
+  const Eigen::MatrixXi FTC = (F.array()*TC.rows())/V.rows();
+
+  // Previous implementation writing line by line
+  const auto reference = [&](const std::string & path,const bool N,const bool T)
+  {
+    FILE * fp = fopen(path.c_str(),"w");
+    for(int i = 0;i<(int)V.rows();i++)
+    {
+      fprintf(fp,"v");
+      for(int j = 0;j<(int)V.cols();++j)
+      {
+        fprintf(fp," %0.17g", V(i,j));
+      }
+      fprintf(fp,"\n");
+    }
+    if(N)
+    {
+      for(int i = 0;i<(int)CN.rows();i++)
+      {
+        fprintf(fp,"vn %0.17g %0.17g %0.17g\n",CN(i,0),CN(i,1),CN(i,2));
+      }
+      fprintf(fp,"\n");
+    }
+    if(T)
+    {
+      for(int i = 0;i<(int)TC.rows();i++)
+      {
+        fprintf(fp, "vt %0.17g %0.17g\n",TC(i,0),TC(i,1));
+      }
+      fprintf(fp,"\n");
+    }
+    for(int i = 0;i<(int)F.rows();++i)
+    {
+      fprintf(fp,"f");
+      for(int j = 0; j<(int)F.cols();++j)
+      {
+        fprintf(fp," %u",F(i,j)+1);
+        if(T)
+          fprintf(fp,"/%u",FTC(i,j)+1);
+        if(N)
+        {
+          if (T)
+            fprintf(fp,"/%u",FN(i,j)+1);
+          else
+            fprintf(fp,"//%u",FN(i,j)+1);
+        }
+      }
+      fprintf(fp,"\n");
+    }
+    fclose(fp);
+  };
+
+  const Eigen::MatrixXd empty_d;
+  const Eigen::MatrixXi empty_i;
+  for(const bool N : {false, true})
+  {
+    for(const bool T : {false, true})
+    {
+      reference("test_writeOBJ_reference.obj",N,T);
+      REQUIRE(igl::writeOBJ("test_writeOBJ.obj",V,F,
+        N ? CN : empty_d, N ? FN : empty_i,
+        T ? TC : empty_d, T ? FTC : empty_i));
+      REQUIRE(file_contents("test_writeOBJ.obj") ==
+        file_contents("test_writeOBJ_reference.obj"));
+    }
+  }
+  std::remove("test_writeOBJ.obj");
+  std::remove("test_writeOBJ_reference.obj");
+}
+
+TEST_CASE("writeOBJ: same text as Eigen::IOFormat", "[igl]")
+{
+  using namespace Eigen;
+  const MatrixXd V = awkward_values(40000);
+  const MatrixXi F = (MatrixXd::Random(30000,3).array().abs()*
+    (V.rows()-1)).cast<int>();
+  check_same_as_ioformat(V,F);
+  check_same_as_ioformat(MatrixXf(V.cast<float>()),F);
+  // Point cloud
+  check_same_as_ioformat(V,MatrixXi(0,3));
+
+  // Written text is read back (FullPrecision may round the last digit)
+  const MatrixXd W = MatrixXd::Random(V.rows(),3);
+  REQUIRE(igl::writeOBJ("test_writeOBJ.obj",W,F));
+  MatrixXd rV;
+  MatrixXi rF;
+  REQUIRE(igl::readOBJ("test_writeOBJ.obj",rV,rF));
+  REQUIRE((rV-W).cwiseAbs().maxCoeff() < 1e-14);
+  REQUIRE(rF == F);
+  std::remove("test_writeOBJ.obj");
+  std::remove("test_writeOBJ_reference.obj");
+}
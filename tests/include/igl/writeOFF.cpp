@@ -0,0 +1,68 @@
+#include <test_common.h>
+#include <igl/readOFF.h>
+#include <igl/writeOFF.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+  std::string file_contents(const std::string & path)
+  {
+    std::ifstream f(path, std::ios::binary);
+    std::stringstream s;
+    s << f.rdbuf();
+    return s.str();
+  }
+}
+
+TEST_CASE("writeOFF: same text as Eigen::IOFormat", "[igl]")
+{
+  using namespace Eigen;
+  MatrixXd V = MatrixXd::Random(40000,3);
+  V.col(1) = (V.col(1)*100).array().round();
+  V(0,0) = -0.0;
+  V(0,1) = 1e300;
+  V(0,2) = 1e-320;
+  const MatrixXi F = (MatrixXd::Random(30000,3).array().abs()*
+    (V.rows()-1)).cast<int>();
+  const MatrixXd C = MatrixXd::Random(V.rows(),3).array().abs();
+
+  // Previous implementation streaming Eigen::IOFormat
+  {
+    std::ofstream s("test_writeOFF_reference.off");
+    s<<
+      "OFF\n"<<V.rows()<<" "<<F.rows()<<" 0\n"<<
+      V.format(IOFormat(FullPrecision,DontAlignCols," ","\n","","","","\n"))<<
+      (F.array()).format(IOFormat(FullPrecision,DontAlignCols," ","\n","3 ","","","\n"));
+  }
+  REQUIRE(igl::writeOFF("test_writeOFF.off",V,F));
+  REQUIRE(file_contents("test_writeOFF.off") ==
+    file_contents("test_writeOFF_reference.off"));
+
+  {
+    const MatrixXd RGB_Array = 255.0*C;
+    std::ofstream s("test_writeOFF_reference.off");
+    s<< "COFF\n"<<V.rows()<<" "<<F.rows()<<" 0\n";
+    for (unsigned i=0; i< V.rows(); i++)
+    {
+      s <<V.row(i).format(IOFormat(FullPrecision,DontAlignCols," "," ","","",""," "));
+      s << unsigned(RGB_Array(i,0)) << " " << unsigned(RGB_Array(i,1)) << " " << unsigned(RGB_Array(i,2)) << " 255\n";
+    }
+    s<<(F.array()).format(IOFormat(FullPrecision,DontAlignCols," ","\n","3 ","","","\n"));
+  }
+  REQUIRE(igl::writeOFF("test_writeOFF.off",V,F,C));
+  REQUIRE(file_contents("test_writeOFF.off") ==
+    file_contents("test_writeOFF_reference.off"));
+
+  // Written text is read back (FullPrecision may round the last digit)
+  const MatrixXd W = MatrixXd::Random(V.rows(),3);
+  REQUIRE(igl::writeOFF("test_writeOFF.off",W,F));
+  MatrixXd rV;
+  MatrixXi rF;
+  REQUIRE(igl::readOFF("test_writeOFF.off",rV,rF));
+  REQUIRE((rV-W).cwiseAbs().maxCoeff() < 1e-14);
+  REQUIRE(rF == F);
+  std::remove("test_writeOFF.off");
+  std::remove("test_writeOFF_reference.off");
+}
@@ -1,6 +1,7 @@
 #include <test_common.h>
 #include <igl/readPLY.h>
 #include <igl/writePLY.h>
+#include <cstdio>
 #include <fstream>
 #include <string>
 #include <vector>
@@ -77,3 +78,47 @@ TEST_CASE("writePLY: bunny.ply", "[igl]")
     // there are comments
     REQUIRE (comments.size() == 2);
 }
+
+TEST_CASE("writePLY: encoding", "[igl]")
+{
+    Eigen::MatrixXd V = Eigen::MatrixXd::Random(5000,3);
+    Eigen::MatrixXi F = (Eigen::MatrixXd::Random(7000,3).array().abs()*4999).cast<int>();
+    // Row major positions are written without a copy
+    const Eigen::Matrix<double,Eigen::Dynamic,3,Eigen::RowMajor> rV = V;
+    for(const igl::FileEncoding encoding : {igl::FileEncoding::Binary, igl::FileEncoding::Ascii})
+    {
+        REQUIRE (igl::writePLY("test_encoding.ply", rV, F, encoding));
+        std::ifstream f("test_encoding.ply");
+        std::string line;
+        std::getline(f,line);
+        std::getline(f,line);
+        REQUIRE (line == (encoding == igl::FileEncoding::Binary ?
+            "format binary_little_endian 1.0" : "format ascii 1.0"));
+        f.close();
+
+        Eigen::MatrixXd V2;
+        Eigen::MatrixXi F2;
+        REQUIRE (igl::readPLY("test_encoding.ply", V2, F2));
+        if(encoding == igl::FileEncoding::Binary)
+        {
+            REQUIRE (V2 == V);
+        }else
+        {
+            REQUIRE ((V2-V).cwiseAbs().maxCoeff() < 1e-5);
+        }
+        REQUIRE (F2 == F);
+    }
+
+    // Interleaved vertex properties
+    const Eigen::MatrixXd N = Eigen::MatrixXd::Random(V.rows(),3);
+    const Eigen::MatrixXd UV = Eigen::MatrixXd::Random(V.rows(),2);
+    REQUIRE (igl::writePLY("test_encoding.ply", V, F, N, UV, igl::FileEncoding::Binary));
+    Eigen::MatrixXd V2,N2,UV2;
+    Eigen::MatrixXi F2,E2;
+    REQUIRE (igl::readPLY("test_encoding.ply", V2, F2, E2, N2, UV2));
+    REQUIRE (V2 == V);
+    REQUIRE (N2 == N);
+    REQUIRE (UV2 == UV);
+    REQUIRE (F2 == F);
+    std::remove("test_encoding.ply");
+}
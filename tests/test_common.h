@@ -6,6 +6,8 @@
 #include <igl/readDMAT.h>
 
 #include <igl/find.h>
+#include <igl/triangulated_grid.h>
+#include <igl/PI.h>
 
 #include <Eigen/Core>
 #include <catch2/catch.hpp>
@@ -97,6 +99,65 @@ namespace test_common
     return std::string(LIBIGL_DATA_DIR) + "/" + s;
   };
 
+  // Bumpy n by n grid in 3D
+  inline void grid_mesh(const int n, Eigen::MatrixXd & V, Eigen::MatrixXi & F)
+  {
+    Eigen::MatrixXd V2;
+    igl::triangulated_grid(n,n,V2,F);
+    V.resize(V2.rows(),3);
+    V << V2, V2.col(0).array().sin()*V2.col(1).array();
+  }
+
+  // Wavy n by n grid over [0,1]², 2(n-1)² triangles
+  inline void wavy_grid(const int n, Eigen::MatrixXd & V, Eigen::MatrixXi & F)
+  {
+    Eigen::MatrixXd GV;
+    igl::triangulated_grid(n,n,GV,F);
+    V.resize(GV.rows(),3);
+    V.leftCols(2) = GV;
+    for(int v = 0;v<V.rows();v++)
+    {
+      V(v,2) = 0.1*sin(4.*igl::PI*V(v,0))*cos(3.*igl::PI*V(v,1));
+    }
+  }
+
+  // Torus with a bumpy tube, n by n vertices
+  inline void bumpy_torus(const int n, Eigen::MatrixXd & V, Eigen::MatrixXi & F)
+  {
+    Eigen::MatrixXd UV;
+    igl::triangulated_grid(n,n,UV,F);
+    V.resize(UV.rows(),3);
+    for(int v = 0;v<V.rows();v++)
+    {
+      const double a = 2.*igl::PI*UV(v,0);
+      const double b = 2.*igl::PI*UV(v,1);
+      const double r = 0.4+0.05*sin(5.*a)*sin(3.*b);
+      V.row(v) << (1.+r*cos(b))*cos(a), (1.+r*cos(b))*sin(a), r*sin(b);
+    }
+  }
+
+  // Grid of n^3 vertices with 6 tets per cube, jittered
+  inline void tet_grid(const int n, Eigen::MatrixXd & V, Eigen::MatrixXi & T)
+  {
+    V.resize(n*n*n,3);
+    for(int i = 0;i<n*n*n;i++)
+    {
+      V.row(i) << i%n, (i/n)%n, i/(n*n);
+    }
+    V += 0.1*Eigen::MatrixXd::Random(V.rows(),3);
+    const int m = n-1;
+    T.resize(6*m*m*m,4);
+    const int paths[6][3] = {{1,n,n*n},{1,n*n,n},{n,1,n*n},{n,n*n,1},{n*n,1,n},{n*n,n,1}};
+    for(int c = 0;c<m*m*m;c++)
+    {
+      const int v = c%m + n*((c/m)%m) + n*n*(c/(m*m));
+      for(int p = 0;p<6;p++)
+      {
+        T.row(6*c+p) << v, v+paths[p][0], v+paths[p][0]+paths[p][1], v+1+n+n*n;
+      }
+    }
+  }
+
   template <typename DerivedA, typename DerivedB>
   void assert_eq(
     const Eigen::MatrixBase<DerivedA> & A,
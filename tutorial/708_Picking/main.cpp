@@ -17,19 +17,22 @@ int main(int argc, char *argv[])
   C = Eigen::MatrixXd::Constant(F.rows(),3,1);
   igl::opengl::glfw::Viewer viewer;
   viewer.callback_mouse_down =
-    [&V,&F,&C](igl::opengl::glfw::Viewer& viewer, int, int)->bool
+    [&C](igl::opengl::glfw::Viewer& viewer, int, int)->bool
   {
     int fid;
     Eigen::Vector3f bc;
-    // Cast a ray in the view direction starting from the mouse position
+    // Cast a ray in the view direction starting from the mouse position,
+    // through the bounding volume hierarchy cached by the mesh
     double x = viewer.current_mouse_x;
     double y = viewer.core().viewport(3) - viewer.current_mouse_y;
+    igl::opengl::ViewerData & data = viewer.data();
     if(igl::unproject_onto_mesh(Eigen::Vector2f(x,y), viewer.core().view,
-      viewer.core().proj, viewer.core().viewport, V, F, fid, bc))
+      viewer.core().proj, viewer.core().viewport, data.V, data.F,
+      data.picking_tree(), fid, bc))
     {
       // paint hit red
       C.row(fid)<<1,0,0;
-      viewer.data().set_colors(C);
+      data.set_colors(C);
       return true;
     }
     return false;